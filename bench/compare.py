@@ -0,0 +1,89 @@
+#!/usr/bin/env python3
+"""
+@file compare.py
+@author Abdulelah Mulla
+
+Compare two google-benchmark JSON results, as written by the
+bench_json target, and flag the benchmarks that got slower.
+
+    bench/compare.py old.json new.json [--threshold 0.10] [--metric cpu_time]
+
+With repetitions the median aggregate is compared. Exits with 1 if
+any benchmark regressed by more than the threshold, so it can gate CI.
+"""
+
+import argparse
+import json
+import sys
+
+UNIT_NS = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+
+def load(path, metric):
+    """Benchmark name to time in ns."""
+    with open(path) as f:
+        results = json.load(f)
+    times = {}
+    medians = {}
+    for bench in results.get("benchmarks", []):
+        if bench.get("error_occurred"):
+            continue
+        value = bench[metric] * UNIT_NS[bench.get("time_unit", "ns")]
+        if bench.get("run_type") == "aggregate":
+            if bench.get("aggregate_name") == "median":
+                medians[bench["run_name"]] = value
+            continue
+        name = bench.get("run_name", bench["name"])
+        # Keep the first repetition, replaced by the median if there is one
+        times.setdefault(name, value)
+    times.update(medians)
+    return times
+
+
+def format_ns(value):
+    for unit, scale in (("s", 1e9), ("ms", 1e6), ("us", 1e3)):
+        if value >= scale:
+            return "%.2f %s" % (value / scale, unit)
+    return "%.1f ns" % value
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[1])
+    parser.add_argument("old")
+    parser.add_argument("new")
+    parser.add_argument("--threshold", type=float, default=0.10,
+                        help="relative slowdown that counts as a regression (default 0.10)")
+    parser.add_argument("--metric", choices=("real_time", "cpu_time"), default="real_time")
+    args = parser.parse_args()
+
+    old = load(args.old, args.metric)
+    new = load(args.new, args.metric)
+
+    regressions = 0
+    width = max((len(name) for name in old.keys() | new.keys()), default=10)
+    print("%-*s %12s %12s %9s" % (width, "benchmark", "old", "new", "change"))
+    for name in sorted(old.keys() | new.keys()):
+        if name not in old or name not in new:
+            print("%-*s %12s %12s %9s" % (width, name,
+                                          format_ns(old[name]) if name in old else "-",
+                                          format_ns(new[name]) if name in new else "-",
+                                          "removed" if name in old else "added"))
+            continue
+        change = (new[name] - old[name]) / old[name] if old[name] > 0 else 0.0
+        flag = ""
+        if change > args.threshold:
+            flag = "  REGRESSION"
+            regressions += 1
+        elif change < -args.threshold:
+            flag = "  improved"
+        print("%-*s %12s %12s %+8.1f%%%s" % (width, name, format_ns(old[name]), format_ns(new[name]),
+                                            100.0 * change, flag))
+
+    if regressions:
+        print("\n%d benchmark(s) slower by more than %.0f%%" % (regressions, 100.0 * args.threshold))
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
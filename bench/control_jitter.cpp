@@ -0,0 +1,178 @@
+/**
+ * @file control_jitter.cpp
+ * @author Abdulelah Mulla
+ * @brief Control loop jitter under GCS command load
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mode_manager.h"
+#include "rate_groups.h"
+#include "vehicle.h"
+#include "morb.h"
+
+#include <mavsdk/mavsdk.h>
+#include <mavsdk/server_component.h>
+#include <mavsdk/plugins/action_server/action_server.h>
+
+/**
+ * @brief One second of the POSITION group, as reported by the rate groups.
+ */
+struct Window {
+    uint32_t max_latency_us; // IMU trigger to cycle start
+    uint32_t max_run_us;
+    uint64_t overruns;
+};
+
+static uint32_t percentile(std::vector<uint32_t> values, float p) {
+    if (values.empty()) {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    const size_t index = std::min(values.size() - 1, static_cast<size_t>(p * values.size()));
+    return values[index];
+}
+
+static void print_phase(const char *name, const std::vector<Window> &windows, uint64_t requests) {
+    std::vector<uint32_t> latency, run;
+    uint64_t overruns = 0;
+    for (const Window &window : windows) {
+        latency.push_back(window.max_latency_us);
+        run.push_back(window.max_run_us);
+        overruns = std::max(overruns, window.overruns);
+    }
+    if (!windows.empty()) {
+        overruns -= windows.front().overruns;
+    }
+    std::printf("%-8s %8zu %10lu %10u %10u %10u %10u %10lu\n", name, windows.size(),
+                static_cast<unsigned long>(requests), percentile(latency, 0.5f), percentile(latency, 0.99f),
+                latency.empty() ? 0u : *std::max_element(latency.begin(), latency.end()),
+                run.empty() ? 0u : *std::max_element(run.begin(), run.end()),
+                static_cast<unsigned long>(overruns));
+}
+
+/**
+ * Drives the mode manager from a simulated 1 kHz IMU, first alone and
+ * then while threads flood it with mode changes as a busy GCS would,
+ * and prints how late the control cycles start after their trigger.
+ * Each sample is the worst cycle of one second.
+ *
+ * --seconds=<n>: length of each phase (default 10)
+ * --threads=<n>: command threads in the loaded phase (default 8)
+ */
+int main(int argc, char *argv[]) {
+    int seconds = 10;
+    int threads = 8;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg(argv[i]);
+        if (arg.find("--seconds=") == 0) {
+            seconds = std::max(1, std::stoi(arg.substr(10)));
+        } else if (arg.find("--threads=") == 0) {
+            threads = std::max(1, std::stoi(arg.substr(10)));
+        } else {
+            std::cout << "Usage: " << argv[0] << " [--seconds=<n>] [--threads=<n>]" << std::endl;
+            return 1;
+        }
+    }
+
+    /// Autopilot and GCS over loopback, as the mode manager tests do
+    mavsdk::Mavsdk mavsdk_autopilot{mavsdk::Mavsdk::Configuration{mavsdk::ComponentType::Autopilot}};
+    mavsdk_autopilot.add_any_connection("udpout://127.0.0.1:14570");
+    auto server = mavsdk_autopilot.server_component();
+    mavsdk::Mavsdk mavsdk_gcs{mavsdk::Mavsdk::Configuration{mavsdk::ComponentType::GroundStation}};
+    mavsdk_gcs.add_any_connection("udpin://127.0.0.1:14570");
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (mavsdk_gcs.systems().empty() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    if (mavsdk_gcs.systems().empty()) {
+        std::cerr << "No system discovered" << std::endl;
+        return 1;
+    }
+
+    Morb morb;
+    mavsdk::ActionServer action{server};
+    Vehicle vehicle(server, mavsdk_gcs.systems()[0], &morb);
+    ModeManager manager(vehicle, action, &morb);
+    manager.initialize_modes();
+
+    std::mutex windows_mutex;
+    std::vector<Window> windows;
+    morb.subscribe<RateGroupReport>("rate_group_stats", [&](const RateGroupReport &report) {
+        const RateGroupStats &position = report.groups[static_cast<int>(RateGroup::POSITION)];
+        std::lock_guard<std::mutex> lock(windows_mutex);
+        windows.push_back({position.max_latency_us, position.max_run_us, position.overruns});
+    });
+    RateGroups &groups = RateGroups::initialize();
+    groups.attach(&morb);
+
+    /// Simulated IMU
+    std::atomic<bool> running{true};
+    std::thread imu([&] {
+        /// Stands in for the gz-transport thread, left at its default policy
+        auto next = std::chrono::steady_clock::now();
+        while (running.load()) {
+            next += std::chrono::milliseconds(1);
+            std::this_thread::sleep_until(next);
+            groups.tick(std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+    });
+
+    manager.start();
+    manager.activate_takeoff();
+    manager.change_mode(mavsdk::ActionServer::FlightMode::Hold);
+
+    auto phase = [&](int loaders, uint64_t &requests) {
+        {
+            std::lock_guard<std::mutex> lock(windows_mutex);
+            windows.clear();
+        }
+        std::atomic<bool> loading{true};
+        std::atomic<uint64_t> sent{0};
+        std::vector<std::thread> gcs;
+        for (int i = 0; i < loaders; i++) {
+            gcs.emplace_back([&] {
+                while (loading.load()) {
+                    manager.change_mode(mavsdk::ActionServer::FlightMode::Mission);
+                    manager.change_mode(mavsdk::ActionServer::FlightMode::Hold);
+                    manager.arm();
+                    sent.fetch_add(3, std::memory_order_relaxed);
+                }
+            });
+        }
+        std::this_thread::sleep_for(std::chrono::seconds(seconds));
+        loading.store(false);
+        for (std::thread &thread : gcs) {
+            thread.join();
+        }
+        requests = sent.load();
+        std::lock_guard<std::mutex> lock(windows_mutex);
+        return windows;
+    };
+
+    uint64_t idle_requests = 0, loaded_requests = 0;
+    const std::vector<Window> idle = phase(0, idle_requests);
+    const std::vector<Window> loaded = phase(threads, loaded_requests);
+
+    manager.stop();
+    running.store(false);
+    imu.join();
+    groups.detach();
+
+    std::printf("%-8s %8s %10s %10s %10s %10s %10s %10s\n", "phase", "seconds", "requests",
+                "p50 us", "p99 us", "max us", "run us", "overruns");
+    print_phase("idle", idle, idle_requests);
+    print_phase("loaded", loaded, loaded_requests);
+    return 0;
+}
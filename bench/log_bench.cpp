@@ -0,0 +1,38 @@
+/**
+ * @file log_bench.cpp
+ * @author Abdulelah Mulla
+ * @brief Microbenchmarks of the log files
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "log.h"
+
+#include <gz/msgs.hh>
+#include <benchmark/benchmark.h>
+
+/// One IMU sample into the sensor log, as every gazebo callback does
+static void BM_SensorLogImu(benchmark::State &state) {
+    gz::msgs::IMU msg;
+    msg.mutable_angular_velocity()->set_x(0.01);
+    msg.mutable_angular_velocity()->set_y(-0.02);
+    msg.mutable_angular_velocity()->set_z(0.03);
+    msg.mutable_linear_acceleration()->set_z(-9.81);
+    msg.mutable_orientation()->set_w(1.0);
+    uint64_t time = 0;
+    MITL_LOG &log = MITL_LOG::initialize();
+    for (auto _ : state) {
+        log.sensor_log(msg, "[IMU]", time++);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SensorLogImu);
+
+/// One line into the program log
+static void BM_ProgramLog(benchmark::State &state) {
+    MITL_LOG &log = MITL_LOG::initialize();
+    for (auto _ : state) {
+        log.program_log("[Bench] program log line");
+    }
+}
+BENCHMARK(BM_ProgramLog);
@@ -0,0 +1,61 @@
+/**
+ * @file morb_bench.cpp
+ * @author Abdulelah Mulla
+ * @brief Microbenchmarks of the message bus
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include <string>
+
+#include "vehicle_state.h"
+#include "morb.h"
+
+#include <benchmark/benchmark.h>
+
+/// Publish a state to N subscribers, as the estimator does every IMU sample
+static void BM_MorbPublish(benchmark::State &state) {
+    Morb morb;
+    uint64_t received = 0;
+    for (int64_t i = 0; i < state.range(0); i++) {
+        morb.subscribe<VehicleState>("vehicle_state", [&received](const VehicleState &vehicle_state) {
+            received += vehicle_state.timestamp;
+        });
+    }
+    /// Other topics in the map, as in the running system
+    for (int i = 0; i < 16; i++) {
+        morb.subscribe<int>("topic_" + std::to_string(i), [](const int &) {});
+    }
+    VehicleState vehicle_state{};
+    for (auto _ : state) {
+        vehicle_state.timestamp++;
+        morb.publish<VehicleState>("vehicle_state", vehicle_state);
+    }
+    benchmark::DoNotOptimize(received);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MorbPublish)->Arg(1)->Arg(4)->Arg(16);
+
+/// Publish on a topic nobody listens to
+static void BM_MorbPublishNoSubscriber(benchmark::State &state) {
+    Morb morb;
+    morb.subscribe<int>("other", [](const int &) {});
+    VehicleState vehicle_state{};
+    for (auto _ : state) {
+        morb.publish<VehicleState>("vehicle_state", vehicle_state);
+    }
+}
+BENCHMARK(BM_MorbPublishNoSubscriber);
+
+/// Subscribe N callbacks to one topic
+static void BM_MorbSubscribe(benchmark::State &state) {
+    for (auto _ : state) {
+        Morb morb;
+        for (int64_t i = 0; i < state.range(0); i++) {
+            morb.subscribe<VehicleState>("vehicle_state", [](const VehicleState &) {});
+        }
+        benchmark::DoNotOptimize(morb);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MorbSubscribe)->Arg(1)->Arg(16);
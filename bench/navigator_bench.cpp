@@ -0,0 +1,86 @@
+/**
+ * @file navigator_bench.cpp
+ * @author Abdulelah Mulla
+ * @brief Microbenchmarks of the navigator and the modes
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "navigator/navigator.h"
+#include "vehicle_state.h"
+#include "morb.h"
+
+#include <benchmark/benchmark.h>
+
+/**
+ * @brief A mode that only counts its calls, so the benchmark measures
+ * the dispatch.
+ */
+class CountingMode : public Mode {
+public:
+    uint64_t calls{0};
+
+    void on_inactive() override {calls++;}
+    void on_activation() override {calls++;}
+    void on_inactivation() override {calls++;}
+    void on_active() override {calls++;}
+    bool is_complete() const override {return false;}
+};
+
+/// Every mode run once, one of them active, as Navigator::run() does
+static void BM_ModeRunDispatch(benchmark::State &state) {
+    CountingMode modes[MODE_COUNT];
+    Mode *table[MODE_COUNT];
+    for (int i = 0; i < MODE_COUNT; i++) {
+        table[i] = &modes[i];
+    }
+    Mode *current = table[static_cast<int>(ModeId::HOLD)];
+    for (auto _ : state) {
+        for (int i = 0; i < MODE_COUNT; i++) {
+            table[i]->run(current == table[i]);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * MODE_COUNT);
+}
+BENCHMARK(BM_ModeRunDispatch);
+
+/// Hovering at 10 m over the reference, level
+static VehicleState hover_state() {
+    VehicleState state{};
+    state.timestamp = 1;
+    state.q[0] = 1.f;
+    state.accel[2] = -9.81f;
+    state.position[2] = -10.f;
+    state.lat = 47.3977;
+    state.lon = 8.5456;
+    state.alt = 498.0;
+    state.attitude_valid = true;
+    state.local_valid = true;
+    state.global_valid = true;
+    return state;
+}
+
+/// One control cycle of the navigator in a mode
+static void BM_NavigatorRun(benchmark::State &state) {
+    const mavsdk::ActionServer::FlightMode flight_mode = MODE_INFO[state.range(0)].flight_mode;
+    Morb morb;
+    uint64_t setpoints = 0;
+    morb.subscribe<Position>("position_setpoint", [&setpoints](const Position &) {
+        setpoints++;
+    });
+    Navigator navigator(&morb);
+    morb.publish<VehicleState>("vehicle_state", hover_state());
+    navigator.set_mode(flight_mode);
+    navigator.run();
+
+    for (auto _ : state) {
+        navigator.run();
+    }
+    state.counters["setpoints"] = benchmark::Counter(static_cast<double>(setpoints), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_NavigatorRun)
+    ->ArgName("mode")
+    ->Arg(static_cast<int>(ModeId::READY))
+    ->Arg(static_cast<int>(ModeId::HOLD))
+    ->Arg(static_cast<int>(ModeId::LAND));
@@ -0,0 +1,128 @@
+/**
+ * @file scheduler_bench.cpp
+ * @author Abdulelah Mulla
+ * @brief Microbenchmarks of the simulation clock
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "scheduler.h"
+
+#include <benchmark/benchmark.h>
+
+/**
+ * @brief Simulation time for the benchmarks, only ever moves forward
+ * as the scheduler expects.
+ */
+static uint64_t advance(uint64_t interval) {
+    static uint64_t time_us = 1;
+    time_us += interval;
+    return time_us;
+}
+
+/// Far enough that no alarm goes off while measuring
+static constexpr uint64_t PARKED = 1000000000;
+
+/**
+ * @brief Threads asleep on the scheduler.
+ *
+ * The scheduler keeps a pointer to every sleeping thread's alarm until
+ * the set_time() after it woke, so the threads only exit after that.
+ */
+struct Sleepers {
+    Scheduler &scheduler;
+    std::atomic<int> awake{0};
+    std::atomic<bool> release{false};
+    std::vector<std::thread> threads;
+
+    Sleepers(Scheduler &s, int64_t count, uint64_t interval) : scheduler(s) {
+        for (int64_t i = 0; i < count; i++) {
+            threads.emplace_back([this, interval] {
+                scheduler.sleep(interval);
+                awake.fetch_add(1);
+                while (!release.load()) {
+                    std::this_thread::yield();
+                }
+            });
+        }
+    }
+
+    /// Keep the clock moving until every thread woke, some may not have slept yet
+    ~Sleepers() {
+        while (awake.load() < static_cast<int>(threads.size())) {
+            scheduler.set_time(advance(PARKED));
+            std::this_thread::yield();
+        }
+        scheduler.set_time(advance(1));
+        release.store(true);
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+    }
+};
+
+/// set_time() with N threads asleep, as the gazebo clock callback does
+static void BM_SchedulerSetTime(benchmark::State &state) {
+    Scheduler &scheduler = Scheduler::initialize();
+    scheduler.set_time(advance(1));
+    Sleepers sleepers(scheduler, state.range(0), PARKED);
+    /// Let them get on the list
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    for (auto _ : state) {
+        scheduler.set_time(advance(1));
+    }
+}
+BENCHMARK(BM_SchedulerSetTime)->Arg(0)->Arg(1)->Arg(8)->Arg(32);
+
+/// From set_time() to the sleeping thread running again
+static void BM_SchedulerWakeLatency(benchmark::State &state) {
+    Scheduler &scheduler = Scheduler::initialize();
+    scheduler.set_time(advance(1));
+
+    std::atomic<bool> running{true};
+    std::atomic<uint64_t> wakeups{0};
+    std::atomic<int64_t> woken_ns{0};
+    std::atomic<bool> exited{false};
+    std::atomic<bool> release{false};
+    std::thread sleeper([&] {
+        while (running.load()) {
+            scheduler.sleep(1);
+            woken_ns.store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+            wakeups.fetch_add(1);
+        }
+        exited.store(true);
+        while (!release.load()) {
+            std::this_thread::yield();
+        }
+    });
+
+    for (auto _ : state) {
+        /// Keep the clock moving until it wakes, in case it was not parked yet
+        const uint64_t before = wakeups.load();
+        const auto start = std::chrono::steady_clock::now();
+        while (wakeups.load() == before) {
+            scheduler.set_time(advance(1));
+            std::this_thread::yield();
+        }
+        const int64_t start_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(start.time_since_epoch()).count();
+        state.SetIterationTime(static_cast<double>(woken_ns.load() - start_ns) * 1e-9);
+    }
+
+    running.store(false);
+    while (!exited.load()) {
+        scheduler.set_time(advance(1));
+        std::this_thread::yield();
+    }
+    /// Unlink its alarm before it goes away
+    scheduler.set_time(advance(1));
+    release.store(true);
+    sleeper.join();
+}
+BENCHMARK(BM_SchedulerWakeLatency)->UseManualTime()->Unit(benchmark::kMicrosecond);
@@ -16,7 +16,17 @@
 #include "morb.h"
 #include "mavlink_interface.h"
 #include "gazebo/gazebo_state.h"
+#include "estimator/estimator.h"
+#include "estimator/land_detector.h"
+#include "controllers/controller.h"
+#include "health_monitor.h"
+#include "flight_recorder.h"
+#include "params.h"
 #include "scheduler.h"
+#include "rate_groups.h"
+#include "thread_factory.h"
+#include "watchdog.h"
+#include "trace.h"
 #include "log.h"
 
 /**
@@ -25,6 +35,8 @@
  * the binary, the program takes two optional arguments.
  * --world=<name>: Name of the Gazebo world (default: "default")
  * --vehicle=<name>: Name of the vehicle model (default: "x500_0")
+ * On exit the latency trace is written to trace.json, open it
+ * in chrome://tracing or ui.perfetto.dev.
  */
 int main(int argc, char *argv[]) {
     /// Parse arguments
@@ -56,11 +68,27 @@ int main(int argc, char *argv[]) {
     Morb morb;
     /// Start Logger
     MITL_LOG::initialize();
+    /// Load the params saved by the last run
+    Params::initialize().open("params");
+    /// Keep gz-transport and MAVSDK off the real-time core, if any
+    ThreadFactory &threads = ThreadFactory::initialize();
+    threads.isolate();
     /// Start scheduler
     Scheduler::initialize();
     /// Initialize gazebo_state
     GazeboState gazebo_state(&morb, world, vehicle);
-    gazebo_state.activate_subscriptions();
+    /// Initialize the control path
+    Estimator estimator(&morb);
+    Controller controller(&morb);
+    LandDetector land_detector(&morb);
+    HealthMonitor health_monitor(&morb);
+    /// Log the bus topics mitl-analyze reads
+    FlightRecorder flight_recorder(&morb);
+    /// Trigger the slower loops after the rate loop has run
+    RateGroups::initialize().attach(&morb);
+    /// Watch the loops for missed deadlines
+    Watchdog &watchdog = Watchdog::initialize();
+    watchdog.attach(&morb);
     /// Initialize mavlink interface
     MavlinkInterface mav_interface(&morb);
 
@@ -73,7 +101,6 @@ int main(int argc, char *argv[]) {
             if (c == 'q') {
                 std::cout << "Stop requested by user.\n";
                 stop_requested = true;
-                mav_interface.stop();
                 break;
             }
         }
@@ -89,12 +116,23 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
+    /// Subscribe to gazebo once every morb subscriber is registered,
+    /// morb does not support subscribing while publishing.
+    gazebo_state.activate_subscriptions();
+
     std::cout << "running! Press 'q' to stop." << std::endl;
-    mav_interface.run();
+    threads.add(MitlThread::ATTITUDE, [&] {controller.start();}, [&] {controller.stop();});
+    threads.add(MitlThread::CONTROL, [&] {mav_interface.run();}, [&] {mav_interface.stop();});
+    threads.add(MitlThread::HEALTH, [&] {health_monitor.start();}, [&] {health_monitor.stop();});
+    threads.add(MitlThread::WATCHDOG, [&] {watchdog.start();}, [&] {watchdog.stop();});
+    threads.add(MitlThread::LOGGER, [] {MITL_LOG::initialize().start();}, [] {MITL_LOG::initialize().stop();});
+    threads.start();
 
     /// Wait for input thread to finish
     if (input_thread.joinable()) {
         input_thread.join();
     }
+    threads.stop();
+    Trace::initialize().export_chrome_json("trace.json");
     return 0;
 }
\ No newline at end of file
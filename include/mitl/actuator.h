@@ -0,0 +1,36 @@
+/**
+ * @file actuator.h
+ * @author Abdulelah Mulla
+ * @date 10/18/2026
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "trace.h"
+
+/**
+ * @brief Data structure representing the controller output.
+ *
+ * Torques are normalized to [-1, 1] and thrust to [0, 1],
+ * in the body FRD frame.
+ */
+struct ActuatorControls {
+    uint64_t timestamp; // steady clock time the controller produced this, in ns
+    float roll;
+    float pitch;
+    float yaw;
+    float thrust;
+    TraceContext trace;
+};
+
+/**
+ * @brief Latency statistics from controller output to actuator publish.
+ */
+struct LatencyStats {
+    uint64_t count;
+    uint64_t last_ns;
+    uint64_t max_ns;
+    uint64_t mean_ns;
+};
@@ -0,0 +1,96 @@
+/**
+ * @file alloc_audit.h
+ * @author Abdulelah Mulla
+ * @brief Reports heap allocations on the control path
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "thread_factory.h"
+
+/**
+ * @brief One allocation caught by the audit.
+ */
+struct AllocRecord {
+    MitlThread thread; // watched thread that allocated
+    size_t size;       // bytes
+};
+
+/**
+ * @brief Counts heap allocations made by the real-time threads.
+ *
+ * Once the vehicle is flying the control path must not allocate:
+ * malloc takes locks and can page fault. The real-time threads are
+ * watched, ThreadFactory watches the SCHED_FIFO threads it spawns and
+ * the sensor callbacks watch themselves with a Scope, since the
+ * gz-transport thread is not ours. Calls into libraries that allocate
+ * on their own, such as publishing to gazebo, are marked with Exempt.
+ *
+ * Allocations are only seen in test and benchmark builds, which link
+ * the operator new replacement in alloc_hook.cpp. Between start() and
+ * stop() every allocation on a watched thread is counted and the first
+ * RECORDS are kept.
+ *
+ * Nothing here allocates, it runs inside operator new.
+ */
+class AllocAudit {
+public:
+    /// Allocations kept for the report
+    static constexpr int RECORDS = 16;
+
+    /**
+     * @brief Watches the calling thread for its lifetime, or until
+     * unwatch()
+     */
+    static void watch(MitlThread id);
+    static void unwatch();
+
+    /**
+     * @brief Watches the calling thread for a scope.
+     */
+    class Scope {
+    private:
+        bool _watched;
+        MitlThread _thread;
+    public:
+        explicit Scope(MitlThread id);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    /**
+     * @brief Allocations of the calling thread are not counted for a
+     * scope, for calls into libraries we cannot change.
+     */
+    class Exempt {
+    private:
+        bool _watched;
+    public:
+        Exempt();
+        ~Exempt();
+        Exempt(const Exempt&) = delete;
+        Exempt& operator=(const Exempt&) = delete;
+    };
+
+    /// Start counting, clears the count
+    static void start();
+    static void stop();
+
+    /// Allocations on watched threads since start()
+    static uint64_t count();
+
+    /**
+     * @brief The first allocations since start()
+     * @return how many were written, at most max and RECORDS
+     */
+    static int records(AllocRecord *out, int max);
+
+    /// Called by operator new, counts it if the calling thread is watched
+    static void on_alloc(size_t size);
+};
@@ -0,0 +1,152 @@
+/**
+ * @file column_reader.h
+ * @author Abdulelah Mulla
+ * @brief Partial reads of columnar sensor log segments
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "log_segments.h"
+#include "telemetry/log_store.h"
+
+/// Field type of a value type
+template<typename T> constexpr LogFieldType log_field_type();
+template<> constexpr LogFieldType log_field_type<uint8_t>() {return LogFieldType::U8;}
+template<> constexpr LogFieldType log_field_type<uint32_t>() {return LogFieldType::U32;}
+template<> constexpr LogFieldType log_field_type<uint64_t>() {return LogFieldType::U64;}
+template<> constexpr LogFieldType log_field_type<float>() {return LogFieldType::F32;}
+template<> constexpr LogFieldType log_field_type<double>() {return LogFieldType::F64;}
+
+/**
+ * @brief A topic as named by a SCHEMA chunk.
+ */
+struct ColumnarTopic {
+    std::string label; // empty if the segment does not name it
+    std::string type;
+    std::vector<LogField> fields;
+    bool keep_payload{false};
+};
+
+/**
+ * @brief A segment written in the COLUMNAR layout, read through mmap.
+ *
+ * open() reads only the index. A read picks the groups of a topic
+ * whose time range overlaps the one asked for, and decompresses the
+ * chunks of the one column it wants, plus the TIME chunk of the groups
+ * that are only partly in range. Chunks stored uncompressed are read
+ * in place. Reads append to their outputs, so several segments can be
+ * read into the same vectors.
+ *
+ * Not thread-safe, use one per thread.
+ */
+class ColumnarSegment {
+private:
+    MappedFile _file;
+    LogCodec _codec{LogCodec::NONE};
+
+    /// Topics by id
+    std::vector<ColumnarTopic> _topics;
+
+    /// Every chunk, in file order, so a group's chunks are together
+    std::vector<LogChunkIndex> _chunks;
+
+    /// Decompressed chunks, reused
+    std::vector<uint8_t> _times;
+    std::vector<uint8_t> _values;
+    uint64_t _bytes_read{0};
+
+    bool parse_schema(const LogChunkIndex &chunk);
+
+    /// The chunk of a group, searched from its TIME chunk, -1 if none
+    long find_chunk(size_t time_chunk, LogChunkKind kind, uint16_t column) const;
+
+    /**
+     * @brief Bytes of a chunk, decompressed into buffer if needed.
+     * @return nullptr if corrupt
+     */
+    const uint8_t* load(const LogChunkIndex &chunk, std::vector<uint8_t> &buffer);
+
+    /// Values of a fixed width column in range, appended as bytes
+    bool read_column(int topic, LogChunkKind kind, uint16_t column, size_t width, uint64_t from, uint64_t to,
+                     std::vector<uint8_t> &out, std::vector<uint64_t> *times);
+public:
+    /**
+     * @brief Map a segment and read its index.
+     *
+     * Without an index the chunk headers are walked.
+     *
+     * @return false if it cannot be mapped or is not a COLUMNAR segment
+     */
+    bool open(const std::string &path);
+
+    const std::vector<ColumnarTopic>& topics() const {return _topics;}
+    const std::vector<LogChunkIndex>& chunks() const {return _chunks;}
+
+    /// -1 if not found
+    int find_topic(const std::string &label) const;
+    int find_field(int topic, const std::string &name) const;
+
+    /**
+     * @brief Times of a topic's records in [from, to], µs.
+     */
+    bool read_times(int topic, uint64_t from, uint64_t to, std::vector<uint64_t> &times);
+
+    /**
+     * @brief One field of a topic in [from, to].
+     *
+     * @param times if not null, the times of the values
+     * @return false if T is not the field's type, or a chunk is corrupt
+     */
+    template<typename T>
+    bool read_field(int topic, int field, uint64_t from, uint64_t to, std::vector<T> &values,
+                    std::vector<uint64_t> *times = nullptr) {
+        if (topic < 0 || topic >= static_cast<int>(_topics.size()) || field < 0 ||
+            field >= static_cast<int>(_topics[topic].fields.size()) ||
+            _topics[topic].fields[field].type != log_field_type<T>()) {
+            return false;
+        }
+        std::vector<uint8_t> bytes;
+        if (!read_column(topic, LogChunkKind::FIELD, static_cast<uint16_t>(field), sizeof(T), from, to, bytes,
+                         times)) {
+            return false;
+        }
+        const size_t before = values.size();
+        values.resize(before + bytes.size() / sizeof(T));
+        std::memcpy(values.data() + before, bytes.data(), bytes.size());
+        return true;
+    }
+
+    /**
+     * @brief One field of any type, as doubles, for plotting.
+     */
+    bool read_values(int topic, int field, uint64_t from, uint64_t to, std::vector<double> &values,
+                     std::vector<uint64_t> *times = nullptr);
+
+    /**
+     * @brief Range of a field in [from, to] from the chunk headers alone.
+     *
+     * Groups partly in range count whole, so the range may be wider.
+     *
+     * @return false if no group is in range
+     */
+    bool field_range(int topic, int field, uint64_t from, uint64_t to, double &min, double &max) const;
+
+    /**
+     * @brief The records of a topic in [from, to], as appended, for replay.
+     *
+     * @param sizes bytes of each record in payload
+     * @return false if the topic kept no payload
+     */
+    bool read_payloads(int topic, uint64_t from, uint64_t to, std::vector<uint64_t> &times,
+                       std::vector<uint32_t> &sizes, std::vector<uint8_t> &payload);
+
+    /// Bytes decompressed, or read in place, since open()
+    uint64_t bytes_read() const {return _bytes_read;}
+};
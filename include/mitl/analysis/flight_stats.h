@@ -0,0 +1,139 @@
+/**
+ * @file flight_stats.h
+ * @author Abdulelah Mulla
+ * @brief Flight statistics computed from the columns of a log
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "analysis/log_reader.h"
+#include "mode/mode_table.h"
+
+/**
+ * @brief Fixed width histogram, the last bin takes everything above.
+ */
+class Histogram {
+private:
+    uint32_t _bin_us;
+    std::vector<uint64_t> _counts;
+    uint64_t _total{0};
+public:
+    Histogram(uint32_t bin_us, size_t bins) : _bin_us(bin_us), _counts(bins, 0) {}
+
+    void add(uint64_t us) {
+        const uint64_t bin = us / _bin_us;
+        _counts[bin < _counts.size() ? bin : _counts.size() - 1]++;
+        _total++;
+    }
+
+    uint32_t bin_us() const {return _bin_us;}
+    const std::vector<uint64_t>& counts() const {return _counts;}
+    uint64_t total() const {return _total;}
+
+    /// Upper edge of the bin the fraction p of the values are in, µs
+    uint64_t percentile(double p) const;
+};
+
+/**
+ * @brief How often a topic was logged.
+ */
+struct TopicRate {
+    std::string label;
+    std::string type;
+    uint64_t count;
+    uint64_t bytes;
+    double rate_hz;            // over the span of the topic
+    uint64_t median_interval_us;
+    uint64_t p99_interval_us;
+    uint64_t max_interval_us;
+};
+
+/**
+ * @brief Position tracking error, state against setpoint.
+ */
+struct TrackingStats {
+    uint64_t samples{0};
+    double rms_horizontal{0}; // m
+    double max_horizontal{0};
+    double rms_vertical{0};
+    double max_vertical{0};
+    double rms_velocity{0};   // m/s, 3D
+};
+
+/**
+ * @brief A stretch of time spent in one mode.
+ */
+struct ModeSpan {
+    uint64_t start; // sim time, µs
+    uint64_t end;
+    ModeId mode;
+    ModeEvent event; // that entered it, COUNT for the first span
+};
+
+/**
+ * @brief Everything mitl-analyze reports on a log.
+ */
+struct FlightStats {
+    uint64_t start{0}; // first record, sim time µs
+    uint64_t end{0};   // last record
+
+    /// Per topic, in the order the log named them
+    std::vector<TopicRate> rates;
+
+    /// Between consecutive actuator outputs, the control loop period
+    Histogram loop_interval{LOOP_BIN_US, LOOP_BINS};
+    /// From sample to actuator output
+    Histogram latency{LATENCY_BIN_US, LATENCY_BINS};
+
+    /// From the last control loop report
+    uint64_t loop_cycles{0};
+    uint64_t loop_overruns{0};
+    uint32_t max_cycle_us{0}; // over all reports
+
+    /// Per mode, READY is left out, without mode changes all is HOLD
+    TrackingStats tracking[MODE_COUNT];
+
+    /// Actuator outputs at the end of their range
+    uint64_t actuator_samples{0};
+    uint64_t saturated{0};
+    double mean_thrust{0};
+
+    std::vector<ModeSpan> modes;
+
+    static constexpr uint32_t LOOP_BIN_US = 100;
+    static constexpr size_t LOOP_BINS = 200;
+    static constexpr uint32_t LATENCY_BIN_US = 20;
+    static constexpr size_t LATENCY_BINS = 250;
+};
+
+/**
+ * @brief Compute the statistics of a log.
+ *
+ * Each statistic is one pass over its columns, they run in parallel.
+ */
+FlightStats compute_stats(const LogColumns &columns);
+
+/// Mode names, for reports
+const char* mode_name(ModeId mode);
+
+/**
+ * @brief Write the statistics as CSV files in a directory.
+ *
+ * topics.csv, loop_timing.csv, tracking.csv and modes.csv.
+ *
+ * @return false if a file could not be written
+ */
+bool write_stats_csv(const FlightStats &stats, const std::string &directory);
+
+/**
+ * @brief Write each table as a CSV file in a directory, name.csv.
+ *
+ * @return false if a file could not be written
+ */
+bool write_tables_csv(const std::vector<TableRef> &tables, const std::string &directory);
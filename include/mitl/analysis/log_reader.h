@@ -0,0 +1,154 @@
+/**
+ * @file log_reader.h
+ * @author Abdulelah Mulla
+ * @brief Reads sensor log segments back into columns
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Every record of one topic, by time.
+ */
+struct TopicSeries {
+    std::string label;
+    std::string type; // protobuf full name, or mitl.* for bus messages
+    std::vector<uint64_t> time; // sim time, µs
+    uint64_t bytes{0};          // payload
+};
+
+/// mitl.VehicleState
+struct StateColumns {
+    std::vector<uint64_t> time;
+    std::vector<float> x, y, z;    // NED, m
+    std::vector<float> vx, vy, vz; // NED, m/s
+    std::vector<double> lat, lon, alt;
+    std::vector<uint8_t> global_valid;
+};
+
+/// mitl.Position, the position setpoint
+struct SetpointColumns {
+    std::vector<uint64_t> time;
+    std::vector<double> lat, lon, alt;
+    std::vector<float> vx, vy, vz;
+};
+
+/// mitl.ActuatorControls
+struct ActuatorColumns {
+    std::vector<uint64_t> time;
+    std::vector<uint64_t> stamp_ns;  // steady clock, when produced
+    std::vector<uint64_t> origin_ns; // steady clock, when its sample entered mitl
+    std::vector<float> roll, pitch, yaw, thrust;
+};
+
+/// mitl.ControlLoopStats
+struct LoopColumns {
+    std::vector<uint64_t> time;
+    std::vector<uint64_t> cycles;
+    std::vector<uint64_t> overruns;
+    std::vector<uint32_t> max_cycle_us;
+};
+
+/// mitl.ModeChange, ModeId and ModeEvent values
+struct ModeColumns {
+    std::vector<uint64_t> time;
+    std::vector<uint8_t> from, to, event;
+};
+
+/**
+ * @brief A log as arrays of fields, one vector per field.
+ *
+ * Every topic keeps the times of its records. The bus messages the
+ * FlightRecorder logs are also split into their fields, sensor
+ * messages stay serialized and are not decoded.
+ */
+struct LogColumns {
+    std::vector<TopicSeries> topics;
+    StateColumns state;
+    SetpointColumns setpoint;
+    ActuatorColumns actuators;
+    LoopColumns loop;
+    ModeColumns modes;
+
+    uint64_t blocks{0};
+    uint64_t records{0};
+    uint64_t bad_blocks{0};  // truncated, or failed to decompress
+    uint64_t bad_records{0}; // a bus message of another layout
+
+    /**
+     * @brief Append the columns of a later part of the log.
+     *
+     * Topics are matched by label and type.
+     */
+    void append(LogColumns &&later);
+};
+
+/**
+ * @brief Column types, for exporting without knowing the tables.
+ */
+enum class ColumnType : uint8_t {
+    U8,
+    U32,
+    U64,
+    F32,
+    F64
+};
+
+struct ColumnRef {
+    const char *name;
+    ColumnType type;
+    const void *data; // rows values
+};
+
+/**
+ * @brief A table of columns sharing the row count, borrowed from LogColumns.
+ */
+struct TableRef {
+    const char *name;
+    size_t rows;
+    std::vector<ColumnRef> columns;
+};
+
+/**
+ * @brief The bus message tables of a log, empty ones included.
+ */
+std::vector<TableRef> column_tables(const LogColumns &columns);
+
+/**
+ * @brief Segments to read, in order.
+ *
+ * Directories are replaced by the .mlog files in them, sorted by name
+ * so the segments of a log follow each other.
+ */
+std::vector<std::string> find_segments(const std::vector<std::string> &paths);
+
+/**
+ * @brief Read one segment through a memory mapping.
+ *
+ * Blocks are found through the index, or by walking the segment when
+ * it has none. Bad blocks are skipped and counted. A COLUMNAR segment
+ * is read through ColumnarSegment, only the fields the tables need.
+ *
+ * @return false if the file cannot be mapped or is not a segment
+ */
+bool read_segment(const std::string &path, LogColumns &columns);
+
+/**
+ * @brief Read segments on several threads.
+ *
+ * The blocks of all segments are split in runs of about equal size,
+ * one per thread, so a single large segment is read in parallel too.
+ * A COLUMNAR segment counts as one block.
+ * The result is in segment and block order.
+ *
+ * @param threads 0 for one per core
+ * @param failed set to the segments that could not be read
+ */
+LogColumns read_segments(const std::vector<std::string> &segments, unsigned threads,
+                         std::vector<std::string> *failed = nullptr);
@@ -8,11 +8,160 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+
+#include "actuator.h"
+#include "position.h"
+#include "seqlock.h"
+#include "thread_factory.h"
+#include "vehicle_state.h"
+
+class Morb;
+
+/**
+ * @brief Output of the attitude loop, tracked by the rate loop.
+ */
+struct RateSetpoint {
+    float roll;   // rad/s, FRD
+    float pitch;
+    float yaw;
+    float thrust; // [0, 1]
+    bool valid;   // false when not flying, the rate loop outputs nothing
+};
+
 /**
  * @brief This class takes care of the control loops,
  * it knows which PID loops to run and the state of 
  * the vehicle. 
+ *
+ * "vehicle_state" is only stored, on the thread that delivers the IMU.
+ * The rate loop runs on its own thread in the RATE rate group, woken
+ * by every sample, and publishes "actuator_controls". The attitude
+ * loop runs on its own thread in the ATTITUDE rate group and hands the
+ * rate loop its setpoint through a seqlock.
+ *
+ * The attitude loop tracks the latest "position_setpoint": a P
+ * position loop and a PI velocity loop, with the setpoint's velocity
+ * and acceleration fed forward, give the acceleration to fly. Its
+ * thrust vector, tilt limited, sets the attitude and the collective
+ * thrust, scaled so HOVER_THRUST holds 1 g. A P loop on the
+ * quaternion error turns the attitude into body rates. The rate loop
+ * is a PID on the body rates, D on the measurement, and outputs the
+ * normalized torques the mixer expects. The gains are those of the
+ * PX4 x500 defaults.
+ *
+ * The loops run from the first position setpoint until the vehicle
+ * is back in READY, which publishes a single zero command so the
+ * motors stop. Otherwise nothing is published.
  */
 class Controller {
-    
-};
\ No newline at end of file
+public:
+    /// Position loop, 1/s, north east down
+    static constexpr float POSITION_P[3] = {0.95f, 0.95f, 1.f};
+
+    /// Velocity loop, 1/s and 1/s², and how far the integral may go, m/s²
+    static constexpr float VELOCITY_P[3] = {1.8f, 1.8f, 4.f};
+    static constexpr float VELOCITY_I[3] = {0.4f, 0.4f, 2.f};
+    static constexpr float VELOCITY_I_LIMIT = 4.f;
+
+    /// Velocity limits, m/s
+    static constexpr float MAX_SPEED_XY = 12.f;
+    static constexpr float MAX_SPEED_UP = 3.f;
+    static constexpr float MAX_SPEED_DOWN = 1.5f;
+
+    /// m/s²
+    static constexpr float GRAVITY = 9.81f;
+
+    /// Largest tilt, rad, and collective thrust that holds 1 g
+    static constexpr float MAX_TILT = 0.785f;
+    static constexpr float HOVER_THRUST = 0.6f;
+    static constexpr float MIN_THRUST = 0.08f;
+    static constexpr float MAX_THRUST = 1.f;
+
+    /// Attitude loop, 1/s, and body rate limits, rad/s
+    static constexpr float ATTITUDE_P[3] = {6.5f, 6.5f, 2.8f};
+    static constexpr float MAX_RATE[3] = {3.84f, 3.84f, 3.49f};
+
+    /// Rate loop, per rad/s of error, and how far the integral may go
+    static constexpr float RATE_P[3] = {0.15f, 0.15f, 0.2f};
+    static constexpr float RATE_I[3] = {0.2f, 0.2f, 0.1f};
+    static constexpr float RATE_D[3] = {0.003f, 0.003f, 0.f};
+    static constexpr float RATE_I_LIMIT = 0.3f;
+
+    /// Longest step the integrators take, s, a longer gap restarts them
+    static constexpr float MAX_DT = 0.1f;
+private:
+    /// Message bus
+    Morb *_morb;
+
+    /// Output, reused every cycle
+    ActuatorControls _controls{};
+
+    /// Latest state for both loops, written by the IMU thread
+    SeqLock<VehicleState> _state;
+
+    /// Written by the attitude loop
+    SeqLock<RateSetpoint> _rate_setpoint;
+
+    /// Latest "position_setpoint", written by the control thread
+    SeqLock<Position> _position_setpoint;
+
+    /// From the first position setpoint until READY
+    std::atomic<bool> _flying{false};
+
+    /// Attitude loop only
+    float _velocity_integral[3]{};
+    uint64_t _attitude_time{0};
+
+    /// Rate loop only
+    float _rate_integral[3]{};
+    float _last_rates[3]{};
+    uint64_t _rate_time{0};
+
+    /// The motors were commanded since the last zero output
+    bool _output_zero{false};
+
+    /// Rate and attitude loop threads
+    std::atomic<bool> _running{false};
+    FactoryThread _rate_thread;
+    FactoryThread _attitude_thread;
+
+    /// Longest the loops wait for a trigger before checking _running
+    static constexpr std::chrono::microseconds LOOP_WAIT{100000};
+
+    /// Longest an attitude cycle may run before the watchdog steps in
+    static constexpr std::chrono::microseconds ATTITUDE_DEADLINE{20000};
+
+    void rate_loop();
+    void attitude_loop();
+public:
+    /// Constructor
+    explicit Controller(Morb *morb);
+    ~Controller();
+
+    /// Disable copy constructor and assignment operator
+    Controller(const Controller&) = delete;
+    Controller& operator=(const Controller&) = delete;
+
+    /**
+     * @brief Start and stop the rate and attitude loops.
+     */
+    void start();
+    void stop();
+
+    /**
+     * @brief Run the rate loop once on the latest state.
+     */
+    void rate_update();
+
+    /**
+     * @brief Run the attitude loop once on the latest state.
+     */
+    void attitude_update();
+
+    /**
+     * @brief true from the first position setpoint until READY.
+     */
+    bool flying() const {return _flying.load(std::memory_order_acquire);}
+};
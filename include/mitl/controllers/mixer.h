@@ -0,0 +1,114 @@
+/**
+ * @file mixer.h
+ * @author Abdulelah Mulla
+ * @brief Control allocation from torque and thrust to motor outputs
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include "actuator.h"
+
+/**
+ * @brief Geometry of a single rotor.
+ *
+ * Position is in the body FRD frame, km is the ratio of
+ * rotor moment to thrust, positive for CCW rotors.
+ */
+struct Rotor {
+    float x;
+    float y;
+    float km;
+};
+
+/**
+ * @brief How saturation is resolved.
+ *
+ * DISABLED: thrust may only be reduced to unsaturate, roll and pitch
+ * are reduced if that is not enough.
+ * ROLL_PITCH: thrust may be raised or reduced to keep roll/pitch authority.
+ * ROLL_PITCH_YAW: same, and yaw is mixed together with roll and pitch.
+ *
+ * In every mode yaw has the lowest priority.
+ */
+enum class Airmode {
+    DISABLED,
+    ROLL_PITCH,
+    ROLL_PITCH_YAW
+};
+
+/**
+ * @brief Multirotor mixer.
+ *
+ * The mixer matrix is the pseudo-inverse of the effectiveness matrix
+ * built from the rotor geometry, computed once at construction.
+ * Full roll, pitch or yaw commands span half the output range and full
+ * thrust drives every motor to 1. Outputs are normalized to [0, 1].
+ *
+ * Desaturation follows the sequential approach of PX4: the outputs are
+ * shifted along the thrust, roll, pitch or yaw column by the gain that
+ * minimizes saturation, in order of priority.
+ */
+class Mixer {
+public:
+    static constexpr int MAX_ROTORS = 8;
+
+private:
+    /// Control axes, columns of the mixer matrix
+    enum Axis {
+        ROLL,
+        PITCH,
+        YAW,
+        THRUST,
+        AXIS_COUNT
+    };
+
+    int _rotor_count;
+    Airmode _airmode;
+
+    /// Mixer matrix, one row per rotor
+    float _mix[MAX_ROTORS][AXIS_COUNT]{};
+
+    /**
+     * @brief Gain along vec that minimizes the saturation of outputs
+     */
+    float desaturation_gain(const float *outputs, const float *vec, float max) const;
+
+    /**
+     * @brief Shift outputs along the column of an axis to minimize saturation
+     * @param reduce_only only allow the axis to be reduced
+     */
+    void desaturate(float *outputs, Axis axis, bool reduce_only, float max = 1.f) const;
+
+    /**
+     * @brief Add yaw on top of roll/pitch/thrust without affecting them
+     */
+    void mix_yaw(float *outputs, float yaw) const;
+
+public:
+    /**
+     * Constructor
+     * @brief Computes the mixer matrix from the rotor geometry
+     * @param rotors geometry of each rotor, in output order
+     * @param count number of rotors, at most MAX_ROTORS
+     * @param airmode saturation strategy
+     */
+    Mixer(const Rotor *rotors, int count, Airmode airmode = Airmode::ROLL_PITCH);
+
+    /**
+     * @brief Mixer for the gz_x500 quad, in gazebo motor order.
+     */
+    static Mixer x500(Airmode airmode = Airmode::ROLL_PITCH);
+
+    /**
+     * @brief Allocate controls to motors.
+     * @param controls controller output
+     * @param outputs array of at least rotor_count() motor outputs in [0, 1]
+     */
+    void mix(const ActuatorControls &controls, float *outputs) const;
+
+    int rotor_count() const {return _rotor_count;}
+
+    void set_airmode(Airmode airmode) {_airmode = airmode;}
+};
@@ -0,0 +1,63 @@
+/**
+ * @file estimator.h
+ * @author Abdulelah Mulla
+ * @brief Header file for the state estimator
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include "geodesy.h"
+#include "morb.h"
+#include "seqlock.h"
+#include "sensors.h"
+#include "vehicle_state.h"
+
+/**
+ * @brief Produces the vehicle state from the sensors.
+ *
+ * There is no filter yet, the estimate is the Gazebo odometry
+ * and navsat, with attitude rates and acceleration from the IMU.
+ * A VehicleState is published on every IMU sample so the control
+ * loop runs at IMU rate.
+ *
+ * Odometry and GPS arrive on other threads than the IMU, their
+ * latest samples are kept in seqlocks.
+ *
+ * The first GPS fix places the origin of the local position, after
+ * that the global position is the local one through that origin so
+ * the two always agree.
+ */
+class Estimator {
+private:
+    /// Message bus
+    Morb *_morb;
+
+    /// Latest samples of the slower sensors
+    SeqLock<SensorOdometry> _odometry;
+    SeqLock<SensorGps> _gps;
+
+    /// Only touched on the IMU thread
+    VehicleState _state{};
+
+    /// Global position of the local origin, IMU thread
+    LocalFrame _origin;
+    bool _origin_set{false};
+
+    /**
+     * @brief Builds and publishes the state from an IMU sample.
+     */
+    void imu_update(const SensorImu &imu);
+
+public:
+    /**
+     * Constructor
+     * @brief Subscribes to the sensor topics.
+     */
+    explicit Estimator(Morb *morb);
+
+    /// Disable copy constructor and assignment operator
+    Estimator(const Estimator&) = delete;
+    Estimator& operator=(const Estimator&) = delete;
+};
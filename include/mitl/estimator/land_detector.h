@@ -0,0 +1,174 @@
+/**
+ * @file land_detector.h
+ * @author Abdulelah Mulla
+ * @brief Landing detection from the vehicle state, thrust and baro
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "actuator.h"
+#include "sensors.h"
+#include "vehicle_state.h"
+
+class Morb;
+
+/**
+ * @brief The signals that vote, bits of LandDetected::votes.
+ */
+enum LandVote : uint8_t {
+    LAND_VOTE_VERTICAL_SPEED = 1 << 0, // estimator vertical speed is small
+    LAND_VOTE_THRUST = 1 << 1,         // thrust setpoint is low
+    LAND_VOTE_ACCEL = 1 << 2,          // specific force is steady
+    LAND_VOTE_BARO = 1 << 3,           // baro altitude is not changing
+};
+
+/**
+ * @brief Published on "land_detected" when it changes, and at
+ * HEARTBEAT_US otherwise.
+ */
+struct LandDetected {
+    uint64_t timestamp;  // state time, µs
+    bool ground_contact; // low thrust and not moving down
+    bool maybe_landed;   // most of the motion signals agree
+    bool landed;         // all of them agree
+    uint8_t votes;       // LandVote bits cast on this update
+    uint8_t available;   // LandVote bits that had data
+};
+
+/**
+ * @brief A boolean that only changes once the input held for a while.
+ */
+class Hysteresis {
+private:
+    bool _state{false};
+    bool _pending{false};
+    uint64_t _since{0};
+    uint64_t _true_time;
+    uint64_t _false_time;
+public:
+    /**
+     * Constructor
+     * @param true_time how long the input must be true to switch on, µs
+     * @param false_time how long it must be false to switch off, µs
+     */
+    Hysteresis(uint64_t true_time, uint64_t false_time) :
+        _true_time(true_time),
+        _false_time(false_time)
+    {}
+
+    /**
+     * @brief Feed the input at time now, µs.
+     * @return the state after the update
+     */
+    bool update(bool input, uint64_t now);
+
+    bool state() const {return _state;}
+};
+
+/**
+ * @brief Votes across independent signals to decide if the vehicle
+ * is on the ground.
+ *
+ * The vertical speed of the estimator, the thrust setpoint, the
+ * variance of the specific force and the baro climb rate each cast a
+ * vote. Signals without data abstain, so a missing baro or controller
+ * does not block detection.
+ *
+ * - ground contact: thrust is low and either height sensor says the
+ *   vehicle is not descending
+ * - maybe landed: ground contact, at most one available motion
+ *   signal disagrees
+ * - landed: maybe landed, every available signal agrees
+ *
+ * Each stage must hold for its hysteresis time on top of the one
+ * before it. Updates run on every "vehicle_state", at control rate,
+ * with fixed memory and O(1) work. The baro slope is a least squares
+ * fit over the last BARO_WINDOW samples, updated on the baro thread.
+ */
+class LandDetector {
+private:
+    /// Message bus
+    Morb *_morb;
+
+    /// Latest thrust, from the controller thread
+    std::atomic<float> _thrust{0.f};
+    std::atomic<bool> _has_thrust{false};
+
+    /// Baro altitudes, only touched on the baro thread
+    static constexpr int BARO_WINDOW = 32;
+    float _baro_alt[BARO_WINDOW]{};
+    uint64_t _baro_time[BARO_WINDOW]{};
+    int _baro_count{0};
+    int _baro_head{0};
+
+    /// Baro climb rate for the state thread, m/s up
+    std::atomic<float> _baro_rate{0.f};
+    std::atomic<uint64_t> _baro_updated{0};
+
+    /// Specific force statistics, EWMA
+    float _accel_mean{0};
+    float _accel_variance{0};
+    bool _accel_init{false};
+
+    /// Stages
+    Hysteresis _ground_contact{GROUND_CONTACT_TIME, 100000};
+    Hysteresis _maybe_landed{MAYBE_LANDED_TIME, 0};
+    Hysteresis _landed{LANDED_TIME, 0};
+
+    /// Output, reused every update
+    LandDetected _detected{};
+    uint64_t _last_publish{0};
+
+    /// Thresholds
+    static constexpr float VERTICAL_SPEED = 0.3f;   // m/s
+    static constexpr float BARO_RATE = 0.5f;        // m/s
+    static constexpr float LOW_THRUST = 0.3f;       // normalized
+    static constexpr float ACCEL_VARIANCE = 0.5f;   // (m/s²)²
+    static constexpr float ACCEL_ALPHA = 0.05f;     // EWMA weight
+
+    /// A baro slope older than this abstains, µs
+    static constexpr uint64_t BARO_TIMEOUT = 500000;
+
+    /// Hysteresis of each stage, µs
+    static constexpr uint64_t GROUND_CONTACT_TIME = 350000;
+    static constexpr uint64_t MAYBE_LANDED_TIME = 250000;
+    static constexpr uint64_t LANDED_TIME = 300000;
+
+    /// Publish at least this often, µs
+    static constexpr uint64_t HEARTBEAT = 1000000;
+
+    /**
+     * @brief Add a baro sample and refit the climb rate.
+     */
+    void baro_update(const SensorBaro &baro);
+public:
+    /**
+     * Constructor
+     * @brief Subscribes to the state, the controller and the baro.
+     */
+    explicit LandDetector(Morb *morb);
+
+    /// Disable copy constructor and assignment operator
+    LandDetector(const LandDetector&) = delete;
+    LandDetector& operator=(const LandDetector&) = delete;
+
+    /**
+     * @brief Vote on a new state and publish on change.
+     */
+    void update(const VehicleState &state);
+
+    /**
+     * @brief Latest result, for the state thread.
+     */
+    const LandDetected& detected() const {return _detected;}
+
+    /**
+     * @brief Pressure altitude in the standard atmosphere, m
+     */
+    static float pressure_altitude(float pressure_pa);
+};
@@ -0,0 +1,60 @@
+/**
+ * @file flight_recorder.h
+ * @author Abdulelah Mulla
+ * @brief Logs the internal bus topics next to the sensor messages
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "log_segments.h"
+
+class Morb;
+
+/**
+ * @brief Types the bus messages are logged as, shared with the readers.
+ */
+namespace recorded_type {
+    constexpr char VEHICLE_STATE[] = "mitl.VehicleState";
+    constexpr char POSITION_SETPOINT[] = "mitl.Position";
+    constexpr char ACTUATOR_CONTROLS[] = "mitl.ActuatorControls";
+    constexpr char CONTROL_LOOP_STATS[] = "mitl.ControlLoopStats";
+    constexpr char MODE_CHANGE[] = "mitl.ModeChange";
+}
+
+/**
+ * @brief Fields of a recorded type, by the names readers look them up
+ * by in the COLUMNAR layout.
+ *
+ * @return empty if the type is not recorded
+ */
+std::vector<LogField> recorded_fields(const char *type);
+
+/**
+ * @brief Records the state, setpoints, actuator outputs, loop timing
+ * and mode changes into the sensor log.
+ *
+ * Every message is logged as it is published, with MITL_LOG::struct_log,
+ * stamped with the sim time so it lines up with the sensor messages.
+ * The callbacks only copy the message into the log queue, they are
+ * safe on the control path. recorded_fields() of each type are
+ * described to MITL_LOG, for the COLUMNAR layout. Read the log back with mitl-analyze.
+ */
+class FlightRecorder {
+private:
+    /// Message bus
+    Morb *_morb;
+public:
+    /**
+     * Constructor
+     * @brief Subscribes, construct it before anything is published.
+     */
+    explicit FlightRecorder(Morb *morb);
+
+    /// Delete copy constructor and assignment operator
+    FlightRecorder(const FlightRecorder&) = delete;
+    FlightRecorder& operator=(const FlightRecorder&) = delete;
+};
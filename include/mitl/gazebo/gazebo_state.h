@@ -8,8 +8,12 @@
 
 #pragma once
 
+#include <atomic>
 #include <string>
 #include "morb.h"
+#include "actuator.h"
+#include "controllers/mixer.h"
+#include "gazebo/sensor_monitor.h"
 #include <gz/msgs.hh>
 #include <gz/transport.hh>
 
@@ -32,6 +36,33 @@ private:
     
     gz::transport::Node _node;
 
+    /// Tracks rate and staleness of every topic we subscribe to
+    SensorMonitor _monitor;
+
+    /// Control allocation for the gz_x500
+    Mixer _mixer;
+    float _motor_outputs[Mixer::MAX_ROTORS]{};
+
+    /// Motor speed publisher, advertised once
+    gz::transport::Node::Publisher _actuator_pub;
+
+    /// Reused every cycle so publishing does not allocate
+    gz::msgs::Actuators _actuator_msg;
+
+    /// Max rotor velocity of the gz_x500 motors, rad/s
+    static constexpr float MAX_ROTOR_SPEED = 1000.f;
+
+    /// Controller output to publish latency
+    std::atomic<uint64_t> _latency_count{0};
+    std::atomic<uint64_t> _latency_last_ns{0};
+    std::atomic<uint64_t> _latency_max_ns{0};
+    std::atomic<uint64_t> _latency_total_ns{0};
+
+    /**
+     * @brief Converts a message header stamp to sim time in µs.
+     */
+    static uint64_t stamp_us(const gz::msgs::Header &header);
+
     /// Callbacks
 
     /**
@@ -69,13 +100,25 @@ public:
      * 
      * The sensor readings include: Accelerometer, Gyroscope,
      * Magnetometer, Magnetometer, Barometer
+     *
+     * Every topic is monitored, and a SensorHealth report is
+     * published on "sensor_health" at 10hz while the clock runs.
      */
     void activate_subscriptions();
 
     /**
      * @brief Publishes actuator commands to Gazebo.
      * 
-     * Commands come from the controller.
+     * Commands come from the controller through the "actuator_controls"
+     * topic. They are mixed into motor speeds and published on the
+     * motor_speed topic of the vehicle.
+     *
+     * @param controls the controller output
+     */
+    void publish_actuator(const ActuatorControls &controls);
+
+    /**
+     * @brief Latency from controller output to Gazebo publish.
      */
-    void publish_actuator();
+    LatencyStats actuator_latency() const;
 };
\ No newline at end of file
@@ -0,0 +1,166 @@
+/**
+ * @file sensor_monitor.h
+ * @author Abdulelah Mulla
+ * @brief Rate and staleness monitoring of the Gazebo sensor topics
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+class Morb;
+
+/**
+ * @brief The Gazebo topics we subscribe to.
+ *
+ * Used as an index into the monitor tables, keep COUNT last.
+ */
+enum class SensorTopic : uint8_t {
+    CLOCK,
+    POSE,
+    IMU,
+    MAG,
+    ODOMETRY,
+    LASER_SCAN,
+    AIRSPEED,
+    AIR_PRESSURE,
+    NAV_SAT,
+    COUNT
+};
+
+constexpr int SENSOR_TOPIC_COUNT = static_cast<int>(SensorTopic::COUNT);
+
+/**
+ * @brief Statistics of a single topic at the time of the report.
+ */
+struct TopicHealth {
+    uint64_t count;      // messages received
+    uint64_t age_us;     // wall time since the last message
+    float rate_hz;       // measured arrival rate
+    float jitter_us;     // mean absolute deviation of the inter-arrival time
+    float skew_us;       // wall time elapsed minus sim time elapsed since the first message
+    uint32_t gaps;       // number of inter-arrival gaps detected
+    uint32_t max_gap_us; // largest inter-arrival time seen
+};
+
+/**
+ * @brief Health report published on the "sensor_health" topic.
+ *
+ * A topic is stale when nothing arrived within a few nominal periods,
+ * and slow when its measured rate drops under half the nominal rate.
+ */
+struct SensorHealth {
+    uint64_t timestamp{0};      // wall time of the report in µs
+    uint16_t required_mask{0};  // topics needed for flight
+    uint16_t stale_mask{0};
+    uint16_t slow_mask{0};
+    float real_time_factor{0};  // sim time / wall time, from the clock topic
+    TopicHealth topics[SENSOR_TOPIC_COUNT]{};
+
+    /// true if every required topic is fresh and at rate
+    bool healthy() const {
+        return ((stale_mask | slow_mask) & required_mask) == 0;
+    }
+};
+
+/**
+ * @brief Tracks arrival rate, jitter, gaps and clock skew per topic.
+ *
+ * record() is called from the gazebo callbacks and does O(1) work.
+ * Each topic is only ever written by its own callback thread, every
+ * field read from another thread is an atomic.
+ *
+ * The report is built and published from the clock callback at
+ * REPORT_PERIOD_US, so if the simulation stalls entirely the reports
+ * stop and consumers should treat an old report as unhealthy.
+ */
+class SensorMonitor {
+private:
+    /// Per topic configuration and running statistics
+    struct TopicState {
+        float nominal_rate_hz{0};
+        bool required{false};
+
+        /// Only touched by the callback thread
+        uint64_t first_wall_us{0};
+        uint64_t first_sim_us{0};
+        float mean_dt_us{0};
+
+        /// Read by the reporting thread
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> last_wall_us{0};
+        std::atomic<float> mean_dt{0};
+        std::atomic<float> jitter_us{0};
+        std::atomic<float> skew_us{0};
+        std::atomic<uint32_t> gaps{0};
+        std::atomic<uint32_t> max_gap_us{0};
+    };
+
+    /// Message bus
+    Morb *_morb;
+
+    TopicState _topics[SENSOR_TOPIC_COUNT];
+
+    /// Real time factor from the clock topic
+    uint64_t _rtf_last_wall_us{0};
+    uint64_t _rtf_last_sim_us{0};
+    float _rtf{0};
+
+    /// Last time a report was published
+    uint64_t _last_report_us{0};
+
+    /// Report we reuse to avoid building one on the stack every time
+    SensorHealth _report{};
+
+    /// EWMA weight for rate and jitter
+    static constexpr float ALPHA = 0.05f;
+    /// An inter-arrival time above this many nominal periods is a gap
+    static constexpr float GAP_FACTOR = 3.0f;
+    /// No message for this many nominal periods means stale
+    static constexpr float STALE_FACTOR = 10.0f;
+    /// Report rate, 10hz
+    static constexpr uint64_t REPORT_PERIOD_US = 100000;
+
+    void configure(SensorTopic topic, float nominal_rate_hz, bool required);
+
+    void publish_report(uint64_t now_us);
+
+public:
+    /**
+     * Constructor
+     * @brief Sets the nominal rates of the gz_x500 sensors.
+     */
+    explicit SensorMonitor(Morb *morb);
+
+    /// Disable copy constructor and assignment operator
+    SensorMonitor(const SensorMonitor&) = delete;
+    SensorMonitor& operator=(const SensorMonitor&) = delete;
+
+    /**
+     * @brief Record the arrival of a message.
+     * @param topic the topic the message arrived on
+     * @param sim_us the sim timestamp of the message in µs
+     */
+    void record(SensorTopic topic, uint64_t sim_us);
+
+    /**
+     * @brief Record the arrival of a message at a given wall time.
+     * @param now_us wall time of the arrival in µs, from wall_time_us()
+     */
+    void record(SensorTopic topic, uint64_t sim_us, uint64_t now_us);
+
+    /**
+     * @brief Build a report of all topics.
+     * @param now_us current wall time in µs
+     * @param report output
+     */
+    void evaluate(uint64_t now_us, SensorHealth &report) const;
+
+    /**
+     * @brief Monotonic wall time in µs, the time base of the monitor.
+     */
+    static uint64_t wall_time_us();
+};
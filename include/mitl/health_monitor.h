@@ -0,0 +1,168 @@
+/**
+ * @file health_monitor.h
+ * @author Abdulelah Mulla
+ * @brief Preflight and in-flight health checks
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "gazebo/sensor_monitor.h"
+#include "vehicle_state.h"
+#include "thread_factory.h"
+
+class Morb;
+
+/**
+ * @brief The health checks, bit positions in HealthReport.
+ *
+ * Keep COUNT last.
+ */
+enum class HealthCheck : uint8_t {
+    SENSORS,      // every required sensor topic is fresh and at rate
+    ESTIMATOR,    // the estimate is valid, recent and settled
+    CONTROL_LOOP, // the control loop keeps its period
+    LINK,         // the GCS is connected
+    COUNT
+};
+
+constexpr int HEALTH_CHECK_COUNT = static_cast<int>(HealthCheck::COUNT);
+
+constexpr uint8_t health_bit(HealthCheck check) {
+    return static_cast<uint8_t>(1u << static_cast<int>(check));
+}
+
+/// Every check
+constexpr uint8_t HEALTH_ALL = (1u << HEALTH_CHECK_COUNT) - 1;
+
+/// Failures that end the flight, a slow control loop only blocks arming
+constexpr uint8_t HEALTH_FAILSAFE = health_bit(HealthCheck::SENSORS) |
+                                    health_bit(HealthCheck::ESTIMATOR) |
+                                    health_bit(HealthCheck::LINK);
+
+/**
+ * @brief Published on "health_report" when it changes, and once a
+ * second otherwise.
+ */
+struct HealthReport {
+    uint64_t timestamp; // wall time, µs
+    uint8_t failing;    // health_bit() of the failing checks
+    uint8_t checked;    // health_bit() of the checks run at least once
+
+    /// Every check ran and passed
+    bool arming_ok() const {return checked == HEALTH_ALL && failing == 0;}
+};
+
+/**
+ * @brief Published on "control_loop_stats" by the mode manager once
+ * a second.
+ */
+struct ControlLoopStats {
+    uint64_t timestamp;    // wall time, µs
+    uint64_t cycles;       // since start
+    uint64_t overruns;     // cycles that took longer than the period
+    uint32_t max_cycle_us; // over the last second
+};
+
+/**
+ * @brief Published on "link_status" when the GCS connects or drops.
+ */
+struct LinkStatus {
+    uint64_t timestamp; // wall time, µs
+    bool connected;
+};
+
+/**
+ * @brief Aggregates the health of the vehicle into one bitmask.
+ *
+ * The inputs arrive on the bus and are only stored, as atomics, so
+ * the control path pays a few relaxed stores. The checks run on the
+ * monitor thread, one per tick in turn, so every check runs every
+ * HEALTH_CHECK_COUNT * TICK and a tick costs a handful of loads. A
+ * state is fresh if one arrived since the previous estimator check.
+ *
+ * Inputs that never reported, no control loop or no GCS, are not
+ * checked. The sensors and the estimator are the exceptions, as for
+ * the mode manager, without them we cannot fly.
+ *
+ * The mode manager refuses to arm unless arming_ok(), and lands
+ * when a HEALTH_FAILSAFE check fails in flight.
+ */
+class HealthMonitor {
+private:
+    /// Message bus
+    Morb *_morb;
+
+    /// Latest inputs, written from their publishers
+    std::atomic<bool> _sensors_healthy{false};
+    std::atomic<uint64_t> _sensor_report_time{0};
+    std::atomic<uint8_t> _state_valid{0};
+    std::atomic<uint64_t> _state_count{0};
+    std::atomic<uint64_t> _loop_cycles{0};
+    std::atomic<uint64_t> _loop_overruns{0};
+    std::atomic<uint64_t> _loop_stats_time{0};
+    std::atomic<bool> _link_connected{false};
+    std::atomic<bool> _link_seen{false};
+
+    /// Check state, monitor thread only
+    int _next_check{0};
+    uint64_t _estimator_valid_since{0};
+    uint64_t _last_state_count{0};
+    uint64_t _last_cycles{0};
+    uint64_t _last_overruns{0};
+    HealthReport _report{};
+    uint64_t _last_publish{0};
+
+    std::atomic<bool> _running{false};
+    FactoryThread _thread;
+
+    /// Timing, µs
+    static constexpr uint64_t TICK = 50000;
+    static constexpr uint64_t SENSOR_TIMEOUT = 500000;
+    static constexpr uint64_t ESTIMATOR_SETTLE = 1000000;
+    static constexpr uint64_t LOOP_STATS_TIMEOUT = 3000000;
+    static constexpr uint64_t HEARTBEAT = 1000000;
+
+    /// Fraction of overrunning cycles that fails the control loop check
+    static constexpr float MAX_OVERRUN_RATE = 0.05f;
+
+    /**
+     * @brief Run one check.
+     * @return true if it passed
+     */
+    bool check(HealthCheck check, uint64_t now);
+
+    void loop();
+public:
+    /**
+     * Constructor
+     * @brief Subscribes to the inputs.
+     */
+    explicit HealthMonitor(Morb *morb);
+    ~HealthMonitor();
+
+    /// Disable copy constructor and assignment operator
+    HealthMonitor(const HealthMonitor&) = delete;
+    HealthMonitor& operator=(const HealthMonitor&) = delete;
+
+    /**
+     * @brief Start and stop the monitor thread
+     */
+    void start();
+    void stop();
+
+    /**
+     * @brief Run the next check and publish on change.
+     * @param now wall time, µs
+     */
+    void step(uint64_t now);
+
+    /**
+     * @brief Latest report, monitor thread.
+     */
+    const HealthReport& report() const {return _report;}
+};
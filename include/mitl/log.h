@@ -8,25 +8,154 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <type_traits>
+#include <vector>
+
+#include "mpsc_queue.h"
+#include "memory_pool.h"
+#include "thread_factory.h"
+#include "watchdog.h"
+#include "log_segments.h"
+#include "message_columns.h"
 
   #include <google/protobuf/message.h>
 
+/**
+ * @brief A sensor message waiting to be written, serialized.
+ */
+struct SensorRecord {
+    static constexpr size_t BYTES = 4096;
+
+    const char *label;
+    uint64_t time;
+    const google::protobuf::Descriptor *type;
+    const char *struct_type; // bus messages logged as is, type is null
+    uint32_t size;
+    uint8_t *large;          // a block of the large pool when size > BYTES, else null
+    uint8_t bytes[BYTES];
+
+    const uint8_t* data() const {return large ? large : bytes;}
+};
+
+/**
+ * @brief A program log line waiting to be written, truncated to fit.
+ */
+struct ProgramRecord {
+    static constexpr size_t BYTES = 160;
+
+    char text[BYTES];
+};
+
 /**
  * @brief Class for managing logging with thread safety.
+ *
+ * Sensor messages arrive on the thread that runs the control path, so
+ * sensor_log() only serializes them into a queue, without allocating,
+ * and the logger thread writes them out. Until start(), and after
+ * stop(), they are written in place. Messages larger than
+ * SensorRecord::BYTES, such as laser scans, are serialized into a
+ * block of a pool reserved up front, which the logger thread frees.
+ * Messages larger than a block, or that find the pool or the queue
+ * full, are dropped and counted, and the first oversized message of
+ * each topic is logged.
+ *
+ * program_log() takes a lock and flushes to disk. The real-time
+ * threads use program_log_nowait() instead, which queues the line for
+ * the logger thread the same way.
+ *
+ * Sensor messages are kept serialized, in the compressed segments of a
+ * SegmentedLog named sensor_log, one topic per label and message type.
+ * Bus messages, logged with struct_log(), go in the same log as their
+ * raw bytes, typed with a name like "mitl.VehicleState".
+ * Segment size, duration and the disk budget are the MITL_LOG_* params,
+ * read on start().
+ *
+ * With MITL_LOG_COLUMNS set, segments use the COLUMNAR layout: each
+ * field of a topic is stored in its own chunks, so a reader takes only
+ * what it needs. Sensor messages are flattened by MessageColumns on the
+ * logger thread and keep their serialized bytes too. Bus messages are
+ * split by the fields given to describe(), and keep only those.
  */
 class MITL_LOG {
 private:
     std::ofstream _program_log; // Logs the start of different processes
-    std::ofstream _sensor_log; // Logs sensor data
+    SegmentedLog _sensor_log{".", "sensor_log"}; // Logs sensor data
 
-    /// Mutex for accessing shared Log files
-    std::mutex _program_mutex; 
+    /// Topics of the sensor log, guarded by _sensor_mutex
+    struct LogTopic {
+        const char *label;
+        const google::protobuf::Descriptor *type;
+        const char *struct_type;
+        uint8_t id;
+        std::unique_ptr<MessageColumns> columns; // sensor messages
+    };
+    static constexpr int MAX_TOPICS = 64;
+    LogTopic _topics[MAX_TOPICS];
+    int _topic_count{0};
+
+    /// Fields of the bus messages, by type, guarded by _sensor_mutex
+    struct StructFields {
+        const char *type;
+        std::vector<LogField> fields;
+    };
+    std::vector<StructFields> _struct_fields;
+
+    /// A flattened sensor message, on the logger thread
+    double _row[MessageColumns::MAX_FIELDS];
+
+    /// Mutex for accessing shared Log files, the real-time threads may wait on the program log's
+    WatchedMutex _program_mutex;
     std::mutex _sensor_mutex;
 
+    /// Program log lines from the real-time threads
+    static constexpr size_t PROGRAM_QUEUE_SIZE = 64;
+    MpscQueue<ProgramRecord, PROGRAM_QUEUE_SIZE> _program_queue;
+    std::atomic<uint64_t> _program_dropped{0};
+
+    /// Sensor messages for the logger thread
+    static constexpr size_t SENSOR_QUEUE_SIZE = 256;
+    MpscQueue<SensorRecord, SENSOR_QUEUE_SIZE> _sensor_queue;
+    std::atomic<bool> _writing{false};
+    std::atomic<uint64_t> _sensor_dropped{0};
+    FactoryThread _writer;
+
+    /// Blocks for sensor messages larger than a record
+    static constexpr size_t LARGE_BYTES = 64 * 1024;
+    static constexpr uint32_t LARGE_BLOCKS = 16;
+    BlockPool _large_pool{LARGE_BYTES, LARGE_BLOCKS};
+
+    /// Topics that had a message too large for a block, warned once each
+    std::atomic<const char*> _oversized[MAX_TOPICS] = {};
+
+    /// Log the first message of a topic too large to log
+    void warn_oversized(const char *label, size_t size);
+
+    /// The writer flushes the sensor log this often, a crash loses at most this much
+    static constexpr std::chrono::seconds FLUSH_PERIOD{1};
+
+    /// Writes queued sensor messages until stop()
+    void writer_loop();
+
+    /// Write the queues out, from the logger thread
+    void drain();
+
+    void write_sensor(const google::protobuf::Message& msg, const char *label, uint64_t time);
+
+    /// Append a serialized message, with _sensor_mutex held
+    void write_record(const char *label, const google::protobuf::Descriptor *type, const char *struct_type,
+                      uint64_t time, const void *bytes, uint32_t size);
+
+    /// Queue, or write, the bytes of a bus message
+    void write_struct(const void *bytes, uint32_t size, const char *label, const char *type, uint64_t time);
+
     /**
      * Constructor
      * @brief Defines the log files.
@@ -54,5 +183,57 @@ public:
      */
     void program_log(const std::string &msg);
 
-    void sensor_log(const google::protobuf::Message& msg, std::string label, uint64_t time);
+    /// Same, without building a std::string from a literal
+    void program_log(const char *msg);
+
+    /**
+     * @brief Log a line from a real-time thread, without blocking.
+     *
+     * Queued for the logger thread, truncated to ProgramRecord::BYTES,
+     * and dropped if the queue is full. Written in place until start().
+     */
+    void program_log_nowait(const char *msg);
+
+    /**
+     * @brief Log a sensor message.
+     *
+     * @param label a string literal, kept until the message is written
+     */
+    void sensor_log(const google::protobuf::Message& msg, const char *label, uint64_t time);
+
+    /**
+     * @brief Log a bus message as its raw bytes.
+     *
+     * Same path as sensor_log(), for the internal topics. Readers
+     * recognize the message by type, and its layout by its size.
+     *
+     * @param label a string literal, kept until the message is written
+     * @param type a string literal naming the struct
+     */
+    template<typename T>
+    void struct_log(const T &msg, const char *label, const char *type, uint64_t time) {
+        static_assert(std::is_trivially_copyable_v<T>, "logged as raw bytes");
+        static_assert(sizeof(T) <= SensorRecord::BYTES, "too large for a record");
+        write_struct(&msg, sizeof(T), label, type, time);
+    }
+
+    /**
+     * @brief Name the fields of a bus message type, for the COLUMNAR layout.
+     *
+     * Call before the first struct_log() of the type, a type without
+     * fields is kept as its raw bytes only. Describing a type again
+     * replaces its fields, as every FlightRecorder does.
+     *
+     * @param type a string literal, as given to struct_log()
+     */
+    void describe(const char *type, std::vector<LogField> fields);
+
+    /// Sensor messages dropped since startup
+    uint64_t sensor_dropped() const {return _sensor_dropped.load(std::memory_order_relaxed);}
+
+    /**
+     * @brief Start and stop the logger thread
+     */
+    void start();
+    void stop();
 };
\ No newline at end of file
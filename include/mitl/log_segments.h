@@ -0,0 +1,328 @@
+/**
+ * @file log_segments.h
+ * @author Abdulelah Mulla
+ * @brief Binary log split into compressed, size-bounded segments
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief How blocks are compressed, fixed per segment.
+ */
+enum class LogCodec : uint8_t {
+    NONE,
+    ZSTD,
+    LZ4
+};
+
+/**
+ * @brief How records are laid out in a segment, fixed per segment.
+ */
+enum class LogLayout : uint8_t {
+    INTERLEAVED, // blocks of records in arrival order
+    COLUMNAR     // per topic, each column in its own chunks
+};
+
+enum class LogRecordKind : uint8_t {
+    TOPIC = 1, // payload: label, '\0', message type
+    DATA = 2   // payload: serialized message
+};
+
+/**
+ * @brief Precedes every record once a block is decompressed.
+ */
+struct LogRecordHeader {
+    LogRecordKind kind;
+    uint8_t topic;
+    uint16_t reserved;
+    uint32_t size; // payload bytes
+    uint64_t time; // µs
+};
+
+/**
+ * @brief Start of a segment file.
+ */
+struct LogFileHeader {
+    char magic[8]; // "MITLLOG1"
+    uint32_t version;
+    LogCodec codec;
+    LogLayout layout;
+    uint8_t reserved[2];
+};
+
+/**
+ * @brief Precedes every block in a segment file.
+ */
+struct LogBlockHeader {
+    uint32_t size;     // bytes in the file after this header
+    uint32_t raw_size; // bytes once decompressed
+};
+
+/**
+ * @brief One entry of a segment index, a block and the times in it.
+ */
+struct LogBlockIndex {
+    uint64_t offset;     // of the LogBlockHeader in the segment file
+    uint32_t size;
+    uint32_t raw_size;
+    uint64_t first_time; // µs
+    uint64_t last_time;
+};
+
+/**
+ * @brief Type of a field of a fixed layout record.
+ */
+enum class LogFieldType : uint8_t {
+    U8,
+    U32,
+    U64,
+    F32,
+    F64
+};
+
+/// Bytes of a field type
+constexpr size_t field_size(LogFieldType type) {
+    return type == LogFieldType::U8 ? 1 : type == LogFieldType::U64 || type == LogFieldType::F64 ? 8 : 4;
+}
+
+/**
+ * @brief A field of a topic, at an offset in its rows.
+ */
+struct LogField {
+    std::string name;
+    LogFieldType type;
+    uint16_t offset;
+};
+
+enum class LogChunkKind : uint8_t {
+    SCHEMA = 1,  // payload: a topic and its fields, see SegmentedLog
+    TIME = 2,    // uint64_t per row
+    FIELD = 3,   // one field, packed, per row
+    SIZES = 4,   // uint32_t per row, bytes of each payload
+    PAYLOAD = 5  // the records as appended, back to back
+};
+
+/**
+ * @brief Precedes every chunk of a columnar segment, and is repeated
+ * in its index, so a reader picks chunks without touching the others.
+ */
+struct LogChunkHeader {
+    LogChunkKind kind;
+    uint8_t topic;
+    uint16_t column;     // field, FIELD chunks only
+    uint32_t group;      // chunks of the same rows share it
+    uint32_t count;      // rows
+    uint32_t size;       // bytes in the file after this header
+    uint32_t raw_size;   // bytes once decompressed
+    uint32_t reserved;
+    uint64_t first_time; // µs
+    uint64_t last_time;
+    double min;          // of the values, FIELD chunks only
+    double max;
+};
+
+/**
+ * @brief One entry of a columnar segment index.
+ */
+struct LogChunkIndex {
+    uint64_t offset; // of the LogChunkHeader in the segment file
+    LogChunkHeader header;
+};
+
+/**
+ * @brief When to start a new segment and how much disk to keep.
+ */
+struct LogPolicy {
+    uint64_t segment_bytes;
+    std::chrono::seconds segment_duration;
+    uint64_t budget_bytes; // all segments of this log, older ones are deleted
+};
+
+/**
+ * @brief A log written as numbered segments, name_000001.mlog and so on.
+ *
+ * Records are gathered into blocks of BLOCK_BYTES, and each full block
+ * is compressed and appended to the current segment. A block starts
+ * with the TOPIC record of every topic seen so far, so any block can be
+ * decoded on its own. Next to each segment, name_000001.mlog.idx lists
+ * its blocks with their offsets and time ranges, one LogBlockIndex per
+ * block after a LogFileHeader. The index is appended as blocks are
+ * written, so a crash loses at most the open block.
+ *
+ * A segment ends once it reaches the policy's size or duration. Segments
+ * are numbered on from the previous run, and the oldest are deleted
+ * while the log takes more than the budget.
+ *
+ * In the COLUMNAR layout every topic is buffered on its own. Once one
+ * of its columns reaches BLOCK_BYTES, or its rows span GROUP_AGE_US,
+ * the rows are written as a group:
+ * a TIME chunk, a FIELD chunk per field of the topic, and for topics
+ * that keep their payload, SIZES and PAYLOAD chunks. Each chunk is
+ * compressed alone, and its LogChunkHeader carries the rows' time range
+ * and, for fields, the min and max, so a reader decompresses only the
+ * columns and time ranges it asks for. The index lists every chunk as
+ * a LogChunkIndex. A SCHEMA chunk names each topic before its first
+ * group in a segment: label '\0' type '\0', uint8_t keeps payload,
+ * uint16_t field count, then per field uint8_t type, uint16_t offset
+ * and name '\0'.
+ *
+ * Not thread-safe, MITL_LOG serializes the calls.
+ */
+class SegmentedLog {
+public:
+    static constexpr size_t BLOCK_BYTES = 64 * 1024;
+
+    /// Log time a COLUMNAR group spans at most, µs
+    static constexpr uint64_t GROUP_AGE_US = 1000000;
+    static constexpr uint32_t VERSION = 1;
+
+    /// Default policy, before MITL_LOG reads the params
+    static constexpr LogPolicy DEFAULT_POLICY{64ull << 20, std::chrono::seconds(600), 2048ull << 20};
+private:
+    std::string _directory;
+    std::string _name;
+    LogPolicy _policy{DEFAULT_POLICY};
+    LogCodec _codec;
+
+    LogLayout _layout{LogLayout::INTERLEAVED};
+
+    /// Topics in order of their id
+    std::vector<std::string> _topics;
+
+    /**
+     * @brief A topic's fields, and its rows buffered for the COLUMNAR layout.
+     */
+    struct TopicColumns {
+        std::vector<LogField> fields;
+        uint32_t row_size{0}; // bytes the fields span
+        bool keep_payload{true};
+        bool schema_written{false}; // in the open segment
+
+        std::vector<uint64_t> times;
+        std::vector<uint8_t> rows; // row_size bytes each
+        std::vector<uint32_t> sizes;
+        std::vector<uint8_t> payload;
+    };
+    std::vector<TopicColumns> _columns;
+    uint32_t _next_group{0};
+
+    /// Open segment, 0 if none
+    uint32_t _segment{0};
+    std::ofstream _file;
+    std::ofstream _index;
+    uint64_t _file_size{0};
+    std::chrono::steady_clock::time_point _opened;
+
+    /// Block being filled
+    std::vector<uint8_t> _block;
+    uint64_t _first_time{0};
+    uint64_t _last_time{0};
+    bool _block_has_data{false};
+
+    /// Compressed block, and a column gathered from rows, reused
+    std::vector<uint8_t> _compressed;
+    std::vector<uint8_t> _column;
+
+    void open_segment();
+    void write_block();
+    void start_block();
+    void put(LogRecordKind kind, uint8_t topic, uint64_t time, const void *data, uint32_t size);
+
+    /// COLUMNAR layout
+    void write_group(uint8_t topic);
+    void write_chunk(LogChunkHeader header, const uint8_t *data, size_t size);
+    void write_groups();
+
+    /// End the segment once it reaches the policy's size or duration
+    void rotate();
+
+    /// Delete the oldest segments while over budget
+    void enforce_budget();
+public:
+    /**
+     * Constructor
+     *
+     * @param directory where the segments go
+     * @param name file name prefix
+     */
+    SegmentedLog(std::string directory, std::string name);
+    ~SegmentedLog();
+
+    /// Delete copy constructor and assignment operator
+    SegmentedLog(const SegmentedLog&) = delete;
+    SegmentedLog& operator=(const SegmentedLog&) = delete;
+
+    /// Applies from the next block
+    void set_policy(const LogPolicy &policy) {_policy = policy;}
+
+    /**
+     * @brief Set the layout of the following segments.
+     *
+     * Ends the open segment if it has another layout.
+     */
+    void set_layout(LogLayout layout);
+    LogLayout layout() const {return _layout;}
+
+    /**
+     * @brief Register a topic.
+     *
+     * @param fields of its rows, for the COLUMNAR layout
+     * @param keep_payload also keep the records as appended, for the
+     *        COLUMNAR layout, always true without fields
+     * @return its id, records refer to it
+     */
+    uint8_t add_topic(const std::string &label, const std::string &type,
+                      std::vector<LogField> fields = {}, bool keep_payload = true);
+
+    /**
+     * @brief Append a record of a topic.
+     *
+     * @param row the fields are read from, data if null. A row shorter
+     *        than the fields is dropped from the COLUMNAR layout.
+     */
+    void append(uint8_t topic, uint64_t time, const void *data, uint32_t size, const void *row = nullptr,
+                uint32_t row_size = 0);
+
+    /**
+     * @brief Write the open block, or the buffered groups, even if not full.
+     *
+     * Ends the segment if it reached the policy's size or duration, call
+     * it periodically so an idle log still rotates.
+     */
+    void flush();
+
+    /**
+     * @brief Flush and end the segment, the next record starts a new one.
+     */
+    void close();
+
+    /// Number of the open segment, 0 if none
+    uint32_t segment() const {return _segment;}
+
+    /// Path of a segment
+    std::string segment_path(uint32_t segment) const;
+
+    /// Codec compiled in, the best available
+    static LogCodec default_codec();
+
+    /**
+     * @brief Compress a block.
+     * @return false if the codec is not compiled in
+     */
+    static bool compress(LogCodec codec, const uint8_t *data, size_t size, std::vector<uint8_t> &out);
+
+    /**
+     * @brief Decompress a block of raw_size bytes into out.
+     * @return false if corrupt, or the codec is not compiled in
+     */
+    static bool decompress(LogCodec codec, const uint8_t *data, size_t size, uint8_t *out, size_t raw_size);
+};
@@ -18,6 +18,11 @@
 #include "mode_manager.h"
 #include "vehicle.h"
 #include "morb.h"
+#include "params.h"
+#include "thread_factory.h"
+#include "telemetry/telemetry_streams.h"
+#include "telemetry/log_server.h"
+#include "telemetry/fence_server.h"
 
 #include <mavsdk/mavsdk.h>
 #include <mavsdk/plugins/param_server/param_server.h>
@@ -68,14 +73,33 @@ private:
     std::future<mavsdk::MissionRawServer::MissionPlan> _mission_future;
     mavsdk::MissionRawServer::IncomingMissionHandle _mission_handle{};
 
+    /// Last mission item reported to MissionRawServer as current
+    std::atomic<uint16_t> _mission_reported{0};
+
+    /// Item the Mission mode has reached, written by the control thread
+    std::atomic<uint16_t> _mission_target{0};
+
+    /// Receives the geofence, which MissionRawServer does not handle
+    std::unique_ptr<FenceServer> _fence_server;
+
     /// state
     std::atomic<bool> _running{false};
 
     /// Dedicated thread for 'running' the vehicle
-    std::thread _vehicle_thread;
+    FactoryThread _vehicle_thread;
+
+    /// Longest a mode change waits to be reported to the GCS
+    static constexpr uint64_t MODE_REPORT_PERIOD_US = 20000;
+
+    /// Telemetry stream rates
+    TelemetryStreams _streams;
+
+    /// Incoming COMMAND_LONG, for the commands MAVSDK does not handle
+    mavsdk::MavlinkDirect::MessageHandle _command_handle{};
+    bool _command_subscribed = false;
 
-    /// Flag indicating that the vehicle is armed
-    std::atomic<bool> _armed{false};
+    /// Serves the log files to the GCS
+    std::unique_ptr<LogServer> _log_server;
 
     /// Message bus
     Morb* _morb;
@@ -94,6 +118,44 @@ private:
      */
     void setup_params();
 
+    /**
+     * @brief Store a param the GCS changed, through set_param()
+     */
+    void on_param_changed(const std::string &name, float value);
+
+    /**
+     * @brief Store a param, apply it to the telemetry streams and
+     * publish it on "parameter_update"
+     *
+     * Out of range values are refused and the GCS gets the old one back.
+     *
+     * @return false if refused
+     */
+    bool set_param(ParamId id, float value);
+
+    /**
+     * @brief Give the GCS the value we keep for a param
+     */
+    void provide_param(ParamId id);
+
+    /**
+     * @brief Sets up the telemetry streams
+     *
+     * Handles SET_MESSAGE_INTERVAL and GET_MESSAGE_INTERVAL from the GCS,
+     * and starts the log download server.
+     */
+    void setup_telemetry();
+
+    /**
+     * @brief Callback for COMMAND_LONG received through MavlinkDirect
+     */
+    void on_command_long(const mavsdk::MavlinkDirect::MavlinkMessage &message);
+
+    /**
+     * @brief Acknowledge a COMMAND_LONG
+     */
+    void send_command_ack(uint32_t command, uint32_t result, const mavsdk::MavlinkDirect::MavlinkMessage &request);
+
     /**
      * @brief Sets up the actions of our vehicle
      * 
@@ -104,7 +166,8 @@ private:
     /**
      * @brief Sets up the MissionRawServer
      * 
-     * Subscribes to incoming mission callback.
+     * Subscribes to incoming mission callback, and starts
+     * the geofence server.
      */
     void setup_mission_server();
 
@@ -151,6 +214,30 @@ private:
      */
     void on_incoming_mission(mavsdk::MissionRawServer::Result res, mavsdk::MissionRawServer::MissionPlan plan);
     
+    /**
+     * @brief Callback for receiving a geofence upload from the GCS
+     *
+     * @param items fence items, empty when the fence is cleared
+     * @return false if the fence is invalid
+     */
+    bool on_incoming_fence(const std::vector<mavsdk::MissionRawServer::MissionItem> &items);
+
+    /**
+     * @brief Callback for the mission progress of the Mission mode
+     *
+     * Runs on the control thread, so it only records how far the
+     * mission got, report_mission_progress() tells the GCS.
+     */
+    void on_mission_progress(const MissionProgress &progress);
+
+    /**
+     * @brief Completes items on MissionRawServer up to the one reached,
+     * which reports MISSION_CURRENT and MISSION_ITEM_REACHED to the GCS.
+     *
+     * Called from the vehicle thread.
+     */
+    void report_mission_progress();
+
     /**
      * @brief Callback for receiving mode change requests from the GCS
      */
@@ -159,7 +246,9 @@ private:
     /**
      * @brief Performs necessary vehicle functions for the vehicle thread
      * 
-     * Simply publishes telem and sends heartbeats for now
+     * Sends each telemetry stream when it is due, sleeping
+     * until the next deadline in between, and reports mode
+     * changes to the GCS.
      */
     void vehicle_loop();
 
@@ -170,6 +259,9 @@ public:
      *
      * @brief Initializes _connection_url, _config, _mavsdk,
      * _mission_future, and _morb.
+     *
+     * With "raw://" there is no socket, join mavsdk() to a GCS
+     * with a MavlinkLoopback before start().
      */
     MavlinkInterface(
         Morb* morb, std::string url = "udpout://127.0.0.1:14550", mavsdk::ComponentType type = mavsdk::ComponentType::Autopilot);
@@ -223,4 +315,9 @@ public:
      * then it CAN'T be restarted or used again!
      */
     void stop();
+
+    /**
+     * @brief Our MAVSDK instance, for a MavlinkLoopback to carry its bytes
+     */
+    mavsdk::Mavsdk& mavsdk() {return _mavsdk;}
 };
\ No newline at end of file
@@ -0,0 +1,124 @@
+/**
+ * @file memory_pool.h
+ * @author Abdulelah Mulla
+ * @brief Fixed-block pools for messages, usable by std::pmr containers
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+
+/**
+ * @brief Counters of a pool.
+ */
+struct PoolStats {
+    size_t block_size; // bytes
+    uint32_t blocks;   // in the pool
+    uint32_t in_use;   // handed out now
+    uint64_t fallbacks; // served by the upstream resource instead
+};
+
+/**
+ * @brief Blocks of one size, carved from one upstream allocation.
+ *
+ * Allocating and freeing a block pops or pushes a lock-free list, so
+ * either may happen on any thread, the control thread included. The
+ * head carries a tag that changes on every update, so a block taken
+ * and returned by another thread in between cannot be mistaken for
+ * the old head. Requests larger than a block, or made while every
+ * block is in use, go to the upstream resource and are counted.
+ */
+class BlockPool : public std::pmr::memory_resource {
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    size_t _block_size;
+    uint32_t _block_count;
+    std::pmr::memory_resource *_upstream;
+
+    std::byte *_blocks;
+    /// Next free block of each block
+    std::unique_ptr<std::atomic<uint32_t>[]> _next;
+    /// Tag in the high half, first free block in the low half
+    std::atomic<uint64_t> _head;
+
+    std::atomic<uint32_t> _in_use{0};
+    std::atomic<uint64_t> _fallbacks{0};
+
+    bool owns(const void *p) const;
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+public:
+    /**
+     * Constructor
+     *
+     * @param block_size rounded up to alignof(std::max_align_t)
+     * @param block_count blocks allocated up front
+     * @param upstream where the blocks, and what does not fit, come from
+     */
+    BlockPool(size_t block_size, uint32_t block_count,
+              std::pmr::memory_resource *upstream = std::pmr::new_delete_resource());
+    ~BlockPool() override;
+
+    /// Delete copy constructor and assignment operator
+    BlockPool(const BlockPool&) = delete;
+    BlockPool& operator=(const BlockPool&) = delete;
+
+    size_t block_size() const {return _block_size;}
+
+    /**
+     * @brief A block, never the upstream.
+     * @return nullptr if it does not fit or every block is in use,
+     * free it with deallocate()
+     */
+    void* try_allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+    PoolStats stats() const;
+};
+
+/**
+ * @brief One BlockPool per message size class.
+ *
+ * A request is served by the smallest pool its size fits in, or by
+ * the heap if it fits none. Use it for data that is produced and
+ * consumed on different threads, such as solved trajectories, so
+ * neither side has to take the heap's locks.
+ */
+class MessagePools : public std::pmr::memory_resource {
+public:
+    static constexpr int CLASS_COUNT = 5;
+    static constexpr size_t BLOCK_SIZES[CLASS_COUNT] = {64, 256, 1024, 4096, 16384};
+    static constexpr uint32_t BLOCK_COUNTS[CLASS_COUNT] = {256, 128, 64, 32, 8};
+private:
+    std::unique_ptr<BlockPool> _pools[CLASS_COUNT];
+
+    /// Constructor
+    MessagePools();
+
+    /// Pool a request of this size goes to, nullptr for the heap
+    BlockPool* pool_for(size_t bytes, size_t alignment);
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+public:
+    /// Delete copy constructor and assignment operator
+    MessagePools(const MessagePools&) = delete;
+    MessagePools& operator=(const MessagePools&) = delete;
+
+    /**
+     * Singleton approach to give global access to this class.
+     */
+    static MessagePools& initialize();
+
+    /// Counters of size class i
+    PoolStats stats(int i) const {return _pools[i]->stats();}
+};
@@ -0,0 +1,59 @@
+/**
+ * @file message_columns.h
+ * @author Abdulelah Mulla
+ * @brief Numeric fields of a protobuf message as a row of doubles
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "log_segments.h"
+
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/message.h>
+
+/**
+ * @brief Flattens a protobuf message type into columns, for the
+ * COLUMNAR layout of the sensor log.
+ *
+ * Every singular numeric, bool and enum field becomes an F64 column,
+ * named by its path, like "linear_acceleration.z". Submessages are
+ * followed MAX_DEPTH deep, the headers of submessages are left out,
+ * and strings and repeated fields are not columns. The serialized
+ * message is kept as the payload, so nothing is lost.
+ */
+class MessageColumns {
+public:
+    static constexpr size_t MAX_FIELDS = 64;
+    static constexpr int MAX_DEPTH = 4;
+private:
+    /// Fields from the message down to a leaf
+    std::vector<std::vector<const google::protobuf::FieldDescriptor*>> _paths;
+    std::vector<LogField> _fields;
+
+    /// Parsed into, reused
+    std::unique_ptr<google::protobuf::Message> _message;
+
+    void add(const google::protobuf::Descriptor *type, std::vector<const google::protobuf::FieldDescriptor*> &path,
+             const std::string &prefix, int depth);
+public:
+    explicit MessageColumns(const google::protobuf::Descriptor *type);
+
+    const std::vector<LogField>& fields() const {return _fields;}
+
+    /// Bytes of a row
+    uint32_t row_size() const {return static_cast<uint32_t>(_fields.size() * sizeof(double));}
+
+    /**
+     * @brief Parse a serialized message into a row.
+     *
+     * @param row row_size() bytes
+     * @return false if it does not parse
+     */
+    bool flatten(const void *bytes, uint32_t size, double *row);
+};
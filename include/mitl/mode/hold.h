@@ -1,25 +1,74 @@
 /**
  * @file hold.h
  * @author Abdulelah Mulla
- * @date 11/25/2025
+ * @brief Header file for the hold mode
+ * @version 0.1
+ * @date 2026-10-18
  */
 
 #pragma once
 
 #include "mode/mode.h"
+#include "geodesy.h"
 
-/// TODO:
+class Navigator;
+class Morb;
+
+/**
+ * @brief Stops the vehicle and holds position and yaw.
+ *
+ * On activation the vehicle brakes along its current velocity at a
+ * constant deceleration, the setpoint follows that profile in closed
+ * form so braking starts on the first tick. Once stopped, the
+ * position and the yaw at activation are latched and the setpoint
+ * no longer changes, so nothing more is published.
+ */
 class Hold : public Mode {
+private:
+    Morb *_morb;
+    Navigator *_navigator;
+
+    /// Profile frame, centered where the mode was entered
+    LocalFrame _frame;
+
+    /// Velocity at activation, NED m/s
+    float _v0[3]{};
+
+    /// Time the braking started and how long it takes, s
+    double _start_time{0};
+    float _stop_time{0};
+
+    bool _braking{false};
+
+    /// Yaw at activation, deg
+    float _yaw{0};
+
+    /// Braking deceleration, m/s²
+    static constexpr float BRAKE_DECELERATION = 3.0f;
 public:
-    Hold();
+    /// Constructor and destructor
+    Hold(Morb *morb, Navigator *navigator);
+    ~Hold();
+
+    /// Disable default constructor
+    Hold() = delete;
+    /// Disable Assignment operator
+    Hold& operator=(const Hold&) = delete;
 
+    /**
+     * @brief Latch yaw and start braking.
+     */
     void on_activation() override;
 
+    /**
+     * @brief Follow the braking profile, O(1).
+     */
     void on_active() override;
 
     void on_inactivation() override;
 
     void on_inactive() override;
 
+    /// Hold never completes
     bool is_complete() const override;
-};
\ No newline at end of file
+};
@@ -1,25 +1,102 @@
 /**
  * @file land.h
  * @author Abdulelah Mulla
- * @date 11/25/2025
+ * @brief Header file for the land mode
+ * @version 0.1
+ * @date 2026-10-18
  */
 
 #pragma once
 
 #include "mode/mode.h"
 
-/// TODO:
+class Navigator;
+class Morb;
+
+/**
+ * @brief Enum defining current land state
+ */
+enum class LandState {
+    INIT,
+    DESCENDING,
+    GROUND_CONTACT,
+    LANDED
+};
+
+/**
+ * @brief Descends in place and detects touchdown.
+ *
+ * The descent rate is scheduled on the height above the local
+ * origin, fast high up and slow near the ground, and ramps between
+ * rates with a bounded acceleration. Horizontal position and yaw are
+ * latched where the mode was entered.
+ *
+ * Touchdown comes from the land detector. On ground contact the
+ * descent stops, once landed the mode completes and the mode
+ * manager disarms through Ready.
+ */
 class Land : public Mode {
+private:
+    Morb *_morb;
+    Navigator *_navigator;
+
+    LandState _state{LandState::INIT};
+
+    /// Latched horizontal position and yaw
+    double _lat{0};
+    double _lon{0};
+    float _yaw{0};
+
+    /// Altitude and rate setpoints, AMSL m and m/s down
+    double _alt_sp{0};
+    float _rate_sp{0};
+
+    /// Time of the last tick, s
+    double _last_time{0};
+
+    /// Descent profile
+    static constexpr float DESCENT_RATE_FAST = 1.5f;   // m/s, above SLOW_DOWN_HEIGHT
+    static constexpr float DESCENT_RATE_SLOW = 0.5f;   // m/s, below TOUCHDOWN_HEIGHT
+    static constexpr float SLOW_DOWN_HEIGHT = 10.0f;   // m
+    static constexpr float TOUCHDOWN_HEIGHT = 3.0f;    // m
+    static constexpr float DESCENT_ACCELERATION = 1.0f; // m/s²
+
+    /// How far the setpoint may lead the vehicle down, m
+    static constexpr float MAX_LEAD = 1.0f;
+
+    /**
+     * @brief Descent rate for a height above the local origin
+     */
+    static float descent_rate(float height);
+
+    /**
+     * @brief Follow the land detector
+     */
+    void update_detector();
 public:
-    Land();
+    /// Constructor and destructor
+    Land(Morb *morb, Navigator *navigator);
+    ~Land();
+
+    /// Disable default constructor
+    Land() = delete;
+    /// Disable Assignment operator
+    Land& operator=(const Land&) = delete;
 
+    /**
+     * @brief Latch the position and start descending.
+     */
     void on_activation() override;
 
+    /**
+     * @brief Step the descent profile and the ground detection, O(1).
+     */
     void on_active() override;
 
     void on_inactivation() override;
 
     void on_inactive() override;
 
+    /// Landed, ready to disarm
     bool is_complete() const override;
-};
\ No newline at end of file
+};
@@ -0,0 +1,100 @@
+/**
+ * @file mission.h
+ * @author Abdulelah Mulla
+ * @brief Header file for the mission mode
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "mode/mode.h"
+#include "navigator/mission_plan.h"
+#include "navigator/trajectory.h"
+
+class Navigator;
+class Morb;
+
+/**
+ * @brief Published on "mission_progress" when the current item changes.
+ */
+struct MissionProgress {
+    uint16_t current_seq;  // item flown to now
+    uint16_t reached_seq;  // item just reached, current_seq if none
+    bool finished;         // the last waypoint was reached
+};
+
+/**
+ * @brief Flies the uploaded mission waypoint by waypoint.
+ *
+ * The plan is picked up from the navigator on activation and when
+ * a new one is uploaded. Each tick only compares the vehicle against
+ * the current waypoint and samples the trajectory, so the cost does
+ * not depend on mission size.
+ *
+ * Without a mission the vehicle holds where it entered the mode.
+ */
+class Mission : public Mode {
+private:
+    Morb *_morb;
+    Navigator *_navigator;
+
+    /// Plan being flown
+    std::shared_ptr<const MissionPlan> _plan;
+
+    /// Waypoint flown to
+    size_t _index{0};
+
+    bool _complete{false};
+
+    /// Smooth path through the remaining waypoints
+    TrajectoryTracker _tracker;
+
+    /// Cruise limits
+    static constexpr TrajectoryLimits LIMITS{5.0f, 3.0f};
+
+    /**
+     * @brief Set the navigator target to the current waypoint, and
+     * request a trajectory from here through the rest of the mission.
+     */
+    void set_target();
+
+    /**
+     * @brief Publish the progress to "mission_progress".
+     */
+    void report(uint16_t reached_seq);
+
+    /**
+     * @brief Take the latest plan and jump requests from the navigator.
+     */
+    void update_plan();
+public:
+    /// Constructor and destructor
+    Mission(Morb *morb, Navigator *navigator);
+    ~Mission();
+
+    /// Disable default constructor
+    Mission() = delete;
+    /// Disable Assignment operator
+    Mission& operator=(const Mission&) = delete;
+
+    /**
+     * @brief Pick up the plan and head to the current waypoint.
+     */
+    void on_activation() override;
+
+    /**
+     * @brief Step to the next waypoint once the current one is reached.
+     */
+    void on_active() override;
+
+    void on_inactivation() override;
+
+    void on_inactive() override;
+
+    /// The last waypoint was reached
+    bool is_complete() const override;
+};
@@ -0,0 +1,58 @@
+/**
+ * @file mode_change.h
+ * @author Abdulelah Mulla
+ * @brief Flight mode ids, events and the mode_change bus message
+ * @version 0.1
+ * @date 2026-10-19
+ */
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief The flight modes, used as index into the tables.
+ *
+ * Keep COUNT last.
+ */
+enum class ModeId : uint8_t {
+    READY,
+    TAKEOFF,
+    HOLD,
+    MISSION,
+    LAND,
+    COUNT
+};
+
+constexpr int MODE_COUNT = static_cast<int>(ModeId::COUNT);
+
+/**
+ * @brief Everything that can make the mode change.
+ *
+ * The REQUEST_* events come from the GCS, the others from the
+ * control loop. Keep COUNT last.
+ */
+enum class ModeEvent : uint8_t {
+    REQUEST_READY,
+    REQUEST_TAKEOFF,
+    REQUEST_HOLD,
+    REQUEST_MISSION,
+    REQUEST_LAND,
+    MODE_COMPLETE,   // the current mode finished, auto-transition
+    FENCE_PREDICTED, // the geofence will be breached soon
+    FENCE_BREACHED,  // outside the geofence
+    FAILSAFE,        // a health check failed in flight
+    COUNT
+};
+
+constexpr int MODE_EVENT_COUNT = static_cast<int>(ModeEvent::COUNT);
+
+/**
+ * @brief Published on "mode_change" by the control thread after a transition.
+ */
+struct ModeChange {
+    uint64_t timestamp; // sim time, µs
+    ModeId from;
+    ModeId to;
+    ModeEvent event;
+};
@@ -0,0 +1,204 @@
+/**
+ * @file mode_table.h
+ * @author Abdulelah Mulla
+ * @brief Compile-time flight mode state machine
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "mode/mode_change.h"
+
+#include <mavsdk/mavsdk.h>
+#include <mavsdk/plugins/action_server/action_server.h>
+
+/**
+ * @brief Condition checked before a transition is taken.
+ */
+enum class ModeGuard : uint8_t {
+    NONE,
+    HEALTHY,       // the health checks allow arming
+    LANDED,        // the land detector says we are on the ground
+};
+
+/**
+ * @brief Action run when entering or leaving a mode.
+ */
+enum class ModeAction : uint8_t {
+    NONE,
+    DISARM,
+};
+
+/**
+ * @brief Static description of a mode.
+ */
+struct ModeInfo {
+    ModeId id;
+    mavsdk::ActionServer::FlightMode flight_mode;
+    ModeEvent request;    // event a GCS request for this mode maps to
+    ModeAction on_entry;
+    ModeAction on_exit;
+};
+
+/**
+ * @brief One row of the transition table.
+ */
+struct ModeTransition {
+    ModeId from;
+    ModeEvent event;
+    ModeId to;
+    ModeGuard guard;
+};
+
+/// Indexed by ModeId
+constexpr std::array<ModeInfo, MODE_COUNT> MODE_INFO{{
+    {ModeId::READY,   mavsdk::ActionServer::FlightMode::Ready,   ModeEvent::REQUEST_READY,   ModeAction::DISARM, ModeAction::NONE},
+    {ModeId::TAKEOFF, mavsdk::ActionServer::FlightMode::Takeoff, ModeEvent::REQUEST_TAKEOFF, ModeAction::NONE,   ModeAction::NONE},
+    {ModeId::HOLD,    mavsdk::ActionServer::FlightMode::Hold,    ModeEvent::REQUEST_HOLD,    ModeAction::NONE,   ModeAction::NONE},
+    {ModeId::MISSION, mavsdk::ActionServer::FlightMode::Mission, ModeEvent::REQUEST_MISSION, ModeAction::NONE,   ModeAction::NONE},
+    {ModeId::LAND,    mavsdk::ActionServer::FlightMode::Land,    ModeEvent::REQUEST_LAND,    ModeAction::NONE,   ModeAction::NONE},
+}};
+
+/**
+ * Every allowed transition, anything not listed is refused.
+ *
+ * Geofence failsafe: stop before a predicted breach, land once
+ * outside. Health failsafe: land, there is no return mode yet.
+ * Ready disarms, a GCS can only ask for it once landed.
+ */
+constexpr ModeTransition MODE_TRANSITIONS[] = {
+    {ModeId::READY,   ModeEvent::REQUEST_TAKEOFF, ModeId::TAKEOFF, ModeGuard::HEALTHY},
+    {ModeId::TAKEOFF, ModeEvent::REQUEST_HOLD,    ModeId::HOLD,    ModeGuard::NONE},
+    {ModeId::TAKEOFF, ModeEvent::MODE_COMPLETE,   ModeId::HOLD,    ModeGuard::NONE},
+    {ModeId::TAKEOFF, ModeEvent::FENCE_PREDICTED, ModeId::HOLD,    ModeGuard::NONE},
+    {ModeId::TAKEOFF, ModeEvent::FENCE_BREACHED,  ModeId::LAND,    ModeGuard::NONE},
+    {ModeId::TAKEOFF, ModeEvent::FAILSAFE,        ModeId::LAND,    ModeGuard::NONE},
+    {ModeId::HOLD,    ModeEvent::REQUEST_LAND,    ModeId::LAND,    ModeGuard::NONE},
+    {ModeId::HOLD,    ModeEvent::REQUEST_MISSION, ModeId::MISSION, ModeGuard::NONE},
+    {ModeId::HOLD,    ModeEvent::FENCE_BREACHED,  ModeId::LAND,    ModeGuard::NONE},
+    {ModeId::HOLD,    ModeEvent::FAILSAFE,        ModeId::LAND,    ModeGuard::NONE},
+    {ModeId::MISSION, ModeEvent::REQUEST_HOLD,    ModeId::HOLD,    ModeGuard::NONE},
+    {ModeId::MISSION, ModeEvent::MODE_COMPLETE,   ModeId::HOLD,    ModeGuard::NONE},
+    {ModeId::MISSION, ModeEvent::FENCE_PREDICTED, ModeId::HOLD,    ModeGuard::NONE},
+    {ModeId::MISSION, ModeEvent::FENCE_BREACHED,  ModeId::LAND,    ModeGuard::NONE},
+    {ModeId::MISSION, ModeEvent::FAILSAFE,        ModeId::LAND,    ModeGuard::NONE},
+    {ModeId::LAND,    ModeEvent::REQUEST_READY,   ModeId::READY,   ModeGuard::LANDED},
+    {ModeId::LAND,    ModeEvent::MODE_COMPLETE,   ModeId::READY,   ModeGuard::NONE},
+};
+
+constexpr int MODE_TRANSITION_COUNT = sizeof(MODE_TRANSITIONS) / sizeof(MODE_TRANSITIONS[0]);
+
+/// No transition for this mode and event
+constexpr int8_t NO_TRANSITION = -1;
+
+/**
+ * @brief [mode][event] to the row of MODE_TRANSITIONS, or NO_TRANSITION.
+ */
+using ModeDispatchTable = std::array<std::array<int8_t, MODE_EVENT_COUNT>, MODE_COUNT>;
+
+constexpr ModeDispatchTable make_dispatch_table() {
+    ModeDispatchTable table{};
+    for (auto &row : table) {
+        for (auto &cell : row) {
+            cell = NO_TRANSITION;
+        }
+    }
+    for (int i = 0; i < MODE_TRANSITION_COUNT; i++) {
+        const ModeTransition &t = MODE_TRANSITIONS[i];
+        table[static_cast<int>(t.from)][static_cast<int>(t.event)] = static_cast<int8_t>(i);
+    }
+    return table;
+}
+
+constexpr ModeDispatchTable MODE_DISPATCH = make_dispatch_table();
+
+/**
+ * @brief The transition for a mode and event, nullptr if refused.
+ */
+constexpr const ModeTransition* find_transition(ModeId from, ModeEvent event) {
+    const int8_t row = MODE_DISPATCH[static_cast<int>(from)][static_cast<int>(event)];
+    return row == NO_TRANSITION ? nullptr : &MODE_TRANSITIONS[row];
+}
+
+/**
+ * @brief The mode for a MAVSDK flight mode.
+ * @return false if it is not one we fly
+ */
+constexpr bool mode_from_flight_mode(mavsdk::ActionServer::FlightMode flight_mode, ModeId &mode) {
+    for (const ModeInfo &info : MODE_INFO) {
+        if (info.flight_mode == flight_mode) {
+            mode = info.id;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Static checks of the tables
+ */
+
+constexpr bool mode_info_in_order() {
+    for (int i = 0; i < MODE_COUNT; i++) {
+        if (static_cast<int>(MODE_INFO[i].id) != i) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// A mode and event must not lead to two places
+constexpr bool transitions_unique() {
+    for (int i = 0; i < MODE_TRANSITION_COUNT; i++) {
+        for (int j = i + 1; j < MODE_TRANSITION_COUNT; j++) {
+            if (MODE_TRANSITIONS[i].from == MODE_TRANSITIONS[j].from &&
+                MODE_TRANSITIONS[i].event == MODE_TRANSITIONS[j].event) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/// Every mode can be reached from READY
+constexpr bool all_modes_reachable() {
+    bool reached[MODE_COUNT]{};
+    reached[static_cast<int>(ModeId::READY)] = true;
+    for (int pass = 0; pass < MODE_COUNT; pass++) {
+        for (const ModeTransition &t : MODE_TRANSITIONS) {
+            if (reached[static_cast<int>(t.from)]) {
+                reached[static_cast<int>(t.to)] = true;
+            }
+        }
+    }
+    for (bool r : reached) {
+        if (!r) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Every mode can be left, no dead ends
+constexpr bool no_dead_ends() {
+    for (int mode = 0; mode < MODE_COUNT; mode++) {
+        bool leaves = false;
+        for (const ModeTransition &t : MODE_TRANSITIONS) {
+            leaves |= static_cast<int>(t.from) == mode && t.to != t.from;
+        }
+        if (!leaves) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(mode_info_in_order(), "MODE_INFO must be indexed by ModeId");
+static_assert(transitions_unique(), "Duplicate mode transition");
+static_assert(all_modes_reachable(), "A mode cannot be reached from READY");
+static_assert(no_dead_ends(), "A mode cannot be left");
+static_assert(MODE_TRANSITION_COUNT < 128, "Dispatch table rows are int8_t");
@@ -10,6 +10,8 @@
 
 #include "mode.h"
 #include "position.h"
+#include "geodesy.h"
+#include "navigator/trajectory.h"
 
 class Navigator;
 class Morb;
@@ -31,8 +33,6 @@ private:
     Morb *_morb;
     Navigator *_navigator;
 
-    float _takeoff_alt_amsl{0};  // Target altitude AMSL
-
     bool _active{false};
     
     /// State tracking
@@ -40,6 +40,17 @@ private:
 
     /// Completion threshold
     const float ALTITUDE_THRESHOLD = 0.5f;  // meters
+
+    /// Climb height, MIS_TAKEOFF_ALT when activated
+    float _height{10.0f};
+
+    /// Climb profile and completion, centered on the takeoff point
+    LocalFrame _frame;
+    TrajectoryTracker _tracker;
+    static constexpr TrajectoryLimits LIMITS{1.5f, 1.0f};
+
+    /// Top of the climb, shared with the solver
+    std::shared_ptr<float[][3]> _top{new float[1][3]{}};
 public:
     /// Constructor and destructor
     Takeoff(Morb *morb, Navigator *navigator);
@@ -11,19 +11,45 @@
 #include <vector>
 #include <memory>
 #include <thread>
-#include <mutex>
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <unordered_map>
 
 #include "vehicle.h"
 #include "navigator/navigator.h"
+#include "mode/mode_table.h"
+#include "gazebo/sensor_monitor.h"
+#include "health_monitor.h"
+#include "params.h"
+#include "mpsc_queue.h"
+#include "rate_groups.h"
+#include "thread_factory.h"
+#include "watchdog.h"
 #include "morb.h"
 
 #include <mavsdk/mavsdk.h>
 #include <mavsdk/plugins/action_server/action_server.h>
 #include <mavsdk/plugins/telemetry_server/telemetry_server.h>
 
+/**
+ * @brief A request for the control thread.
+ */
+enum class ModeCommandType : uint8_t {
+    SET_MODE,
+    TAKEOFF,
+    LAND,
+    ARM,
+    DISARM
+};
+
+struct ModeCommand {
+    ModeCommandType type;
+    ModeId mode;   // SET_MODE only
+    uint32_t seq;  // matches the ack
+};
+
 /**
  * @brief The system that manages the mode
  * 
@@ -34,13 +60,23 @@
  * looks at the request and the current state of the vehicle and
  * decides the appropriate actions. 
  * 
- * Mode changes are governed by a state machine.
+ * Mode changes are governed by a state machine, the
+ * compile-time tables in mode/mode_table.h.
+ *
+ * Only the control thread touches the state machine. Requests from
+ * the GCS, which arrive on MAVSDK threads, are pushed on a lock-free
+ * queue that the control loop drains at the start of a cycle, and
+ * the requesting thread waits for the result. The control loop only
+ * takes the ack lock, which a requester holds for no more than a
+ * check of its ack, logs through program_log_nowait(), and never
+ * calls into MAVSDK, the new mode and armed state are reported to
+ * the GCS by report_mode() from the vehicle thread.
  * 
  */
 class ModeManager {
 private:
     /// The mode we are currently on
-    mavsdk::ActionServer::FlightMode _curr_mode;
+    std::atomic<ModeId> _curr_mode{ModeId::READY};
 
     /// Vehicle instance to utilize
     Vehicle& _vehicle;
@@ -55,30 +91,82 @@ private:
     Navigator _navigator;
 
     /// Control thread running flag
-    std::atomic<bool> _running;
+    std::atomic<bool> _running{false};
 
     /// Dedicated control loop thread
-    std::thread _control_thread;
+    FactoryThread _control_thread;
 
-    /// Thread safety lock
-    std::mutex _mutex;
+    /// Requests from the GCS, drained by the control loop
+    static constexpr size_t COMMAND_QUEUE_SIZE = 32;
+    MpscQueue<ModeCommand, COMMAND_QUEUE_SIZE> _commands;
 
-    /// The control rate we will be running at
-    const int _CONTROL_RATE = 50;
-    std::chrono::milliseconds _CONTROL_PERIOD = std::chrono::milliseconds(1000/_CONTROL_RATE);
+    /// State of a request, (seq << 2) | state at seq % COMMAND_QUEUE_SIZE.
+    /// The control loop claims a request before running it, a requester
+    /// that times out cancels it first, so it never runs unreported.
+    static constexpr uint64_t ACK_RUNNING = 0;
+    static constexpr uint64_t ACK_ACCEPTED = 1;
+    static constexpr uint64_t ACK_REFUSED = 2;
+    static constexpr uint64_t ACK_CANCELLED = 3;
+    std::atomic<uint64_t> _acks[COMMAND_QUEUE_SIZE]{};
+    std::atomic<uint32_t> _next_seq{1};
 
-    /**
-     * @brief Verifies mode transitions
-     * 
-     * Uses the state machine outlined (TODO) to verify 
-     * transitions.
-     * 
-     * MUST be called with mutex held
-     * 
-     * @param new_mode_type The mode type we want to change to
-     * @return true if the transition is valid, false otherwise
-     */
-    bool isValidTransition(mavsdk::ActionServer::FlightMode new_mode_type);
+    /// Requesters sleep on it, the control loop only takes the lock
+    /// for an instant before it notifies
+    std::mutex _ack_mutex;
+    std::condition_variable _ack_ready;
+
+    /// Longest a request waits for the control loop
+    static constexpr std::chrono::milliseconds COMMAND_TIMEOUT{500};
+
+    /// Mode and armed state last sent to the GCS, vehicle thread only
+    ModeId _reported_mode{ModeId::READY};
+    bool _reported_armed{false};
+
+    /// Set when the GCS saw an arm request, MAVSDK changes the armed
+    /// state it reports on its own, so it is sent again
+    std::atomic<bool> _armed_stale{false};
+
+    /// Latest sensor health, written from the gazebo clock thread
+    std::atomic<bool> _sensors_healthy{false};
+    std::atomic<uint64_t> _sensor_health_time{0};
+
+    /// Missions and geofences replaced while the control thread may
+    /// still hold them, freed by release_retired() off the control thread
+    std::mutex _retired_mutex;
+    std::vector<std::shared_ptr<const void>> _retired;
+
+    /// A health report older than this counts as stale sensors
+    static constexpr uint64_t SENSOR_HEALTH_TIMEOUT_US = 500000;
+
+    /// Latest health checks, written from the health monitor thread
+    static constexpr uint64_t HEALTH_REPORT_TIMEOUT_US = 2000000;
+    std::atomic<uint8_t> _health_failing{0};
+    std::atomic<bool> _health_arming_ok{false};
+    std::atomic<uint64_t> _health_time{0};
+
+    /// Control loop timing, control thread only
+    ControlLoopStats _loop_stats{};
+    uint32_t _loop_window_max_us{0};
+
+    /// A watched thread missed its deadline, set from the watchdog thread
+    std::atomic<bool> _watchdog_failsafe{false};
+
+    /// Longest a cycle may run before the watchdog steps in, in control periods
+    static constexpr int WATCHDOG_PERIODS = 2;
+
+    /// Latest land detector output, written from the control path,
+    /// and the wall time it arrived, 0 if it never did
+    std::atomic<bool> _landed{false};
+    std::atomic<uint64_t> _landed_time{0};
+
+    /// The detector reports at least once a second, three missed is stale
+    static constexpr uint64_t LAND_DETECTED_TIMEOUT_US = 3000000;
+
+    /// The control rate we will be running at, MITL_CTRL_HZ, read every cycle.
+    /// Cycles are triggered by the POSITION rate group while the IMU runs.
+    Params &_params;
+    int _control_rate{50};
+    std::chrono::microseconds _control_period{20000};
 
     /**
      * @brief Main control loop
@@ -88,28 +176,104 @@ private:
     void control_loop();
     
     /**
-     * @brief Internal mode change (not thread-safe)
+     * @brief Queue a request and wait for the control loop to run it
+     *
+     * Sleeps until the loop reports the result. If the loop has not
+     * picked the request up within COMMAND_TIMEOUT, it is cancelled
+     * and never runs.
+     *
+     * @return the result, false if the loop is not running or busy
+     */
+    bool submit(ModeCommandType type, ModeId mode = ModeId::READY);
+
+    /**
+     * @brief Runs every queued request, control thread only
+     */
+    void run_commands();
+
+    /**
+     * @brief Runs one request, control thread only
+     */
+    bool execute(const ModeCommand &command);
+
+    /**
+     * @brief Feeds an event to the state machine (not thread-safe)
      * 
-     * Validates the transition, exits current mode,
-     * and enters the new mode
+     * Looks the transition up in the table, checks its guard,
+     * runs the exit action of the current mode, switches, and
+     * runs the entry action of the new mode.
      * 
-     * MUST be called with mutex held
+     * MUST be called from the control thread
      * 
-     * @param new_mode_type The mode to switch to
-     * @return true if transition successful
+     * @param event What happened
+     * @return true if the mode changed
      */
-    bool change_mode_internal(mavsdk::ActionServer::FlightMode new_mode_type);
+    bool dispatch(ModeEvent event);
 
     /**
-     * @brief get the next mode type based on the current one
-     * 
-     * Based on state machine, determine what mode should
-     * automatically transition to after current mode finishes
-     * 
-     * @param current Current mode type
-     * @return Next mode type
+     * @brief Evaluates a transition guard
+     */
+    bool check_guard(ModeGuard guard) const;
+
+    /**
+     * @brief Keep a replaced mission or geofence for release_retired()
+     */
+    void retire(std::shared_ptr<const void> replaced);
+
+    /**
+     * @brief Runs an entry or exit action
+     */
+    void run_action(ModeAction action);
+
+    /**
+     * @brief Checks the latest sensor health report
+     *
+     * Fails closed, if no SensorMonitor ever reported (no simulator
+     * attached) this returns false. Reports must be recent and healthy.
+     *
+     * @return true if the sensors allow takeoff
+     */
+    bool sensors_ready() const;
+
+    /**
+     * @brief Checks the latest health report
+     *
+     * Without a health monitor this falls back to the sensor
+     * health alone.
+     *
+     * @return true if the vehicle may arm
      */
-    mavsdk::ActionServer::FlightMode get_next_mode(mavsdk::ActionServer::FlightMode current);
+    bool healthy() const;
+
+    /**
+     * @brief Arms if the health checks allow it (not thread-safe)
+     *
+     * MUST be called from the control thread. The allocation audit
+     * runs while armed.
+     */
+    bool arm_checked();
+
+    /**
+     * @brief Disarms and reports the allocation audit (not thread-safe)
+     *
+     * MUST be called from the control thread
+     */
+    void disarm_vehicle();
+
+    /**
+     * @brief Counts the cycle and publishes the stats once a second
+     */
+    void record_cycle(std::chrono::nanoseconds elapsed);
+
+    /**
+     * @brief Checks the land detector
+     *
+     * Fails closed, without a land detector report, or with one
+     * older than LAND_DETECTED_TIMEOUT_US, this returns false.
+     *
+     * @return true if the vehicle may disarm outside Ready
+     */
+    bool landed() const;
 
 public:
 
@@ -152,10 +316,28 @@ public:
      * This function accepts the takoff request and verifies
      * the request based on the state-machine, and then gives
      * the job to the TakeOffMode.
-     * 
-     * @param height the height that we want to reach to
+     *
+     * @return true if taking off
+     */
+    bool activate_takeoff();
+
+    /**
+     * @brief Arms the vehicle
+     *
+     * Refused while a health check fails.
+     *
+     * @return true if armed
+     */
+    bool arm();
+
+    /**
+     * @brief Disarms the vehicle
+     *
+     * Refused in flight, only in Ready or with a fresh landed report.
+     *
+     * @return true if disarmed
      */
-    void activate_takeoff();
+    bool disarm();
 
     /**
      * @brief Performs the landing operations
@@ -163,8 +345,61 @@ public:
      * This function accepts the landing request and verifies
      * the request based on the state-machine, and then gives
      * the job to the LandMode.
+     *
+     * @return true if landing
+     */
+    bool activate_land();
+
+    /**
+     * @brief Hands an uploaded mission to the Mission mode
+     *
+     * Safe to call from any thread, the mission mode picks it up
+     * on its next tick. The plan it replaces is freed by
+     * release_retired(), never on the control thread.
+     *
+     * @param plan parsed mission, nullptr to clear it
+     */
+    void load_mission(std::shared_ptr<const MissionPlan> plan);
+
+    /**
+     * @brief Hands an uploaded geofence to the navigator
+     *
+     * Safe to call from any thread. Once set, a predicted breach
+     * stops the vehicle and a breach lands it.
+     *
+     * @param fence built geofence, nullptr to clear it
+     */
+    void load_geofence(std::shared_ptr<const Geofence> fence);
+
+    /**
+     * @brief Free the replaced missions and geofences the control
+     * thread is done with
+     *
+     * Call it periodically from a non real-time thread.
+     */
+    void release_retired();
+
+    /**
+     * @brief Continue the mission from an item, as set by the GCS
+     *
+     * @param seq sequence number of the mission item
+     */
+    void set_mission_item(uint16_t seq);
+
+    /**
+     * @brief Tell the GCS about a mode or armed state change, if there
+     * was one
+     *
+     * Calls into MAVSDK, call it from a non real-time thread.
+     */
+    void report_mode();
+
+    /**
+     * @brief Send the armed state again on the next report_mode()
+     *
+     * Call it once a GCS arm or disarm request was answered.
      */
-    void activate_land();
+    void refresh_armed() {_armed_stale.store(true);}
 
     /**
      * @brief Get the current flight mode
@@ -9,6 +9,8 @@
 #include <map>
 #include <functional>
 #include <string>
+#include <string_view>
+#include <vector>
 
 /**
  * @brief Message bus for objects that need to know.
@@ -16,27 +18,37 @@
  * This is not uORB, this is Morb; the M is for Mulla.
  * This Message bus is susceptible to type errors if the
  * use passes the wrong type!
+ *
+ * A topic can have any number of subscribers, they are called
+ * in the order they subscribed, on the thread that publishes.
+ * Subscribe everything before anything is published.
+ *
+ * Publishing does not allocate, the topic is looked up without
+ * building a std::string, so it may run on the control path.
  * 
- * TODO: Re-design to avoid dynamic allocation
+ * TODO: Re-design to avoid dynamic allocation in subscribe
  * TODO: Make it asynchronous 
  */
 class Morb {
 private:
-    std::map<std::string, std::function<void(const void*)>> _subscribers;
+    /// std::less<> finds a topic by string_view
+    std::map<std::string, std::vector<std::function<void(const void*)>>, std::less<>> _subscribers;
 public:
     template<typename T>
     void subscribe(const std::string& topic, std::function<void(const T&)> callback) {
-        _subscribers[topic] = [callback](const void* data) {
+        _subscribers[topic].push_back([callback](const void* data) {
             const T* typed = static_cast<const T*>(data);
             callback(*typed);
-        };
+        });
     }
 
     template<typename T>
-    void publish(const std::string& topic, const T& msg) {
+    void publish(std::string_view topic, const T& msg) {
         auto it = _subscribers.find(topic);
         if (it != _subscribers.end()) {
-            it->second(static_cast<const void*>(&msg));
+            for (auto &callback : it->second) {
+                callback(static_cast<const void*>(&msg));
+            }
         }
     }
 };
\ No newline at end of file
@@ -0,0 +1,86 @@
+/**
+ * @file mpsc_queue.h
+ * @author Abdulelah Mulla
+ * @date 10/18/2026
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Bounded queue of T without locks.
+ *
+ * Any number of producers, one consumer. Every cell carries a
+ * sequence number that says whose turn it is, so a producer claims a
+ * cell with one compare and swap and the consumer never waits, it
+ * sees an empty queue until the producer has finished writing.
+ * N must be a power of two, T must be trivially copyable.
+ */
+template<typename T, size_t N>
+class MpscQueue {
+private:
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "N must be a power of two");
+
+    struct Cell {
+        std::atomic<size_t> seq;
+        T value;
+    };
+    Cell _cells[N];
+
+    /// Producers, apart from the consumer so they do not share a line
+    alignas(64) std::atomic<size_t> _tail{0};
+    alignas(64) size_t _head{0};
+public:
+    MpscQueue() {
+        for (size_t i = 0; i < N; i++) {
+            _cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /// Disable copy constructor and assignment operator
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    /**
+     * @brief Add a value, from any thread.
+     * @return false if the queue is full
+     */
+    bool push(const T &value) {
+        size_t pos = _tail.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell &cell = _cells[pos & (N - 1)];
+            const size_t seq = cell.seq.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = value;
+                    cell.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                /// The consumer has not freed this cell yet
+                return false;
+            } else {
+                pos = _tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Take the oldest value. Only one thread may pop.
+     * @return false if the queue is empty
+     */
+    bool pop(T &value) {
+        Cell &cell = _cells[_head & (N - 1)];
+        if (cell.seq.load(std::memory_order_acquire) != _head + 1) {
+            return false;
+        }
+        value = cell.value;
+        cell.seq.store(_head + N, std::memory_order_release);
+        _head++;
+        return true;
+    }
+};
@@ -0,0 +1,183 @@
+/**
+ * @file geofence.h
+ * @author Abdulelah Mulla
+ * @brief Polygon and circle geofences, precomputed for fast queries
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "geodesy.h"
+
+#include <mavsdk/plugins/mission_raw_server/mission_raw_server.h>
+
+/**
+ * @brief A fence polygon in the local frame, horizontal only.
+ *
+ * The polygon is cut into horizontal slabs. An edge that crosses a
+ * slab from bottom to top is a spanning edge of that slab; since the
+ * edges of a simple polygon do not cross, the spanning edges of a slab
+ * are kept sorted left to right and found by binary search. The few
+ * edges with an end inside the slab are tested one by one.
+ *
+ * A point query casts a ray towards +E in its slab only, so it costs
+ * O(log n) plus the partial edges of one slab, whatever the size of
+ * the polygon.
+ */
+class GeofencePolygon {
+private:
+    struct Edge {
+        float a[2]; // lower end, NE
+        float b[2]; // upper end, NE
+    };
+
+    std::vector<Edge> _edges;
+
+    /// Bounding box, NE
+    float _min[2]{0, 0};
+    float _max[2]{0, 0};
+
+    /// Slabs along N
+    int _slab_count{0};
+    float _slab_height{1};
+
+    /// Spanning edges of each slab, sorted W to E, CSR layout
+    std::vector<uint32_t> _spanning_start;
+    std::vector<uint32_t> _spanning;
+
+    /// Edges ending inside each slab, CSR layout
+    std::vector<uint32_t> _partial_start;
+    std::vector<uint32_t> _partial;
+
+    bool _inclusion{true};
+
+    /// E of an edge at a N coordinate
+    static float east_at(const Edge &edge, float north);
+
+    /// Slab of a N coordinate, clamped
+    int slab_of(float north) const;
+
+    /// Crossing of the segment p + d t, t in [0, 1], with an edge
+    static float hit(const Edge &edge, const float *p, const float *d);
+public:
+    /**
+     * Constructor
+     *
+     * @param vertices NE vertices, count rows, in order
+     * @param count at least 3
+     * @param inclusion the vehicle must stay inside, otherwise outside
+     */
+    GeofencePolygon(const float (*vertices)[2], size_t count, bool inclusion);
+
+    bool inclusion() const {return _inclusion;}
+    size_t edge_count() const {return _edges.size();}
+
+    /// Bounding box, NE
+    const float* min() const {return _min;}
+    const float* max() const {return _max;}
+
+    /**
+     * @brief true if the point is inside the polygon
+     * @param p NE, m
+     */
+    bool contains(const float *p) const;
+
+    /**
+     * @brief First crossing of the boundary along a segment.
+     *
+     * @param p start, NE, m
+     * @param d segment, the end is p + d
+     * @return fraction of the segment in [0, 1], INFINITY if none
+     */
+    float first_crossing(const float *p, const float *d) const;
+};
+
+/**
+ * @brief A fence circle in the local frame.
+ */
+struct GeofenceCircle {
+    float center[2]; // NE, m
+    float radius;    // m
+    bool inclusion;
+
+    bool contains(const float *p) const;
+
+    /// Same as GeofencePolygon::first_crossing
+    float first_crossing(const float *p, const float *d) const;
+};
+
+/**
+ * @brief Result of a geofence check.
+ */
+struct GeofenceStatus {
+    bool breached{false};           // outside the fence now
+    float time_to_breach{INFINITY}; // s at the current velocity, INFINITY if not within the horizon
+};
+
+/**
+ * @brief The uploaded geofence, immutable once built.
+ *
+ * The vehicle must be inside at least one inclusion zone, if there is
+ * any, and outside every exclusion zone. Built from the fence items
+ * off the control thread, then shared read-only like the mission.
+ */
+class Geofence {
+private:
+    std::vector<GeofencePolygon> _polygons;
+    std::vector<GeofenceCircle> _circles;
+    LocalFrame _frame;
+
+    /// Bounding box of the inclusion zones, NE
+    float _min[2]{-INFINITY, -INFINITY};
+    float _max[2]{INFINITY, INFINITY};
+    bool _has_inclusion{false};
+
+    /// Return point, if the GCS sent one
+    bool _has_return_point{false};
+    float _return_point[2]{0, 0};
+
+    Geofence() = default;
+public:
+    /**
+     * @brief Build a geofence from MAV_MISSION_TYPE_FENCE items.
+     *
+     * @param items fence items as uploaded
+     * @param ref_lat reference of the local frame, deg
+     * @param ref_lon deg
+     * @param ref_alt AMSL, m
+     * @return the fence, nullptr if an item is invalid
+     */
+    static std::shared_ptr<const Geofence> parse(
+        const std::vector<mavsdk::MissionRawServer::MissionItem> &items,
+        double ref_lat, double ref_lon, double ref_alt);
+
+    const LocalFrame& frame() const {return _frame;}
+    const std::vector<GeofencePolygon>& polygons() const {return _polygons;}
+    const std::vector<GeofenceCircle>& circles() const {return _circles;}
+    bool empty() const {return _polygons.empty() && _circles.empty();}
+
+    bool has_return_point() const {return _has_return_point;}
+    const float* return_point() const {return _return_point;}
+
+    /**
+     * @brief true if the point is inside the fence
+     * @param p NE, m
+     */
+    bool contains(const float *p) const;
+
+    /**
+     * @brief Time until the fence is breached flying straight.
+     *
+     * @param p NE, m
+     * @param v horizontal velocity, NE, m/s
+     * @param horizon how far ahead to look, s
+     * @return 0 if outside already, INFINITY if not within the horizon
+     */
+    float time_to_breach(const float *p, const float *v, float horizon) const;
+};
@@ -0,0 +1,111 @@
+/**
+ * @file mission_plan.h
+ * @author Abdulelah Mulla
+ * @brief Mission uploaded by the GCS, parsed once for flight
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+#include "geodesy.h"
+
+#include <mavsdk/plugins/mission_raw_server/mission_raw_server.h>
+
+/**
+ * @brief A position the mission flies to.
+ *
+ * Everything the navigator needs per tick is precomputed, so
+ * stepping through the mission never touches the raw items.
+ */
+struct MissionWaypoint {
+    float ned[3];             // local NED in the plan frame, m
+    float acceptance_radius;  // horizontal, m
+    float leg_length;         // 3D distance from the previous waypoint, m
+    float yaw;                // deg, NAN to keep the current heading
+    double lat;
+    double lon;
+    double alt;               // AMSL, m
+    uint16_t seq;             // sequence number of the mission item
+    uint16_t command;         // MAV_CMD
+};
+
+/**
+ * @brief Immutable, contiguous array of the mission waypoints.
+ *
+ * Built once when the mission is uploaded, then shared read-only
+ * with the control thread. Items that are not positions (DO_*,
+ * CONDITION_*) are skipped, their sequence numbers are still
+ * accounted for when reporting progress.
+ *
+ * The arrays live in an arena owned by the plan, sized for the upload
+ * and taken from the heap in one piece. Dropping the plan, when a
+ * mission is replaced or cleared, frees it in one piece too, on the
+ * vehicle thread, see ModeManager::release_retired().
+ */
+class MissionPlan {
+private:
+    std::pmr::monotonic_buffer_resource _arena;
+    std::pmr::vector<MissionWaypoint> _waypoints{&_arena};
+    /// Waypoint positions again, packed for the trajectory solver
+    std::pmr::vector<float> _path{&_arena};
+    LocalFrame _frame;
+    float _total_length{0};
+    uint16_t _item_count{0};
+
+    /// Room for count waypoints in the arena
+    explicit MissionPlan(size_t count);
+public:
+    /// Acceptance radius when the item does not set one, m
+    static constexpr float DEFAULT_ACCEPTANCE_RADIUS = 2.0f;
+
+    /// Vertical acceptance, m
+    static constexpr float ALTITUDE_ACCEPTANCE = 0.8f;
+
+    /// Delete copy constructor and assignment operator
+    MissionPlan(const MissionPlan&) = delete;
+    MissionPlan& operator=(const MissionPlan&) = delete;
+
+    /**
+     * @brief Parse an uploaded mission.
+     *
+     * Relative altitudes are taken above the reference, which is home.
+     *
+     * @param items mission items as uploaded
+     * @param ref_lat reference of the local frame, home, deg
+     * @param ref_lon deg
+     * @param ref_alt AMSL, m
+     * @return the plan, empty if no item is a position
+     */
+    static std::shared_ptr<const MissionPlan> parse(
+        const std::vector<mavsdk::MissionRawServer::MissionItem> &items,
+        double ref_lat, double ref_lon, double ref_alt);
+
+    size_t size() const {return _waypoints.size();}
+    bool empty() const {return _waypoints.empty();}
+    const MissionWaypoint* waypoints() const {return _waypoints.data();}
+    const MissionWaypoint& operator[](size_t index) const {return _waypoints[index];}
+
+    /// Waypoint positions, local NED, size() rows
+    const float (*path() const)[3] {return reinterpret_cast<const float (*)[3]>(_path.data());}
+
+    /// Frame the waypoints are in
+    const LocalFrame& frame() const {return _frame;}
+
+    /// Sum of the leg lengths, m
+    float total_length() const {return _total_length;}
+
+    /// Number of mission items uploaded, positions or not
+    uint16_t item_count() const {return _item_count;}
+
+    /**
+     * @brief Index of the first waypoint at or after a mission item.
+     * @return size() if there is none
+     */
+    size_t index_of(uint16_t seq) const;
+};
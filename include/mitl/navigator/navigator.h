@@ -8,22 +8,28 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
+
 #include "mode/mode.h"
 #include "mode/takeoff.h"
 #include "mode/hold.h"
 #include "mode/land.h"
 #include "mode/active.h"
+#include "mode/mission.h"
+#include "mode/mode_table.h"
+#include "navigator/mission_plan.h"
+#include "navigator/geofence.h"
+#include "navigator/trajectory.h"
+#include "vehicle_state.h"
+#include "estimator/land_detector.h"
+#include "seqlock.h"
 #include "morb.h"
 #include "position.h"
 
 #include <mavsdk/mavsdk.h>
 #include <mavsdk/plugins/action_server/action_server.h>
 
-/**
- * Number of modes we are using
- */
-#define MODE_ARRAY_SIZE 3
-
 /**
  * @brief Provides waypoint for navigation based on 
  * the current mode of the vehicle.
@@ -31,7 +37,7 @@
 class Navigator {
 private:
     Mode *_curr_mode{nullptr};  // pointer to the current mode
-    Mode *_modes[MODE_ARRAY_SIZE] {}; // pointer to an array of modes
+    Mode *_modes[MODE_COUNT] {}; // our modes, indexed by ModeId
 
     /// Message bus
     Morb* _morb;
@@ -41,10 +47,46 @@ private:
     Takeoff _takeoff;
     Hold _hold;
     Land _land;
+    Mission _mission;
 
     /// Position stuff
     PosSet _positions{};
     bool _position_updated{false};
+    bool _position_valid{false};
+
+    /// Last setpoint put on "position_setpoint"
+    Position _published{};
+    bool _has_published{false};
+
+    /// Latest estimator output, written by the control path
+    SeqLock<VehicleState> _state;
+
+    /// Copy of the latest state, taken by update_position()
+    VehicleState _vehicle_state{};
+
+    /// Latest land detector output, written by the control path
+    SeqLock<LandDetected> _land_detector;
+    LandDetected _land_detected{};
+
+    /// Latest uploaded mission, swapped in from the MAVLink thread
+    std::shared_ptr<const MissionPlan> _mission_plan;
+
+    /// Mission item the GCS asked to fly to, -1 if none
+    std::atomic<int32_t> _mission_jump{-1};
+
+    /// Solves the mode trajectories off the control thread
+    TrajectoryGenerator _trajectories;
+
+    /// Latest uploaded geofence, swapped in from the MAVLink thread
+    std::shared_ptr<const Geofence> _geofence;
+
+    /// Geofence check of the last run()
+    GeofenceStatus _fence_status{};
+
+    /**
+     * @brief Check the current position and velocity against the geofence
+     */
+    void check_geofence();
 
 public:
     /// Constructor and destructor
@@ -57,15 +99,109 @@ public:
 
     void run();
 
-    void update_position(const Position &pos);
+    /**
+     * @brief true if the current mode finished on the last run()
+     *
+     * The mode manager turns this into ModeEvent::MODE_COMPLETE.
+     */
+    bool mode_complete() const {return _curr_mode && _curr_mode->is_complete();}
+
+    /// How far ahead a geofence breach is predicted, s
+    static constexpr float FENCE_PREDICT_TIME = 2.0f;
+
+    /**
+     * @brief Geofence check of the last run()
+     */
+    const GeofenceStatus& fence_status() const {return _fence_status;}
+
+    /**
+     * @brief Hand a new geofence to the navigator, thread safe.
+     * @param fence built geofence, nullptr to clear
+     * @return the geofence it replaced
+     */
+    std::shared_ptr<const Geofence> set_geofence(std::shared_ptr<const Geofence> fence);
+
+    /**
+     * @brief The latest geofence, thread safe.
+     */
+    std::shared_ptr<const Geofence> geofence() const;
+
+    /**
+     * @brief Refresh the current position from the latest vehicle state
+     */
+    void update_position();
+
+    /**
+     * @brief true once the current position came from the estimator
+     */
+    bool position_valid() const {return _position_valid;}
+
+    /**
+     * @brief The state the current position was taken from
+     */
+    const VehicleState& vehicle_state() const {return _vehicle_state;}
+
+    /**
+     * @brief Land detector output as of the last run()
+     */
+    const LandDetected& land_detected() const {return _land_detected;}
+
+    /**
+     * @brief Hand a new mission to the mission mode, thread safe.
+     * @param plan parsed mission, nullptr to clear
+     * @return the mission it replaced
+     */
+    std::shared_ptr<const MissionPlan> set_mission(std::shared_ptr<const MissionPlan> plan);
+
+    /**
+     * @brief The latest mission, thread safe.
+     */
+    std::shared_ptr<const MissionPlan> mission_plan() const;
+
+    /**
+     * @brief Ask the mission to continue from an item, thread safe.
+     */
+    void set_mission_item(uint16_t seq) {_mission_jump.store(seq);}
+
+    /**
+     * @brief Take the pending mission item request.
+     * @return the item, -1 if none
+     */
+    int32_t take_mission_jump() {return _mission_jump.exchange(-1);}
 
     /**
      * @brief Getters
      */
     PosSet *get_position() {return &_positions;}
 
+    /**
+     * @brief Trajectory solver shared by the modes
+     */
+    TrajectoryGenerator& trajectories() {return _trajectories;}
+
+    /**
+     * @brief Monotonic time in s, the clock of the trajectories
+     */
+    static double now();
+
+    /**
+     * @brief Replace the clock behind now(), for tests stepping time
+     * @param clock time source in s, nullptr for the steady clock
+     */
+    static void set_clock(double (*clock)());
+
+    /**
+     * @brief Fill the target from a trajectory point
+     * @param frame frame the trajectory is in
+     * @param point position, velocity and acceleration feed-forward
+     */
+    void set_target(const LocalFrame &frame, const TrajectoryPoint &point);
+
     /**
      * @brief Notify navigator that position has been updated
+     *
+     * The setpoint is published at the end of run(), only if it
+     * differs from the one published last.
      */
     void notify_position_updated() {_position_updated = true;}
 
@@ -73,7 +209,7 @@ public:
      * @brief Update the flight mode
      * @param mode flight mode to update to
      * 
-     * Currently only supports Takeoff, Hold, and Land
+     * Currently only supports Takeoff, Hold, Mission, and Land
      */
     void set_mode(mavsdk::ActionServer::FlightMode mode);
 };
\ No newline at end of file
@@ -0,0 +1,209 @@
+/**
+ * @file trajectory.h
+ * @author Abdulelah Mulla
+ * @brief Polynomial trajectories through waypoints
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+#include "thread_factory.h"
+#include "watchdog.h"
+
+/**
+ * @brief A point on a trajectory, local NED.
+ */
+struct TrajectoryPoint {
+    float ned[3]; // m
+    float vel[3]; // m/s
+    float acc[3]; // m/s²
+};
+
+/**
+ * @brief Limits the trajectory must respect.
+ */
+struct TrajectoryLimits {
+    float max_velocity;     // m/s, norm
+    float max_acceleration; // m/s², norm
+};
+
+/**
+ * @brief Polynomial order, the value is the number of coefficients.
+ *
+ * MIN_JERK: quintic, continuous in acceleration.
+ * MIN_SNAP: septic, continuous in jerk.
+ */
+enum class TrajectoryOrder : uint8_t {
+    MIN_JERK = 6,
+    MIN_SNAP = 8
+};
+
+/**
+ * @brief Solved trajectory, one polynomial per leg and axis.
+ *
+ * Each leg is the minimum-jerk or minimum-snap polynomial between its
+ * end states. Velocities through the intermediate waypoints are chosen
+ * from the turn angle and the leg lengths, accelerations and jerks
+ * there are zero, and the last waypoint is reached at rest. Leg
+ * durations are stretched until the sampled speed and acceleration
+ * are within the limits.
+ *
+ * Immutable once solved, so it can be shared with the control thread.
+ * The segments come from MessagePools, the control thread usually
+ * drops the last reference and frees them without taking a lock.
+ */
+class Trajectory {
+public:
+    static constexpr int MAX_COEFFS = 8;
+
+    struct Segment {
+        double start;    // s from the start of the trajectory
+        double duration; // s
+        /// Coefficients in normalized time tau = (t - start) / duration
+        double coeffs[3][MAX_COEFFS];
+    };
+private:
+    std::pmr::vector<Segment> _segments;
+    TrajectoryOrder _order{TrajectoryOrder::MIN_SNAP};
+    double _duration{0};
+
+    Trajectory();
+public:
+    /**
+     * @brief Solve a trajectory. Expensive, keep it off the control thread.
+     *
+     * @param waypoints local NED positions to pass through
+     * @param count number of waypoints
+     * @param start current state of the vehicle
+     * @param limits speed and acceleration limits
+     * @param order MIN_JERK or MIN_SNAP
+     */
+    static std::shared_ptr<const Trajectory> solve(const float (*waypoints)[3], size_t count,
+                                                   const TrajectoryPoint &start,
+                                                   const TrajectoryLimits &limits,
+                                                   TrajectoryOrder order);
+
+    /// Total duration, s
+    double duration() const {return _duration;}
+
+    size_t segment_count() const {return _segments.size();}
+    const Segment& segment(size_t index) const {return _segments[index];}
+
+    /**
+     * @brief Evaluate the trajectory, O(1) for increasing times.
+     *
+     * Horner evaluation of position, velocity and acceleration. Past
+     * the end the last waypoint is held at rest.
+     *
+     * @param t s from the start of the trajectory
+     * @param hint segment found by the previous call, updated
+     * @param point filled in
+     */
+    void evaluate(double t, size_t &hint, TrajectoryPoint &point) const;
+};
+
+/// Waypoints x y z, kept alive by their owner, such as a mission plan
+using WaypointPath = std::shared_ptr<const float[][3]>;
+
+/**
+ * @brief Solves trajectories on its own thread.
+ *
+ * request() hands over the waypoints and returns at once. The result
+ * is published through an atomic shared_ptr, a newer request replaces
+ * one that was not solved yet.
+ *
+ * The waypoints are shared with their owner, not copied, so request()
+ * never allocates on the control thread, whatever the mission length.
+ */
+class TrajectoryGenerator {
+private:
+    struct Request {
+        uint32_t id{0};
+        WaypointPath waypoints;
+        size_t count{0};
+        TrajectoryPoint start{};
+        TrajectoryLimits limits{};
+        TrajectoryOrder order{TrajectoryOrder::MIN_SNAP};
+    };
+
+    /// Pending request, guarded by _mutex
+    Request _pending;
+    bool _has_pending{false};
+
+    /// Taken by the control thread in request(), watched for inversion
+    WatchedMutex _mutex;
+    std::condition_variable_any _wake;
+
+    /// Latest solution and the request it solved
+    std::shared_ptr<const Trajectory> _latest;
+    std::atomic<uint32_t> _latest_id{0};
+
+    std::atomic<uint32_t> _next_id{1};
+    std::atomic<bool> _running{true};
+    FactoryThread _worker;
+
+    void solve_loop();
+public:
+    TrajectoryGenerator();
+    ~TrajectoryGenerator();
+
+    /// Delete copy constructor and assignment operator
+    TrajectoryGenerator(const TrajectoryGenerator&) = delete;
+    TrajectoryGenerator& operator=(const TrajectoryGenerator&) = delete;
+
+    /**
+     * @brief Ask for a trajectory, does not block on the solve.
+     * @return id of the request, to match it with latest()
+     */
+    uint32_t request(WaypointPath waypoints, size_t count, const TrajectoryPoint &start,
+                     const TrajectoryLimits &limits, TrajectoryOrder order = TrajectoryOrder::MIN_SNAP);
+
+    /**
+     * @brief The latest solution, if it solved request id.
+     * @return nullptr until it is solved
+     */
+    std::shared_ptr<const Trajectory> latest(uint32_t id) const;
+};
+
+/**
+ * @brief Follows the trajectory of one request from the control thread.
+ */
+class TrajectoryTracker {
+private:
+    uint32_t _request{0};
+    std::shared_ptr<const Trajectory> _trajectory;
+    double _start_time{0};
+    size_t _hint{0};
+public:
+    /**
+     * @brief Request a new trajectory and forget the current one.
+     */
+    void start(TrajectoryGenerator &generator, WaypointPath waypoints, size_t count,
+               const TrajectoryPoint &start, const TrajectoryLimits &limits,
+               TrajectoryOrder order = TrajectoryOrder::MIN_SNAP);
+
+    /// Stop following
+    void reset();
+
+    /**
+     * @brief The setpoint at time now.
+     *
+     * The trajectory clock starts on the first tick it is available.
+     *
+     * @param now s, monotonic
+     * @return false while the trajectory is being solved
+     */
+    bool sample(const TrajectoryGenerator &generator, double now, TrajectoryPoint &point);
+
+    /// true once the end of the trajectory is reached
+    bool finished(double now) const;
+};
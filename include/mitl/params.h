@@ -0,0 +1,287 @@
+/**
+ * @file params.h
+ * @author Abdulelah Mulla
+ * @brief Parameter table and store
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+
+/**
+ * @brief Every parameter, an index into PARAM_TABLE.
+ *
+ * Keep COUNT last.
+ */
+enum class ParamId : uint16_t {
+    MIS_TAKEOFF_ALT,
+    MITL_CTRL_HZ,
+    MITL_ATT_HZ,
+    MITL_RT_CPU,
+    MITL_WD_ACTION,
+    MITL_LOG_SEG_MB,
+    MITL_LOG_SEG_S,
+    MITL_LOG_MAX_MB,
+    MITL_LOG_COLUMNS,
+    MITL_LOG_KBPS,
+    TEL_HOME_HZ,
+    TEL_SYS_HZ,
+    TEL_ATT_HZ,
+    TEL_POS_HZ,
+    TEL_NED_HZ,
+    TEL_GPS_HZ,
+    MY_PARAM,
+    COUNT
+};
+
+constexpr int PARAM_COUNT = static_cast<int>(ParamId::COUNT);
+
+enum class ParamType : uint8_t {
+    INT32,
+    FLOAT
+};
+
+/**
+ * @brief Static description of a parameter.
+ *
+ * Bounds and defaults are floats for both types, every int param
+ * fits one exactly.
+ */
+struct ParamInfo {
+    ParamId id;
+    const char *name; // at most 16 characters, as in MAVLink
+    ParamType type;
+    float default_value;
+    float min;
+    float max;
+};
+
+/// Indexed by ParamId
+constexpr ParamInfo PARAM_TABLE[PARAM_COUNT] = {
+    {ParamId::MIS_TAKEOFF_ALT, "MIS_TAKEOFF_ALT", ParamType::FLOAT, 10.f, 1.f, 100.f},  // takeoff height, m
+    {ParamId::MITL_CTRL_HZ,    "MITL_CTRL_HZ",    ParamType::INT32, 50.f, 10.f, 500.f}, // position group rate
+    {ParamId::MITL_ATT_HZ,     "MITL_ATT_HZ",     ParamType::INT32, 250.f, 10.f, 1000.f}, // attitude group rate
+    {ParamId::MITL_RT_CPU,     "MITL_RT_CPU",     ParamType::INT32, -1.f, -1.f, 1023.f}, // real-time core, -1 for none
+    {ParamId::MITL_WD_ACTION,  "MITL_WD_ACTION",  ParamType::INT32, 0.f, 0.f, 1.f},       // deadline miss, 0 report, 1 land
+    {ParamId::MITL_LOG_SEG_MB, "MITL_LOG_SEG_MB", ParamType::INT32, 64.f, 1.f, 4096.f},   // sensor log segment size
+    {ParamId::MITL_LOG_SEG_S,  "MITL_LOG_SEG_S",  ParamType::INT32, 600.f, 10.f, 86400.f}, // sensor log segment length
+    {ParamId::MITL_LOG_MAX_MB, "MITL_LOG_MAX_MB", ParamType::INT32, 2048.f, 16.f, 1e6f},   // disk kept for sensor logs
+    {ParamId::MITL_LOG_COLUMNS, "MITL_LOG_COLUMNS", ParamType::INT32, 0.f, 0.f, 1.f},     // 1: columnar sensor log
+    {ParamId::MITL_LOG_KBPS,   "MITL_LOG_KBPS",   ParamType::INT32, 2000.f, 1.f, 100000.f}, // log download, kB/s, 72 on a radio
+    {ParamId::TEL_HOME_HZ,     "TEL_HOME_HZ",     ParamType::FLOAT, 1.f, 0.f, 500.f},    // HOME_POSITION rate, 0 off
+    {ParamId::TEL_SYS_HZ,      "TEL_SYS_HZ",      ParamType::FLOAT, 1.f, 0.f, 500.f},    // SYS_STATUS rate
+    {ParamId::TEL_ATT_HZ,      "TEL_ATT_HZ",      ParamType::FLOAT, 50.f, 0.f, 500.f},   // ATTITUDE rate
+    {ParamId::TEL_POS_HZ,      "TEL_POS_HZ",      ParamType::FLOAT, 50.f, 0.f, 500.f},   // GLOBAL_POSITION_INT rate
+    {ParamId::TEL_NED_HZ,      "TEL_NED_HZ",      ParamType::FLOAT, 50.f, 0.f, 500.f},   // LOCAL_POSITION_NED rate
+    {ParamId::TEL_GPS_HZ,      "TEL_GPS_HZ",      ParamType::FLOAT, 5.f, 0.f, 500.f},    // GPS_RAW_INT rate
+    {ParamId::MY_PARAM,        "MY_PARAM",        ParamType::INT32, 1.f, -1e6f, 1e6f},
+};
+
+template<typename T> constexpr ParamType param_type();
+template<> constexpr ParamType param_type<float>() {return ParamType::FLOAT;}
+template<> constexpr ParamType param_type<int32_t>() {return ParamType::INT32;}
+
+/**
+ * @brief A parameter and its type, resolved at compile time.
+ */
+template<typename T>
+struct ParamHandle {
+    ParamId id;
+
+    constexpr int index() const {return static_cast<int>(id);}
+};
+
+/**
+ * @brief Handles for the code that reads parameters.
+ */
+namespace param {
+    constexpr ParamHandle<float> MIS_TAKEOFF_ALT{ParamId::MIS_TAKEOFF_ALT};
+    constexpr ParamHandle<int32_t> MITL_CTRL_HZ{ParamId::MITL_CTRL_HZ};
+    constexpr ParamHandle<int32_t> MITL_ATT_HZ{ParamId::MITL_ATT_HZ};
+    constexpr ParamHandle<int32_t> MITL_RT_CPU{ParamId::MITL_RT_CPU};
+    constexpr ParamHandle<int32_t> MITL_WD_ACTION{ParamId::MITL_WD_ACTION};
+    constexpr ParamHandle<int32_t> MITL_LOG_SEG_MB{ParamId::MITL_LOG_SEG_MB};
+    constexpr ParamHandle<int32_t> MITL_LOG_SEG_S{ParamId::MITL_LOG_SEG_S};
+    constexpr ParamHandle<int32_t> MITL_LOG_MAX_MB{ParamId::MITL_LOG_MAX_MB};
+    constexpr ParamHandle<int32_t> MITL_LOG_COLUMNS{ParamId::MITL_LOG_COLUMNS};
+    constexpr ParamHandle<int32_t> MITL_LOG_KBPS{ParamId::MITL_LOG_KBPS};
+    constexpr ParamHandle<float> TEL_HOME_HZ{ParamId::TEL_HOME_HZ};
+    constexpr ParamHandle<float> TEL_SYS_HZ{ParamId::TEL_SYS_HZ};
+    constexpr ParamHandle<float> TEL_ATT_HZ{ParamId::TEL_ATT_HZ};
+    constexpr ParamHandle<float> TEL_POS_HZ{ParamId::TEL_POS_HZ};
+    constexpr ParamHandle<float> TEL_NED_HZ{ParamId::TEL_NED_HZ};
+    constexpr ParamHandle<float> TEL_GPS_HZ{ParamId::TEL_GPS_HZ};
+    constexpr ParamHandle<int32_t> MY_PARAM{ParamId::MY_PARAM};
+
+    /// The handle and the table agree on the type and the position
+    template<typename T>
+    constexpr bool matches(ParamHandle<T> handle) {
+        return PARAM_TABLE[handle.index()].id == handle.id &&
+               PARAM_TABLE[handle.index()].type == param_type<T>();
+    }
+    static_assert(matches(MIS_TAKEOFF_ALT), "MIS_TAKEOFF_ALT does not match PARAM_TABLE");
+    static_assert(matches(MITL_CTRL_HZ), "MITL_CTRL_HZ does not match PARAM_TABLE");
+    static_assert(matches(MITL_ATT_HZ), "MITL_ATT_HZ does not match PARAM_TABLE");
+    static_assert(matches(MITL_RT_CPU), "MITL_RT_CPU does not match PARAM_TABLE");
+    static_assert(matches(MITL_WD_ACTION), "MITL_WD_ACTION does not match PARAM_TABLE");
+    static_assert(matches(MITL_LOG_SEG_MB), "MITL_LOG_SEG_MB does not match PARAM_TABLE");
+    static_assert(matches(MITL_LOG_SEG_S), "MITL_LOG_SEG_S does not match PARAM_TABLE");
+    static_assert(matches(MITL_LOG_MAX_MB), "MITL_LOG_MAX_MB does not match PARAM_TABLE");
+    static_assert(matches(MITL_LOG_COLUMNS), "MITL_LOG_COLUMNS does not match PARAM_TABLE");
+    static_assert(matches(MITL_LOG_KBPS), "MITL_LOG_KBPS does not match PARAM_TABLE");
+    static_assert(matches(TEL_HOME_HZ), "TEL_HOME_HZ does not match PARAM_TABLE");
+    static_assert(matches(TEL_SYS_HZ), "TEL_SYS_HZ does not match PARAM_TABLE");
+    static_assert(matches(TEL_ATT_HZ), "TEL_ATT_HZ does not match PARAM_TABLE");
+    static_assert(matches(TEL_POS_HZ), "TEL_POS_HZ does not match PARAM_TABLE");
+    static_assert(matches(TEL_NED_HZ), "TEL_NED_HZ does not match PARAM_TABLE");
+    static_assert(matches(TEL_GPS_HZ), "TEL_GPS_HZ does not match PARAM_TABLE");
+    static_assert(matches(MY_PARAM), "MY_PARAM does not match PARAM_TABLE");
+}
+
+/**
+ * @brief Published on "parameter_update" when the GCS changes a
+ * parameter.
+ */
+struct ParamUpdate {
+    uint64_t timestamp; // wall time, µs
+    ParamId id;
+};
+
+/**
+ * @brief Current value of every parameter.
+ *
+ * Values are a flat array of 32 bit words indexed by handle, so a
+ * read is one relaxed load and may happen on any thread, the control
+ * loop included. Writes are rare, they come from the GCS through the
+ * ParamServer, and are serialized by a mutex.
+ *
+ * Once open(), every write also lands in the param file, a fixed
+ * array of records mapped with mmap. Records are matched by name
+ * and type when loading, so params can be added or reordered.
+ */
+class Params {
+private:
+    /// Value bits, float or int32 by PARAM_TABLE type
+    std::atomic<uint32_t> _values[PARAM_COUNT];
+
+    /// Serializes writers and the file
+    std::mutex _mutex;
+
+    /// Mapped param file, nullptr when not persisting
+    struct FileRecord {
+        char name[16];
+        uint32_t type;
+        uint32_t value;
+    };
+    struct FileHeader {
+        uint32_t magic;
+        uint32_t count;
+    };
+    void *_map{nullptr};
+    size_t _map_size{0};
+    int _fd{-1};
+
+    static constexpr uint32_t FILE_MAGIC = 0x4d505231; // "MPR1"
+
+    /**
+     * Constructor
+     * @brief Every param at its default.
+     * Private, we are using a singleton pattern approach.
+     */
+    Params();
+
+    FileRecord* records() const;
+
+    /// Store and persist, with the mutex held
+    void store(int index, uint32_t bits);
+
+    template<typename T>
+    static uint32_t to_bits(T value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    template<typename T>
+    static T from_bits(uint32_t bits) {
+        T value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+public:
+    /**
+     * @brief Initialize a single instance of the store.
+     */
+    static Params& initialize();
+
+    /**
+     * Destructor
+     * @brief Flushes and closes the param file.
+     */
+    ~Params();
+
+    /// Delete copy constructor and assignment operator
+    Params(const Params&) = delete;
+    Params& operator=(const Params&) = delete;
+
+    /**
+     * @brief Current value, one load.
+     */
+    template<typename T>
+    T get(ParamHandle<T> handle) const {
+        return from_bits<T>(_values[handle.index()].load(std::memory_order_relaxed));
+    }
+
+    /**
+     * @brief Set a value, persisted if the file is open.
+     * @return false if out of range, the value is kept
+     */
+    template<typename T>
+    bool set(ParamHandle<T> handle, T value) {
+        return set(handle.id, static_cast<float>(value));
+    }
+
+    /**
+     * @brief Set any param from a float, rounded for int params.
+     * @return false if out of range, the value is kept
+     */
+    bool set(ParamId id, float value);
+
+    /**
+     * @brief Current value of any param as a float.
+     */
+    float value(ParamId id) const;
+
+    /**
+     * @brief Find a param by name.
+     * @return false if there is none
+     */
+    static bool find(const char *name, ParamId &id);
+
+    /**
+     * @brief Restore every default, persisted if the file is open.
+     */
+    void reset();
+
+    /**
+     * @brief Load the param file and keep it mapped for writes.
+     *
+     * The file is created if missing, and rewritten with the current
+     * table. Records that are unknown, mistyped or out of range are
+     * dropped.
+     *
+     * @return false if the file could not be opened or mapped
+     */
+    bool open(const std::string &path);
+
+    /**
+     * @brief Flush and unmap the param file, values are kept.
+     */
+    void close();
+};
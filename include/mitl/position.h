@@ -12,11 +12,14 @@
 struct Position {
     double lat;
     double lon;
-    float alt;
-    float yaw;
+    double alt; // AMSL, m
+    float yaw; // deg
     float vx;
     float vy;
     float vz;
+    float ax; // acceleration feed-forward, NED m/s²
+    float ay;
+    float az;
 };
 
 /**
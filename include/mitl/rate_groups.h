@@ -0,0 +1,188 @@
+/**
+ * @file rate_groups.h
+ * @author Abdulelah Mulla
+ * @brief Multi-rate scheduling of the control loops
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+#include "watchdog.h"
+
+class Morb;
+class Watchdog;
+
+/**
+ * @brief The control loops, fastest first.
+ *
+ * Keep COUNT last.
+ */
+enum class RateGroup : uint8_t {
+    RATE,     // body rates, on every IMU sample
+    ATTITUDE, // attitude, MITL_ATT_HZ
+    POSITION, // navigator and modes, MITL_CTRL_HZ
+    COUNT
+};
+
+constexpr int RATE_GROUP_COUNT = static_cast<int>(RateGroup::COUNT);
+
+/**
+ * @brief Timing of one group over the last report.
+ */
+struct RateGroupStats {
+    uint64_t cycles;         // since start
+    uint64_t overruns;       // triggers dropped, the group was still busy
+    uint32_t max_run_us;     // longest cycle
+    uint32_t max_latency_us; // longest trigger to start
+    uint16_t divider;        // IMU samples per cycle
+};
+
+/**
+ * @brief Published on "rate_group_stats" once a second.
+ */
+struct RateGroupReport {
+    uint64_t timestamp; // IMU time, µs
+    float imu_rate_hz;  // measured
+    RateGroupStats groups[RATE_GROUP_COUNT];
+};
+
+/**
+ * @brief Triggers the control loops off the IMU.
+ *
+ * Every group runs on its own thread, owned by its module, that waits
+ * for a trigger. tick() counts IMU samples and triggers a group every
+ * divider samples, the divider being the measured IMU rate over the
+ * group's rate param. The rate loop is triggered on every sample, and
+ * the slower loops run on integer sub-multiples of it, in phase.
+ *
+ * The group threads take their SCHED_FIFO priorities from
+ * THREAD_TABLE, faster groups higher, so the inner loops are never
+ * delayed by the navigator. tick() leaves the calling thread alone,
+ * it is gz-transport's, which runs every gz callback, so it keeps its
+ * default policy and stays off the real-time core.
+ *
+ * A trigger that finds its group still busy is dropped and counted
+ * as an overrun, triggers never queue up.
+ */
+class RateGroups {
+private:
+    struct Group {
+        /// Trigger, one waiter per group
+        WatchedMutex mutex;
+        std::condition_variable_any condition;
+        bool triggered{false};
+        std::atomic<bool> busy{false};
+        std::atomic<uint64_t> trigger_ns{0};
+
+        /// IMU samples until the next trigger, IMU thread only
+        int countdown{0};
+
+        /// Stats, windows reset on every report
+        std::atomic<uint64_t> cycles{0};
+        std::atomic<uint64_t> overruns{0};
+        std::atomic<uint32_t> max_run_us{0};
+        std::atomic<uint32_t> max_latency_us{0};
+        std::atomic<uint16_t> divider{1};
+    };
+    Group _groups[RATE_GROUP_COUNT];
+
+    /// IMU rate, IMU thread only
+    uint64_t _last_tick_us{0};
+    float _imu_dt_us{0};
+
+    /// Wall time of the last tick, ns
+    std::atomic<uint64_t> _last_tick_ns{0};
+
+    /// Cycles are heartbeats
+    Watchdog &_watchdog;
+
+    /// Longest rate loop cycle before the watchdog steps in
+    static constexpr std::chrono::microseconds RATE_DEADLINE{10000};
+
+    /// Stats reports, IMU thread only
+    Morb *_morb{nullptr};
+    uint64_t _last_report_us{0};
+
+    /// EWMA weight of the IMU period
+    static constexpr float IMU_ALPHA = 0.05f;
+
+    /// Without a tick for this long the groups fall back to their timers, ns
+    static constexpr uint64_t TICK_TIMEOUT = 100000000;
+
+    static constexpr uint64_t REPORT_INTERVAL = 1000000;
+
+    /// Constructor
+    RateGroups();
+
+    /**
+     * @brief Trigger a group, or count an overrun if it is busy.
+     */
+    void trigger(Group &group, uint64_t now_ns);
+
+    void report(uint64_t timestamp);
+public:
+    /// Delete copy constructor and assignment operator
+    RateGroups(const RateGroups&) = delete;
+    RateGroups& operator=(const RateGroups&) = delete;
+
+    /**
+     * Singleton approach to give global access to this class.
+     */
+    static RateGroups& initialize();
+
+    /**
+     * @brief Drive the groups from "vehicle_state", one per IMU sample,
+     * and publish "rate_group_stats".
+     *
+     * Subscribe after the controller so the rate loop wakes to the
+     * sample that triggered it.
+     */
+    void attach(Morb *morb);
+
+    /**
+     * @brief Stop publishing stats, before the bus goes away.
+     */
+    void detach();
+
+    /**
+     * @brief One IMU sample, triggers the groups that are due.
+     * @param timestamp_us sample time
+     */
+    void tick(uint64_t timestamp_us);
+
+    /**
+     * @brief true while IMU samples are arriving.
+     */
+    bool ticking() const;
+
+    /**
+     * @brief Block until the group is triggered.
+     * @return false on timeout
+     */
+    bool wait(RateGroup group, std::chrono::microseconds timeout);
+
+    /**
+     * @brief Mark the start and end of a cycle, for the stats and
+     * as heartbeats of the group's thread.
+     * @return start time to pass to end(), ns
+     */
+    uint64_t begin(RateGroup group);
+    void end(RateGroup group, uint64_t start_ns);
+
+    /**
+     * @brief Current stats of a group.
+     */
+    RateGroupStats stats(RateGroup group) const;
+
+    /**
+     * @brief Monotonic time, ns.
+     */
+    static uint64_t now_ns();
+};
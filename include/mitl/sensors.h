@@ -0,0 +1,66 @@
+/**
+ * @file sensors.h
+ * @author Abdulelah Mulla
+ * @date 10/18/2026
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "trace.h"
+
+/**
+ * Sensor samples published on Morb by GazeboState.
+ *
+ * Timestamps are sim time in µs, vectors are in the body FRD
+ * or the local NED frame, as PX4 does.
+ */
+
+/**
+ * @brief Published on "sensor_imu".
+ */
+struct SensorImu {
+    uint64_t timestamp;
+    float accel[3]; // specific force, m/s²
+    float gyro[3];  // rad/s
+    TraceContext trace;
+};
+
+/**
+ * @brief Published on "sensor_odometry", Gazebo ground truth.
+ */
+struct SensorOdometry {
+    uint64_t timestamp;
+    float position[3]; // local NED, m
+    float velocity[3]; // local NED, m/s
+    float q[4];        // body FRD to NED, w x y z
+    float rates[3];    // body FRD, rad/s
+};
+
+/**
+ * @brief Published on "sensor_gps".
+ */
+struct SensorGps {
+    uint64_t timestamp;
+    double lat;
+    double lon;
+    double alt;        // AMSL, m
+    float velocity[3]; // NED, m/s
+};
+
+/**
+ * @brief Published on "sensor_baro".
+ */
+struct SensorBaro {
+    uint64_t timestamp;
+    float pressure_pa;
+};
+
+/**
+ * @brief Published on "sensor_mag".
+ */
+struct SensorMag {
+    uint64_t timestamp;
+    float field[3]; // body FRD, gauss
+};
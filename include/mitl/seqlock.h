@@ -0,0 +1,57 @@
+/**
+ * @file seqlock.h
+ * @author Abdulelah Mulla
+ * @date 10/18/2026
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief Latest value of T shared between threads without locking.
+ *
+ * One writer, any number of readers. The writer never waits, readers
+ * retry if the value changed while they were copying it.
+ * T must be trivially copyable.
+ */
+template<typename T>
+class SeqLock {
+private:
+    std::atomic<uint32_t> _seq{0};
+    T _value{};
+public:
+    /**
+     * @brief Store a new value. Only one thread may store.
+     */
+    void store(const T &value) {
+        const uint32_t seq = _seq.load(std::memory_order_relaxed);
+        _seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        _value = value;
+        _seq.store(seq + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Copy out the latest value.
+     */
+    T load() const {
+        T value;
+        uint32_t before, after;
+        do {
+            before = _seq.load(std::memory_order_acquire);
+            value = _value;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = _seq.load(std::memory_order_relaxed);
+        } while ((before & 1) || before != after);
+        return value;
+    }
+
+    /**
+     * @brief Number of stores so far, 0 if never written.
+     */
+    uint32_t generation() const {
+        return _seq.load(std::memory_order_acquire) / 2;
+    }
+};
@@ -0,0 +1,96 @@
+/**
+ * @file fence_server.h
+ * @author Abdulelah Mulla
+ * @brief MAVLink mission protocol server for geofence items
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include <mavsdk/plugins/mavlink_direct/mavlink_direct.h>
+#include <mavsdk/plugins/mission_raw_server/mission_raw_server.h>
+
+/**
+ * @brief Receives and serves the geofence with the mission protocol.
+ *
+ * MissionRawServer only handles MAV_MISSION_TYPE_MISSION, so the
+ * fence transfers (mission_type 1) are handled here on MavlinkDirect:
+ * upload (MISSION_COUNT, MISSION_REQUEST_INT, MISSION_ITEM_INT,
+ * MISSION_ACK), download (MISSION_REQUEST_LIST) and MISSION_CLEAR_ALL.
+ * Messages of the other mission types are left alone.
+ *
+ * Once every item is in, the fence callback decides whether the
+ * upload is accepted.
+ */
+class FenceServer {
+public:
+    /// Build the fence from the items, false to refuse them
+    using FenceCallback = std::function<bool(const std::vector<mavsdk::MissionRawServer::MissionItem>&)>;
+private:
+    /// MAV_MISSION_TYPE_FENCE
+    static constexpr uint32_t MISSION_TYPE_FENCE = 1;
+
+    /// Link to the GCS
+    mavsdk::MavlinkDirect &_mavdirect;
+
+    FenceCallback _on_fence;
+
+    /// Items of the upload in progress, guarded by _mutex
+    std::vector<mavsdk::MissionRawServer::MissionItem> _incoming;
+    uint32_t _expected{0};
+    bool _uploading{false};
+
+    /// Items of the accepted fence, served on download
+    std::vector<mavsdk::MissionRawServer::MissionItem> _items;
+
+    std::mutex _mutex;
+
+    bool _subscribed{false};
+    mavsdk::MavlinkDirect::MessageHandle _count_handle{};
+    mavsdk::MavlinkDirect::MessageHandle _item_handle{};
+    mavsdk::MavlinkDirect::MessageHandle _request_list_handle{};
+    mavsdk::MavlinkDirect::MessageHandle _request_handle{};
+    mavsdk::MavlinkDirect::MessageHandle _clear_handle{};
+
+    void on_count(const mavsdk::MavlinkDirect::MavlinkMessage &message);
+    void on_item(const mavsdk::MavlinkDirect::MavlinkMessage &message);
+    void on_request_list(const mavsdk::MavlinkDirect::MavlinkMessage &message);
+    void on_request(const mavsdk::MavlinkDirect::MavlinkMessage &message);
+    void on_clear_all(const mavsdk::MavlinkDirect::MavlinkMessage &message);
+
+    /// true if the message is about the fence
+    static bool is_fence(const mavsdk::MavlinkDirect::MavlinkMessage &message);
+
+    void send_request(uint32_t seq, const mavsdk::MavlinkDirect::MavlinkMessage &to);
+    void send_ack(uint32_t result, const mavsdk::MavlinkDirect::MavlinkMessage &to);
+public:
+    /**
+     * Constructor
+     *
+     * @param mavdirect link to the GCS
+     * @param on_fence called with the uploaded items, from the MAVSDK thread
+     */
+    FenceServer(mavsdk::MavlinkDirect &mavdirect, FenceCallback on_fence);
+
+    /// Destructor, stops the server
+    ~FenceServer();
+
+    /// Delete copy constructor and assignment operator
+    FenceServer(const FenceServer&) = delete;
+    FenceServer& operator=(const FenceServer&) = delete;
+
+    /**
+     * @brief Subscribe to the mission protocol messages.
+     */
+    void start();
+
+    /**
+     * @brief Unsubscribe.
+     */
+    void stop();
+};
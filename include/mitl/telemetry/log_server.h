@@ -0,0 +1,111 @@
+/**
+ * @file log_server.h
+ * @author Abdulelah Mulla
+ * @brief MAVLink log download (LOG_REQUEST_*) server
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "telemetry/log_store.h"
+#include "thread_factory.h"
+
+#include <mavsdk/plugins/mavlink_direct/mavlink_direct.h>
+
+/**
+ * @brief Serves the log files to a GCS with the MAVLink log protocol.
+ *
+ * LOG_REQUEST_LIST is answered with one LOG_ENTRY per log.
+ * LOG_REQUEST_DATA starts a transfer of LOG_DATA packets from the
+ * mmap'd file, sent every tick by a dedicated thread so neither the
+ * MAVSDK receive thread nor the control loop wait on it. The rate is
+ * MITL_LOG_KBPS, read every tick: the default suits UDP and SITL, 72
+ * leaves room for telemetry on a radio link.
+ * A new LOG_REQUEST_DATA replaces the running transfer, which is how the
+ * GCS asks again for the chunks it missed. LOG_REQUEST_END stops it.
+ */
+class LogServer {
+private:
+    /// Payload bytes in a LOG_DATA
+    static constexpr uint32_t LOG_DATA_LENGTH = 90;
+
+    /// Send period, the rate is spread over it
+    static constexpr int TICK_US = 10000;
+
+    /// Link to the GCS
+    mavsdk::MavlinkDirect &_mavdirect;
+
+    /// The logs, guarded by _mutex
+    LogStore _store;
+
+    /// Current transfer, guarded by _mutex
+    struct Transfer {
+        bool active = false;
+        uint16_t id = 0;
+        uint32_t offset = 0; // next byte to send
+        uint32_t end = 0;    // one past the last byte requested
+        uint32_t target_system = 0;
+        uint32_t target_component = 0;
+    } _transfer;
+
+    std::mutex _mutex;
+    std::condition_variable _wake;
+
+    std::atomic<bool> _running{false};
+    FactoryThread _sender;
+
+    mavsdk::MavlinkDirect::MessageHandle _list_handle{};
+    mavsdk::MavlinkDirect::MessageHandle _data_handle{};
+    mavsdk::MavlinkDirect::MessageHandle _end_handle{};
+
+    /// Reused for every LOG_DATA, sender thread only
+    std::string _fields;
+
+    void on_request_list(const mavsdk::MavlinkDirect::MavlinkMessage &message);
+    void on_request_data(const mavsdk::MavlinkDirect::MavlinkMessage &message);
+    void on_request_end(const mavsdk::MavlinkDirect::MavlinkMessage &message);
+
+    /**
+     * @brief Sender thread, runs the transfer a tick at a time.
+     */
+    void send_loop();
+
+    /**
+     * @brief Send one LOG_DATA, _mutex must be held.
+     * @return bytes sent, 0 marks the end of the log
+     */
+    uint32_t send_data(uint16_t id, uint32_t offset, uint32_t count);
+public:
+    /**
+     * Constructor
+     *
+     * @param mavdirect link to the GCS
+     * @param directory where the logs are
+     */
+    LogServer(mavsdk::MavlinkDirect &mavdirect, std::string directory);
+
+    /// Destructor, stops the server
+    ~LogServer();
+
+    /// Delete copy constructor and assignment operator
+    LogServer(const LogServer&) = delete;
+    LogServer& operator=(const LogServer&) = delete;
+
+    /**
+     * @brief Subscribe to the log requests and start the sender thread.
+     */
+    void start();
+
+    /**
+     * @brief Unsubscribe and join the sender thread.
+     */
+    void stop();
+};
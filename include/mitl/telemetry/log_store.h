@@ -0,0 +1,123 @@
+/**
+ * @file log_store.h
+ * @author Abdulelah Mulla
+ * @brief Log files offered for download, read through mmap
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Read-only memory mapping of a whole file.
+ *
+ * Move only, unmapped on destruction.
+ */
+class MappedFile {
+private:
+    const uint8_t *_data = nullptr;
+    size_t _size = 0;
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile& operator=(MappedFile &&other) noexcept;
+
+    /**
+     * @brief Map the file as it is now, later appends are not visible.
+     * @return true if mapped, an empty file maps to nothing but succeeds
+     */
+    bool open(const std::string &path);
+
+    /// Unmap the file
+    void close();
+
+    const uint8_t* data() const {return _data;}
+    size_t size() const {return _size;}
+};
+
+/**
+ * @brief A log as listed to the GCS.
+ */
+struct LogEntry {
+    uint16_t id;        // MAVLink log id, from 1
+    std::string path;
+    uint32_t size;      // bytes, at the time of listing
+    uint32_t time_utc;  // last modification, s since epoch
+};
+
+/**
+ * @brief The set of log files in a directory that may be downloaded.
+ *
+ * Ids are assigned oldest first on refresh(), so they stay stable as
+ * long as no older log is deleted. One file is mapped at a time, the
+ * one being downloaded.
+ */
+class LogStore {
+private:
+    /// Where the logs are
+    std::string _directory;
+
+    /// File name prefixes of the logs to offer
+    std::vector<std::string> _prefixes;
+
+    /// Listed logs, index id - 1
+    std::vector<LogEntry> _entries;
+
+    /// Log being read and its mapping
+    uint16_t _mapped_id = 0;
+    MappedFile _mapped;
+public:
+    /**
+     * Constructor
+     *
+     * @param directory directory to look in
+     * @param prefixes only files named one of these, or segments of one,
+     *        starting with it and ending in .mlog, are offered
+     */
+    LogStore(std::string directory, std::vector<std::string> prefixes);
+
+    /**
+     * @brief Rescan the directory.
+     * @return number of logs
+     */
+    size_t refresh();
+
+    /**
+     * @brief Logs found by the last refresh().
+     */
+    const std::vector<LogEntry>& entries() const {return _entries;}
+
+    /**
+     * @brief Zero-copy read of part of a log.
+     *
+     * Maps the log if it is not the one mapped already. The file is
+     * mapped at its current size, bytes appended later are not read.
+     *
+     * @param id log id
+     * @param offset byte offset
+     * @param count bytes wanted
+     * @param data set to the bytes in the mapping, valid until the
+     *        next read() of another log or close()
+     * @return bytes available at data, 0 at or past the end
+     */
+    size_t read(uint16_t id, uint32_t offset, uint32_t count, const uint8_t *&data);
+
+    /**
+     * @brief Size of the mapped log, 0 if none.
+     */
+    size_t mapped_size() const {return _mapped.size();}
+
+    /**
+     * @brief Unmap the current log.
+     */
+    void close();
+};
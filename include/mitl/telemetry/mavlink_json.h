@@ -0,0 +1,23 @@
+/**
+ * @file mavlink_json.h
+ * @author Abdulelah Mulla
+ * @brief Helpers for the fields_json of MavlinkDirect messages
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <string>
+
+/**
+ * @brief Read a number field out of a MavlinkDirect fields_json.
+ *
+ * The json is flat and generated by MAVSDK, so a key lookup is enough.
+ *
+ * @param json fields_json of a received message
+ * @param key field name
+ * @param value set to the field value if found
+ * @return true if the field was found
+ */
+bool json_number(const std::string &json, const char *key, double &value);
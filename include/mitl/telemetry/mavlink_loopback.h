@@ -0,0 +1,68 @@
+/**
+ * @file mavlink_loopback.h
+ * @author Abdulelah Mulla
+ * @brief In-process MAVLink link between two MAVSDK instances
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <mavsdk/mavsdk.h>
+
+/**
+ * @brief Carries the MAVLink bytes of two MAVSDK instances to each other.
+ *
+ * Both instances connect with "raw://", so there is no socket and no
+ * port: any number of pairs can run at once, in the same process.
+ * Bytes are handed over on a thread of the link, in the order they
+ * were sent, as a UDP receive thread would; MAVSDK may reply from
+ * inside a receive, which must not run on the sender's thread.
+ *
+ * Bytes sent before the other side added its raw connection are lost,
+ * like datagrams to a closed port. Both instances must outlive the link.
+ */
+class MavlinkLoopback {
+private:
+    struct Chunk {
+        bool to_second;
+        std::string bytes;
+    };
+
+    mavsdk::Mavsdk &_first;
+    mavsdk::Mavsdk &_second;
+    mavsdk::Mavsdk::RawBytesHandle _first_handle{};
+    mavsdk::Mavsdk::RawBytesHandle _second_handle{};
+
+    /// Bytes in flight, guarded by _mutex
+    std::deque<Chunk> _queue;
+    bool _running{true};
+    std::mutex _mutex;
+    std::condition_variable _pending;
+
+    /// Stands in for the MAVSDK I/O threads, which are not ours either
+    std::thread _thread;
+
+    void send(bool to_second, const char *bytes, size_t length);
+    void deliver();
+public:
+    /**
+     * Constructor
+     *
+     * @brief Starts carrying bytes between the two instances
+     */
+    MavlinkLoopback(mavsdk::Mavsdk &first, mavsdk::Mavsdk &second);
+
+    /// Destructor, drops the bytes still in flight
+    ~MavlinkLoopback();
+
+    /// Delete copy constructor and assignment operator
+    MavlinkLoopback(const MavlinkLoopback&) = delete;
+    MavlinkLoopback& operator=(const MavlinkLoopback&) = delete;
+};
@@ -0,0 +1,126 @@
+/**
+ * @file telemetry_streams.h
+ * @author Abdulelah Mulla
+ * @brief Per-message MAVLink telemetry stream rates and scheduling
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "params.h"
+
+/**
+ * @brief The telemetry messages we stream to the GCS.
+ *
+ * Used as an index into the stream table, keep COUNT last.
+ */
+enum class TelemetryStream : uint8_t {
+    HOME,
+    SYS_STATUS,
+    ATTITUDE,
+    POSITION,
+    POSITION_NED,
+    RAW_GPS,
+    COUNT
+};
+
+constexpr int TELEMETRY_STREAM_COUNT = static_cast<int>(TelemetryStream::COUNT);
+
+/**
+ * @brief Static description of a stream.
+ */
+struct StreamInfo {
+    TelemetryStream stream;
+    uint32_t msg_id;          // MAVLink message id
+    ParamId param;            // rate param, in Hz, its default is the stream's
+};
+
+/**
+ * @brief Table of stream intervals and the scheduler that runs them.
+ *
+ * Intervals may be changed from any thread (SET_MESSAGE_INTERVAL,
+ * param changes), they are atomics. Scheduling state is only touched
+ * by the telemetry thread through due(). The rates are the TEL_*_HZ
+ * params, which the owner keeps in step, streams start at their
+ * defaults.
+ *
+ * An interval of 0 or less disables the stream, as in MAVLink.
+ */
+class TelemetryStreams {
+private:
+    /// Current interval of each stream, µs
+    std::atomic<int64_t> _interval_us[TELEMETRY_STREAM_COUNT];
+
+    /// Next time each stream is due, µs, telemetry thread only
+    uint64_t _next_us[TELEMETRY_STREAM_COUNT]{};
+
+public:
+    /// Shortest interval accepted, 500 Hz
+    static constexpr int64_t MIN_INTERVAL_US = 2000;
+
+    /// Longest the telemetry thread sleeps, so rate changes apply quickly
+    static constexpr uint64_t MAX_SLEEP_US = 100000;
+
+    /// Constructor, every stream at its default interval
+    TelemetryStreams();
+
+    /// Delete copy constructor and assignment operator
+    TelemetryStreams(const TelemetryStreams&) = delete;
+    TelemetryStreams& operator=(const TelemetryStreams&) = delete;
+
+    /**
+     * @brief Static info of every stream, indexed by TelemetryStream.
+     */
+    static const StreamInfo* table();
+
+    /**
+     * @brief Find the stream sending a MAVLink message.
+     * @return true if the message is one of ours
+     */
+    static bool find(uint32_t msg_id, TelemetryStream &stream);
+
+    /**
+     * @brief Find the stream configured by a param.
+     * @return true if the param is a stream rate
+     */
+    static bool find(ParamId param, TelemetryStream &stream);
+
+    /**
+     * @brief Interval of a rate, as set_rate() would store it, -1 if disabled.
+     */
+    static int64_t rate_interval(float rate_hz);
+
+    /**
+     * @brief Set the interval of a stream.
+     *
+     * Follows SET_MESSAGE_INTERVAL: -1 disables, 0 restores the default.
+     * Intervals are clamped to MIN_INTERVAL_US.
+     */
+    void set_interval(TelemetryStream stream, int64_t interval_us);
+
+    /**
+     * @brief Set the rate of a stream in Hz, 0 disables.
+     */
+    void set_rate(TelemetryStream stream, float rate_hz);
+
+    /**
+     * @brief Current interval of a stream, -1 if disabled.
+     */
+    int64_t interval(TelemetryStream stream) const;
+
+    /**
+     * @brief Streams due at now_us, and schedule their next deadline.
+     *
+     * Deadlines advance by whole intervals so rates do not drift. If
+     * the thread fell behind, missed sends are dropped, not bunched.
+     *
+     * @param now_us monotonic time
+     * @param next_us set to the next time any stream is due
+     * @return bitmask of due streams, bit i is TelemetryStream i
+     */
+    uint32_t due(uint64_t now_us, uint64_t &next_us);
+};
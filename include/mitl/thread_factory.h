@@ -2,34 +2,193 @@
  * @file thread_factory.h
  * @author Abdulelah Mulla
  * @brief Factory class to manage starting threads.
- * @version 0.1
- * @date 2025-12-29
+ * @version 0.2
+ * @date 2026-10-18
  */
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
 #include <string>
 
-#include "morb.h"
-#include "scheduler.h"
-#include "mavlink_interface.h"
-#include "gazebo/gazebo_state.h"
+#include <pthread.h>
+#include <sched.h>
+
+/**
+ * @brief Every thread MITL runs, an index into THREAD_TABLE.
+ *
+ * Keep COUNT last.
+ */
+enum class MitlThread : uint8_t {
+    RATE,       // rate loop, woken by every IMU sample
+    ATTITUDE,   // attitude loop
+    CONTROL,    // mode manager and navigator
+    TRAJECTORY, // trajectory solver
+    HEALTH,     // health checks
+    VEHICLE,    // MAVLink telemetry
+    LOG_SERVER, // log downloads
+    WATCHDOG,   // deadline monitor
+    LOGGER,     // sensor log writer
+    COUNT
+};
+
+constexpr int MITL_THREAD_COUNT = static_cast<int>(MitlThread::COUNT);
+
+/**
+ * @brief Where a thread may run, MITL_RT_CPU picks the real-time core.
+ */
+enum class ThreadCpus : uint8_t {
+    ANY,     // wherever the scheduler likes
+    RT_CORE, // on the real-time core only
+    NON_RT   // anywhere but the real-time core
+};
+
+/**
+ * @brief Static description of a thread.
+ */
+struct ThreadSpec {
+    MitlThread id;
+    const char *name; // at most 15 characters, shows in top and gdb
+    int policy;       // SCHED_FIFO or SCHED_OTHER
+    int priority;     // SCHED_FIFO only
+    ThreadCpus cpus;
+    size_t stack_size;
+    int start_order;  // lowest first, stopped in reverse
+};
+
+/// Indexed by MitlThread
+constexpr ThreadSpec THREAD_TABLE[MITL_THREAD_COUNT] = {
+    {MitlThread::RATE,       "mitl_rate",     SCHED_FIFO,  80, ThreadCpus::RT_CORE, 256 * 1024, 0},
+    {MitlThread::ATTITUDE,   "mitl_attitude", SCHED_FIFO,  70, ThreadCpus::RT_CORE, 256 * 1024, 1},
+    {MitlThread::CONTROL,    "mitl_control",  SCHED_FIFO,  60, ThreadCpus::RT_CORE, 512 * 1024, 2},
+    {MitlThread::TRAJECTORY, "mitl_traj",     SCHED_OTHER, 0,  ThreadCpus::NON_RT,  512 * 1024, 3},
+    {MitlThread::HEALTH,     "mitl_health",   SCHED_OTHER, 0,  ThreadCpus::NON_RT,  128 * 1024, 4},
+    {MitlThread::VEHICLE,    "mitl_vehicle",  SCHED_OTHER, 0,  ThreadCpus::NON_RT,  256 * 1024, 5},
+    {MitlThread::LOG_SERVER, "mitl_logs",     SCHED_OTHER, 0,  ThreadCpus::NON_RT,  256 * 1024, 6},
+    {MitlThread::WATCHDOG,   "mitl_watchdog", SCHED_FIFO,  90, ThreadCpus::NON_RT,  128 * 1024, 7},
+    {MitlThread::LOGGER,     "mitl_log",      SCHED_OTHER, 0,  ThreadCpus::NON_RT,  256 * 1024, 8},
+};
+
+/**
+ * @brief A thread started by the factory, joined like a std::thread.
+ *
+ * Owns its stack, which is released on join.
+ */
+class FactoryThread {
+private:
+    pthread_t _thread{};
+    bool _joinable{false};
+    void *_stack{nullptr};
+    size_t _stack_size{0};
+
+    friend class ThreadFactory;
+public:
+    FactoryThread() = default;
+    ~FactoryThread();
+
+    FactoryThread(FactoryThread &&other) noexcept;
+    FactoryThread& operator=(FactoryThread &&other) noexcept;
+
+    /// Disable copy constructor and assignment operator
+    FactoryThread(const FactoryThread&) = delete;
+    FactoryThread& operator=(const FactoryThread&) = delete;
+
+    bool joinable() const {return _joinable;}
+    void join();
+};
 
 /**
  * This class is used to start threads in one place,
  * for simplicity and ensuring threads are started in
  * the correct order.
+ *
+ * Every thread is described by THREAD_TABLE. Modules start their
+ * threads through spawn(), which creates them with the policy,
+ * priority, CPU set and stack of their entry. Stacks are mapped and
+ * locked in memory so the loops never page fault on them. If the
+ * process may not use real-time priorities, or lock memory, the
+ * thread still starts without them and this is logged once.
+ *
+ * Modules register their start and stop with add(). start() runs them
+ * in start_order and stop() in reverse, so consumers stop before
+ * the threads that feed them.
+ *
+ * With MITL_RT_CPU set, RT_CORE threads run on that core only, and
+ * isolate() keeps the main thread, and every thread created after it
+ * such as the MAVSDK and gz-transport ones, off it.
  */
 class ThreadFactory {
 private:
-    Morb& _morb;
-    std::string _world_name;
-    std::string _vehicle_name;
-public:
+    struct Hooks {
+        std::function<void()> start;
+        std::function<void()> stop;
+        bool started{false};
+    };
+    Hooks _hooks[MITL_THREAD_COUNT];
+    std::mutex _mutex;
+
+    bool _priority_logged{false};
+    bool _lock_logged{false};
+
     /// Constructor
     ThreadFactory();
+
+    /**
+     * @brief The CPUs a thread may run on.
+     * @return false to leave the affinity alone
+     */
+    static bool cpu_set(ThreadCpus cpus, cpu_set_t &set);
+
+    void log_once(bool &logged, const std::string &msg);
+public:
+    /// Delete copy constructor and assignment operator
+    ThreadFactory(const ThreadFactory&) = delete;
+    ThreadFactory& operator=(const ThreadFactory&) = delete;
+
+    /**
+     * Singleton approach to give global access to this class.
+     */
+    static ThreadFactory& initialize();
+
+    /**
+     * @brief Start a thread as described in THREAD_TABLE.
+     */
+    FactoryThread spawn(MitlThread id, std::function<void()> body);
+
+    /**
+     * @brief Apply a table entry to the calling thread, for threads
+     * we do not create.
+     * @return false if the priority could not be set
+     */
+    bool adopt(MitlThread id);
+
+    /**
+     * @brief Table entry of the calling thread.
+     * @return COUNT if it was neither spawned nor adopted
+     */
+    static MitlThread current();
+
+    /**
+     * @brief Keep the calling thread, and the threads it creates, off
+     * the real-time core. Call first thing in main.
+     */
+    void isolate();
+
+    /**
+     * @brief Register how a module starts and stops its thread.
+     */
+    void add(MitlThread id, std::function<void()> start, std::function<void()> stop);
+
     /**
      * @brief Initialize all threads
      */
     void start();
-};
\ No newline at end of file
+
+    /**
+     * @brief Stop every started thread, in reverse start order.
+     */
+    void stop();
+};
@@ -0,0 +1,132 @@
+/**
+ * @file trace.h
+ * @author Abdulelah Mulla
+ * @brief Sensor to actuator latency tracing
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Stages a sample goes through from sensor to motor.
+ *
+ * TRANSPORT covers the gazebo callback up to the bus publish,
+ * BUS the Morb hop into the estimator, and the rest the stage
+ * named, each one measured from the end of the previous stage.
+ * END_TO_END spans from the gazebo callback to the motor publish.
+ */
+enum class TraceStage : uint8_t {
+    TRANSPORT,
+    BUS,
+    ESTIMATOR,
+    CONTROLLER,
+    MIXER,
+    PUBLISH,
+    END_TO_END,
+    COUNT
+};
+
+/**
+ * @brief Travels with a message across Morb.
+ *
+ * An id of 0 means the message is not traced.
+ */
+struct TraceContext {
+    uint32_t id;
+    uint64_t origin_ns; // when the sample entered mitl
+    uint64_t last_ns;   // when the previous stage ended
+};
+
+/**
+ * @brief Lock-free buffer of trace events.
+ *
+ * Writers claim a slot with a single fetch_add and publish it with a
+ * per slot sequence number, so any thread can record without locking.
+ * The buffer is a ring, once full the oldest events are overwritten.
+ *
+ * Events are exported in the Chrome trace event format, which can be
+ * opened in chrome://tracing or ui.perfetto.dev.
+ */
+class Trace {
+private:
+    struct Event {
+        std::atomic<uint64_t> seq{0}; // odd while being written
+        std::atomic<uint32_t> id{0};
+        std::atomic<uint32_t> thread{0};
+        std::atomic<uint8_t> stage{0};
+        std::atomic<uint64_t> start_ns{0};
+        std::atomic<uint64_t> end_ns{0};
+    };
+
+    /// Must be a power of 2
+    static constexpr size_t CAPACITY = 1 << 16;
+
+    Event _events[CAPACITY];
+
+    /// Next slot to write
+    std::atomic<uint64_t> _head{0};
+
+    /// Next trace id to hand out
+    std::atomic<uint32_t> _next_id{1};
+
+    std::atomic<bool> _enabled{true};
+
+    /// Constructor
+    Trace();
+public:
+    /// Delete copy constructor and assignment operator
+    Trace(const Trace&) = delete;
+    Trace operator=(const Trace&) = delete;
+
+    /**
+     * Singleton approach to give global access to this class.
+     */
+    static Trace& initialize();
+
+    /**
+     * @brief Monotonic wall time in ns, the time base of all events.
+     */
+    static uint64_t now_ns();
+
+    /**
+     * @brief Start tracing a new sample.
+     * @return context to attach to the message, id 0 if disabled
+     */
+    TraceContext begin();
+
+    /**
+     * @brief Record the stage that just ended and advance the context.
+     * @param ctx context carried by the message, last_ns is set to now
+     * @param stage the stage that ended
+     */
+    void stage(TraceContext &ctx, TraceStage stage);
+
+    /**
+     * @brief Record an event with explicit times.
+     */
+    void record(uint32_t id, TraceStage stage, uint64_t start_ns, uint64_t end_ns);
+
+    /// Turn tracing on or off, on by default
+    void enable(bool enabled) {_enabled.store(enabled);}
+
+    /**
+     * @brief Write the buffered events as Chrome trace JSON.
+     *
+     * Events written while exporting may be skipped.
+     *
+     * @param path output file
+     * @return true if the file was written
+     */
+    bool export_chrome_json(const std::string &path) const;
+
+    /**
+     * @brief Name of a stage, as used in the export.
+     */
+    static const char* stage_name(TraceStage stage);
+};
@@ -8,9 +8,13 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 
 #include "controllers/controller.h"
+#include "telemetry/telemetry_streams.h"
+#include "vehicle_state.h"
+#include "seqlock.h"
 #include "position.h"
 
 #include <mavsdk/mavsdk.h>
@@ -39,8 +43,9 @@ private:
     /// Flag indicating if arming is in progress
     bool _arming_in_progress = false;
 
-    /// Flag indicating if the vehicle is armed
-    bool _armed = false;
+    /// Flag indicating if the vehicle is armed, written by the control
+    /// thread and reported to the GCS from the vehicle thread
+    std::atomic<bool> _armed{false};
 
     /// The current mode this vehicle is in
     mavsdk::ActionServer::FlightMode _curr_mode;
@@ -54,14 +59,25 @@ private:
     /// Current position estimate
     Position _position;
 
-    /// Vehicle State, HARDCODED FOR NOW
-    mavsdk::TelemetryServer::Position _pos{42.7161389, -84.50325, 0.f, 0.f};
-    mavsdk::TelemetryServer::PositionVelocityNed _pos_vel{{0,0,0},{0,0,0}};
-    mavsdk::TelemetryServer::VelocityNed _vel{};
-    mavsdk::TelemetryServer::Heading _hdg{60};
-    mavsdk::TelemetryServer::RawGps _raw_gps{0,55.953251,-3.188267,0, NAN,NAN,0,NAN,0,0,0,0,0,0};
+    /// Latest estimator output, written by the control path,
+    /// read by the telemetry thread
+    SeqLock<VehicleState> _state;
+
+    /// Home, set once from the first valid global position, then read only
+    mavsdk::TelemetryServer::Position _home{};
+    std::atomic<bool> _home_set{false};
+
+    /// Not simulated yet
     mavsdk::TelemetryServer::GpsInfo _gps_info{11, mavsdk::TelemetryServer::FixType::Fix3D};
-    mavsdk::TelemetryServer::Battery _battery{};
+    mavsdk::TelemetryServer::Battery _battery{16.2f, 1.f};
+
+    /**
+     * @brief Build and send the ATTITUDE message.
+     *
+     * TelemetryServer has no attitude publisher, so it goes out
+     * through MavlinkDirect.
+     */
+    void publish_attitude(const VehicleState &state);
 
 public:
     explicit Vehicle(std::shared_ptr<mavsdk::ServerComponent> server, std::shared_ptr<mavsdk::System> system, Morb* morb);
@@ -94,17 +110,51 @@ public:
     bool is_arming();
 
     /**
-     * @brief publishes telemetry using mavlink
+     * @brief Publishes one telemetry stream using mavlink
+     *
+     * Called from the telemetry thread only. Values come from the
+     * given "vehicle_state", nothing here touches the control path.
+     * HOME is only sent once home is set.
+     *
+     * @param stream The stream to send
+     * @param state estimator output for this tick
+     */
+    void publish_stream(TelemetryStream stream, const VehicleState &state);
+
+    /**
+     * @brief Publishes every stream set in a due() mask
+     *
+     * The state is read once, so the streams of a tick agree.
      */
-    void publish_telem();
+    void publish_streams(uint32_t mask);
 
     /**
-     * @brief performs takeoff operations
+     * @brief Latest estimator output
+     */
+    VehicleState state() const {return _state.load();}
+
+    /**
+     * @brief Home position, safe from any thread
+     *
+     * @param home set if known
+     * @return false until the first valid global position
+     */
+    bool home(mavsdk::TelemetryServer::Position &home) const;
+
+    /**
+     * @brief Mavlink direct instance, to send and receive raw messages
+     */
+    mavsdk::MavlinkDirect& mavlink_direct() {return *_mavdirect;}
+
+    /**
+     * @brief Enter Takeoff, the climb itself is the Takeoff mode's job
+     *
+     * @return false if not armed, arming is up to the mode manager
      */
-    void takeoff();
+    bool takeoff();
 
     /**
-     * @brief performs necessary operations to hold
+     * @brief Enter Hold
      */
     void enter_hold();
 
@@ -0,0 +1,38 @@
+/**
+ * @file vehicle_state.h
+ * @author Abdulelah Mulla
+ * @date 10/18/2026
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "trace.h"
+
+/**
+ * @brief Output of the estimator, published on "vehicle_state".
+ */
+struct VehicleState {
+    uint64_t timestamp; // sim time, µs
+
+    /// Attitude
+    float q[4];      // body FRD to NED, w x y z
+    float rates[3];  // body FRD, rad/s
+    float accel[3];  // body FRD specific force, m/s²
+
+    /// Local position, relative to the Gazebo world origin
+    float position[3]; // NED, m
+    float velocity[3]; // NED, m/s
+
+    /// Global position
+    double lat;
+    double lon;
+    double alt; // AMSL, m
+
+    bool attitude_valid;
+    bool local_valid;
+    bool global_valid;
+
+    TraceContext trace;
+};
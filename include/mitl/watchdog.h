@@ -0,0 +1,205 @@
+/**
+ * @file watchdog.h
+ * @author Abdulelah Mulla
+ * @brief Deadline monitoring of the real-time threads
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+#include <sys/types.h>
+
+#include "thread_factory.h"
+
+class Morb;
+
+/**
+ * @brief A mutex that remembers which thread holds it.
+ *
+ * Lets the watchdog name the thread a late thread is waiting on.
+ * Costs one relaxed store on lock and unlock.
+ */
+class WatchedMutex {
+private:
+    std::mutex _mutex;
+    std::atomic<pid_t> _owner{0};
+public:
+    void lock();
+    bool try_lock();
+    void unlock();
+
+    /**
+     * @brief Kernel id of the holder, 0 if free.
+     */
+    pid_t owner() const {return _owner.load(std::memory_order_relaxed);}
+};
+
+/**
+ * @brief What the watchdog does when a thread misses its deadline,
+ * MITL_WD_ACTION.
+ */
+enum class WatchdogAction : uint8_t {
+    REPORT, // log and publish only, the default
+    LAND    // and land, through the mode manager
+};
+
+/**
+ * @brief Published on "watchdog_report" when a thread misses its
+ * deadline, and again when it recovers.
+ */
+struct WatchdogReport {
+    uint64_t timestamp;  // wall time, µs
+    MitlThread thread;
+    bool late;           // true on the miss, false on the recovery
+    bool failsafe;       // the mode manager should land
+    bool inversion;      // waiting on a lock held by a lower priority thread
+    uint32_t busy_us;    // time in the cycle when detected
+    const char *stage;   // last stage the thread entered, never nullptr
+    pid_t holder;        // thread holding the lock it waits on, 0 if none
+    uint32_t misses;     // of this thread, since start
+};
+
+/**
+ * @brief Detects threads that stop making progress.
+ *
+ * A watched thread calls beat() when it starts a cycle and idle()
+ * when it goes back to waiting for work, the rate groups do this in
+ * begin() and end(). Both are a relaxed load and store of a counter
+ * only that thread writes, busy when odd, so the loops pay nothing
+ * measurable. A thread that stays busy longer than its deadline has
+ * missed it, a thread that is idle is never late.
+ *
+ * stage() names what the thread is doing, a static string, so a
+ * report tells where it got stuck. A thread about to take a
+ * WatchedMutex passes it along, and if it is late there the report
+ * names the holder. Holding it from a thread that runs below the
+ * waiter's THREAD_TABLE priority is a priority inversion. The locks
+ * the loops share with other threads are WatchedMutexes: the program
+ * log's, the rate group triggers and the trajectory request.
+ *
+ * The watchdog thread checks every slot each TICK, which is also
+ * the resolution of a deadline, logs every miss and publishes a
+ * WatchdogReport. With MITL_WD_ACTION set to LAND the report asks
+ * for the failsafe, which the mode manager runs on its next cycle, a
+ * control thread that never comes back cannot land itself.
+ */
+class Watchdog {
+private:
+    struct alignas(64) Slot {
+        /// Written by the watched thread
+        std::atomic<uint32_t> beats{0};
+        std::atomic<const char*> stage{"none"};
+        std::atomic<const WatchedMutex*> waiting{nullptr};
+
+        /// 0 when not watched, µs
+        std::atomic<uint64_t> deadline_us{0};
+
+        /// Watchdog thread only
+        bool seen{false};
+        uint32_t last_beats{0};
+        uint64_t since_ns{0};
+        bool late{false};
+        uint32_t misses{0};
+    };
+    Slot _slots[MITL_THREAD_COUNT];
+
+    /// Message bus, nullptr to only log
+    std::atomic<Morb*> _morb{nullptr};
+
+    std::atomic<bool> _running{false};
+    FactoryThread _thread;
+
+    /// Check period, ns
+    static constexpr uint64_t TICK = 10000000;
+
+    /// Constructor
+    Watchdog();
+
+    void loop();
+
+    /**
+     * @brief Fill in the lock the thread waits on and whether it is
+     * an inversion.
+     */
+    static void find_holder(MitlThread id, const WatchedMutex *lock, WatchdogReport &report);
+
+    void publish(const WatchdogReport &report);
+public:
+    /// Delete copy constructor and assignment operator
+    Watchdog(const Watchdog&) = delete;
+    Watchdog& operator=(const Watchdog&) = delete;
+
+    /**
+     * Singleton approach to give global access to this class.
+     */
+    static Watchdog& initialize();
+
+    /**
+     * @brief Publish "watchdog_report", before start().
+     */
+    void attach(Morb *morb) {_morb.store(morb);}
+    void detach() {_morb.store(nullptr);}
+
+    /**
+     * @brief Start and stop the watchdog thread.
+     */
+    void start();
+    void stop();
+
+    /**
+     * @brief Watch a thread, or change its deadline.
+     * @param deadline longest a cycle may take
+     */
+    void watch(MitlThread id, std::chrono::microseconds deadline);
+
+    /**
+     * @brief Stop watching a thread, before it exits.
+     */
+    void unwatch(MitlThread id);
+
+    /**
+     * @brief The calling thread starts a cycle.
+     */
+    void beat(MitlThread id) {
+        Slot &slot = _slots[static_cast<int>(id)];
+        const uint32_t beats = slot.beats.load(std::memory_order_relaxed);
+        slot.beats.store((beats + 1) | 1u, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief The calling thread waits for work, no deadline.
+     */
+    void idle(MitlThread id) {
+        Slot &slot = _slots[static_cast<int>(id)];
+        const uint32_t beats = slot.beats.load(std::memory_order_relaxed);
+        slot.beats.store((beats + 1) & ~1u, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief The calling thread enters a stage of its cycle.
+     * @param stage static string
+     * @param lock the lock it is about to take, if any
+     */
+    void stage(MitlThread id, const char *stage, const WatchedMutex *lock = nullptr) {
+        Slot &slot = _slots[static_cast<int>(id)];
+        slot.stage.store(stage, std::memory_order_relaxed);
+        slot.waiting.store(lock, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Check every watched thread once.
+     * @param now monotonic time, ns
+     */
+    void check(uint64_t now);
+
+    /**
+     * @brief Kernel id of the calling thread.
+     */
+    static pid_t thread_id();
+};
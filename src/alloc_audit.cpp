@@ -0,0 +1,85 @@
+/**
+ * @file alloc_audit.cpp
+ * @author Abdulelah Mulla
+ */
+
+#include <atomic>
+
+#include "alloc_audit.h"
+
+/// Constant initialized, operator new may run before main
+static std::atomic<bool> enabled{false};
+static std::atomic<uint64_t> allocations{0};
+
+static std::atomic<uint8_t> record_thread[AllocAudit::RECORDS];
+static std::atomic<size_t> record_size[AllocAudit::RECORDS];
+
+static thread_local bool watched = false;
+static thread_local MitlThread watched_thread = MitlThread::COUNT;
+
+void AllocAudit::watch(MitlThread id) {
+    watched_thread = id;
+    watched = true;
+}
+
+void AllocAudit::unwatch() {
+    watched = false;
+}
+
+AllocAudit::Scope::Scope(MitlThread id) :
+    _watched(watched),
+    _thread(watched_thread)
+{
+    watch(id);
+}
+
+AllocAudit::Scope::~Scope() {
+    watched_thread = _thread;
+    watched = _watched;
+}
+
+AllocAudit::Exempt::Exempt() :
+    _watched(watched)
+{
+    watched = false;
+}
+
+AllocAudit::Exempt::~Exempt() {
+    watched = _watched;
+}
+
+void AllocAudit::start() {
+    allocations.store(0, std::memory_order_relaxed);
+    enabled.store(true, std::memory_order_release);
+}
+
+void AllocAudit::stop() {
+    enabled.store(false, std::memory_order_release);
+}
+
+uint64_t AllocAudit::count() {
+    return allocations.load(std::memory_order_relaxed);
+}
+
+int AllocAudit::records(AllocRecord *out, int max) {
+    const uint64_t total = count();
+    int n = total < static_cast<uint64_t>(RECORDS) ? static_cast<int>(total) : RECORDS;
+    n = n < max ? n : max;
+    for (int i = 0; i < n; i++) {
+        out[i].thread = static_cast<MitlThread>(record_thread[i].load(std::memory_order_relaxed));
+        out[i].size = record_size[i].load(std::memory_order_relaxed);
+    }
+    return n;
+}
+
+void AllocAudit::on_alloc(size_t size) {
+    if (!watched || !enabled.load(std::memory_order_acquire)) {
+        return;
+    }
+    /// Claims a record, read them after stop()
+    const uint64_t index = allocations.fetch_add(1, std::memory_order_relaxed);
+    if (index < static_cast<uint64_t>(RECORDS)) {
+        record_thread[index].store(static_cast<uint8_t>(watched_thread), std::memory_order_relaxed);
+        record_size[index].store(size, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,96 @@
+/**
+ * @file alloc_hook.cpp
+ * @author Abdulelah Mulla
+ */
+
+/// Replaces the global operator new for AllocAudit. Only linked into
+/// the test and benchmark executables, see mitl_alloc_hook.
+
+#include <cstdlib>
+#include <new>
+
+#include "alloc_audit.h"
+
+static void* allocate(std::size_t size) {
+    AllocAudit::on_alloc(size);
+    void *ptr = std::malloc(size ? size : 1);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+static void* allocate_aligned(std::size_t size, std::align_val_t align) {
+    AllocAudit::on_alloc(size);
+    void *ptr = nullptr;
+    const std::size_t alignment = static_cast<std::size_t>(align) < sizeof(void*) ?
+        sizeof(void*) : static_cast<std::size_t>(align);
+    if (posix_memalign(&ptr, alignment, size ? size : 1) != 0) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new(std::size_t size) {
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size) {
+    return allocate(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return allocate(size);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return allocate(size);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void* operator new(std::size_t size, std::align_val_t align) {
+    return allocate_aligned(size, align);
+}
+
+void* operator new[](std::size_t size, std::align_val_t align) {
+    return allocate_aligned(size, align);
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept {
+    std::free(ptr);
+}
@@ -0,0 +1,351 @@
+/**
+ * @file column_reader.cpp
+ * @author Abdulelah Mulla
+ */
+
+#include <algorithm>
+
+#include <sys/mman.h>
+
+#include "analysis/column_reader.h"
+
+bool ColumnarSegment::open(const std::string &path) {
+    _topics.clear();
+    _chunks.clear();
+    _bytes_read = 0;
+    if (!_file.open(path) || _file.size() < sizeof(LogFileHeader)) {
+        return false;
+    }
+    LogFileHeader header;
+    std::memcpy(&header, _file.data(), sizeof(header));
+    if (std::memcmp(header.magic, "MITLLOG1", sizeof(header.magic)) != 0 || header.version != SegmentedLog::VERSION ||
+        header.layout != LogLayout::COLUMNAR) {
+        return false;
+    }
+    _codec = header.codec;
+    /// Only the chunks asked for are touched, no read ahead
+    madvise(const_cast<uint8_t*>(_file.data()), _file.size(), MADV_RANDOM);
+    const size_t file_size = _file.size();
+
+    /// A chunk is usable if it lies within the file and matches its header
+    auto valid = [&](const LogChunkIndex &chunk) {
+        if (chunk.offset > file_size || file_size - chunk.offset < sizeof(LogChunkHeader) ||
+            chunk.header.size > file_size - chunk.offset - sizeof(LogChunkHeader)) {
+            return false;
+        }
+        return std::memcmp(_file.data() + chunk.offset, &chunk.header, sizeof(chunk.header)) == 0;
+    };
+
+    uint64_t end = sizeof(LogFileHeader);
+    MappedFile index;
+    if (index.open(path + ".idx") && index.size() >= sizeof(LogFileHeader)) {
+        const size_t count = (index.size() - sizeof(LogFileHeader)) / sizeof(LogChunkIndex);
+        _chunks.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            LogChunkIndex chunk;
+            std::memcpy(&chunk, index.data() + sizeof(LogFileHeader) + i * sizeof(chunk), sizeof(chunk));
+            if (chunk.offset != end || !valid(chunk)) {
+                break;
+            }
+            _chunks.push_back(chunk);
+            end = chunk.offset + sizeof(LogChunkHeader) + chunk.header.size;
+        }
+    }
+
+    /// No index, or chunks after it, walk the file
+    while (end + sizeof(LogChunkHeader) <= file_size) {
+        LogChunkIndex chunk;
+        chunk.offset = end;
+        std::memcpy(&chunk.header, _file.data() + end, sizeof(chunk.header));
+        if (!valid(chunk)) {
+            break;
+        }
+        _chunks.push_back(chunk);
+        end += sizeof(LogChunkHeader) + chunk.header.size;
+    }
+
+    for (const LogChunkIndex &chunk : _chunks) {
+        if (chunk.header.kind == LogChunkKind::SCHEMA && !parse_schema(chunk)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ColumnarSegment::parse_schema(const LogChunkIndex &chunk) {
+    std::vector<uint8_t> buffer;
+    const uint8_t *data = load(chunk, buffer);
+    if (!data) {
+        return false;
+    }
+    const uint8_t *end = data + chunk.header.raw_size;
+
+    /// A string up to its '\0'
+    auto text = [&](std::string &out) {
+        const uint8_t *stop = std::find(data, end, '\0');
+        if (stop == end) {
+            return false;
+        }
+        out.assign(reinterpret_cast<const char*>(data), stop - data);
+        data = stop + 1;
+        return true;
+    };
+
+    ColumnarTopic topic;
+    uint16_t count;
+    if (!text(topic.label) || !text(topic.type) || end - data < 1 + static_cast<long>(sizeof(count))) {
+        return false;
+    }
+    topic.keep_payload = *data++ != 0;
+    std::memcpy(&count, data, sizeof(count));
+    data += sizeof(count);
+    for (uint16_t i = 0; i < count; i++) {
+        LogField field;
+        if (end - data < 1 + static_cast<long>(sizeof(field.offset))) {
+            return false;
+        }
+        field.type = static_cast<LogFieldType>(*data++);
+        if (field.type > LogFieldType::F64) {
+            return false;
+        }
+        std::memcpy(&field.offset, data, sizeof(field.offset));
+        data += sizeof(field.offset);
+        if (!text(field.name)) {
+            return false;
+        }
+        topic.fields.push_back(std::move(field));
+    }
+    if (chunk.header.topic >= _topics.size()) {
+        _topics.resize(chunk.header.topic + 1);
+    }
+    /// Every segment names its topics the same way, the first one wins
+    if (_topics[chunk.header.topic].label.empty()) {
+        _topics[chunk.header.topic] = std::move(topic);
+    }
+    return true;
+}
+
+int ColumnarSegment::find_topic(const std::string &label) const {
+    for (size_t i = 0; i < _topics.size(); i++) {
+        if (_topics[i].label == label) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+int ColumnarSegment::find_field(int topic, const std::string &name) const {
+    if (topic < 0 || topic >= static_cast<int>(_topics.size())) {
+        return -1;
+    }
+    const std::vector<LogField> &fields = _topics[topic].fields;
+    for (size_t i = 0; i < fields.size(); i++) {
+        if (fields[i].name == name) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+long ColumnarSegment::find_chunk(size_t time_chunk, LogChunkKind kind, uint16_t column) const {
+    const LogChunkHeader &time = _chunks[time_chunk].header;
+    for (size_t i = time_chunk; i < _chunks.size(); i++) {
+        const LogChunkHeader &header = _chunks[i].header;
+        if (header.topic != time.topic || header.group != time.group) {
+            break;
+        }
+        if (header.kind == kind && (kind != LogChunkKind::FIELD || header.column == column)) {
+            return static_cast<long>(i);
+        }
+    }
+    return -1;
+}
+
+const uint8_t* ColumnarSegment::load(const LogChunkIndex &chunk, std::vector<uint8_t> &buffer) {
+    const uint8_t *data = _file.data() + chunk.offset + sizeof(LogChunkHeader);
+    _bytes_read += chunk.header.raw_size;
+    if (chunk.header.size == chunk.header.raw_size) {
+        /// Stored as is, read in place
+        return data;
+    }
+    buffer.resize(chunk.header.raw_size);
+    if (!SegmentedLog::decompress(_codec, data, chunk.header.size, buffer.data(), buffer.size())) {
+        return nullptr;
+    }
+    return buffer.data();
+}
+
+bool ColumnarSegment::read_column(int topic, LogChunkKind kind, uint16_t column, size_t width, uint64_t from,
+                                  uint64_t to, std::vector<uint8_t> &out, std::vector<uint64_t> *times) {
+    if (topic < 0 || topic >= static_cast<int>(_topics.size())) {
+        return false;
+    }
+    for (size_t i = 0; i < _chunks.size(); i++) {
+        const LogChunkHeader &time = _chunks[i].header;
+        if (time.kind != LogChunkKind::TIME || time.topic != topic || time.last_time < from ||
+            time.first_time > to) {
+            continue;
+        }
+        const long found = kind == LogChunkKind::TIME ? static_cast<long>(i) : find_chunk(i, kind, column);
+        if (found < 0) {
+            return false;
+        }
+        const LogChunkIndex &chunk = _chunks[found];
+        if (chunk.header.count != time.count || chunk.header.raw_size != time.count * width ||
+            time.raw_size != time.count * sizeof(uint64_t)) {
+            return false;
+        }
+        const uint8_t *values = load(chunk, _values);
+        if (!values) {
+            return false;
+        }
+
+        /// A group wholly in range is copied as is
+        const bool whole = time.first_time >= from && time.last_time <= to;
+        if (whole && !times) {
+            out.insert(out.end(), values, values + chunk.header.raw_size);
+            continue;
+        }
+        const uint8_t *stamps = kind == LogChunkKind::TIME ? values : load(_chunks[i], _times);
+        if (!stamps) {
+            return false;
+        }
+        for (uint32_t r = 0; r < time.count; r++) {
+            uint64_t stamp;
+            std::memcpy(&stamp, stamps + r * sizeof(stamp), sizeof(stamp));
+            if (stamp < from || stamp > to) {
+                continue;
+            }
+            out.insert(out.end(), values + r * width, values + (r + 1) * width);
+            if (times) {
+                times->push_back(stamp);
+            }
+        }
+    }
+    return true;
+}
+
+bool ColumnarSegment::read_times(int topic, uint64_t from, uint64_t to, std::vector<uint64_t> &times) {
+    std::vector<uint8_t> bytes;
+    if (!read_column(topic, LogChunkKind::TIME, 0, sizeof(uint64_t), from, to, bytes, nullptr)) {
+        return false;
+    }
+    const size_t before = times.size();
+    times.resize(before + bytes.size() / sizeof(uint64_t));
+    std::memcpy(times.data() + before, bytes.data(), bytes.size());
+    return true;
+}
+
+bool ColumnarSegment::read_values(int topic, int field, uint64_t from, uint64_t to, std::vector<double> &values,
+                                  std::vector<uint64_t> *times) {
+    if (topic < 0 || topic >= static_cast<int>(_topics.size()) || field < 0 ||
+        field >= static_cast<int>(_topics[topic].fields.size())) {
+        return false;
+    }
+    const LogFieldType type = _topics[topic].fields[field].type;
+    const size_t width = field_size(type);
+    std::vector<uint8_t> bytes;
+    if (!read_column(topic, LogChunkKind::FIELD, static_cast<uint16_t>(field), width, from, to, bytes, times)) {
+        return false;
+    }
+    const size_t rows = bytes.size() / width;
+    values.reserve(values.size() + rows);
+    for (size_t r = 0; r < rows; r++) {
+        const uint8_t *value = bytes.data() + r * width;
+        switch (type) {
+            case LogFieldType::U8:
+                values.push_back(*value);
+                break;
+            case LogFieldType::U32: {
+                uint32_t number;
+                std::memcpy(&number, value, sizeof(number));
+                values.push_back(number);
+                break;
+            }
+            case LogFieldType::U64: {
+                uint64_t number;
+                std::memcpy(&number, value, sizeof(number));
+                values.push_back(static_cast<double>(number));
+                break;
+            }
+            case LogFieldType::F32: {
+                float number;
+                std::memcpy(&number, value, sizeof(number));
+                values.push_back(number);
+                break;
+            }
+            case LogFieldType::F64: {
+                double number;
+                std::memcpy(&number, value, sizeof(number));
+                values.push_back(number);
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+bool ColumnarSegment::field_range(int topic, int field, uint64_t from, uint64_t to, double &min,
+                                  double &max) const {
+    bool found = false;
+    for (const LogChunkIndex &chunk : _chunks) {
+        const LogChunkHeader &header = chunk.header;
+        if (header.kind != LogChunkKind::FIELD || header.topic != topic || header.column != field ||
+            header.last_time < from || header.first_time > to) {
+            continue;
+        }
+        /// All NaN, nothing to add
+        if (header.min > header.max) {
+            continue;
+        }
+        min = found ? std::min(min, header.min) : header.min;
+        max = found ? std::max(max, header.max) : header.max;
+        found = true;
+    }
+    return found;
+}
+
+bool ColumnarSegment::read_payloads(int topic, uint64_t from, uint64_t to, std::vector<uint64_t> &times,
+                                    std::vector<uint32_t> &sizes, std::vector<uint8_t> &payload) {
+    if (topic < 0 || topic >= static_cast<int>(_topics.size()) || !_topics[topic].keep_payload) {
+        return false;
+    }
+    std::vector<uint8_t> records;
+    for (size_t i = 0; i < _chunks.size(); i++) {
+        const LogChunkHeader &time = _chunks[i].header;
+        if (time.kind != LogChunkKind::TIME || time.topic != topic || time.last_time < from ||
+            time.first_time > to) {
+            continue;
+        }
+        const long sizes_chunk = find_chunk(i, LogChunkKind::SIZES, 0);
+        const long payload_chunk = find_chunk(i, LogChunkKind::PAYLOAD, 0);
+        if (sizes_chunk < 0 || payload_chunk < 0 || time.raw_size != time.count * sizeof(uint64_t) ||
+            _chunks[sizes_chunk].header.raw_size != time.count * sizeof(uint32_t)) {
+            return false;
+        }
+        const uint8_t *stamps = load(_chunks[i], _times);
+        const uint8_t *lengths = load(_chunks[sizes_chunk], _values);
+        const uint8_t *bytes = stamps && lengths ? load(_chunks[payload_chunk], records) : nullptr;
+        if (!bytes) {
+            return false;
+        }
+        const uint32_t total = _chunks[payload_chunk].header.raw_size;
+        uint32_t offset = 0;
+        for (uint32_t r = 0; r < time.count; r++) {
+            uint64_t stamp;
+            uint32_t size;
+            std::memcpy(&stamp, stamps + r * sizeof(stamp), sizeof(stamp));
+            std::memcpy(&size, lengths + r * sizeof(size), sizeof(size));
+            if (size > total - offset) {
+                return false;
+            }
+            if (stamp >= from && stamp <= to) {
+                times.push_back(stamp);
+                sizes.push_back(size);
+                payload.insert(payload.end(), bytes + offset, bytes + offset + size);
+            }
+            offset += size;
+        }
+    }
+    return true;
+}
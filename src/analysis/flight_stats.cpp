@@ -0,0 +1,353 @@
+/**
+ * @file flight_stats.cpp
+ * @author Abdulelah Mulla
+ */
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <future>
+
+#include "analysis/flight_stats.h"
+#include "geodesy.h"
+
+static const char *MODE_NAMES[MODE_COUNT] = {"READY", "TAKEOFF", "HOLD", "MISSION", "LAND"};
+
+static const char *EVENT_NAMES[MODE_EVENT_COUNT] = {
+    "REQUEST_READY", "REQUEST_TAKEOFF", "REQUEST_HOLD", "REQUEST_MISSION", "REQUEST_LAND",
+    "MODE_COMPLETE", "FENCE_PREDICTED", "FENCE_BREACHED", "FAILSAFE"
+};
+
+const char* mode_name(ModeId mode) {
+    const int index = static_cast<int>(mode);
+    return index < MODE_COUNT ? MODE_NAMES[index] : "UNKNOWN";
+}
+
+static const char* event_name(ModeEvent event) {
+    const int index = static_cast<int>(event);
+    return index < MODE_EVENT_COUNT ? EVENT_NAMES[index] : "";
+}
+
+uint64_t Histogram::percentile(double p) const {
+    const double wanted = p * static_cast<double>(_total);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < _counts.size(); i++) {
+        seen += _counts[i];
+        if (seen > 0 && static_cast<double>(seen) >= wanted) {
+            return (i + 1) * _bin_us;
+        }
+    }
+    return _counts.size() * _bin_us;
+}
+
+static std::vector<TopicRate> topic_rates(const LogColumns &columns) {
+    std::vector<TopicRate> rates;
+    std::vector<uint64_t> intervals;
+    for (const TopicSeries &series : columns.topics) {
+        TopicRate rate{series.label, series.type, series.time.size(), series.bytes, 0, 0, 0, 0};
+        if (series.time.size() > 1) {
+            intervals.resize(series.time.size() - 1);
+            for (size_t i = 1; i < series.time.size(); i++) {
+                const uint64_t a = series.time[i - 1], b = series.time[i];
+                intervals[i - 1] = b > a ? b - a : 0;
+            }
+            const uint64_t span = series.time.back() > series.time.front() ?
+                                  series.time.back() - series.time.front() : 0;
+            if (span > 0) {
+                rate.rate_hz = 1e6 * static_cast<double>(intervals.size()) / static_cast<double>(span);
+            }
+            rate.max_interval_us = *std::max_element(intervals.begin(), intervals.end());
+            auto median = intervals.begin() + intervals.size() / 2;
+            std::nth_element(intervals.begin(), median, intervals.end());
+            rate.median_interval_us = *median;
+            auto p99 = intervals.begin() + (intervals.size() * 99) / 100;
+            std::nth_element(intervals.begin(), p99, intervals.end());
+            rate.p99_interval_us = *p99;
+        }
+        rates.push_back(std::move(rate));
+    }
+    return rates;
+}
+
+/// Loop period and latency from the actuator outputs, and the loop reports
+static void loop_timing(const LogColumns &columns, FlightStats &stats) {
+    const ActuatorColumns &a = columns.actuators;
+    for (size_t i = 0; i < a.time.size(); i++) {
+        if (i > 0 && a.stamp_ns[i] > a.stamp_ns[i - 1]) {
+            stats.loop_interval.add((a.stamp_ns[i] - a.stamp_ns[i - 1]) / 1000);
+        }
+        if (a.origin_ns[i] != 0 && a.stamp_ns[i] >= a.origin_ns[i]) {
+            stats.latency.add((a.stamp_ns[i] - a.origin_ns[i]) / 1000);
+        }
+    }
+    const LoopColumns &l = columns.loop;
+    if (!l.time.empty()) {
+        stats.loop_cycles = l.cycles.back();
+        stats.loop_overruns = l.overruns.back();
+        stats.max_cycle_us = *std::max_element(l.max_cycle_us.begin(), l.max_cycle_us.end());
+    }
+}
+
+/// Actuator outputs pinned at the end of their range
+static void actuator_usage(const LogColumns &columns, FlightStats &stats) {
+    const ActuatorColumns &a = columns.actuators;
+    double thrust = 0;
+    for (size_t i = 0; i < a.time.size(); i++) {
+        thrust += a.thrust[i];
+        if (a.thrust[i] <= 0.f || a.thrust[i] >= 1.f || std::fabs(a.roll[i]) >= 1.f ||
+            std::fabs(a.pitch[i]) >= 1.f || std::fabs(a.yaw[i]) >= 1.f) {
+            stats.saturated++;
+        }
+    }
+    stats.actuator_samples = a.time.size();
+    stats.mean_thrust = a.time.empty() ? 0 : thrust / static_cast<double>(a.time.size());
+}
+
+/**
+ * Every state is compared to the setpoint in force when it was logged,
+ * in the tangent plane at the setpoint.
+ */
+static void tracking(const LogColumns &columns, TrackingStats (&tracking)[MODE_COUNT]) {
+    const StateColumns &s = columns.state;
+    const SetpointColumns &p = columns.setpoint;
+    const ModeColumns &m = columns.modes;
+
+    size_t next_setpoint = 0;
+    bool has_setpoint = false;
+    size_t setpoint = 0;
+    LocalFrame frame;
+
+    /// Without mode changes the whole log counts as HOLD
+    size_t next_mode = 0;
+    ModeId mode = m.time.empty() ? ModeId::HOLD : static_cast<ModeId>(m.from[0]);
+
+    for (size_t i = 0; i < s.time.size(); i++) {
+        const uint64_t time = s.time[i];
+        while (next_setpoint < p.time.size() && p.time[next_setpoint] <= time) {
+            setpoint = next_setpoint++;
+            has_setpoint = true;
+            frame = LocalFrame(p.lat[setpoint], p.lon[setpoint], p.alt[setpoint]);
+        }
+        while (next_mode < m.time.size() && m.time[next_mode] <= time) {
+            mode = static_cast<ModeId>(m.to[next_mode++]);
+        }
+        if (!has_setpoint || !s.global_valid[i] || mode == ModeId::READY || mode >= ModeId::COUNT) {
+            continue;
+        }
+        float ned[3];
+        frame.to_ned(s.lat[i], s.lon[i], s.alt[i], ned);
+        const double horizontal = std::hypot(ned[0], ned[1]);
+        const double vertical = std::fabs(ned[2]);
+        const double dvx = s.vx[i] - p.vx[setpoint];
+        const double dvy = s.vy[i] - p.vy[setpoint];
+        const double dvz = s.vz[i] - p.vz[setpoint];
+
+        TrackingStats &t = tracking[static_cast<int>(mode)];
+        t.samples++;
+        t.rms_horizontal += horizontal * horizontal;
+        t.rms_vertical += vertical * vertical;
+        t.rms_velocity += dvx * dvx + dvy * dvy + dvz * dvz;
+        t.max_horizontal = std::max(t.max_horizontal, horizontal);
+        t.max_vertical = std::max(t.max_vertical, vertical);
+    }
+    /// Sums of squares to RMS
+    for (TrackingStats &t : tracking) {
+        if (t.samples > 0) {
+            const double n = static_cast<double>(t.samples);
+            t.rms_horizontal = std::sqrt(t.rms_horizontal / n);
+            t.rms_vertical = std::sqrt(t.rms_vertical / n);
+            t.rms_velocity = std::sqrt(t.rms_velocity / n);
+        }
+    }
+}
+
+static std::vector<ModeSpan> mode_timeline(const LogColumns &columns, uint64_t start, uint64_t end) {
+    const ModeColumns &m = columns.modes;
+    std::vector<ModeSpan> spans;
+    if (m.time.empty()) {
+        return spans;
+    }
+    spans.push_back({start, m.time[0], static_cast<ModeId>(m.from[0]), ModeEvent::COUNT});
+    for (size_t i = 0; i < m.time.size(); i++) {
+        spans.back().end = m.time[i];
+        spans.push_back({m.time[i], end, static_cast<ModeId>(m.to[i]), static_cast<ModeEvent>(m.event[i])});
+    }
+    spans.back().end = std::max(end, spans.back().start);
+    return spans;
+}
+
+FlightStats compute_stats(const LogColumns &columns) {
+    FlightStats stats;
+    bool first = true;
+    for (const TopicSeries &series : columns.topics) {
+        if (series.time.empty()) {
+            continue;
+        }
+        const auto range = std::minmax_element(series.time.begin(), series.time.end());
+        stats.start = first ? *range.first : std::min(stats.start, *range.first);
+        stats.end = first ? *range.second : std::max(stats.end, *range.second);
+        first = false;
+    }
+
+    /// Independent passes over different columns
+    auto rates = std::async(std::launch::async, topic_rates, std::cref(columns));
+    auto timing = std::async(std::launch::async, [&] {loop_timing(columns, stats);});
+    auto usage = std::async(std::launch::async, [&] {actuator_usage(columns, stats);});
+    tracking(columns, stats.tracking);
+    stats.modes = mode_timeline(columns, stats.start, stats.end);
+    stats.rates = rates.get();
+    timing.get();
+    usage.get();
+    return stats;
+}
+
+/**
+ * @brief A file written through a large buffer.
+ */
+class CsvFile {
+private:
+    std::FILE *_file;
+    std::vector<char> _buffer;
+public:
+    explicit CsvFile(const std::string &path) :
+        _file(std::fopen(path.c_str(), "w")),
+        _buffer(1 << 20)
+    {
+        if (_file) {
+            std::setvbuf(_file, _buffer.data(), _IOFBF, _buffer.size());
+        }
+    }
+
+    ~CsvFile() {
+        close();
+    }
+
+    CsvFile(const CsvFile&) = delete;
+    CsvFile& operator=(const CsvFile&) = delete;
+
+    std::FILE* get() const {return _file;}
+
+    /// @return false if anything failed to write
+    bool close() {
+        if (!_file) {
+            return false;
+        }
+        const bool ok = !std::ferror(_file);
+        const bool closed = std::fclose(_file) == 0;
+        _file = nullptr;
+        return ok && closed;
+    }
+};
+
+bool write_stats_csv(const FlightStats &stats, const std::string &directory) {
+    bool ok = true;
+    {
+        CsvFile csv(directory + "/topics.csv");
+        if (FILE *f = csv.get()) {
+            std::fprintf(f, "label,type,count,bytes,rate_hz,median_interval_us,p99_interval_us,max_interval_us\n");
+            for (const TopicRate &rate : stats.rates) {
+                std::fprintf(f, "\"%s\",%s,%llu,%llu,%.3f,%llu,%llu,%llu\n", rate.label.c_str(), rate.type.c_str(),
+                             static_cast<unsigned long long>(rate.count), static_cast<unsigned long long>(rate.bytes),
+                             rate.rate_hz, static_cast<unsigned long long>(rate.median_interval_us),
+                             static_cast<unsigned long long>(rate.p99_interval_us),
+                             static_cast<unsigned long long>(rate.max_interval_us));
+            }
+        }
+        ok = csv.close() && ok;
+    }
+    {
+        CsvFile csv(directory + "/loop_timing.csv");
+        if (FILE *f = csv.get()) {
+            std::fprintf(f, "histogram,bin_start_us,bin_end_us,count\n");
+            for (const auto &[name, histogram] : {std::make_pair("loop_interval", &stats.loop_interval),
+                                                  std::make_pair("latency", &stats.latency)}) {
+                const std::vector<uint64_t> &counts = histogram->counts();
+                for (size_t i = 0; i < counts.size(); i++) {
+                    /// The last bin is open ended
+                    std::fprintf(f, "%s,%llu,%s,%llu\n", name,
+                                 static_cast<unsigned long long>(i * histogram->bin_us()),
+                                 i + 1 < counts.size() ? std::to_string((i + 1) * histogram->bin_us()).c_str() : "",
+                                 static_cast<unsigned long long>(counts[i]));
+                }
+            }
+        }
+        ok = csv.close() && ok;
+    }
+    {
+        CsvFile csv(directory + "/tracking.csv");
+        if (FILE *f = csv.get()) {
+            std::fprintf(f, "mode,samples,rms_horizontal_m,max_horizontal_m,rms_vertical_m,max_vertical_m,"
+                            "rms_velocity_m_s\n");
+            for (int i = 0; i < MODE_COUNT; i++) {
+                const TrackingStats &t = stats.tracking[i];
+                std::fprintf(f, "%s,%llu,%.4f,%.4f,%.4f,%.4f,%.4f\n", MODE_NAMES[i],
+                             static_cast<unsigned long long>(t.samples), t.rms_horizontal, t.max_horizontal,
+                             t.rms_vertical, t.max_vertical, t.rms_velocity);
+            }
+        }
+        ok = csv.close() && ok;
+    }
+    {
+        CsvFile csv(directory + "/modes.csv");
+        if (FILE *f = csv.get()) {
+            std::fprintf(f, "start_us,end_us,duration_s,mode,event\n");
+            for (const ModeSpan &span : stats.modes) {
+                std::fprintf(f, "%llu,%llu,%.3f,%s,%s\n", static_cast<unsigned long long>(span.start),
+                             static_cast<unsigned long long>(span.end), (span.end - span.start) * 1e-6,
+                             mode_name(span.mode), event_name(span.event));
+            }
+        }
+        ok = csv.close() && ok;
+    }
+    return ok;
+}
+
+bool write_tables_csv(const std::vector<TableRef> &tables, const std::string &directory) {
+    bool ok = true;
+    for (const TableRef &table : tables) {
+        CsvFile csv(directory + "/" + table.name + ".csv");
+        FILE *f = csv.get();
+        if (!f) {
+            ok = false;
+            continue;
+        }
+        for (size_t c = 0; c < table.columns.size(); c++) {
+            std::fprintf(f, c ? ",%s" : "%s", table.columns[c].name);
+        }
+        std::fputc('\n', f);
+        /// to_chars, shortest round trip and much faster than printf
+        char line[1024];
+        for (size_t row = 0; row < table.rows; row++) {
+            char *end = line;
+            char *const last = line + sizeof(line);
+            for (size_t c = 0; c < table.columns.size(); c++) {
+                const ColumnRef &column = table.columns[c];
+                if (c) {
+                    *end++ = ',';
+                }
+                switch (column.type) {
+                    case ColumnType::U8:
+                        end = std::to_chars(end, last, static_cast<const uint8_t*>(column.data)[row]).ptr;
+                        break;
+                    case ColumnType::U32:
+                        end = std::to_chars(end, last, static_cast<const uint32_t*>(column.data)[row]).ptr;
+                        break;
+                    case ColumnType::U64:
+                        end = std::to_chars(end, last, static_cast<const uint64_t*>(column.data)[row]).ptr;
+                        break;
+                    case ColumnType::F32:
+                        end = std::to_chars(end, last, static_cast<const float*>(column.data)[row]).ptr;
+                        break;
+                    case ColumnType::F64:
+                        end = std::to_chars(end, last, static_cast<const double*>(column.data)[row]).ptr;
+                        break;
+                }
+            }
+            *end++ = '\n';
+            std::fwrite(line, 1, end - line, f);
+        }
+        ok = csv.close() && ok;
+    }
+    return ok;
+}
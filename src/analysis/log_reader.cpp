@@ -0,0 +1,661 @@
+/**
+ * @file log_reader.cpp
+ * @author Abdulelah Mulla
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <unordered_map>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "analysis/log_reader.h"
+#include "analysis/column_reader.h"
+#include "telemetry/log_store.h"
+#include "log_segments.h"
+#include "flight_recorder.h"
+#include "actuator.h"
+#include "position.h"
+#include "vehicle_state.h"
+#include "health_monitor.h"
+#include "mode_manager.h"
+
+/**
+ * @brief What a topic is split into.
+ */
+enum class TopicKind : uint8_t {
+    OTHER,
+    STATE,
+    SETPOINT,
+    ACTUATORS,
+    LOOP,
+    MODE
+};
+
+static TopicKind topic_kind(const std::string &type) {
+    if (type == recorded_type::VEHICLE_STATE) {
+        return TopicKind::STATE;
+    }
+    if (type == recorded_type::POSITION_SETPOINT) {
+        return TopicKind::SETPOINT;
+    }
+    if (type == recorded_type::ACTUATOR_CONTROLS) {
+        return TopicKind::ACTUATORS;
+    }
+    if (type == recorded_type::CONTROL_LOOP_STATS) {
+        return TopicKind::LOOP;
+    }
+    if (type == recorded_type::MODE_CHANGE) {
+        return TopicKind::MODE;
+    }
+    return TopicKind::OTHER;
+}
+
+/**
+ * @brief A mapped segment and its blocks, or its chunks if COLUMNAR.
+ */
+struct Segment {
+    MappedFile file;
+    LogCodec codec{LogCodec::NONE};
+    std::vector<LogBlockIndex> blocks;
+
+    bool columnar{false};
+    ColumnarSegment chunks;
+};
+
+/**
+ * @brief Decodes blocks into one LogColumns, one per thread.
+ */
+class BlockDecoder {
+private:
+    LogColumns &_columns;
+
+    /// Topics of _columns, by label '\0' type
+    std::unordered_map<std::string, size_t> _series;
+
+    /// Topics of the block being decoded, by id
+    struct Slot {
+        size_t series;
+        TopicKind kind;
+        bool known;
+    };
+    Slot _slots[UINT8_MAX + 1]{};
+
+    /// Decompressed block, reused
+    std::vector<uint8_t> _raw;
+
+    void add_topic(uint8_t id, const uint8_t *payload, uint32_t size);
+    void add_record(const LogRecordHeader &record, const uint8_t *payload);
+public:
+    explicit BlockDecoder(LogColumns &columns) : _columns(columns) {}
+
+    void decode(const Segment &segment, const LogBlockIndex &block);
+
+    /// Append the columns of a columnar segment, read in between blocks
+    void merge(LogColumns &&later);
+};
+
+void BlockDecoder::add_topic(uint8_t id, const uint8_t *payload, uint32_t size) {
+    const std::string key(reinterpret_cast<const char*>(payload), size);
+    auto it = _series.find(key);
+    if (it == _series.end()) {
+        TopicSeries series;
+        const size_t split = key.find('\0');
+        series.label = key.substr(0, split);
+        series.type = split == std::string::npos ? std::string() : key.substr(split + 1);
+        _columns.topics.push_back(std::move(series));
+        it = _series.emplace(key, _columns.topics.size() - 1).first;
+    }
+    _slots[id] = {it->second, topic_kind(_columns.topics[it->second].type), true};
+}
+
+template<typename T>
+static bool load(const LogRecordHeader &record, const uint8_t *payload, T &msg) {
+    if (record.size != sizeof(T)) {
+        return false;
+    }
+    std::memcpy(&msg, payload, sizeof(T));
+    return true;
+}
+
+void BlockDecoder::add_record(const LogRecordHeader &record, const uint8_t *payload) {
+    const Slot &slot = _slots[record.topic];
+    if (!slot.known) {
+        _columns.bad_records++;
+        return;
+    }
+    TopicSeries &series = _columns.topics[slot.series];
+    series.time.push_back(record.time);
+    series.bytes += record.size;
+    _columns.records++;
+
+    bool loaded = true;
+    switch (slot.kind) {
+        case TopicKind::STATE: {
+            VehicleState state;
+            if ((loaded = load(record, payload, state))) {
+                StateColumns &c = _columns.state;
+                c.time.push_back(record.time);
+                c.x.push_back(state.position[0]);
+                c.y.push_back(state.position[1]);
+                c.z.push_back(state.position[2]);
+                c.vx.push_back(state.velocity[0]);
+                c.vy.push_back(state.velocity[1]);
+                c.vz.push_back(state.velocity[2]);
+                c.lat.push_back(state.lat);
+                c.lon.push_back(state.lon);
+                c.alt.push_back(state.alt);
+                c.global_valid.push_back(state.global_valid);
+            }
+            break;
+        }
+        case TopicKind::SETPOINT: {
+            Position setpoint;
+            if ((loaded = load(record, payload, setpoint))) {
+                SetpointColumns &c = _columns.setpoint;
+                c.time.push_back(record.time);
+                c.lat.push_back(setpoint.lat);
+                c.lon.push_back(setpoint.lon);
+                c.alt.push_back(setpoint.alt);
+                c.vx.push_back(setpoint.vx);
+                c.vy.push_back(setpoint.vy);
+                c.vz.push_back(setpoint.vz);
+            }
+            break;
+        }
+        case TopicKind::ACTUATORS: {
+            ActuatorControls controls;
+            if ((loaded = load(record, payload, controls))) {
+                ActuatorColumns &c = _columns.actuators;
+                c.time.push_back(record.time);
+                c.stamp_ns.push_back(controls.timestamp);
+                c.origin_ns.push_back(controls.trace.origin_ns);
+                c.roll.push_back(controls.roll);
+                c.pitch.push_back(controls.pitch);
+                c.yaw.push_back(controls.yaw);
+                c.thrust.push_back(controls.thrust);
+            }
+            break;
+        }
+        case TopicKind::LOOP: {
+            ControlLoopStats stats;
+            if ((loaded = load(record, payload, stats))) {
+                LoopColumns &c = _columns.loop;
+                c.time.push_back(record.time);
+                c.cycles.push_back(stats.cycles);
+                c.overruns.push_back(stats.overruns);
+                c.max_cycle_us.push_back(stats.max_cycle_us);
+            }
+            break;
+        }
+        case TopicKind::MODE: {
+            ModeChange change;
+            if ((loaded = load(record, payload, change))) {
+                ModeColumns &c = _columns.modes;
+                c.time.push_back(record.time);
+                c.from.push_back(static_cast<uint8_t>(change.from));
+                c.to.push_back(static_cast<uint8_t>(change.to));
+                c.event.push_back(static_cast<uint8_t>(change.event));
+            }
+            break;
+        }
+        case TopicKind::OTHER:
+            break;
+    }
+    if (!loaded) {
+        /// Logged by a build with another layout
+        _columns.bad_records++;
+    }
+}
+
+void BlockDecoder::decode(const Segment &segment, const LogBlockIndex &block) {
+    _columns.blocks++;
+    const uint8_t *data = segment.file.data() + block.offset + sizeof(LogBlockHeader);
+    const uint8_t *raw = data;
+    if (block.size != block.raw_size) {
+        _raw.resize(block.raw_size);
+        if (!SegmentedLog::decompress(segment.codec, data, block.size, _raw.data(), _raw.size())) {
+            _columns.bad_blocks++;
+            return;
+        }
+        raw = _raw.data();
+    }
+
+    /// Every block names its topics again
+    for (Slot &slot : _slots) {
+        slot.known = false;
+    }
+    size_t offset = 0;
+    while (offset + sizeof(LogRecordHeader) <= block.raw_size) {
+        LogRecordHeader record;
+        std::memcpy(&record, raw + offset, sizeof(record));
+        offset += sizeof(record);
+        if (record.size > block.raw_size - offset) {
+            break;
+        }
+        const uint8_t *payload = raw + offset;
+        offset += record.size;
+        if (record.kind == LogRecordKind::TOPIC) {
+            add_topic(record.topic, payload, record.size);
+        } else if (record.kind == LogRecordKind::DATA) {
+            add_record(record, payload);
+        }
+    }
+    if (offset != block.raw_size) {
+        _columns.bad_blocks++;
+    }
+}
+
+void BlockDecoder::merge(LogColumns &&later) {
+    const size_t known = _columns.topics.size();
+    _columns.append(std::move(later));
+    for (size_t i = known; i < _columns.topics.size(); i++) {
+        _series.emplace(_columns.topics[i].label + '\0' + _columns.topics[i].type, i);
+    }
+}
+
+/// Read the field of a topic the tables need, by name
+template<typename T>
+static bool read_named(ColumnarSegment &segment, int topic, const char *name, std::vector<T> &values) {
+    return segment.read_field(topic, segment.find_field(topic, name), 0, UINT64_MAX, values);
+}
+
+/**
+ * @brief Read the columns of a COLUMNAR segment.
+ *
+ * Fields are found by the names FlightRecorder gives them. A topic
+ * missing one, or with a bad chunk, counts its records as bad.
+ */
+static LogColumns read_columnar(ColumnarSegment &segment) {
+    LogColumns columns;
+    for (const LogChunkIndex &chunk : segment.chunks()) {
+        if (chunk.header.kind == LogChunkKind::TIME) {
+            columns.blocks++;
+        }
+    }
+    for (size_t id = 0; id < segment.topics().size(); id++) {
+        const ColumnarTopic &topic = segment.topics()[id];
+        const int t = static_cast<int>(id);
+        TopicSeries series;
+        series.label = topic.label;
+        series.type = topic.type;
+        if (series.label.empty() || !segment.read_times(t, 0, UINT64_MAX, series.time)) {
+            continue;
+        }
+        for (const LogChunkIndex &chunk : segment.chunks()) {
+            const LogChunkKind payload = topic.keep_payload ? LogChunkKind::PAYLOAD : LogChunkKind::FIELD;
+            if (chunk.header.topic == id && chunk.header.kind == payload) {
+                series.bytes += chunk.header.raw_size;
+            }
+        }
+        const std::vector<uint64_t> &time = series.time;
+        columns.records += time.size();
+
+        bool ok = true;
+        switch (topic_kind(topic.type)) {
+            case TopicKind::STATE: {
+                StateColumns c;
+                c.time = time;
+                ok = read_named(segment, t, "x", c.x) && read_named(segment, t, "y", c.y) &&
+                     read_named(segment, t, "z", c.z) && read_named(segment, t, "vx", c.vx) &&
+                     read_named(segment, t, "vy", c.vy) && read_named(segment, t, "vz", c.vz) &&
+                     read_named(segment, t, "lat", c.lat) && read_named(segment, t, "lon", c.lon) &&
+                     read_named(segment, t, "alt", c.alt) && read_named(segment, t, "global_valid", c.global_valid);
+                if (ok) {
+                    columns.state = std::move(c);
+                }
+                break;
+            }
+            case TopicKind::SETPOINT: {
+                SetpointColumns c;
+                c.time = time;
+                ok = read_named(segment, t, "lat", c.lat) && read_named(segment, t, "lon", c.lon) &&
+                     read_named(segment, t, "alt", c.alt) && read_named(segment, t, "vx", c.vx) &&
+                     read_named(segment, t, "vy", c.vy) && read_named(segment, t, "vz", c.vz);
+                if (ok) {
+                    columns.setpoint = std::move(c);
+                }
+                break;
+            }
+            case TopicKind::ACTUATORS: {
+                ActuatorColumns c;
+                c.time = time;
+                ok = read_named(segment, t, "timestamp", c.stamp_ns) &&
+                     read_named(segment, t, "origin_ns", c.origin_ns) && read_named(segment, t, "roll", c.roll) &&
+                     read_named(segment, t, "pitch", c.pitch) && read_named(segment, t, "yaw", c.yaw) &&
+                     read_named(segment, t, "thrust", c.thrust);
+                if (ok) {
+                    columns.actuators = std::move(c);
+                }
+                break;
+            }
+            case TopicKind::LOOP: {
+                LoopColumns c;
+                c.time = time;
+                ok = read_named(segment, t, "cycles", c.cycles) && read_named(segment, t, "overruns", c.overruns) &&
+                     read_named(segment, t, "max_cycle_us", c.max_cycle_us);
+                if (ok) {
+                    columns.loop = std::move(c);
+                }
+                break;
+            }
+            case TopicKind::MODE: {
+                ModeColumns c;
+                c.time = time;
+                ok = read_named(segment, t, "from", c.from) && read_named(segment, t, "to", c.to) &&
+                     read_named(segment, t, "event", c.event);
+                if (ok) {
+                    columns.modes = std::move(c);
+                }
+                break;
+            }
+            case TopicKind::OTHER:
+                break;
+        }
+        if (!ok) {
+            columns.bad_records += time.size();
+        }
+        columns.topics.push_back(std::move(series));
+    }
+    return columns;
+}
+
+/// Map a segment and list its blocks, or its chunks
+static bool open_segment(const std::string &path, Segment &segment) {
+    if (!segment.file.open(path) || segment.file.size() < sizeof(LogFileHeader)) {
+        return false;
+    }
+    LogFileHeader header;
+    std::memcpy(&header, segment.file.data(), sizeof(header));
+    if (std::memcmp(header.magic, "MITLLOG1", sizeof(header.magic)) != 0 || header.version != SegmentedLog::VERSION) {
+        return false;
+    }
+    if (header.layout == LogLayout::COLUMNAR) {
+        segment.file.close();
+        segment.columnar = true;
+        return segment.chunks.open(path);
+    }
+    if (header.layout != LogLayout::INTERLEAVED) {
+        return false;
+    }
+    segment.codec = header.codec;
+    const size_t file_size = segment.file.size();
+
+    /// A block is usable if it lies within the file and matches its header
+    auto valid = [&](const LogBlockIndex &block) {
+        if (block.offset > file_size || file_size - block.offset < sizeof(LogBlockHeader) ||
+            block.size > file_size - block.offset - sizeof(LogBlockHeader)) {
+            return false;
+        }
+        LogBlockHeader block_header;
+        std::memcpy(&block_header, segment.file.data() + block.offset, sizeof(block_header));
+        return block_header.size == block.size && block_header.raw_size == block.raw_size;
+    };
+
+    uint64_t end = sizeof(LogFileHeader);
+    MappedFile index;
+    if (index.open(path + ".idx") && index.size() >= sizeof(LogFileHeader)) {
+        const size_t count = (index.size() - sizeof(LogFileHeader)) / sizeof(LogBlockIndex);
+        segment.blocks.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            LogBlockIndex block;
+            std::memcpy(&block, index.data() + sizeof(LogFileHeader) + i * sizeof(block), sizeof(block));
+            if (block.offset != end || !valid(block)) {
+                break;
+            }
+            segment.blocks.push_back(block);
+            end = block.offset + sizeof(LogBlockHeader) + block.size;
+        }
+    }
+
+    /// No index, or blocks after it, walk the file
+    while (end + sizeof(LogBlockHeader) <= file_size) {
+        LogBlockHeader block_header;
+        std::memcpy(&block_header, segment.file.data() + end, sizeof(block_header));
+        const LogBlockIndex block{end, block_header.size, block_header.raw_size, 0, 0};
+        if (!valid(block)) {
+            break;
+        }
+        segment.blocks.push_back(block);
+        end += sizeof(LogBlockHeader) + block.size;
+    }
+    return true;
+}
+
+void LogColumns::append(LogColumns &&later) {
+    auto concat = [](auto &into, auto &from) {
+        if (into.empty()) {
+            into = std::move(from);
+        } else {
+            into.insert(into.end(), from.begin(), from.end());
+        }
+    };
+    for (TopicSeries &series : later.topics) {
+        auto it = std::find_if(topics.begin(), topics.end(), [&](const TopicSeries &topic) {
+            return topic.label == series.label && topic.type == series.type;
+        });
+        if (it == topics.end()) {
+            topics.push_back(std::move(series));
+        } else {
+            concat(it->time, series.time);
+            it->bytes += series.bytes;
+        }
+    }
+    concat(state.time, later.state.time);
+    concat(state.x, later.state.x);
+    concat(state.y, later.state.y);
+    concat(state.z, later.state.z);
+    concat(state.vx, later.state.vx);
+    concat(state.vy, later.state.vy);
+    concat(state.vz, later.state.vz);
+    concat(state.lat, later.state.lat);
+    concat(state.lon, later.state.lon);
+    concat(state.alt, later.state.alt);
+    concat(state.global_valid, later.state.global_valid);
+
+    concat(setpoint.time, later.setpoint.time);
+    concat(setpoint.lat, later.setpoint.lat);
+    concat(setpoint.lon, later.setpoint.lon);
+    concat(setpoint.alt, later.setpoint.alt);
+    concat(setpoint.vx, later.setpoint.vx);
+    concat(setpoint.vy, later.setpoint.vy);
+    concat(setpoint.vz, later.setpoint.vz);
+
+    concat(actuators.time, later.actuators.time);
+    concat(actuators.stamp_ns, later.actuators.stamp_ns);
+    concat(actuators.origin_ns, later.actuators.origin_ns);
+    concat(actuators.roll, later.actuators.roll);
+    concat(actuators.pitch, later.actuators.pitch);
+    concat(actuators.yaw, later.actuators.yaw);
+    concat(actuators.thrust, later.actuators.thrust);
+
+    concat(loop.time, later.loop.time);
+    concat(loop.cycles, later.loop.cycles);
+    concat(loop.overruns, later.loop.overruns);
+    concat(loop.max_cycle_us, later.loop.max_cycle_us);
+
+    concat(modes.time, later.modes.time);
+    concat(modes.from, later.modes.from);
+    concat(modes.to, later.modes.to);
+    concat(modes.event, later.modes.event);
+
+    blocks += later.blocks;
+    records += later.records;
+    bad_blocks += later.bad_blocks;
+    bad_records += later.bad_records;
+}
+
+std::vector<TableRef> column_tables(const LogColumns &columns) {
+    const StateColumns &s = columns.state;
+    const SetpointColumns &p = columns.setpoint;
+    const ActuatorColumns &a = columns.actuators;
+    const LoopColumns &l = columns.loop;
+    const ModeColumns &m = columns.modes;
+    return {
+        {"vehicle_state", s.time.size(), {
+            {"time_us", ColumnType::U64, s.time.data()},
+            {"x", ColumnType::F32, s.x.data()},
+            {"y", ColumnType::F32, s.y.data()},
+            {"z", ColumnType::F32, s.z.data()},
+            {"vx", ColumnType::F32, s.vx.data()},
+            {"vy", ColumnType::F32, s.vy.data()},
+            {"vz", ColumnType::F32, s.vz.data()},
+            {"lat", ColumnType::F64, s.lat.data()},
+            {"lon", ColumnType::F64, s.lon.data()},
+            {"alt", ColumnType::F64, s.alt.data()},
+            {"global_valid", ColumnType::U8, s.global_valid.data()}}},
+        {"position_setpoint", p.time.size(), {
+            {"time_us", ColumnType::U64, p.time.data()},
+            {"lat", ColumnType::F64, p.lat.data()},
+            {"lon", ColumnType::F64, p.lon.data()},
+            {"alt", ColumnType::F64, p.alt.data()},
+            {"vx", ColumnType::F32, p.vx.data()},
+            {"vy", ColumnType::F32, p.vy.data()},
+            {"vz", ColumnType::F32, p.vz.data()}}},
+        {"actuator_controls", a.time.size(), {
+            {"time_us", ColumnType::U64, a.time.data()},
+            {"stamp_ns", ColumnType::U64, a.stamp_ns.data()},
+            {"origin_ns", ColumnType::U64, a.origin_ns.data()},
+            {"roll", ColumnType::F32, a.roll.data()},
+            {"pitch", ColumnType::F32, a.pitch.data()},
+            {"yaw", ColumnType::F32, a.yaw.data()},
+            {"thrust", ColumnType::F32, a.thrust.data()}}},
+        {"control_loop", l.time.size(), {
+            {"time_us", ColumnType::U64, l.time.data()},
+            {"cycles", ColumnType::U64, l.cycles.data()},
+            {"overruns", ColumnType::U64, l.overruns.data()},
+            {"max_cycle_us", ColumnType::U32, l.max_cycle_us.data()}}},
+        {"mode_change", m.time.size(), {
+            {"time_us", ColumnType::U64, m.time.data()},
+            {"from", ColumnType::U8, m.from.data()},
+            {"to", ColumnType::U8, m.to.data()},
+            {"event", ColumnType::U8, m.event.data()}}}
+    };
+}
+
+std::vector<std::string> find_segments(const std::vector<std::string> &paths) {
+    std::vector<std::string> segments;
+    for (const std::string &path : paths) {
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0 || !S_ISDIR(st.st_mode)) {
+            segments.push_back(path);
+            continue;
+        }
+        std::vector<std::string> found;
+        if (DIR *dir = opendir(path.c_str())) {
+            while (dirent *entry = readdir(dir)) {
+                const std::string file = entry->d_name;
+                if (file.size() > 5 && file.compare(file.size() - 5, 5, ".mlog") == 0) {
+                    found.push_back(path + "/" + file);
+                }
+            }
+            closedir(dir);
+        }
+        /// Zero padded numbers sort by name
+        std::sort(found.begin(), found.end());
+        segments.insert(segments.end(), found.begin(), found.end());
+    }
+    return segments;
+}
+
+bool read_segment(const std::string &path, LogColumns &columns) {
+    Segment segment;
+    if (!open_segment(path, segment)) {
+        return false;
+    }
+    if (segment.columnar) {
+        columns.append(read_columnar(segment.chunks));
+        return true;
+    }
+    BlockDecoder decoder(columns);
+    for (const LogBlockIndex &block : segment.blocks) {
+        decoder.decode(segment, block);
+    }
+    return true;
+}
+
+LogColumns read_segments(const std::vector<std::string> &segments, unsigned threads,
+                         std::vector<std::string> *failed) {
+    /// Mapping is cheap, the blocks are read later
+    std::vector<Segment> opened(segments.size());
+    /// A columnar segment is read whole, as one block
+    static constexpr size_t WHOLE = SIZE_MAX;
+    struct BlockRef {
+        size_t segment;
+        size_t block;
+    };
+    auto raw_size = [&](const BlockRef &ref) {
+        const Segment &segment = opened[ref.segment];
+        if (ref.block != WHOLE) {
+            return static_cast<uint64_t>(segment.blocks[ref.block].raw_size);
+        }
+        uint64_t bytes = 0;
+        for (const LogChunkIndex &chunk : segment.chunks.chunks()) {
+            bytes += chunk.header.raw_size;
+        }
+        return bytes;
+    };
+    std::vector<BlockRef> blocks;
+    uint64_t total = 0;
+    for (size_t i = 0; i < segments.size(); i++) {
+        if (!open_segment(segments[i], opened[i])) {
+            if (failed) {
+                failed->push_back(segments[i]);
+            }
+            continue;
+        }
+        if (opened[i].columnar) {
+            blocks.push_back({i, WHOLE});
+            total += raw_size(blocks.back());
+        }
+        for (size_t b = 0; b < opened[i].blocks.size(); b++) {
+            blocks.push_back({i, b});
+            total += opened[i].blocks[b].raw_size;
+        }
+    }
+
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = static_cast<unsigned>(std::min<size_t>(threads, std::max<size_t>(blocks.size(), 1)));
+
+    /// Runs of consecutive blocks with about the same raw bytes
+    std::vector<size_t> starts{0};
+    uint64_t bytes = 0;
+    for (size_t i = 0; i < blocks.size() && starts.size() < threads; i++) {
+        bytes += raw_size(blocks[i]);
+        if (bytes * threads >= total * starts.size()) {
+            starts.push_back(i + 1);
+        }
+    }
+    starts.push_back(blocks.size());
+
+    std::vector<LogColumns> parts(starts.size() - 1);
+    auto decode_run = [&](size_t run) {
+        BlockDecoder decoder(parts[run]);
+        for (size_t i = starts[run]; i < starts[run + 1]; i++) {
+            Segment &segment = opened[blocks[i].segment];
+            if (blocks[i].block == WHOLE) {
+                decoder.merge(read_columnar(segment.chunks));
+            } else {
+                decoder.decode(segment, segment.blocks[blocks[i].block]);
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    for (size_t run = 1; run < parts.size(); run++) {
+        workers.emplace_back(decode_run, run);
+    }
+    decode_run(0);
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+
+    LogColumns columns;
+    for (LogColumns &part : parts) {
+        columns.append(std::move(part));
+    }
+    return columns;
+}
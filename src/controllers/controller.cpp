@@ -3,4 +3,281 @@
  * @author Abdulelah Mulla
  */
 
-#include "controllers/controller.h"
\ No newline at end of file
+#include <algorithm>
+#include <cmath>
+
+#include "controllers/controller.h"
+#include "geodesy.h"
+#include "mode/mode_change.h"
+#include "rate_groups.h"
+#include "watchdog.h"
+#include "morb.h"
+#include "trace.h"
+#include "log.h"
+
+Controller::Controller(Morb *morb) :
+    _morb(morb)
+{
+    _morb->subscribe<VehicleState>("vehicle_state", [this](const VehicleState &state) {
+        _state.store(state);
+    });
+    /// Both from the control thread
+    _morb->subscribe<Position>("position_setpoint", [this](const Position &setpoint) {
+        _position_setpoint.store(setpoint);
+        _flying.store(true, std::memory_order_release);
+    });
+    _morb->subscribe<ModeChange>("mode_change", [this](const ModeChange &change) {
+        if (change.to == ModeId::READY) {
+            _flying.store(false, std::memory_order_release);
+        }
+    });
+    MITL_LOG::initialize().program_log("[Controller] Initialized Controller");
+}
+
+Controller::~Controller() {
+    stop();
+}
+
+void Controller::start() {
+    if (_running.load()) {
+        return;
+    }
+    _running.store(true);
+    _rate_thread = ThreadFactory::initialize().spawn(MitlThread::RATE, [this] {rate_loop();});
+    _attitude_thread = ThreadFactory::initialize().spawn(MitlThread::ATTITUDE, [this] {attitude_loop();});
+}
+
+void Controller::stop() {
+    if (!_running.load()) {
+        return;
+    }
+    _running.store(false);
+    if (_rate_thread.joinable()) {
+        _rate_thread.join();
+    }
+    if (_attitude_thread.joinable()) {
+        _attitude_thread.join();
+    }
+}
+
+void Controller::rate_loop() {
+    RateGroups &groups = RateGroups::initialize();
+    Watchdog &watchdog = Watchdog::initialize();
+    while (_running.load()) {
+        if (!groups.wait(RateGroup::RATE, LOOP_WAIT)) {
+            /// No IMU, nothing to control
+            continue;
+        }
+        const uint64_t start = groups.begin(RateGroup::RATE);
+        watchdog.stage(MitlThread::RATE, "rate law");
+        rate_update();
+        groups.end(RateGroup::RATE, start);
+    }
+}
+
+void Controller::attitude_loop() {
+    RateGroups &groups = RateGroups::initialize();
+    Watchdog &watchdog = Watchdog::initialize();
+    watchdog.watch(MitlThread::ATTITUDE, ATTITUDE_DEADLINE);
+    while (_running.load()) {
+        if (!groups.wait(RateGroup::ATTITUDE, LOOP_WAIT)) {
+            /// No IMU, nothing to control
+            continue;
+        }
+        const uint64_t start = groups.begin(RateGroup::ATTITUDE);
+        watchdog.stage(MitlThread::ATTITUDE, "attitude law");
+        attitude_update();
+        groups.end(RateGroup::ATTITUDE, start);
+    }
+    watchdog.unwatch(MitlThread::ATTITUDE);
+}
+
+/// Hamilton product, w x y z
+static void quat_multiply(const float *a, const float *b, float *out) {
+    out[0] = a[0] * b[0] - a[1] * b[1] - a[2] * b[2] - a[3] * b[3];
+    out[1] = a[0] * b[1] + a[1] * b[0] + a[2] * b[3] - a[3] * b[2];
+    out[2] = a[0] * b[2] - a[1] * b[3] + a[2] * b[0] + a[3] * b[1];
+    out[3] = a[0] * b[3] + a[1] * b[2] - a[2] * b[1] + a[3] * b[0];
+}
+
+/// Quaternion of a rotation matrix, columns are the body axes in NED
+static void quat_from_axes(const float *x, const float *y, const float *z, float *q) {
+    const float trace = x[0] + y[1] + z[2];
+    if (trace > 0.f) {
+        const float s = 2.f * std::sqrt(trace + 1.f);
+        q[0] = 0.25f * s;
+        q[1] = (y[2] - z[1]) / s;
+        q[2] = (z[0] - x[2]) / s;
+        q[3] = (x[1] - y[0]) / s;
+    } else if (x[0] > y[1] && x[0] > z[2]) {
+        const float s = 2.f * std::sqrt(1.f + x[0] - y[1] - z[2]);
+        q[0] = (y[2] - z[1]) / s;
+        q[1] = 0.25f * s;
+        q[2] = (y[0] + x[1]) / s;
+        q[3] = (z[0] + x[2]) / s;
+    } else if (y[1] > z[2]) {
+        const float s = 2.f * std::sqrt(1.f + y[1] - x[0] - z[2]);
+        q[0] = (z[0] - x[2]) / s;
+        q[1] = (y[0] + x[1]) / s;
+        q[2] = 0.25f * s;
+        q[3] = (z[1] + y[2]) / s;
+    } else {
+        const float s = 2.f * std::sqrt(1.f + z[2] - x[0] - y[1]);
+        q[0] = (x[1] - y[0]) / s;
+        q[1] = (z[0] + x[2]) / s;
+        q[2] = (z[1] + y[2]) / s;
+        q[3] = 0.25f * s;
+    }
+}
+
+static void cross(const float *a, const float *b, float *out) {
+    out[0] = a[1] * b[2] - a[2] * b[1];
+    out[1] = a[2] * b[0] - a[0] * b[2];
+    out[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+static void normalize(float *v) {
+    const float norm = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    for (int i = 0; i < 3; i++) {
+        v[i] /= norm;
+    }
+}
+
+/// Seconds from last to now, µs, 0 on the first step or after a gap
+static float step_dt(uint64_t last, uint64_t now, float max_dt) {
+    if (last == 0 || now <= last) {
+        return 0.f;
+    }
+    const float dt = static_cast<float>(now - last) * 1e-6f;
+    return dt <= max_dt ? dt : 0.f;
+}
+
+void Controller::attitude_update() {
+    if (_state.generation() == 0) {
+        return;
+    }
+    const VehicleState state = _state.load();
+    if (!flying() || _position_setpoint.generation() == 0 || !state.attitude_valid || !state.global_valid) {
+        std::fill(std::begin(_velocity_integral), std::end(_velocity_integral), 0.f);
+        _attitude_time = 0;
+        _rate_setpoint.store(RateSetpoint{});
+        return;
+    }
+    const Position setpoint = _position_setpoint.load();
+    const float dt = step_dt(_attitude_time, state.timestamp, MAX_DT);
+    _attitude_time = state.timestamp;
+
+    /// Position error, in a frame centered on the vehicle
+    const LocalFrame frame(state.lat, state.lon, state.alt);
+    float error[3];
+    frame.to_ned(setpoint.lat, setpoint.lon, setpoint.alt, error);
+
+    const float feed_velocity[3] = {setpoint.vx, setpoint.vy, setpoint.vz};
+    float velocity[3];
+    for (int i = 0; i < 3; i++) {
+        velocity[i] = POSITION_P[i] * error[i] + feed_velocity[i];
+    }
+    const float speed_xy = std::hypot(velocity[0], velocity[1]);
+    if (speed_xy > MAX_SPEED_XY) {
+        velocity[0] *= MAX_SPEED_XY / speed_xy;
+        velocity[1] *= MAX_SPEED_XY / speed_xy;
+    }
+    velocity[2] = std::clamp(velocity[2], -MAX_SPEED_UP, MAX_SPEED_DOWN);
+
+    /// Acceleration to fly, NED
+    const float feed_acceleration[3] = {setpoint.ax, setpoint.ay, setpoint.az};
+    float acceleration[3];
+    for (int i = 0; i < 3; i++) {
+        const float velocity_error = velocity[i] - state.velocity[i];
+        _velocity_integral[i] = std::clamp(_velocity_integral[i] + VELOCITY_I[i] * velocity_error * dt,
+                                           -VELOCITY_I_LIMIT, VELOCITY_I_LIMIT);
+        acceleration[i] = VELOCITY_P[i] * velocity_error + _velocity_integral[i] + feed_acceleration[i];
+    }
+
+    /// Specific force, thrust points along it. Keep some of it up, then limit the tilt.
+    float force[3] = {acceleration[0], acceleration[1], std::min(acceleration[2] - GRAVITY, -0.2f * GRAVITY)};
+    const float horizontal = std::hypot(force[0], force[1]);
+    const float max_horizontal = -force[2] * std::tan(MAX_TILT);
+    if (horizontal > max_horizontal) {
+        force[0] *= max_horizontal / horizontal;
+        force[1] *= max_horizontal / horizontal;
+    }
+    const float magnitude = std::sqrt(force[0] * force[0] + force[1] * force[1] + force[2] * force[2]);
+
+    /// Body down against the thrust, nose along the yaw setpoint
+    float z[3] = {-force[0] / magnitude, -force[1] / magnitude, -force[2] / magnitude};
+    float yaw = setpoint.yaw * static_cast<float>(M_PI) / 180.f;
+    if (!std::isfinite(yaw)) {
+        yaw = std::atan2(2.f * (state.q[0] * state.q[3] + state.q[1] * state.q[2]),
+                         1.f - 2.f * (state.q[2] * state.q[2] + state.q[3] * state.q[3]));
+    }
+    const float heading[3] = {std::cos(yaw), std::sin(yaw), 0.f};
+    float y[3], x[3];
+    cross(z, heading, y);
+    normalize(y);
+    cross(y, z, x);
+    float q_setpoint[4];
+    quat_from_axes(x, y, z, q_setpoint);
+
+    /// Error in the body frame, the short way round
+    const float q_inverse[4] = {state.q[0], -state.q[1], -state.q[2], -state.q[3]};
+    float q_error[4];
+    quat_multiply(q_inverse, q_setpoint, q_error);
+    const float sign = q_error[0] < 0.f ? -1.f : 1.f;
+
+    RateSetpoint rates{};
+    float *axes[3] = {&rates.roll, &rates.pitch, &rates.yaw};
+    for (int i = 0; i < 3; i++) {
+        *axes[i] = std::clamp(2.f * sign * ATTITUDE_P[i] * q_error[i + 1], -MAX_RATE[i], MAX_RATE[i]);
+    }
+    rates.thrust = std::clamp(magnitude / GRAVITY * HOVER_THRUST, MIN_THRUST, MAX_THRUST);
+    rates.valid = true;
+    _rate_setpoint.store(rates);
+}
+
+void Controller::rate_update() {
+    if (_state.generation() == 0) {
+        return;
+    }
+    const VehicleState state = _state.load();
+    const RateSetpoint setpoint = _rate_setpoint.load();
+    _controls.trace = state.trace;
+
+    const bool active = flying();
+    if (!active || !setpoint.valid || !state.attitude_valid) {
+        std::fill(std::begin(_rate_integral), std::end(_rate_integral), 0.f);
+        _rate_time = 0;
+        if (!_output_zero || active) {
+            /// Nothing to control, motors are left alone
+            return;
+        }
+        /// Back in READY, stop the motors once
+        _output_zero = false;
+        _controls.roll = 0.f;
+        _controls.pitch = 0.f;
+        _controls.yaw = 0.f;
+        _controls.thrust = 0.f;
+    } else {
+        const float dt = step_dt(_rate_time, state.timestamp, MAX_DT);
+        _rate_time = state.timestamp;
+        const float target[3] = {setpoint.roll, setpoint.pitch, setpoint.yaw};
+        float torque[3];
+        for (int i = 0; i < 3; i++) {
+            const float error = target[i] - state.rates[i];
+            const float derivative = dt > 0.f ? (state.rates[i] - _last_rates[i]) / dt : 0.f;
+            _last_rates[i] = state.rates[i];
+            torque[i] = std::clamp(RATE_P[i] * error + _rate_integral[i] - RATE_D[i] * derivative, -1.f, 1.f);
+            _rate_integral[i] = std::clamp(_rate_integral[i] + RATE_I[i] * error * dt, -RATE_I_LIMIT, RATE_I_LIMIT);
+        }
+        _output_zero = true;
+        _controls.roll = torque[0];
+        _controls.pitch = torque[1];
+        _controls.yaw = torque[2];
+        _controls.thrust = setpoint.thrust;
+    }
+
+    Trace::initialize().stage(_controls.trace, TraceStage::CONTROLLER);
+    _controls.timestamp = _controls.trace.last_ns;
+    Watchdog::initialize().stage(MitlThread::RATE, "actuator output");
+    _morb->publish<ActuatorControls>("actuator_controls", _controls);
+}
@@ -0,0 +1,200 @@
+/**
+ * @file mixer.cpp
+ * @author Abdulelah Mulla
+ *
+ * Desaturation logic derived from PX4, Copyright (c) 2021 PX4 Development Team
+ * Used under the BSD 3-Clause license.
+ */
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include "controllers/mixer.h"
+#include "log.h"
+
+/**
+ * Invert a 4x4 matrix in place with Gauss-Jordan elimination.
+ * Returns false if the matrix is singular.
+ */
+static bool invert4(float m[4][4]) {
+    float inv[4][4] = {{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}};
+    for (int col = 0; col < 4; col++) {
+        /// Partial pivoting
+        int pivot = col;
+        for (int row = col + 1; row < 4; row++) {
+            if (std::fabs(m[row][col]) > std::fabs(m[pivot][col])) {
+                pivot = row;
+            }
+        }
+        if (std::fabs(m[pivot][col]) < 1e-9f) {
+            return false;
+        }
+        std::swap(m[col], m[pivot]);
+        std::swap(inv[col], inv[pivot]);
+
+        const float scale = 1.f / m[col][col];
+        for (int k = 0; k < 4; k++) {
+            m[col][k] *= scale;
+            inv[col][k] *= scale;
+        }
+        for (int row = 0; row < 4; row++) {
+            if (row == col) {
+                continue;
+            }
+            const float factor = m[row][col];
+            for (int k = 0; k < 4; k++) {
+                m[row][k] -= factor * m[col][k];
+                inv[row][k] -= factor * inv[col][k];
+            }
+        }
+    }
+    std::copy(&inv[0][0], &inv[0][0] + 16, &m[0][0]);
+    return true;
+}
+
+Mixer::Mixer(const Rotor *rotors, int count, Airmode airmode) :
+    _rotor_count(std::min(count, MAX_ROTORS)),
+    _airmode(airmode)
+{
+    /// Effectiveness of each rotor on each axis, thrust coefficient factored out
+    float effectiveness[AXIS_COUNT][MAX_ROTORS]{};
+    for (int i = 0; i < _rotor_count; i++) {
+        effectiveness[ROLL][i] = -rotors[i].y;
+        effectiveness[PITCH][i] = rotors[i].x;
+        effectiveness[YAW][i] = rotors[i].km;
+        effectiveness[THRUST][i] = 1.f;
+    }
+
+    /// Pseudo-inverse: B^T (B B^T)^-1
+    float bbt[AXIS_COUNT][AXIS_COUNT]{};
+    for (int r = 0; r < AXIS_COUNT; r++) {
+        for (int c = 0; c < AXIS_COUNT; c++) {
+            for (int i = 0; i < _rotor_count; i++) {
+                bbt[r][c] += effectiveness[r][i] * effectiveness[c][i];
+            }
+        }
+    }
+    if (!invert4(bbt)) {
+        MITL_LOG::initialize().program_log("[Mixer] Rotor geometry is not controllable");
+        return;
+    }
+    for (int i = 0; i < _rotor_count; i++) {
+        for (int c = 0; c < AXIS_COUNT; c++) {
+            for (int r = 0; r < AXIS_COUNT; r++) {
+                _mix[i][c] += effectiveness[r][i] * bbt[r][c];
+            }
+        }
+    }
+
+    /// Normalize, roll and pitch share a scale so they keep the same gain
+    float max_rp = 0.f, max_yaw = 0.f, max_thrust = 0.f;
+    for (int i = 0; i < _rotor_count; i++) {
+        max_rp = std::max({max_rp, std::fabs(_mix[i][ROLL]), std::fabs(_mix[i][PITCH])});
+        max_yaw = std::max(max_yaw, std::fabs(_mix[i][YAW]));
+        max_thrust = std::max(max_thrust, _mix[i][THRUST]);
+    }
+    for (int i = 0; i < _rotor_count; i++) {
+        _mix[i][ROLL] *= max_rp > FLT_EPSILON ? 0.5f / max_rp : 0.f;
+        _mix[i][PITCH] *= max_rp > FLT_EPSILON ? 0.5f / max_rp : 0.f;
+        _mix[i][YAW] *= max_yaw > FLT_EPSILON ? 0.5f / max_yaw : 0.f;
+        _mix[i][THRUST] *= max_thrust > FLT_EPSILON ? 1.f / max_thrust : 0.f;
+    }
+}
+
+Mixer Mixer::x500(Airmode airmode) {
+    /// From the PX4 gz_x500 airframe, gazebo motor order
+    static const Rotor rotors[4] = {
+        { 0.13f,  0.22f,  0.05f},
+        {-0.13f, -0.20f,  0.05f},
+        { 0.13f, -0.22f, -0.05f},
+        {-0.13f,  0.20f, -0.05f},
+    };
+    return Mixer(rotors, 4, airmode);
+}
+
+float Mixer::desaturation_gain(const float *outputs, const float *vec, float max) const {
+    float k_min = 0.f;
+    float k_max = 0.f;
+    for (int i = 0; i < _rotor_count; i++) {
+        /// Avoid division by zero, if vec[i] is zero there is no way to unsaturate
+        if (std::fabs(vec[i]) < FLT_EPSILON) {
+            continue;
+        }
+        float k = 0.f;
+        if (outputs[i] < 0.f) {
+            k = -outputs[i] / vec[i];
+        } else if (outputs[i] > max) {
+            k = (max - outputs[i]) / vec[i];
+        } else {
+            continue;
+        }
+        k_min = std::min(k_min, k);
+        k_max = std::max(k_max, k);
+    }
+    /// Reduce the saturation as much as possible
+    return k_min + k_max;
+}
+
+void Mixer::desaturate(float *outputs, Axis axis, bool reduce_only, float max) const {
+    float vec[MAX_ROTORS];
+    for (int i = 0; i < _rotor_count; i++) {
+        vec[i] = _mix[i][axis];
+    }
+    float gain = desaturation_gain(outputs, vec, max);
+    if (reduce_only && gain > 0.f) {
+        return;
+    }
+    for (int i = 0; i < _rotor_count; i++) {
+        outputs[i] += gain * vec[i];
+    }
+    /// Half a second step to balance saturation between the upper and lower bound
+    gain = 0.5f * desaturation_gain(outputs, vec, max);
+    for (int i = 0; i < _rotor_count; i++) {
+        outputs[i] += gain * vec[i];
+    }
+}
+
+void Mixer::mix_yaw(float *outputs, float yaw) const {
+    for (int i = 0; i < _rotor_count; i++) {
+        outputs[i] += yaw * _mix[i][YAW];
+    }
+    /// Unsaturate with yaw only, allowing 15% headroom at the top
+    /// so there is some yaw response at full thrust
+    desaturate(outputs, YAW, false, 1.15f);
+    /// Then take the headroom back out of the thrust
+    desaturate(outputs, THRUST, true);
+}
+
+void Mixer::mix(const ActuatorControls &controls, float *outputs) const {
+    const bool with_yaw = _airmode == Airmode::ROLL_PITCH_YAW;
+    for (int i = 0; i < _rotor_count; i++) {
+        outputs[i] = controls.roll * _mix[i][ROLL] +
+                     controls.pitch * _mix[i][PITCH] +
+                     controls.thrust * _mix[i][THRUST] +
+                     (with_yaw ? controls.yaw * _mix[i][YAW] : 0.f);
+    }
+
+    switch (_airmode) {
+        case Airmode::DISABLED:
+            desaturate(outputs, THRUST, true);
+            desaturate(outputs, ROLL, false);
+            desaturate(outputs, PITCH, false);
+            mix_yaw(outputs, controls.yaw);
+            break;
+
+        case Airmode::ROLL_PITCH:
+            desaturate(outputs, THRUST, false);
+            mix_yaw(outputs, controls.yaw);
+            break;
+
+        case Airmode::ROLL_PITCH_YAW:
+            desaturate(outputs, THRUST, false);
+            desaturate(outputs, YAW, false);
+            break;
+    }
+
+    for (int i = 0; i < _rotor_count; i++) {
+        outputs[i] = std::clamp(outputs[i], 0.f, 1.f);
+    }
+}
@@ -0,0 +1,64 @@
+/**
+ * @file estimator.cpp
+ * @author Abdulelah Mulla
+ */
+
+#include <algorithm>
+
+#include "estimator/estimator.h"
+#include "log.h"
+
+Estimator::Estimator(Morb *morb) :
+    _morb(morb)
+{
+    _morb->subscribe<SensorOdometry>("sensor_odometry", [this](const SensorOdometry &odometry) {
+        _odometry.store(odometry);
+    });
+    _morb->subscribe<SensorGps>("sensor_gps", [this](const SensorGps &gps) {
+        _gps.store(gps);
+    });
+    _morb->subscribe<SensorImu>("sensor_imu", [this](const SensorImu &imu) {
+        imu_update(imu);
+    });
+    MITL_LOG::initialize().program_log("[Estimator] Initialized Estimator");
+}
+
+void Estimator::imu_update(const SensorImu &imu) {
+    TraceContext trace = imu.trace;
+    Trace::initialize().stage(trace, TraceStage::BUS);
+
+    _state.timestamp = imu.timestamp;
+    std::copy(imu.accel, imu.accel + 3, _state.accel);
+    std::copy(imu.gyro, imu.gyro + 3, _state.rates);
+
+    if (_odometry.generation() > 0) {
+        const SensorOdometry odometry = _odometry.load();
+        std::copy(odometry.q, odometry.q + 4, _state.q);
+        std::copy(odometry.position, odometry.position + 3, _state.position);
+        std::copy(odometry.velocity, odometry.velocity + 3, _state.velocity);
+        _state.attitude_valid = true;
+        _state.local_valid = true;
+    }
+    if (_gps.generation() > 0 && !_origin_set) {
+        const SensorGps gps = _gps.load();
+        _state.lat = gps.lat;
+        _state.lon = gps.lon;
+        _state.alt = gps.alt;
+        _state.global_valid = true;
+        if (_state.local_valid) {
+            /// Walk back from the fix to the local origin
+            const float back[3] = {-_state.position[0], -_state.position[1], -_state.position[2]};
+            double lat, lon, alt;
+            LocalFrame(gps.lat, gps.lon, gps.alt).to_global(back, lat, lon, alt);
+            _origin = LocalFrame(lat, lon, alt);
+            _origin_set = true;
+        }
+    }
+    if (_origin_set) {
+        _origin.to_global(_state.position, _state.lat, _state.lon, _state.alt);
+    }
+
+    Trace::initialize().stage(trace, TraceStage::ESTIMATOR);
+    _state.trace = trace;
+    _morb->publish<VehicleState>("vehicle_state", _state);
+}
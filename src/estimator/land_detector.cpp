@@ -0,0 +1,148 @@
+/**
+ * @file land_detector.cpp
+ * @author Abdulelah Mulla
+ */
+
+#include <cmath>
+
+#include "estimator/land_detector.h"
+#include "morb.h"
+#include "log.h"
+
+bool Hysteresis::update(bool input, uint64_t now) {
+    if (input == _state) {
+        _pending = false;
+        return _state;
+    }
+    if (!_pending) {
+        _pending = true;
+        _since = now;
+    }
+    const uint64_t hold = input ? _true_time : _false_time;
+    if (now - _since >= hold) {
+        _state = input;
+        _pending = false;
+    }
+    return _state;
+}
+
+LandDetector::LandDetector(Morb *morb) :
+    _morb(morb)
+{
+    _morb->subscribe<ActuatorControls>("actuator_controls", [this](const ActuatorControls &controls) {
+        _thrust.store(controls.thrust, std::memory_order_relaxed);
+        _has_thrust.store(true, std::memory_order_relaxed);
+    });
+    _morb->subscribe<SensorBaro>("sensor_baro", [this](const SensorBaro &baro) {
+        baro_update(baro);
+    });
+    _morb->subscribe<VehicleState>("vehicle_state", [this](const VehicleState &state) {
+        update(state);
+    });
+    MITL_LOG::initialize().program_log("[LandDetector] Initialized LandDetector");
+}
+
+float LandDetector::pressure_altitude(float pressure_pa) {
+    return 44330.77f * (1.f - std::pow(pressure_pa / 101325.f, 0.190263f));
+}
+
+void LandDetector::baro_update(const SensorBaro &baro) {
+    _baro_alt[_baro_head] = pressure_altitude(baro.pressure_pa);
+    _baro_time[_baro_head] = baro.timestamp;
+    _baro_head = (_baro_head + 1) % BARO_WINDOW;
+    if (_baro_count < BARO_WINDOW) {
+        _baro_count++;
+    }
+    if (_baro_count < BARO_WINDOW / 2) {
+        return;
+    }
+
+    /// Least squares slope, times relative to the newest sample
+    const int newest = (_baro_head + BARO_WINDOW - 1) % BARO_WINDOW;
+    float st = 0, sh = 0, stt = 0, sth = 0;
+    for (int i = 0; i < _baro_count; i++) {
+        const float t = -static_cast<float>(_baro_time[newest] - _baro_time[i]) * 1e-6f;
+        const float h = _baro_alt[i] - _baro_alt[newest];
+        st += t;
+        sh += h;
+        stt += t * t;
+        sth += t * h;
+    }
+    const float n = static_cast<float>(_baro_count);
+    const float denominator = n * stt - st * st;
+    if (denominator <= 0.f) {
+        return;
+    }
+    _baro_rate.store((n * sth - st * sh) / denominator, std::memory_order_relaxed);
+    _baro_updated.store(baro.timestamp, std::memory_order_relaxed);
+}
+
+void LandDetector::update(const VehicleState &state) {
+    const uint64_t now = state.timestamp;
+    uint8_t votes = 0, available = 0;
+
+    if (state.local_valid) {
+        available |= LAND_VOTE_VERTICAL_SPEED;
+        if (std::fabs(state.velocity[2]) < VERTICAL_SPEED) {
+            votes |= LAND_VOTE_VERTICAL_SPEED;
+        }
+    }
+    if (_has_thrust.load(std::memory_order_relaxed)) {
+        available |= LAND_VOTE_THRUST;
+        if (_thrust.load(std::memory_order_relaxed) < LOW_THRUST) {
+            votes |= LAND_VOTE_THRUST;
+        }
+    }
+
+    /// Steady specific force, the airframe is not vibrating or bouncing
+    const float accel = std::sqrt(state.accel[0] * state.accel[0] + state.accel[1] * state.accel[1] +
+                                  state.accel[2] * state.accel[2]);
+    if (!_accel_init) {
+        _accel_mean = accel;
+        _accel_init = true;
+    }
+    const float deviation = accel - _accel_mean;
+    _accel_mean += ACCEL_ALPHA * deviation;
+    _accel_variance = (1.f - ACCEL_ALPHA) * (_accel_variance + ACCEL_ALPHA * deviation * deviation);
+    available |= LAND_VOTE_ACCEL;
+    if (_accel_variance < ACCEL_VARIANCE) {
+        votes |= LAND_VOTE_ACCEL;
+    }
+
+    const uint64_t baro_updated = _baro_updated.load(std::memory_order_relaxed);
+    if (baro_updated != 0 && (now < baro_updated || now - baro_updated < BARO_TIMEOUT)) {
+        available |= LAND_VOTE_BARO;
+        if (std::fabs(_baro_rate.load(std::memory_order_relaxed)) < BARO_RATE) {
+            votes |= LAND_VOTE_BARO;
+        }
+    }
+
+    /// Absent signals count as agreeing
+    const uint8_t agree = votes | static_cast<uint8_t>(~available);
+    const bool low_thrust = agree & LAND_VOTE_THRUST;
+    const bool not_descending = (votes & (LAND_VOTE_VERTICAL_SPEED | LAND_VOTE_BARO)) != 0;
+
+    int dissent = 0;
+    for (uint8_t vote : {LAND_VOTE_VERTICAL_SPEED, LAND_VOTE_ACCEL, LAND_VOTE_BARO}) {
+        dissent += (agree & vote) ? 0 : 1;
+    }
+
+    const bool ground_contact = _ground_contact.update(low_thrust && not_descending, now);
+    const bool maybe_landed = _maybe_landed.update(ground_contact && dissent <= 1, now);
+    const bool landed = _landed.update(maybe_landed && dissent == 0, now);
+
+    const bool changed = ground_contact != _detected.ground_contact ||
+                         maybe_landed != _detected.maybe_landed ||
+                         landed != _detected.landed;
+    _detected.timestamp = now;
+    _detected.ground_contact = ground_contact;
+    _detected.maybe_landed = maybe_landed;
+    _detected.landed = landed;
+    _detected.votes = votes;
+    _detected.available = available;
+
+    if (changed || _last_publish == 0 || now - _last_publish >= HEARTBEAT) {
+        _last_publish = now;
+        _morb->publish<LandDetected>("land_detected", _detected);
+    }
+}
@@ -0,0 +1,116 @@
+/**
+ * @file flight_recorder.cpp
+ * @author Abdulelah Mulla
+ */
+
+#include <cstddef>
+#include <string>
+
+#include "flight_recorder.h"
+#include "morb.h"
+#include "log.h"
+#include "scheduler.h"
+#include "actuator.h"
+#include "position.h"
+#include "vehicle_state.h"
+#include "health_monitor.h"
+#include "mode_manager.h"
+
+/// A field at an offset in its struct
+static LogField field(const char *name, LogFieldType type, size_t offset) {
+    return {name, type, static_cast<uint16_t>(offset)};
+}
+
+std::vector<LogField> recorded_fields(const char *type) {
+    using T = LogFieldType;
+    const std::string name(type);
+    if (name == recorded_type::VEHICLE_STATE) {
+        const size_t q = offsetof(VehicleState, q);
+        const size_t rates = offsetof(VehicleState, rates);
+        const size_t accel = offsetof(VehicleState, accel);
+        const size_t position = offsetof(VehicleState, position);
+        const size_t velocity = offsetof(VehicleState, velocity);
+        return {
+            field("timestamp", T::U64, offsetof(VehicleState, timestamp)),
+            field("q_w", T::F32, q), field("q_x", T::F32, q + 4), field("q_y", T::F32, q + 8),
+            field("q_z", T::F32, q + 12),
+            field("rate_x", T::F32, rates), field("rate_y", T::F32, rates + 4), field("rate_z", T::F32, rates + 8),
+            field("accel_x", T::F32, accel), field("accel_y", T::F32, accel + 4),
+            field("accel_z", T::F32, accel + 8),
+            field("x", T::F32, position), field("y", T::F32, position + 4), field("z", T::F32, position + 8),
+            field("vx", T::F32, velocity), field("vy", T::F32, velocity + 4), field("vz", T::F32, velocity + 8),
+            field("lat", T::F64, offsetof(VehicleState, lat)),
+            field("lon", T::F64, offsetof(VehicleState, lon)),
+            field("alt", T::F64, offsetof(VehicleState, alt)),
+            field("attitude_valid", T::U8, offsetof(VehicleState, attitude_valid)),
+            field("local_valid", T::U8, offsetof(VehicleState, local_valid)),
+            field("global_valid", T::U8, offsetof(VehicleState, global_valid))};
+    }
+    if (name == recorded_type::POSITION_SETPOINT) {
+        return {
+            field("lat", T::F64, offsetof(Position, lat)),
+            field("lon", T::F64, offsetof(Position, lon)),
+            field("alt", T::F64, offsetof(Position, alt)),
+            field("yaw", T::F32, offsetof(Position, yaw)),
+            field("vx", T::F32, offsetof(Position, vx)),
+            field("vy", T::F32, offsetof(Position, vy)),
+            field("vz", T::F32, offsetof(Position, vz)),
+            field("ax", T::F32, offsetof(Position, ax)),
+            field("ay", T::F32, offsetof(Position, ay)),
+            field("az", T::F32, offsetof(Position, az))};
+    }
+    if (name == recorded_type::ACTUATOR_CONTROLS) {
+        return {
+            field("timestamp", T::U64, offsetof(ActuatorControls, timestamp)),
+            field("roll", T::F32, offsetof(ActuatorControls, roll)),
+            field("pitch", T::F32, offsetof(ActuatorControls, pitch)),
+            field("yaw", T::F32, offsetof(ActuatorControls, yaw)),
+            field("thrust", T::F32, offsetof(ActuatorControls, thrust)),
+            field("origin_ns", T::U64, offsetof(ActuatorControls, trace) + offsetof(TraceContext, origin_ns))};
+    }
+    if (name == recorded_type::CONTROL_LOOP_STATS) {
+        return {
+            field("timestamp", T::U64, offsetof(ControlLoopStats, timestamp)),
+            field("cycles", T::U64, offsetof(ControlLoopStats, cycles)),
+            field("overruns", T::U64, offsetof(ControlLoopStats, overruns)),
+            field("max_cycle_us", T::U32, offsetof(ControlLoopStats, max_cycle_us))};
+    }
+    if (name == recorded_type::MODE_CHANGE) {
+        return {
+            field("timestamp", T::U64, offsetof(ModeChange, timestamp)),
+            field("from", T::U8, offsetof(ModeChange, from)),
+            field("to", T::U8, offsetof(ModeChange, to)),
+            field("event", T::U8, offsetof(ModeChange, event))};
+    }
+    return {};
+}
+
+FlightRecorder::FlightRecorder(Morb *morb) :
+    _morb(morb)
+{
+    for (const char *type : {recorded_type::VEHICLE_STATE, recorded_type::POSITION_SETPOINT,
+                             recorded_type::ACTUATOR_CONTROLS, recorded_type::CONTROL_LOOP_STATS,
+                             recorded_type::MODE_CHANGE}) {
+        MITL_LOG::initialize().describe(type, recorded_fields(type));
+    }
+    _morb->subscribe<VehicleState>("vehicle_state", [](const VehicleState &state) {
+        MITL_LOG::initialize().struct_log(state, "[Vehicle state]", recorded_type::VEHICLE_STATE,
+                                          Scheduler::initialize().get_time());
+    });
+    _morb->subscribe<Position>("position_setpoint", [](const Position &setpoint) {
+        MITL_LOG::initialize().struct_log(setpoint, "[Position setpoint]", recorded_type::POSITION_SETPOINT,
+                                          Scheduler::initialize().get_time());
+    });
+    _morb->subscribe<ActuatorControls>("actuator_controls", [](const ActuatorControls &controls) {
+        MITL_LOG::initialize().struct_log(controls, "[Actuator controls]", recorded_type::ACTUATOR_CONTROLS,
+                                          Scheduler::initialize().get_time());
+    });
+    _morb->subscribe<ControlLoopStats>("control_loop_stats", [](const ControlLoopStats &stats) {
+        MITL_LOG::initialize().struct_log(stats, "[Control loop]", recorded_type::CONTROL_LOOP_STATS,
+                                          Scheduler::initialize().get_time());
+    });
+    _morb->subscribe<ModeChange>("mode_change", [](const ModeChange &change) {
+        MITL_LOG::initialize().struct_log(change, "[Mode]", recorded_type::MODE_CHANGE, change.timestamp);
+    });
+    MITL_LOG::initialize().program_log("[FlightRecorder] Initialized FlightRecorder");
+}
@@ -5,18 +5,78 @@
 
 #include <string>
 #include <iostream>
+#include <cmath>
 
 #include "gazebo/gazebo_state.h" 
 #include "scheduler.h"
+#include "sensors.h"
+#include "trace.h"
 #include "log.h"
+#include "alloc_audit.h"
+#include "thread_factory.h"
+
+/**
+ * Gazebo works in ENU world and FLU body frames, mitl in NED and FRD.
+ */
+
+/// FLU to FRD, and back
+static void flu_to_frd(double x, double y, double z, float *out) {
+    out[0] = static_cast<float>(x);
+    out[1] = static_cast<float>(-y);
+    out[2] = static_cast<float>(-z);
+}
+
+/// ENU to NED, and back
+static void enu_to_ned(double x, double y, double z, float *out) {
+    out[0] = static_cast<float>(y);
+    out[1] = static_cast<float>(x);
+    out[2] = static_cast<float>(-z);
+}
+
+/// Hamilton product a * b, w x y z
+static void quat_mul(const double *a, const double *b, double *out) {
+    out[0] = a[0] * b[0] - a[1] * b[1] - a[2] * b[2] - a[3] * b[3];
+    out[1] = a[0] * b[1] + a[1] * b[0] + a[2] * b[3] - a[3] * b[2];
+    out[2] = a[0] * b[2] - a[1] * b[3] + a[2] * b[0] + a[3] * b[1];
+    out[3] = a[0] * b[3] + a[1] * b[2] - a[2] * b[1] + a[3] * b[0];
+}
+
+/// Rotate v by the unit quaternion q
+static void quat_rotate(const float *q, const float *v, float *out) {
+    const float w = q[0], x = q[1], y = q[2], z = q[3];
+    out[0] = (1 - 2 * (y * y + z * z)) * v[0] + 2 * (x * y - w * z) * v[1] + 2 * (x * z + w * y) * v[2];
+    out[1] = 2 * (x * y + w * z) * v[0] + (1 - 2 * (x * x + z * z)) * v[1] + 2 * (y * z - w * x) * v[2];
+    out[2] = 2 * (x * z - w * y) * v[0] + 2 * (y * z + w * x) * v[1] + (1 - 2 * (x * x + y * y)) * v[2];
+}
+
+/// Gazebo orientation (FLU body to ENU world) to FRD body to NED world
+static void orientation_to_ned(const gz::msgs::Quaternion &q_gz, float *out) {
+    static const double q_enu_to_ned[4] = {0.0, M_SQRT1_2, M_SQRT1_2, 0.0};
+    static const double q_frd_to_flu[4] = {0.0, 1.0, 0.0, 0.0};
+    const double gz[4] = {q_gz.w(), q_gz.x(), q_gz.y(), q_gz.z()};
+    double tmp[4], q[4];
+    quat_mul(q_enu_to_ned, gz, tmp);
+    quat_mul(tmp, q_frd_to_flu, q);
+    for (int i = 0; i < 4; i++) {
+        out[i] = static_cast<float>(q[i]);
+    }
+}
 
 /// Constructor
 GazeboState::GazeboState(Morb* morb, std::string world, std::string vehicle) :
     _morb(morb),
     _world(world),
-    _vehicle(vehicle) 
+    _vehicle(vehicle),
+    _monitor(morb),
+    _mixer(Mixer::x500())
     {
-
+        /// Size the message once, publish_actuator only overwrites it
+        for (int i = 0; i < _mixer.rotor_count(); i++) {
+            _actuator_msg.add_velocity(0.0);
+        }
+        _morb->subscribe<ActuatorControls>("actuator_controls", [this](const ActuatorControls &controls) {
+            publish_actuator(controls);
+        });
 }
 
 /// Destructor
@@ -94,58 +154,183 @@ void GazeboState::activate_subscriptions() {
     } else {
         MITL_LOG::initialize().program_log("[GazeboState] Subscribed to navsat topic");
     }
+    /// Motor speed
+    std::string motor_speed_string = "/" + _vehicle + "/command/motor_speed";
+    _actuator_pub = _node.Advertise<gz::msgs::Actuators>(motor_speed_string);
+    if (!_actuator_pub) {
+        std::cerr << "Error advertising motor speed topic" << std::endl;
+    } else {
+        MITL_LOG::initialize().program_log("[GazeboState] Advertised motor speed topic");
+    }
+}
+
+void GazeboState::publish_actuator(const ActuatorControls &controls) {
+    TraceContext trace = controls.trace;
+
+    _mixer.mix(controls, _motor_outputs);
+    for (int i = 0; i < _mixer.rotor_count(); i++) {
+        _actuator_msg.set_velocity(i, _motor_outputs[i] * MAX_ROTOR_SPEED);
+    }
+    Trace::initialize().stage(trace, TraceStage::MIXER);
+
+    /// Stamp with sim time
+    const uint64_t time = Scheduler::initialize().get_time();
+    _actuator_msg.mutable_header()->mutable_stamp()->set_sec(time / 1000000);
+    _actuator_msg.mutable_header()->mutable_stamp()->set_nsec((time % 1000000) * 1000);
+    {
+        /// gz-transport serializes into a new buffer
+        AllocAudit::Exempt exempt;
+        _actuator_pub.Publish(_actuator_msg);
+    }
+
+    Trace::initialize().stage(trace, TraceStage::PUBLISH);
+    Trace::initialize().record(trace.id, TraceStage::END_TO_END, trace.origin_ns, trace.last_ns);
+
+    /// Latency from the controller output
+    const uint64_t now = trace.last_ns;
+    if (controls.timestamp != 0 && now >= controls.timestamp) {
+        const uint64_t latency = now - controls.timestamp;
+        _latency_last_ns.store(latency, std::memory_order_relaxed);
+        _latency_total_ns.fetch_add(latency, std::memory_order_relaxed);
+        _latency_count.fetch_add(1, std::memory_order_relaxed);
+        if (latency > _latency_max_ns.load(std::memory_order_relaxed)) {
+            _latency_max_ns.store(latency, std::memory_order_relaxed);
+        }
+    }
 }
 
-void GazeboState::publish_actuator() {
+LatencyStats GazeboState::actuator_latency() const {
+    LatencyStats stats{};
+    stats.count = _latency_count.load(std::memory_order_relaxed);
+    stats.last_ns = _latency_last_ns.load(std::memory_order_relaxed);
+    stats.max_ns = _latency_max_ns.load(std::memory_order_relaxed);
+    stats.mean_ns = stats.count ? _latency_total_ns.load(std::memory_order_relaxed) / stats.count : 0;
+    return stats;
+}
 
+uint64_t GazeboState::stamp_us(const gz::msgs::Header &header) {
+    return (uint64_t)header.stamp().sec() * 1000000 + (uint64_t)(header.stamp().nsec() / 1000);
 }
 
-/// Callbacks
+/// Callbacks, on gz-transport threads, which the audit does not watch
 
 void GazeboState::clock_callback(const gz::msgs::Clock &msg) {
+    AllocAudit::Scope audit(MitlThread::RATE);
     /// Convert timespec to absolute time
     uint64_t time_mcs = (uint64_t)msg.sim().sec() * 1000000;
     time_mcs += (uint64_t)(msg.sim().nsec() / 1000);
     /// Set time
     Scheduler::initialize().set_time(time_mcs);
+    _monitor.record(SensorTopic::CLOCK, time_mcs);
 }
 
 void GazeboState::airspeed_callback(const gz::msgs::AirSpeed &msg) {
+    AllocAudit::Scope audit(MitlThread::RATE);
     uint64_t time = Scheduler::initialize().get_time();
+    _monitor.record(SensorTopic::AIRSPEED, stamp_us(msg.header()));
     MITL_LOG::initialize().sensor_log(msg, "[Airspeed]", time);
 }
 
 void GazeboState::air_pressure_callback(const gz::msgs::FluidPressure &msg) {
+    AllocAudit::Scope audit(MitlThread::RATE);
     uint64_t time = Scheduler::initialize().get_time();
+    _monitor.record(SensorTopic::AIR_PRESSURE, stamp_us(msg.header()));
+
+    SensorBaro baro{};
+    baro.timestamp = stamp_us(msg.header());
+    baro.pressure_pa = static_cast<float>(msg.pressure());
+    _morb->publish<SensorBaro>("sensor_baro", baro);
+
     MITL_LOG::initialize().sensor_log(msg, "[Air pressure]", time);
 }
 
 void GazeboState::imu_callback(const gz::msgs::IMU &msg) {
+    AllocAudit::Scope audit(MitlThread::RATE);
+    /// A new sample enters the control path here
+    SensorImu imu{};
+    imu.trace = Trace::initialize().begin();
+
     uint64_t time = Scheduler::initialize().get_time();
+    _monitor.record(SensorTopic::IMU, stamp_us(msg.header()));
+
+    imu.timestamp = stamp_us(msg.header());
+    flu_to_frd(msg.linear_acceleration().x(), msg.linear_acceleration().y(),
+               msg.linear_acceleration().z(), imu.accel);
+    flu_to_frd(msg.angular_velocity().x(), msg.angular_velocity().y(),
+               msg.angular_velocity().z(), imu.gyro);
+
+    Trace::initialize().stage(imu.trace, TraceStage::TRANSPORT);
+    _morb->publish<SensorImu>("sensor_imu", imu);
+
+    /// Log after the control path has run
     MITL_LOG::initialize().sensor_log(msg, "[IMU]", time);
 }
 
 void GazeboState::pose_info_callback(const gz::msgs::Pose_V &msg) {
+    AllocAudit::Scope audit(MitlThread::RATE);
     uint64_t time = Scheduler::initialize().get_time();
+    _monitor.record(SensorTopic::POSE, stamp_us(msg.header()));
     MITL_LOG::initialize().sensor_log(msg, "[Pose]", time);
 }
 
 void GazeboState::odometry_callback(const gz::msgs::OdometryWithCovariance &msg) {
+    AllocAudit::Scope audit(MitlThread::RATE);
     uint64_t time = Scheduler::initialize().get_time();
+    _monitor.record(SensorTopic::ODOMETRY, stamp_us(msg.header()));
+
+    const gz::msgs::Pose &pose = msg.pose_with_covariance().pose();
+    const gz::msgs::Twist &twist = msg.twist_with_covariance().twist();
+
+    SensorOdometry odometry{};
+    odometry.timestamp = stamp_us(msg.header());
+    enu_to_ned(pose.position().x(), pose.position().y(), pose.position().z(), odometry.position);
+    orientation_to_ned(pose.orientation(), odometry.q);
+    flu_to_frd(twist.angular().x(), twist.angular().y(), twist.angular().z(), odometry.rates);
+    /// The twist is in the body frame
+    float body_velocity[3];
+    flu_to_frd(twist.linear().x(), twist.linear().y(), twist.linear().z(), body_velocity);
+    quat_rotate(odometry.q, body_velocity, odometry.velocity);
+    _morb->publish<SensorOdometry>("sensor_odometry", odometry);
+
     MITL_LOG::initialize().sensor_log(msg, "[Odometry]", time);
 }
 
 void GazeboState::nav_sat_callback(const gz::msgs::NavSat &msg) {
+    AllocAudit::Scope audit(MitlThread::RATE);
     uint64_t time = Scheduler::initialize().get_time();
+    _monitor.record(SensorTopic::NAV_SAT, stamp_us(msg.header()));
+
+    SensorGps gps{};
+    gps.timestamp = stamp_us(msg.header());
+    gps.lat = msg.latitude_deg();
+    gps.lon = msg.longitude_deg();
+    gps.alt = msg.altitude();
+    enu_to_ned(msg.velocity_east(), msg.velocity_north(), msg.velocity_up(), gps.velocity);
+    _morb->publish<SensorGps>("sensor_gps", gps);
+
     MITL_LOG::initialize().sensor_log(msg, "[NAV SAT]", time);
 }
 
 void GazeboState::laser_scan_callback(const gz::msgs::LaserScan &msg) {
+    AllocAudit::Scope audit(MitlThread::RATE);
     uint64_t time = Scheduler::initialize().get_time();
+    _monitor.record(SensorTopic::LASER_SCAN, stamp_us(msg.header()));
     MITL_LOG::initialize().sensor_log(msg, "[Laser Scan]", time);
 }
 
 void GazeboState::mag_callback(const gz::msgs::Magnetometer &msg) {
+    AllocAudit::Scope audit(MitlThread::RATE);
     uint64_t time = Scheduler::initialize().get_time();
+    _monitor.record(SensorTopic::MAG, stamp_us(msg.header()));
+
+    SensorMag mag{};
+    mag.timestamp = stamp_us(msg.header());
+    flu_to_frd(msg.field_tesla().x(), msg.field_tesla().y(), msg.field_tesla().z(), mag.field);
+    /// Tesla to gauss
+    for (float &axis : mag.field) {
+        axis *= 1e4f;
+    }
+    _morb->publish<SensorMag>("sensor_mag", mag);
+
     MITL_LOG::initialize().sensor_log(msg, "[Magnetometer]", time);
 }
\ No newline at end of file
@@ -0,0 +1,134 @@
+/**
+ * @file sensor_monitor.cpp
+ * @author Abdulelah Mulla
+ */
+
+#include <chrono>
+#include <cmath>
+
+#include "gazebo/sensor_monitor.h"
+#include "morb.h"
+
+/// Constructor
+SensorMonitor::SensorMonitor(Morb *morb) :
+    _morb(morb)
+{
+    /// Nominal rates of the gz_x500 sensors
+    configure(SensorTopic::CLOCK, 250.f, true);
+    configure(SensorTopic::POSE, 50.f, false);
+    configure(SensorTopic::IMU, 250.f, true);
+    configure(SensorTopic::MAG, 100.f, true);
+    configure(SensorTopic::ODOMETRY, 100.f, true);
+    configure(SensorTopic::LASER_SCAN, 10.f, false);
+    configure(SensorTopic::AIRSPEED, 10.f, false);
+    configure(SensorTopic::AIR_PRESSURE, 50.f, true);
+    configure(SensorTopic::NAV_SAT, 10.f, true);
+}
+
+void SensorMonitor::configure(SensorTopic topic, float nominal_rate_hz, bool required) {
+    TopicState &state = _topics[static_cast<int>(topic)];
+    state.nominal_rate_hz = nominal_rate_hz;
+    state.required = required;
+}
+
+uint64_t SensorMonitor::wall_time_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void SensorMonitor::record(SensorTopic topic, uint64_t sim_us) {
+    record(topic, sim_us, wall_time_us());
+}
+
+void SensorMonitor::record(SensorTopic topic, uint64_t sim_us, uint64_t now_us) {
+    TopicState &state = _topics[static_cast<int>(topic)];
+
+    const uint64_t last_us = state.last_wall_us.load(std::memory_order_relaxed);
+    if (last_us == 0) {
+        /// First message, nothing to compare against yet
+        state.first_wall_us = now_us;
+        state.first_sim_us = sim_us;
+        state.mean_dt_us = 1e6f / state.nominal_rate_hz;
+    } else {
+        const float dt_us = static_cast<float>(now_us - last_us);
+        /// Exponentially weighted mean and mean absolute deviation
+        state.mean_dt_us += ALPHA * (dt_us - state.mean_dt_us);
+        const float jitter = state.jitter_us.load(std::memory_order_relaxed);
+        state.jitter_us.store(jitter + ALPHA * (std::fabs(dt_us - state.mean_dt_us) - jitter),
+                              std::memory_order_relaxed);
+        state.mean_dt.store(state.mean_dt_us, std::memory_order_relaxed);
+
+        /// Gap detection against the nominal period
+        if (dt_us > GAP_FACTOR * 1e6f / state.nominal_rate_hz) {
+            state.gaps.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (dt_us > state.max_gap_us.load(std::memory_order_relaxed)) {
+            state.max_gap_us.store(static_cast<uint32_t>(dt_us), std::memory_order_relaxed);
+        }
+
+        /// Positive skew means the simulation is running slower than real time
+        const int64_t wall_elapsed = static_cast<int64_t>(now_us - state.first_wall_us);
+        const int64_t sim_elapsed = static_cast<int64_t>(sim_us) - static_cast<int64_t>(state.first_sim_us);
+        state.skew_us.store(static_cast<float>(wall_elapsed - sim_elapsed), std::memory_order_relaxed);
+    }
+    state.count.fetch_add(1, std::memory_order_relaxed);
+    state.last_wall_us.store(now_us, std::memory_order_release);
+
+    if (topic == SensorTopic::CLOCK) {
+        /// Real time factor
+        if (_rtf_last_wall_us != 0 && now_us > _rtf_last_wall_us && sim_us >= _rtf_last_sim_us) {
+            const float rtf = static_cast<float>(sim_us - _rtf_last_sim_us) /
+                              static_cast<float>(now_us - _rtf_last_wall_us);
+            _rtf += ALPHA * (rtf - _rtf);
+        }
+        _rtf_last_wall_us = now_us;
+        _rtf_last_sim_us = sim_us;
+
+        /// The clock is the fastest topic, so we report from here
+        if (now_us - _last_report_us >= REPORT_PERIOD_US) {
+            publish_report(now_us);
+        }
+    }
+}
+
+void SensorMonitor::evaluate(uint64_t now_us, SensorHealth &report) const {
+    report.timestamp = now_us;
+    report.required_mask = 0;
+    report.stale_mask = 0;
+    report.slow_mask = 0;
+    report.real_time_factor = _rtf;
+
+    for (int i = 0; i < SENSOR_TOPIC_COUNT; i++) {
+        const TopicState &state = _topics[i];
+        TopicHealth &health = report.topics[i];
+        const uint16_t bit = static_cast<uint16_t>(1u << i);
+
+        if (state.required) {
+            report.required_mask |= bit;
+        }
+
+        const uint64_t last_us = state.last_wall_us.load(std::memory_order_acquire);
+        const float mean_dt = state.mean_dt.load(std::memory_order_relaxed);
+        health.count = state.count.load(std::memory_order_relaxed);
+        health.age_us = (last_us == 0 || now_us < last_us) ? UINT64_MAX : now_us - last_us;
+        health.rate_hz = mean_dt > 0.f ? 1e6f / mean_dt : 0.f;
+        health.jitter_us = state.jitter_us.load(std::memory_order_relaxed);
+        health.skew_us = state.skew_us.load(std::memory_order_relaxed);
+        health.gaps = state.gaps.load(std::memory_order_relaxed);
+        health.max_gap_us = state.max_gap_us.load(std::memory_order_relaxed);
+
+        /// Never received counts as stale
+        const float period_us = 1e6f / state.nominal_rate_hz;
+        if (last_us == 0 || static_cast<float>(health.age_us) > STALE_FACTOR * period_us) {
+            report.stale_mask |= bit;
+        } else if (health.count > 1 && health.rate_hz < 0.5f * state.nominal_rate_hz) {
+            report.slow_mask |= bit;
+        }
+    }
+}
+
+void SensorMonitor::publish_report(uint64_t now_us) {
+    _last_report_us = now_us;
+    evaluate(now_us, _report);
+    _morb->publish<SensorHealth>("sensor_health", _report);
+}
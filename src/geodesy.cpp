@@ -0,0 +1,153 @@
+/**
+ * @file geodesy.cpp
+ * @author Abdulelah Mulla
+ */
+
+#include <cmath>
+
+#include "geodesy.h"
+
+static constexpr double DEG_TO_RAD = M_PI / 180.0;
+static constexpr double RAD_TO_DEG = 180.0 / M_PI;
+
+/// Longitude wrapped to [-180, 180), deg
+static double wrap_lon(double lon) {
+    return lon - 360.0 * std::floor(lon / 360.0 + 0.5);
+}
+
+/**
+ * @brief sin and cos of a small angle, Taylor to the 13th order.
+ *
+ * The first neglected term is below 1e-20 for |x| <= SERIES_RANGE.
+ */
+static inline void sincos_series(double x, double &s, double &c) {
+    const double x2 = x * x;
+    s = x * (1.0 - x2 / 6.0 * (1.0 - x2 / 20.0 * (1.0 - x2 / 42.0 * (1.0 - x2 / 72.0 *
+            (1.0 - x2 / 110.0 * (1.0 - x2 / 156.0))))));
+    c = 1.0 - x2 / 2.0 * (1.0 - x2 / 12.0 * (1.0 - x2 / 30.0 * (1.0 - x2 / 56.0 *
+            (1.0 - x2 / 90.0 * (1.0 - x2 / 132.0 * (1.0 - x2 / 182.0))))));
+}
+
+void lla_to_ecef(double lat, double lon, double alt, double *ecef) {
+    const double sin_lat = std::sin(lat * DEG_TO_RAD);
+    const double cos_lat = std::cos(lat * DEG_TO_RAD);
+    const double n = Wgs84::A / std::sqrt(1.0 - Wgs84::E2 * sin_lat * sin_lat);
+    ecef[0] = (n + alt) * cos_lat * std::cos(lon * DEG_TO_RAD);
+    ecef[1] = (n + alt) * cos_lat * std::sin(lon * DEG_TO_RAD);
+    ecef[2] = (n * (1.0 - Wgs84::E2) + alt) * sin_lat;
+}
+
+void ecef_to_lla(const double *ecef, double &lat, double &lon, double &alt) {
+    constexpr double a = Wgs84::A, b = Wgs84::B, e2 = Wgs84::E2;
+    const double x = ecef[0], y = ecef[1], z = ecef[2];
+    const double z2 = z * z;
+    const double p2 = x * x + y * y;
+    const double p = std::sqrt(p2);
+
+    const double f = 54.0 * b * b * z2;
+    const double g = p2 + (1.0 - e2) * z2 - e2 * (a * a - b * b);
+    const double c = e2 * e2 * f * p2 / (g * g * g);
+    const double s = std::cbrt(1.0 + c + std::sqrt(c * c + 2.0 * c));
+    const double k = s + 1.0 + 1.0 / s;
+    const double pp = f / (3.0 * k * k * g * g);
+    const double q = std::sqrt(1.0 + 2.0 * e2 * e2 * pp);
+    const double r0 = -(pp * e2 * p) / (1.0 + q) +
+        std::sqrt(std::fmax(0.0, 0.5 * a * a * (1.0 + 1.0 / q) - pp * (1.0 - e2) * z2 / (q * (1.0 + q)) - 0.5 * pp * p2));
+    const double t = p - e2 * r0;
+    const double u = std::sqrt(t * t + z2);
+    const double v = std::sqrt(t * t + (1.0 - e2) * z2);
+    const double z0 = b * b * z / (a * v);
+
+    alt = u * (1.0 - b * b / (a * v));
+    lat = std::atan2(z + Wgs84::EP2 * z0, p) * RAD_TO_DEG;
+    lon = std::atan2(y, x) * RAD_TO_DEG;
+}
+
+LocalFrame::LocalFrame(double lat, double lon, double alt) :
+    _ref_lat(lat),
+    _ref_lon(lon),
+    _ref_alt(alt),
+    _sin_lat(std::sin(lat * DEG_TO_RAD)),
+    _cos_lat(std::cos(lat * DEG_TO_RAD))
+{
+    const double n = Wgs84::A / std::sqrt(1.0 - Wgs84::E2 * _sin_lat * _sin_lat);
+    _x0 = (n + alt) * _cos_lat;
+    _z0 = (n * (1.0 - Wgs84::E2) + alt) * _sin_lat;
+}
+
+void LocalFrame::to_ned(double lat, double lon, double alt, float *ned) const {
+    const double dlat = (lat - _ref_lat) * DEG_TO_RAD;
+    const double dlon = wrap_lon(lon - _ref_lon) * DEG_TO_RAD;
+
+    double sin_dlat, cos_dlat, sin_dlon, cos_dlon;
+    if (std::fabs(dlat) <= SERIES_RANGE && std::fabs(dlon) <= SERIES_RANGE) {
+        sincos_series(dlat, sin_dlat, cos_dlat);
+        sincos_series(dlon, sin_dlon, cos_dlon);
+    } else {
+        sin_dlat = std::sin(dlat);
+        cos_dlat = std::cos(dlat);
+        sin_dlon = std::sin(dlon);
+        cos_dlon = std::cos(dlon);
+    }
+    const double sin_lat = _sin_lat * cos_dlat + _cos_lat * sin_dlat;
+    const double cos_lat = _cos_lat * cos_dlat - _sin_lat * sin_dlat;
+
+    /// ECEF rotated so the reference meridian is the XZ plane
+    const double n = Wgs84::A / std::sqrt(1.0 - Wgs84::E2 * sin_lat * sin_lat);
+    const double dx = (n + alt) * cos_lat * cos_dlon - _x0;
+    const double y = (n + alt) * cos_lat * sin_dlon;
+    const double dz = (n * (1.0 - Wgs84::E2) + alt) * sin_lat - _z0;
+
+    ned[0] = static_cast<float>(-_sin_lat * dx + _cos_lat * dz);
+    ned[1] = static_cast<float>(y);
+    ned[2] = static_cast<float>(-_cos_lat * dx - _sin_lat * dz);
+}
+
+void LocalFrame::to_global(const float *ned, double &lat, double &lon, double &alt) const {
+    const double ecef[3] = {
+        _x0 - _sin_lat * ned[0] - _cos_lat * ned[2],
+        ned[1],
+        _z0 + _cos_lat * ned[0] - _sin_lat * ned[2]
+    };
+    double dlon;
+    ecef_to_lla(ecef, lat, dlon, alt);
+    lon = wrap_lon(_ref_lon + dlon);
+}
+
+void LocalFrame::to_ned(const double *lat, const double *lon, const double *alt, size_t count, float (*ned)[3]) const {
+    /// Not wrapped, across the antimeridian takes the scalar path
+    bool local = true;
+    for (size_t i = 0; i < count; i++) {
+        local &= std::fabs(lat[i] - _ref_lat) * DEG_TO_RAD <= SERIES_RANGE &&
+                 std::fabs(lon[i] - _ref_lon) * DEG_TO_RAD <= SERIES_RANGE;
+    }
+    if (!local) {
+        for (size_t i = 0; i < count; i++) {
+            to_ned(lat[i], lon[i], alt[i], ned[i]);
+        }
+        return;
+    }
+
+    /// Everything near the reference, no branch and no libm call so it vectorizes
+    const double sin_ref = _sin_lat, cos_ref = _cos_lat, x0 = _x0, z0 = _z0;
+    const double ref_lat = _ref_lat, ref_lon = _ref_lon;
+    const double *__restrict lat_in = lat;
+    const double *__restrict lon_in = lon;
+    const double *__restrict alt_in = alt;
+    float (*__restrict out)[3] = ned;
+    for (size_t i = 0; i < count; i++) {
+        const double h = alt_in[i];
+        double sin_dlat, cos_dlat, sin_dlon, cos_dlon;
+        sincos_series((lat_in[i] - ref_lat) * DEG_TO_RAD, sin_dlat, cos_dlat);
+        sincos_series((lon_in[i] - ref_lon) * DEG_TO_RAD, sin_dlon, cos_dlon);
+        const double sin_lat = sin_ref * cos_dlat + cos_ref * sin_dlat;
+        const double cos_lat = cos_ref * cos_dlat - sin_ref * sin_dlat;
+        const double n = Wgs84::A / std::sqrt(1.0 - Wgs84::E2 * sin_lat * sin_lat);
+        const double dx = (n + h) * cos_lat * cos_dlon - x0;
+        const double y = (n + h) * cos_lat * sin_dlon;
+        const double dz = (n * (1.0 - Wgs84::E2) + h) * sin_lat - z0;
+        out[i][0] = static_cast<float>(-sin_ref * dx + cos_ref * dz);
+        out[i][1] = static_cast<float>(y);
+        out[i][2] = static_cast<float>(-cos_ref * dx - sin_ref * dz);
+    }
+}
@@ -0,0 +1,155 @@
+/**
+ * @file health_monitor.cpp
+ * @author Abdulelah Mulla
+ */
+
+#include <chrono>
+#include <thread>
+
+#include "health_monitor.h"
+#include "morb.h"
+#include "log.h"
+
+/// VehicleState validity, bits of _state_valid
+static constexpr uint8_t ATTITUDE_VALID = 1 << 0;
+static constexpr uint8_t LOCAL_VALID = 1 << 1;
+static constexpr uint8_t GLOBAL_VALID = 1 << 2;
+static constexpr uint8_t ALL_VALID = ATTITUDE_VALID | LOCAL_VALID | GLOBAL_VALID;
+
+static const char *CHECK_NAMES[HEALTH_CHECK_COUNT] = {"sensors", "estimator", "control loop", "link"};
+
+HealthMonitor::HealthMonitor(Morb *morb) :
+    _morb(morb)
+{
+    _morb->subscribe<SensorHealth>("sensor_health", [this](const SensorHealth &health) {
+        _sensors_healthy.store(health.healthy(), std::memory_order_relaxed);
+        _sensor_report_time.store(health.timestamp, std::memory_order_relaxed);
+    });
+    _morb->subscribe<VehicleState>("vehicle_state", [this](const VehicleState &state) {
+        const uint8_t valid = (state.attitude_valid ? ATTITUDE_VALID : 0) |
+                              (state.local_valid ? LOCAL_VALID : 0) |
+                              (state.global_valid ? GLOBAL_VALID : 0);
+        _state_valid.store(valid, std::memory_order_relaxed);
+        _state_count.fetch_add(1, std::memory_order_relaxed);
+    });
+    _morb->subscribe<ControlLoopStats>("control_loop_stats", [this](const ControlLoopStats &stats) {
+        _loop_cycles.store(stats.cycles, std::memory_order_relaxed);
+        _loop_overruns.store(stats.overruns, std::memory_order_relaxed);
+        _loop_stats_time.store(stats.timestamp, std::memory_order_relaxed);
+    });
+    _morb->subscribe<LinkStatus>("link_status", [this](const LinkStatus &status) {
+        _link_connected.store(status.connected, std::memory_order_relaxed);
+        _link_seen.store(true, std::memory_order_relaxed);
+    });
+    MITL_LOG::initialize().program_log("[HealthMonitor] Initialized HealthMonitor");
+}
+
+HealthMonitor::~HealthMonitor() {
+    stop();
+}
+
+void HealthMonitor::start() {
+    if (_running.load()) {
+        return;
+    }
+    _running.store(true);
+    _thread = ThreadFactory::initialize().spawn(MitlThread::HEALTH, [this] {loop();});
+}
+
+void HealthMonitor::stop() {
+    if (!_running.load()) {
+        return;
+    }
+    _running.store(false);
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+void HealthMonitor::loop() {
+    auto next = std::chrono::steady_clock::now();
+    while (_running.load()) {
+        step(SensorMonitor::wall_time_us());
+        next += std::chrono::microseconds(TICK);
+        std::this_thread::sleep_until(next);
+    }
+}
+
+bool HealthMonitor::check(HealthCheck check, uint64_t now) {
+    switch (check) {
+        case HealthCheck::SENSORS: {
+            const uint64_t report_time = _sensor_report_time.load(std::memory_order_relaxed);
+            if (report_time == 0) {
+                /// No monitor attached, as for the mode manager we do not fly blind
+                return false;
+            }
+            return (now < report_time || now - report_time < SENSOR_TIMEOUT) &&
+                   _sensors_healthy.load(std::memory_order_relaxed);
+        }
+        case HealthCheck::ESTIMATOR: {
+            const uint64_t count = _state_count.load(std::memory_order_relaxed);
+            const bool fresh = count != _last_state_count;
+            _last_state_count = count;
+            if (!fresh || _state_valid.load(std::memory_order_relaxed) != ALL_VALID) {
+                _estimator_valid_since = 0;
+                return false;
+            }
+            /// Valid for a while, not just the first sample
+            if (_estimator_valid_since == 0) {
+                _estimator_valid_since = now;
+            }
+            return now - _estimator_valid_since >= ESTIMATOR_SETTLE;
+        }
+        case HealthCheck::CONTROL_LOOP: {
+            const uint64_t stats_time = _loop_stats_time.load(std::memory_order_relaxed);
+            if (stats_time == 0) {
+                /// Control loop not started
+                return true;
+            }
+            if (now > stats_time && now - stats_time > LOOP_STATS_TIMEOUT) {
+                /// Stuck
+                return false;
+            }
+            const uint64_t cycles = _loop_cycles.load(std::memory_order_relaxed);
+            const uint64_t overruns = _loop_overruns.load(std::memory_order_relaxed);
+            if (cycles == _last_cycles) {
+                /// No new stats since the last check, keep the verdict
+                return (_report.failing & health_bit(HealthCheck::CONTROL_LOOP)) == 0;
+            }
+            const float rate = static_cast<float>(overruns - _last_overruns) / static_cast<float>(cycles - _last_cycles);
+            _last_cycles = cycles;
+            _last_overruns = overruns;
+            return rate <= MAX_OVERRUN_RATE;
+        }
+        case HealthCheck::LINK:
+            if (!_link_seen.load(std::memory_order_relaxed)) {
+                /// No GCS yet
+                return true;
+            }
+            return _link_connected.load(std::memory_order_relaxed);
+        case HealthCheck::COUNT:
+        default:
+            return true;
+    }
+}
+
+void HealthMonitor::step(uint64_t now) {
+    const HealthCheck current = static_cast<HealthCheck>(_next_check);
+    _next_check = (_next_check + 1) % HEALTH_CHECK_COUNT;
+
+    const uint8_t bit = health_bit(current);
+    const uint8_t failing = check(current, now) ? (_report.failing & ~bit) : (_report.failing | bit);
+    const bool changed = failing != _report.failing || (_report.checked & bit) == 0;
+    if (failing != _report.failing) {
+        MITL_LOG::initialize().program_log(std::string("[HealthMonitor] ") + CHECK_NAMES[static_cast<int>(current)] +
+                                           ((failing & bit) ? " failing" : " ok"));
+    }
+    _report.failing = failing;
+    _report.checked |= bit;
+    _report.timestamp = now;
+
+    if (changed || now - _last_publish >= HEARTBEAT) {
+        _last_publish = now;
+        _morb->publish<HealthReport>("health_report", _report);
+    }
+}
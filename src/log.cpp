@@ -6,14 +6,24 @@
  * @date 2026-01-01
  */
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <thread>
+
 #include "log.h"
+#include "params.h"
+
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/message.h>
 
 /**
  * Constructor
  */
 MITL_LOG::MITL_LOG() {
     _program_log.open("program_log");
-    _sensor_log.open("sensor_log");
 }
 
 /**
@@ -28,20 +38,262 @@ MITL_LOG& MITL_LOG::initialize() {
  * Destructor
  */
 MITL_LOG::~MITL_LOG() {
+    stop();
     _program_log.close();
     _sensor_log.close();
 }
 
 void MITL_LOG::program_log(const std::string &msg) {
     /// Lock mutex
-    const std::lock_guard<std::mutex> lock(_program_mutex);
+    const std::lock_guard<WatchedMutex> lock(_program_mutex);
+    /// Log the message
+    _program_log << msg << std::endl;
+}
+
+void MITL_LOG::program_log(const char *msg) {
+    /// Lock mutex
+    const std::lock_guard<WatchedMutex> lock(_program_mutex);
     /// Log the message
     _program_log << msg << std::endl;
 }
 
-void MITL_LOG::sensor_log(const google::protobuf::Message& msg, std::string label, uint64_t time) {
+void MITL_LOG::program_log_nowait(const char *msg) {
+    if (!_writing.load(std::memory_order_acquire)) {
+        /// No logger thread, write in place and tell the watchdog whose lock we wait on
+        const MitlThread id = ThreadFactory::current();
+        if (id == MitlThread::COUNT) {
+            program_log(msg);
+            return;
+        }
+        Watchdog &watchdog = Watchdog::initialize();
+        watchdog.stage(id, "program log", &_program_mutex);
+        program_log(msg);
+        watchdog.stage(id, "program log");
+        return;
+    }
+    ProgramRecord record;
+    std::strncpy(record.text, msg, ProgramRecord::BYTES - 1);
+    record.text[ProgramRecord::BYTES - 1] = '\0';
+    if (!_program_queue.push(record)) {
+        _program_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void MITL_LOG::sensor_log(const google::protobuf::Message& msg, const char *label, uint64_t time) {
+    if (!_writing.load(std::memory_order_acquire)) {
+        write_sensor(msg, label, time);
+        return;
+    }
+    /// Serialize on the stack, the queue copies it
+    SensorRecord record;
+    const size_t size = msg.ByteSizeLong();
+    record.large = nullptr;
+    if (size > SensorRecord::BYTES) {
+        /// Too large for the record, serialize into a pooled block
+        record.large = static_cast<uint8_t*>(_large_pool.try_allocate(size));
+        if (!record.large) {
+            if (size > LARGE_BYTES) {
+                warn_oversized(label, size);
+            }
+            _sensor_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+    record.label = label;
+    record.time = time;
+    record.type = msg.GetDescriptor();
+    record.struct_type = nullptr;
+    record.size = static_cast<uint32_t>(size);
+    msg.SerializeWithCachedSizesToArray(record.large ? record.large : record.bytes);
+    if (!_sensor_queue.push(record)) {
+        if (record.large) {
+            _large_pool.deallocate(record.large, size);
+        }
+        _sensor_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void MITL_LOG::write_sensor(const google::protobuf::Message& msg, const char *label, uint64_t time) {
+    const std::string bytes = msg.SerializeAsString();
     /// Lock mutex
     const std::lock_guard<std::mutex> lock(_sensor_mutex);
     /// Log the message
-    _sensor_log << label << ", Time: " << time << ", Message: " << msg.DebugString() << std::endl;
-}
\ No newline at end of file
+    write_record(label, msg.GetDescriptor(), nullptr, time, bytes.data(), static_cast<uint32_t>(bytes.size()));
+}
+
+void MITL_LOG::write_struct(const void *bytes, uint32_t size, const char *label, const char *type, uint64_t time) {
+    if (!_writing.load(std::memory_order_acquire)) {
+        const std::lock_guard<std::mutex> lock(_sensor_mutex);
+        write_record(label, nullptr, type, time, bytes, size);
+        return;
+    }
+    SensorRecord record;
+    record.label = label;
+    record.time = time;
+    record.type = nullptr;
+    record.struct_type = type;
+    record.size = size;
+    record.large = nullptr;
+    std::memcpy(record.bytes, bytes, size);
+    if (!_sensor_queue.push(record)) {
+        _sensor_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+/// Same type, by pointer or by name
+static bool same_name(const char *a, const char *b) {
+    return a == b || (a && b && std::strcmp(a, b) == 0);
+}
+
+void MITL_LOG::warn_oversized(const char *label, size_t size) {
+    for (std::atomic<const char*> &slot : _oversized) {
+        const char *seen = slot.load(std::memory_order_relaxed);
+        if (!seen && slot.compare_exchange_strong(seen, label, std::memory_order_relaxed)) {
+            char line[ProgramRecord::BYTES];
+            std::snprintf(line, sizeof(line), "Sensor log drops %s, %zu bytes is more than %zu",
+                          label, size, LARGE_BYTES);
+            program_log_nowait(line);
+            return;
+        }
+        /// Taken, by this topic or another
+        if (same_name(seen, label)) {
+            return;
+        }
+    }
+}
+
+void MITL_LOG::describe(const char *type, std::vector<LogField> fields) {
+    const std::lock_guard<std::mutex> lock(_sensor_mutex);
+    for (StructFields &described : _struct_fields) {
+        if (same_name(described.type, type)) {
+            described.fields = std::move(fields);
+            return;
+        }
+    }
+    _struct_fields.push_back({type, std::move(fields)});
+}
+
+void MITL_LOG::write_record(const char *label, const google::protobuf::Descriptor *type, const char *struct_type,
+                            uint64_t time, const void *bytes, uint32_t size) {
+    int i = 0;
+    for (; i < _topic_count; i++) {
+        if (_topics[i].type == type && same_name(_topics[i].struct_type, struct_type) &&
+            same_name(_topics[i].label, label)) {
+            break;
+        }
+    }
+    if (i == _topic_count) {
+        if (_topic_count == MAX_TOPICS) {
+            _sensor_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        LogTopic &topic = _topics[_topic_count++];
+        topic = {label, type, struct_type, 0, nullptr};
+        if (type) {
+            /// Kept serialized alongside its columns
+            topic.columns = std::make_unique<MessageColumns>(type);
+            topic.id = _sensor_log.add_topic(label, std::string(type->full_name()), topic.columns->fields());
+        } else {
+            /// The fields hold all a reader needs
+            std::vector<LogField> fields;
+            for (const StructFields &described : _struct_fields) {
+                if (same_name(described.type, struct_type)) {
+                    fields = described.fields;
+                    break;
+                }
+            }
+            const bool keep_payload = fields.empty();
+            topic.id = _sensor_log.add_topic(label, struct_type ? struct_type : "", std::move(fields), keep_payload);
+        }
+    }
+    const LogTopic &topic = _topics[i];
+    if (topic.columns && _sensor_log.layout() == LogLayout::COLUMNAR) {
+        /// A message that does not parse keeps its bytes, its columns read
+        /// NaN, which the chunk min and max leave out
+        if (!topic.columns->flatten(bytes, size, _row)) {
+            std::fill(_row, _row + topic.columns->fields().size(), std::numeric_limits<double>::quiet_NaN());
+        }
+        _sensor_log.append(topic.id, time, bytes, size, _row, topic.columns->row_size());
+        return;
+    }
+    _sensor_log.append(topic.id, time, bytes, size);
+}
+
+void MITL_LOG::start() {
+    if (_writing.load()) {
+        return;
+    }
+    const Params &params = Params::initialize();
+    LogPolicy policy{};
+    policy.segment_bytes = static_cast<uint64_t>(params.get(param::MITL_LOG_SEG_MB)) << 20;
+    policy.segment_duration = std::chrono::seconds(params.get(param::MITL_LOG_SEG_S));
+    policy.budget_bytes = static_cast<uint64_t>(params.get(param::MITL_LOG_MAX_MB)) << 20;
+    {
+        const std::lock_guard<std::mutex> lock(_sensor_mutex);
+        _sensor_log.set_policy(policy);
+        _sensor_log.set_layout(params.get(param::MITL_LOG_COLUMNS) ? LogLayout::COLUMNAR : LogLayout::INTERLEAVED);
+    }
+    _writing.store(true);
+    _writer = ThreadFactory::initialize().spawn(MitlThread::LOGGER, [this] {writer_loop();});
+}
+
+void MITL_LOG::stop() {
+    if (!_writing.load()) {
+        return;
+    }
+    _writing.store(false);
+    if (_writer.joinable()) {
+        _writer.join();
+    }
+    {
+        /// Nothing buffered is lost if the process ends here
+        const std::lock_guard<std::mutex> lock(_sensor_mutex);
+        _sensor_log.close();
+    }
+    const uint64_t dropped = sensor_dropped();
+    if (dropped > 0) {
+        program_log("Sensor log dropped " + std::to_string(dropped) + " messages");
+    }
+    const uint64_t lines = _program_dropped.load(std::memory_order_relaxed);
+    if (lines > 0) {
+        program_log("Program log dropped " + std::to_string(lines) + " lines");
+    }
+}
+
+void MITL_LOG::writer_loop() {
+    auto last_flush = std::chrono::steady_clock::now();
+    while (_writing.load()) {
+        drain();
+        /// Topics that went quiet are written too, and the segment ends on time
+        const auto now = std::chrono::steady_clock::now();
+        if (now - last_flush >= FLUSH_PERIOD) {
+            last_flush = now;
+            const std::lock_guard<std::mutex> lock(_sensor_mutex);
+            _sensor_log.flush();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    /// Producers that saw _writing may still be pushing
+    drain();
+}
+
+void MITL_LOG::drain() {
+    /// The writer is the only consumer
+    static ProgramRecord line;
+    if (_program_queue.pop(line)) {
+        const std::lock_guard<WatchedMutex> lock(_program_mutex);
+        do {
+            _program_log << line.text << '\n';
+        } while (_program_queue.pop(line));
+        _program_log.flush();
+    }
+    static SensorRecord record;
+    const std::lock_guard<std::mutex> lock(_sensor_mutex);
+    while (_sensor_queue.pop(record)) {
+        /// Compression happens here, on full blocks
+        write_record(record.label, record.type, record.struct_type, record.time, record.data(), record.size);
+        if (record.large) {
+            _large_pool.deallocate(record.large, record.size);
+        }
+    }
+}
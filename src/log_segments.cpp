@@ -0,0 +1,490 @@
+/**
+ * @file log_segments.cpp
+ * @author Abdulelah Mulla
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "log_segments.h"
+
+#ifdef MITL_HAVE_ZSTD
+#include <zstd.h>
+#endif
+#ifdef MITL_HAVE_LZ4
+#include <lz4frame.h>
+#endif
+
+static constexpr char MAGIC[8] = {'M', 'I', 'T', 'L', 'L', 'O', 'G', '1'};
+static constexpr char SEGMENT_SUFFIX[] = ".mlog";
+static constexpr char INDEX_SUFFIX[] = ".idx";
+
+/// zstd's fastest levels already shrink protobuf several times
+static constexpr int ZSTD_LEVEL = 1;
+
+struct SegmentFile {
+    uint32_t segment;
+    uint64_t bytes; // segment and index
+};
+
+/// Segments of a log in a directory, oldest first
+static std::vector<SegmentFile> list_segments(const std::string &directory, const std::string &name) {
+    std::vector<SegmentFile> segments;
+    DIR *dir = opendir(directory.c_str());
+    if (!dir) {
+        return segments;
+    }
+    const std::string prefix = name + "_";
+    while (dirent *entry = readdir(dir)) {
+        const std::string file = entry->d_name;
+        unsigned segment = 0;
+        char suffix[8] = {};
+        if (file.compare(0, prefix.size(), prefix) != 0 ||
+            std::sscanf(file.c_str() + prefix.size(), "%6u%7s", &segment, suffix) != 2 ||
+            std::strcmp(suffix, SEGMENT_SUFFIX) != 0 || segment == 0) {
+            continue;
+        }
+        const std::string path = directory + "/" + file;
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0) {
+            continue;
+        }
+        uint64_t bytes = static_cast<uint64_t>(st.st_size);
+        if (stat((path + INDEX_SUFFIX).c_str(), &st) == 0) {
+            bytes += static_cast<uint64_t>(st.st_size);
+        }
+        segments.push_back({segment, bytes});
+    }
+    closedir(dir);
+    std::sort(segments.begin(), segments.end(), [](const SegmentFile &a, const SegmentFile &b) {
+        return a.segment < b.segment;
+    });
+    return segments;
+}
+
+SegmentedLog::SegmentedLog(std::string directory, std::string name) :
+    _directory(std::move(directory)),
+    _name(std::move(name)),
+    _codec(default_codec())
+{
+    _block.reserve(BLOCK_BYTES);
+}
+
+SegmentedLog::~SegmentedLog() {
+    close();
+}
+
+std::string SegmentedLog::segment_path(uint32_t segment) const {
+    char number[16];
+    std::snprintf(number, sizeof(number), "_%06u", segment);
+    return _directory + "/" + _name + number + SEGMENT_SUFFIX;
+}
+
+void SegmentedLog::set_layout(LogLayout layout) {
+    if (layout == _layout) {
+        return;
+    }
+    close();
+    _layout = layout;
+}
+
+uint8_t SegmentedLog::add_topic(const std::string &label, const std::string &type,
+                                std::vector<LogField> fields, bool keep_payload) {
+    if (_topics.size() >= UINT8_MAX) {
+        /// Full, append() drops records of this id
+        return UINT8_MAX;
+    }
+    TopicColumns columns;
+    for (const LogField &field : fields) {
+        columns.row_size = std::max(columns.row_size, static_cast<uint32_t>(field.offset + field_size(field.type)));
+    }
+    columns.keep_payload = keep_payload || fields.empty();
+    columns.fields = std::move(fields);
+    _columns.push_back(std::move(columns));
+
+    _topics.push_back(label + '\0' + type);
+    const uint8_t topic = static_cast<uint8_t>(_topics.size() - 1);
+    if (!_block.empty()) {
+        /// Blocks after this one list it at their start
+        put(LogRecordKind::TOPIC, topic, 0, _topics.back().data(), static_cast<uint32_t>(_topics.back().size()));
+    }
+    return topic;
+}
+
+void SegmentedLog::put(LogRecordKind kind, uint8_t topic, uint64_t time, const void *data, uint32_t size) {
+    LogRecordHeader header{};
+    header.kind = kind;
+    header.topic = topic;
+    header.size = size;
+    header.time = time;
+    const uint8_t *bytes = reinterpret_cast<const uint8_t*>(&header);
+    _block.insert(_block.end(), bytes, bytes + sizeof(header));
+    _block.insert(_block.end(), static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + size);
+}
+
+void SegmentedLog::start_block() {
+    for (size_t i = 0; i < _topics.size(); i++) {
+        put(LogRecordKind::TOPIC, static_cast<uint8_t>(i), 0, _topics[i].data(),
+            static_cast<uint32_t>(_topics[i].size()));
+    }
+}
+
+void SegmentedLog::append(uint8_t topic, uint64_t time, const void *data, uint32_t size, const void *row,
+                          uint32_t row_size) {
+    if (topic >= _topics.size()) {
+        return;
+    }
+    if (_layout == LogLayout::COLUMNAR) {
+        TopicColumns &columns = _columns[topic];
+        if (!row) {
+            row = data;
+            row_size = size;
+        }
+        if (row_size < columns.row_size) {
+            return;
+        }
+        const uint8_t *bytes = static_cast<const uint8_t*>(row);
+        columns.times.push_back(time);
+        columns.rows.insert(columns.rows.end(), bytes, bytes + columns.row_size);
+        if (columns.keep_payload) {
+            bytes = static_cast<const uint8_t*>(data);
+            columns.sizes.push_back(size);
+            columns.payload.insert(columns.payload.end(), bytes, bytes + size);
+        }
+        /// A group ends once one of its columns fills a block, or it spans
+        /// GROUP_AGE_US, so a slow topic does not sit in memory
+        if (columns.times.size() * sizeof(uint64_t) >= BLOCK_BYTES || columns.rows.size() >= BLOCK_BYTES ||
+            columns.payload.size() >= BLOCK_BYTES || time >= columns.times.front() + GROUP_AGE_US) {
+            write_group(topic);
+            _file.flush();
+            _index.flush();
+            rotate();
+        }
+        return;
+    }
+    if (_block_has_data && _block.size() + sizeof(LogRecordHeader) + size > BLOCK_BYTES) {
+        flush();
+    }
+    if (!_block_has_data) {
+        _block.clear();
+        start_block();
+        _first_time = time;
+        _block_has_data = true;
+    }
+    _last_time = time;
+    put(LogRecordKind::DATA, topic, time, data, size);
+}
+
+void SegmentedLog::open_segment() {
+    const std::vector<SegmentFile> existing = list_segments(_directory, _name);
+    _segment = existing.empty() ? 1 : existing.back().segment + 1;
+
+    const std::string path = segment_path(_segment);
+    _file.open(path, std::ios::binary | std::ios::trunc);
+    _index.open(path + INDEX_SUFFIX, std::ios::binary | std::ios::trunc);
+
+    LogFileHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.codec = _codec;
+    header.layout = _layout;
+    _file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    _index.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    _file_size = sizeof(header);
+    _opened = std::chrono::steady_clock::now();
+
+    /// Every segment names its topics
+    for (TopicColumns &columns : _columns) {
+        columns.schema_written = false;
+    }
+    _next_group = 0;
+
+    /// Make room before it grows
+    enforce_budget();
+}
+
+void SegmentedLog::write_block() {
+    if (_segment == 0) {
+        open_segment();
+    }
+    /// Stored as is when it does not shrink, so size < raw_size means compressed
+    const uint8_t *data = _block.data();
+    uint32_t size = static_cast<uint32_t>(_block.size());
+    if (compress(_codec, _block.data(), _block.size(), _compressed) && _compressed.size() < _block.size()) {
+        data = _compressed.data();
+        size = static_cast<uint32_t>(_compressed.size());
+    }
+
+    LogBlockHeader header{size, static_cast<uint32_t>(_block.size())};
+    LogBlockIndex entry{_file_size, header.size, header.raw_size, _first_time, _last_time};
+    _file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    _file.write(reinterpret_cast<const char*>(data), size);
+    _file.flush();
+    _index.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+    _index.flush();
+    _file_size += sizeof(header) + size;
+
+    _block.clear();
+    _block_has_data = false;
+}
+
+/// Value of a field as a double, for the chunk's min and max
+static double field_value(LogFieldType type, const uint8_t *bytes) {
+    switch (type) {
+        case LogFieldType::U8:
+            return *bytes;
+        case LogFieldType::U32: {
+            uint32_t value;
+            std::memcpy(&value, bytes, sizeof(value));
+            return value;
+        }
+        case LogFieldType::U64: {
+            uint64_t value;
+            std::memcpy(&value, bytes, sizeof(value));
+            return static_cast<double>(value);
+        }
+        case LogFieldType::F32: {
+            float value;
+            std::memcpy(&value, bytes, sizeof(value));
+            return value;
+        }
+        case LogFieldType::F64: {
+            double value;
+            std::memcpy(&value, bytes, sizeof(value));
+            return value;
+        }
+    }
+    return 0;
+}
+
+void SegmentedLog::write_chunk(LogChunkHeader header, const uint8_t *data, size_t size) {
+    /// Stored as is when it does not shrink, as blocks are
+    header.raw_size = static_cast<uint32_t>(size);
+    header.size = header.raw_size;
+    if (compress(_codec, data, size, _compressed) && _compressed.size() < size) {
+        data = _compressed.data();
+        header.size = static_cast<uint32_t>(_compressed.size());
+    }
+    const LogChunkIndex entry{_file_size, header};
+    _file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    _file.write(reinterpret_cast<const char*>(data), header.size);
+    _index.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+    _file_size += sizeof(header) + header.size;
+}
+
+void SegmentedLog::write_group(uint8_t topic) {
+    TopicColumns &columns = _columns[topic];
+    if (columns.times.empty()) {
+        return;
+    }
+    if (_segment == 0) {
+        open_segment();
+    }
+    if (!columns.schema_written) {
+        std::vector<uint8_t> &schema = _column;
+        schema.assign(_topics[topic].begin(), _topics[topic].end());
+        schema.push_back('\0');
+        schema.push_back(columns.keep_payload);
+        const uint16_t count = static_cast<uint16_t>(columns.fields.size());
+        schema.insert(schema.end(), reinterpret_cast<const uint8_t*>(&count),
+                      reinterpret_cast<const uint8_t*>(&count) + sizeof(count));
+        for (const LogField &field : columns.fields) {
+            schema.push_back(static_cast<uint8_t>(field.type));
+            schema.insert(schema.end(), reinterpret_cast<const uint8_t*>(&field.offset),
+                          reinterpret_cast<const uint8_t*>(&field.offset) + sizeof(field.offset));
+            schema.insert(schema.end(), field.name.begin(), field.name.end());
+            schema.push_back('\0');
+        }
+        LogChunkHeader header{};
+        header.kind = LogChunkKind::SCHEMA;
+        header.topic = topic;
+        write_chunk(header, schema.data(), schema.size());
+        columns.schema_written = true;
+    }
+
+    const size_t rows = columns.times.size();
+    const auto range = std::minmax_element(columns.times.begin(), columns.times.end());
+    LogChunkHeader header{};
+    header.topic = topic;
+    header.group = _next_group++;
+    header.count = static_cast<uint32_t>(rows);
+    header.first_time = *range.first;
+    header.last_time = *range.second;
+
+    header.kind = LogChunkKind::TIME;
+    write_chunk(header, reinterpret_cast<const uint8_t*>(columns.times.data()), rows * sizeof(uint64_t));
+
+    /// Gather each field out of the rows
+    header.kind = LogChunkKind::FIELD;
+    for (size_t f = 0; f < columns.fields.size(); f++) {
+        const LogField &field = columns.fields[f];
+        const size_t width = field_size(field.type);
+        _column.resize(rows * width);
+        header.column = static_cast<uint16_t>(f);
+        /// NaNs compare false, they are left out
+        header.min = std::numeric_limits<double>::infinity();
+        header.max = -header.min;
+        for (size_t r = 0; r < rows; r++) {
+            const uint8_t *value = columns.rows.data() + r * columns.row_size + field.offset;
+            std::memcpy(_column.data() + r * width, value, width);
+            const double number = field_value(field.type, value);
+            if (number < header.min) {
+                header.min = number;
+            }
+            if (number > header.max) {
+                header.max = number;
+            }
+        }
+        write_chunk(header, _column.data(), _column.size());
+    }
+    header.column = 0;
+    header.min = header.max = 0;
+
+    if (columns.keep_payload) {
+        header.kind = LogChunkKind::SIZES;
+        write_chunk(header, reinterpret_cast<const uint8_t*>(columns.sizes.data()), rows * sizeof(uint32_t));
+        header.kind = LogChunkKind::PAYLOAD;
+        write_chunk(header, columns.payload.data(), columns.payload.size());
+    }
+
+    columns.times.clear();
+    columns.rows.clear();
+    columns.sizes.clear();
+    columns.payload.clear();
+}
+
+void SegmentedLog::write_groups() {
+    for (size_t topic = 0; topic < _columns.size(); topic++) {
+        write_group(static_cast<uint8_t>(topic));
+    }
+    if (_segment != 0) {
+        _file.flush();
+        _index.flush();
+    }
+}
+
+void SegmentedLog::rotate() {
+    if (_segment != 0 && (_file_size >= _policy.segment_bytes ||
+                          std::chrono::steady_clock::now() - _opened >= _policy.segment_duration)) {
+        close();
+    }
+}
+
+void SegmentedLog::flush() {
+    if (_layout == LogLayout::COLUMNAR) {
+        write_groups();
+    } else if (_block_has_data) {
+        write_block();
+    } else {
+        return;
+    }
+    rotate();
+}
+
+void SegmentedLog::close() {
+    if (_layout == LogLayout::COLUMNAR) {
+        write_groups();
+    } else if (_block_has_data) {
+        write_block();
+    }
+    if (_segment == 0) {
+        return;
+    }
+    _file.close();
+    _index.close();
+    _segment = 0;
+    enforce_budget();
+}
+
+void SegmentedLog::enforce_budget() {
+    std::vector<SegmentFile> segments = list_segments(_directory, _name);
+    uint64_t total = 0;
+    for (const SegmentFile &file : segments) {
+        total += file.bytes;
+    }
+    for (const SegmentFile &file : segments) {
+        if (total <= _policy.budget_bytes || file.segment == _segment) {
+            break;
+        }
+        const std::string path = segment_path(file.segment);
+        std::remove(path.c_str());
+        std::remove((path + INDEX_SUFFIX).c_str());
+        total -= file.bytes;
+    }
+}
+
+LogCodec SegmentedLog::default_codec() {
+#if defined(MITL_HAVE_ZSTD)
+    return LogCodec::ZSTD;
+#elif defined(MITL_HAVE_LZ4)
+    return LogCodec::LZ4;
+#else
+    return LogCodec::NONE;
+#endif
+}
+
+bool SegmentedLog::compress(LogCodec codec, [[maybe_unused]] const uint8_t *data, [[maybe_unused]] size_t size,
+                            [[maybe_unused]] std::vector<uint8_t> &out) {
+    switch (codec) {
+#ifdef MITL_HAVE_ZSTD
+        case LogCodec::ZSTD: {
+            out.resize(ZSTD_compressBound(size));
+            const size_t written = ZSTD_compress(out.data(), out.size(), data, size, ZSTD_LEVEL);
+            if (ZSTD_isError(written)) {
+                return false;
+            }
+            out.resize(written);
+            return true;
+        }
+#endif
+#ifdef MITL_HAVE_LZ4
+        case LogCodec::LZ4: {
+            out.resize(LZ4F_compressFrameBound(size, nullptr));
+            const size_t written = LZ4F_compressFrame(out.data(), out.size(), data, size, nullptr);
+            if (LZ4F_isError(written)) {
+                return false;
+            }
+            out.resize(written);
+            return true;
+        }
+#endif
+        default:
+            return false;
+    }
+}
+
+bool SegmentedLog::decompress(LogCodec codec, const uint8_t *data, size_t size, uint8_t *out, size_t raw_size) {
+    if (size == raw_size) {
+        /// Stored as is
+        std::memcpy(out, data, size);
+        return true;
+    }
+    switch (codec) {
+#ifdef MITL_HAVE_ZSTD
+        case LogCodec::ZSTD:
+            return ZSTD_decompress(out, raw_size, data, size) == raw_size;
+#endif
+#ifdef MITL_HAVE_LZ4
+        case LogCodec::LZ4: {
+            LZ4F_dctx *context = nullptr;
+            if (LZ4F_isError(LZ4F_createDecompressionContext(&context, LZ4F_VERSION))) {
+                return false;
+            }
+            size_t out_size = raw_size;
+            size_t in_size = size;
+            const size_t result = LZ4F_decompress(context, out, &out_size, data, &in_size, nullptr);
+            LZ4F_freeDecompressionContext(context);
+            /// 0 once the frame is complete
+            return result == 0 && out_size == raw_size;
+        }
+#endif
+        default:
+            return false;
+    }
+}
@@ -3,15 +3,24 @@
  * @author Abdulelah Mulla
  */
 
+#include <algorithm>
 #include <chrono>
 #include <cmath>
 #include <iostream>
+#include <sstream>
 
 #include "mavlink_interface.h"
+#include "telemetry/mavlink_json.h"
 #include "log.h"
 
 using namespace std::chrono_literals;
 
+/// MAV_CMD ids and MAV_RESULT values we use
+static constexpr uint32_t MAV_CMD_GET_MESSAGE_INTERVAL = 510;
+static constexpr uint32_t MAV_CMD_SET_MESSAGE_INTERVAL = 511;
+static constexpr uint32_t RESULT_ACCEPTED = 0;
+static constexpr uint32_t RESULT_DENIED = 2;
+
 MavlinkInterface::MavlinkInterface(
     Morb* morb, std::string url,
     mavsdk::ComponentType type):
@@ -82,9 +91,131 @@ bool MavlinkInterface::setup_connection() {
 }
 
 void MavlinkInterface::setup_params() {
-    /// PX4-style and custom params
-    _param->provide_param_int("MIS_TAKEOFF_ALT", 0);
-    _param->provide_param_int("MY_PARAM", 1);
+    /// Our params, at their current (possibly persisted) values
+    for (const ParamInfo &info : PARAM_TABLE) {
+        provide_param(info.id);
+    }
+
+    /// Telemetry stream rates, in Hz
+    const Params &params = Params::initialize();
+    const StreamInfo *streams = TelemetryStreams::table();
+    for (int i = 0; i < TELEMETRY_STREAM_COUNT; i++) {
+        _streams.set_rate(streams[i].stream, params.value(streams[i].param));
+    }
+    _param->subscribe_changed_param_float([this](mavsdk::ParamServer::FloatParam param) {
+        on_param_changed(param.name, param.value);
+    });
+    _param->subscribe_changed_param_int([this](mavsdk::ParamServer::IntParam param) {
+        on_param_changed(param.name, static_cast<float>(param.value));
+    });
+}
+
+void MavlinkInterface::on_param_changed(const std::string &name, float value) {
+    ParamId id;
+    if (!Params::find(name.c_str(), id)) {
+        return;
+    }
+    set_param(id, value);
+}
+
+bool MavlinkInterface::set_param(ParamId id, float value) {
+    Params &params = Params::initialize();
+    if (!params.set(id, value)) {
+        /// Out of range, put the GCS back on the value we kept
+        provide_param(id);
+        return false;
+    }
+    TelemetryStream stream;
+    if (TelemetryStreams::find(id, stream)) {
+        _streams.set_rate(stream, params.value(id));
+    }
+    MITL_LOG::initialize().program_log("[MavlinkInterface] Param " + std::string(PARAM_TABLE[static_cast<int>(id)].name) +
+                                       " set to " + std::to_string(params.value(id)));
+    _morb->publish<ParamUpdate>("parameter_update", {SensorMonitor::wall_time_us(), id});
+    return true;
+}
+
+void MavlinkInterface::provide_param(ParamId id) {
+    const ParamInfo &info = PARAM_TABLE[static_cast<int>(id)];
+    const float value = Params::initialize().value(id);
+    if (info.type == ParamType::FLOAT) {
+        _param->provide_param_float(info.name, value);
+    } else {
+        _param->provide_param_int(info.name, static_cast<int32_t>(value));
+    }
+}
+
+void MavlinkInterface::setup_telemetry() {
+    _command_handle = _vehicle->mavlink_direct().subscribe_message("COMMAND_LONG",
+        [this](mavsdk::MavlinkDirect::MavlinkMessage message) { on_command_long(message); });
+    _command_subscribed = true;
+
+    /// Logs are written to the working directory
+    _log_server = std::make_unique<LogServer>(_vehicle->mavlink_direct(), ".");
+    _log_server->start();
+}
+
+void MavlinkInterface::on_command_long(const mavsdk::MavlinkDirect::MavlinkMessage &message) {
+    double command = 0, param1 = 0, param2 = 0;
+    if (!json_number(message.fields_json, "command", command)) {
+        return;
+    }
+    if (command != MAV_CMD_SET_MESSAGE_INTERVAL && command != MAV_CMD_GET_MESSAGE_INTERVAL) {
+        /// Someone else's command
+        return;
+    }
+    json_number(message.fields_json, "param1", param1);
+    json_number(message.fields_json, "param2", param2);
+
+    TelemetryStream stream;
+    if (!TelemetryStreams::find(static_cast<uint32_t>(param1), stream)) {
+        send_command_ack(static_cast<uint32_t>(command), RESULT_DENIED, message);
+        return;
+    }
+
+    if (command == MAV_CMD_SET_MESSAGE_INTERVAL) {
+        /// The rate is the stream's param, so the GCS sees it and it is persisted
+        const ParamInfo &info = PARAM_TABLE[static_cast<int>(TelemetryStreams::table()[static_cast<int>(stream)].param)];
+        float rate_hz = info.default_value;
+        if (param2 < 0) {
+            rate_hz = 0.f;
+        } else if (param2 > 0) {
+            rate_hz = std::clamp(static_cast<float>(1e6 / param2), info.min, info.max);
+        }
+        if (!set_param(info.id, rate_hz)) {
+            send_command_ack(static_cast<uint32_t>(command), RESULT_DENIED, message);
+            return;
+        }
+        provide_param(info.id);
+        MITL_LOG::initialize().program_log("[MavlinkInterface] Message " + std::to_string(static_cast<uint32_t>(param1)) +
+                                           " interval set to " + std::to_string(_streams.interval(stream)) + " us");
+    } else {
+        std::ostringstream fields;
+        fields << "{\"message_id\":" << static_cast<uint32_t>(param1)
+               << ",\"interval_us\":" << _streams.interval(stream) << "}";
+        mavsdk::MavlinkDirect::MavlinkMessage reply;
+        reply.message_name = "MESSAGE_INTERVAL";
+        reply.target_system_id = message.system_id;
+        reply.target_component_id = message.component_id;
+        reply.fields_json = fields.str();
+        _vehicle->mavlink_direct().send_message(reply);
+    }
+    send_command_ack(static_cast<uint32_t>(command), RESULT_ACCEPTED, message);
+}
+
+void MavlinkInterface::send_command_ack(uint32_t command, uint32_t result,
+                                        const mavsdk::MavlinkDirect::MavlinkMessage &request) {
+    std::ostringstream fields;
+    fields << "{\"command\":" << command << ",\"result\":" << result
+           << ",\"progress\":0,\"result_param2\":0"
+           << ",\"target_system\":" << request.system_id
+           << ",\"target_component\":" << request.component_id << "}";
+    mavsdk::MavlinkDirect::MavlinkMessage ack;
+    ack.message_name = "COMMAND_ACK";
+    ack.target_system_id = request.system_id;
+    ack.target_component_id = request.component_id;
+    ack.fields_json = fields.str();
+    _vehicle->mavlink_direct().send_message(ack);
 }
 
 void MavlinkInterface::on_takeoff(mavsdk::ActionServer::Result result, bool in_prog) {
@@ -104,10 +235,19 @@ void MavlinkInterface::on_mode_change(mavsdk::ActionServer::Result res, mavsdk::
 }
 
 void MavlinkInterface::vehicle_loop() {
+    const auto start = std::chrono::steady_clock::now();
     while (_running) {
-        /// 1hz rate
-        _vehicle->publish_telem();
-        std::this_thread::sleep_for(1s);
+        const uint64_t now_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        uint64_t next_us = 0;
+        _vehicle->publish_streams(_streams.due(now_us, next_us));
+        /// Mode, armed state and mission progress from the control loop, which does not call MAVSDK itself,
+        /// and the missions it dropped, which it does not free itself
+        _manager->report_mode();
+        report_mission_progress();
+        _manager->release_retired();
+        next_us = std::min(next_us, now_us + MODE_REPORT_PERIOD_US);
+        std::this_thread::sleep_until(start + std::chrono::microseconds(next_us));
     }
 }
 
@@ -115,25 +255,25 @@ void MavlinkInterface::on_arm_disarm(mavsdk::ActionServer::Result result, mavsdk
     if (result == mavsdk::ActionServer::Result::Success) {
         if(arm_disarm.arm) {
             MITL_LOG::initialize().program_log("[MavlinkInterface] Arming requested");
-            _vehicle->arm();
-            /// Update state to indicate we're armed
-            _armed.store(true);
+            /// Refused while a health check fails
+            _manager->arm();
         } else {
             MITL_LOG::initialize().program_log("[MavlinkInterface] Disarming requested");
-            _vehicle->disarm();
-            _armed.store(false);
+            /// Refused in flight
+            _manager->disarm();
         }
     } else {
         MITL_LOG::initialize().program_log("[MavlinkInterface] Arm/Disarm request failed");
-        _armed.store(false);
     }
+    /// The vehicle thread reports what the control loop decided
+    _manager->refresh_armed();
 }
 
 void MavlinkInterface::setup_actions() {
     _action->set_allowable_flight_modes({true, true, true});
     _action->set_armable(true, true);
     _action->set_disarmable(true, true);
-    _action->set_armed_state(_armed);
+    _action->set_armed_state(_vehicle->is_armed());
     _action->set_allow_takeoff(true);
 
     _action->subscribe_takeoff([this](auto r, bool b){ this->on_takeoff(r,b); });
@@ -149,8 +289,66 @@ void MavlinkInterface::on_incoming_mission(mavsdk::MissionRawServer::Result res,
                                            mavsdk::MissionRawServer::MissionPlan plan) {
     if (res != mavsdk::MissionRawServer::Result::Success) {
         std::cerr << "Mission upload failed: " << '\n';
+        return;
     }
     MITL_LOG::initialize().program_log("Received Uploaded Mission");
+
+    /// The local frame is centered on home, and relative altitudes are
+    /// above it, so a mission is refused until home is known
+    mavsdk::TelemetryServer::Position home;
+    if (!_vehicle->home(home)) {
+        /// The upload is already acked, do not fly the plan it replaced either
+        MITL_LOG::initialize().program_log("Mission rejected, home is not set");
+        _manager->load_mission(nullptr);
+        return;
+    }
+
+    /// Parse once here, off the control thread
+    std::shared_ptr<const MissionPlan> mission = MissionPlan::parse(plan.mission_items, home.latitude_deg, home.longitude_deg,
+                                                                    home.absolute_altitude_m);
+    MITL_LOG::initialize().program_log("Parsed mission: " + std::to_string(mission->size()) + " waypoints of " +
+                                       std::to_string(plan.mission_items.size()) + " items");
+    _mission_reported.store(0);
+    _mission_target.store(0);
+    _manager->load_mission(std::move(mission));
+}
+
+bool MavlinkInterface::on_incoming_fence(const std::vector<mavsdk::MissionRawServer::MissionItem> &items) {
+    if (items.empty()) {
+        _manager->load_geofence(nullptr);
+        return true;
+    }
+
+    /// Same local frame as the mission
+    mavsdk::TelemetryServer::Position home;
+    if (!_vehicle->home(home)) {
+        MITL_LOG::initialize().program_log("Geofence rejected, home is not set");
+        return false;
+    }
+
+    std::shared_ptr<const Geofence> fence = Geofence::parse(items, home.latitude_deg, home.longitude_deg,
+                                                            home.absolute_altitude_m);
+    if (!fence) {
+        return false;
+    }
+    MITL_LOG::initialize().program_log("Parsed geofence: " + std::to_string(fence->polygons().size()) + " polygons, " +
+                                       std::to_string(fence->circles().size()) + " circles");
+    _manager->load_geofence(std::move(fence));
+    return true;
+}
+
+void MavlinkInterface::on_mission_progress(const MissionProgress &progress) {
+    _mission_target.store(progress.finished ? progress.current_seq + 1 : progress.current_seq);
+}
+
+void MavlinkInterface::report_mission_progress() {
+    uint16_t reported = _mission_reported.load();
+    const uint16_t target = _mission_target.load();
+    while (reported < target) {
+        _mission->set_current_item_complete();
+        reported++;
+    }
+    _mission_reported.store(reported);
 }
 
 void MavlinkInterface::setup_mission_server() {
@@ -159,13 +357,26 @@ void MavlinkInterface::setup_mission_server() {
         [this](auto res, auto plan){ this->on_incoming_mission(res, std::move(plan)); });
 
     _mission->subscribe_current_item_changed(
-        [](mavsdk::MissionRawServer::MissionItem item) {
+        [this](mavsdk::MissionRawServer::MissionItem item) {
             MITL_LOG::initialize().program_log("Current item changed");
+            _mission_reported.store(static_cast<uint16_t>(item.seq));
+            _mission_target.store(static_cast<uint16_t>(item.seq));
+            _manager->set_mission_item(static_cast<uint16_t>(item.seq));
         });
 
-    _mission->subscribe_clear_all([](uint32_t){
+    _mission->subscribe_clear_all([this](uint32_t){
         MITL_LOG::initialize().program_log("Clear All Mission!");
+        /// The plan's arena is freed on the vehicle thread
+        _manager->load_mission(nullptr);
     });
+
+    _morb->subscribe<MissionProgress>("mission_progress", [this](const MissionProgress &progress) {
+        on_mission_progress(progress);
+    });
+
+    _fence_server = std::make_unique<FenceServer>(_vehicle->mavlink_direct(),
+        [this](const std::vector<mavsdk::MissionRawServer::MissionItem> &items) { return on_incoming_fence(items); });
+    _fence_server->start();
 }
 
 bool MavlinkInterface::start() {
@@ -179,17 +390,25 @@ bool MavlinkInterface::start() {
     setup_params();
     MITL_LOG::initialize().program_log("Setting up action");
     setup_actions();
+    MITL_LOG::initialize().program_log("Setting up telemetry");
+    setup_telemetry();
     MITL_LOG::initialize().program_log("Setting up mission");
     setup_mission_server();
     MITL_LOG::initialize().program_log("Setting up modes");
     _manager->initialize_modes();
+
+    /// GCS link for the health checks
+    _system->subscribe_is_connected([this](bool connected) {
+        _morb->publish<LinkStatus>("link_status", {SensorMonitor::wall_time_us(), connected});
+        MITL_LOG::initialize().program_log(connected ? "[MavlinkInterface] GCS connected" : "[MavlinkInterface] GCS link lost");
+    });
     _running = true;
     return true;
 }
 
 void MavlinkInterface::run() {
     _manager->start();
-    _vehicle_thread = std::thread(&MavlinkInterface::vehicle_loop, this);
+    _vehicle_thread = ThreadFactory::initialize().spawn(MitlThread::VEHICLE, [this] {vehicle_loop();});
 }
 
 void MavlinkInterface::stop() {
@@ -200,4 +419,14 @@ void MavlinkInterface::stop() {
     if (_vehicle_thread.joinable()) {
         _vehicle_thread.join();
     }
+    if (_log_server) {
+        _log_server->stop();
+    }
+    if (_fence_server) {
+        _fence_server->stop();
+    }
+    if (_vehicle && _command_subscribed) {
+        _vehicle->mavlink_direct().unsubscribe_message(_command_handle);
+        _command_subscribed = false;
+    }
 }
\ No newline at end of file
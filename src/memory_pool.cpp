@@ -0,0 +1,136 @@
+/**
+ * @file memory_pool.cpp
+ * @author Abdulelah Mulla
+ */
+
+#include "memory_pool.h"
+
+static constexpr size_t BLOCK_ALIGN = alignof(std::max_align_t);
+
+BlockPool::BlockPool(size_t block_size, uint32_t block_count, std::pmr::memory_resource *upstream) :
+    _block_size((block_size + BLOCK_ALIGN - 1) / BLOCK_ALIGN * BLOCK_ALIGN),
+    _block_count(block_count),
+    _upstream(upstream),
+    _blocks(static_cast<std::byte*>(upstream->allocate(_block_size * block_count, BLOCK_ALIGN))),
+    _next(new std::atomic<uint32_t>[block_count]),
+    _head(block_count > 0 ? 0 : NONE)
+{
+    /// Every block free, in address order
+    for (uint32_t i = 0; i < block_count; i++) {
+        _next[i].store(i + 1 < block_count ? i + 1 : NONE, std::memory_order_relaxed);
+    }
+}
+
+BlockPool::~BlockPool() {
+    _upstream->deallocate(_blocks, _block_size * _block_count, BLOCK_ALIGN);
+}
+
+bool BlockPool::owns(const void *p) const {
+    const std::byte *byte = static_cast<const std::byte*>(p);
+    return byte >= _blocks && byte < _blocks + _block_size * _block_count;
+}
+
+void* BlockPool::try_allocate(size_t bytes, size_t alignment) {
+    if (bytes <= _block_size && alignment <= BLOCK_ALIGN) {
+        uint64_t head = _head.load(std::memory_order_acquire);
+        for (;;) {
+            const uint32_t index = static_cast<uint32_t>(head);
+            if (index == NONE) {
+                break;
+            }
+            const uint32_t next = _next[index].load(std::memory_order_relaxed);
+            const uint64_t desired = ((head >> 32) + 1) << 32 | next;
+            if (_head.compare_exchange_weak(head, desired, std::memory_order_acquire,
+                                            std::memory_order_acquire)) {
+                _in_use.fetch_add(1, std::memory_order_relaxed);
+                return _blocks + static_cast<size_t>(index) * _block_size;
+            }
+        }
+    }
+    return nullptr;
+}
+
+void* BlockPool::do_allocate(size_t bytes, size_t alignment) {
+    if (void *block = try_allocate(bytes, alignment)) {
+        return block;
+    }
+    /// Too large, or every block in use
+    _fallbacks.fetch_add(1, std::memory_order_relaxed);
+    return _upstream->allocate(bytes, alignment);
+}
+
+void BlockPool::do_deallocate(void *p, size_t bytes, size_t alignment) {
+    if (!owns(p)) {
+        _upstream->deallocate(p, bytes, alignment);
+        return;
+    }
+    const uint32_t index = static_cast<uint32_t>((static_cast<std::byte*>(p) - _blocks) / _block_size);
+    uint64_t head = _head.load(std::memory_order_relaxed);
+    for (;;) {
+        _next[index].store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+        const uint64_t desired = ((head >> 32) + 1) << 32 | index;
+        if (_head.compare_exchange_weak(head, desired, std::memory_order_release,
+                                        std::memory_order_relaxed)) {
+            break;
+        }
+    }
+    _in_use.fetch_sub(1, std::memory_order_relaxed);
+}
+
+bool BlockPool::do_is_equal(const std::pmr::memory_resource &other) const noexcept {
+    return this == &other;
+}
+
+PoolStats BlockPool::stats() const {
+    PoolStats stats{};
+    stats.block_size = _block_size;
+    stats.blocks = _block_count;
+    stats.in_use = _in_use.load(std::memory_order_relaxed);
+    stats.fallbacks = _fallbacks.load(std::memory_order_relaxed);
+    return stats;
+}
+
+/**
+ * Constructor
+ */
+MessagePools::MessagePools() {
+    for (int i = 0; i < CLASS_COUNT; i++) {
+        _pools[i] = std::make_unique<BlockPool>(BLOCK_SIZES[i], BLOCK_COUNTS[i]);
+    }
+}
+
+MessagePools& MessagePools::initialize() {
+    static MessagePools pools; // one instance
+    return pools;
+}
+
+BlockPool* MessagePools::pool_for(size_t bytes, size_t alignment) {
+    if (alignment > BLOCK_ALIGN) {
+        return nullptr;
+    }
+    for (int i = 0; i < CLASS_COUNT; i++) {
+        if (bytes <= BLOCK_SIZES[i]) {
+            return _pools[i].get();
+        }
+    }
+    return nullptr;
+}
+
+void* MessagePools::do_allocate(size_t bytes, size_t alignment) {
+    BlockPool *pool = pool_for(bytes, alignment);
+    return pool ? pool->allocate(bytes, alignment) : std::pmr::new_delete_resource()->allocate(bytes, alignment);
+}
+
+void MessagePools::do_deallocate(void *p, size_t bytes, size_t alignment) {
+    /// pmr hands back the size it asked for, so this finds the same pool
+    BlockPool *pool = pool_for(bytes, alignment);
+    if (pool) {
+        pool->deallocate(p, bytes, alignment);
+    } else {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+}
+
+bool MessagePools::do_is_equal(const std::pmr::memory_resource &other) const noexcept {
+    return this == &other;
+}
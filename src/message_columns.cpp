@@ -0,0 +1,93 @@
+/**
+ * @file message_columns.cpp
+ * @author Abdulelah Mulla
+ */
+
+#include "message_columns.h"
+
+using google::protobuf::Descriptor;
+using google::protobuf::FieldDescriptor;
+using google::protobuf::Message;
+using google::protobuf::MessageFactory;
+using google::protobuf::Reflection;
+
+MessageColumns::MessageColumns(const Descriptor *type) {
+    if (const Message *prototype = MessageFactory::generated_factory()->GetPrototype(type)) {
+        _message.reset(prototype->New());
+    }
+    std::vector<const FieldDescriptor*> path;
+    add(type, path, "", 0);
+}
+
+void MessageColumns::add(const Descriptor *type, std::vector<const FieldDescriptor*> &path,
+                         const std::string &prefix, int depth) {
+    for (int i = 0; i < type->field_count() && _fields.size() < MAX_FIELDS; i++) {
+        const FieldDescriptor *field = type->field(i);
+        if (field->is_repeated()) {
+            continue;
+        }
+        const std::string name = prefix + std::string(field->name());
+        path.push_back(field);
+        switch (field->cpp_type()) {
+            case FieldDescriptor::CPPTYPE_MESSAGE:
+                /// The top level header has the stamp, the others repeat it
+                if (depth < MAX_DEPTH && (depth == 0 || field->name() != "header")) {
+                    add(field->message_type(), path, name + ".", depth + 1);
+                }
+                break;
+            case FieldDescriptor::CPPTYPE_STRING:
+                break;
+            default:
+                _fields.push_back({name, LogFieldType::F64, static_cast<uint16_t>(_paths.size() * sizeof(double))});
+                _paths.push_back(path);
+                break;
+        }
+        path.pop_back();
+    }
+}
+
+bool MessageColumns::flatten(const void *bytes, uint32_t size, double *row) {
+    if (!_message || !_message->ParseFromArray(bytes, static_cast<int>(size))) {
+        return false;
+    }
+    for (size_t i = 0; i < _paths.size(); i++) {
+        const std::vector<const FieldDescriptor*> &path = _paths[i];
+        /// Unset submessages read as their defaults
+        const Message *message = _message.get();
+        for (size_t k = 0; k + 1 < path.size(); k++) {
+            message = &message->GetReflection()->GetMessage(*message, path[k]);
+        }
+        const Reflection *reflection = message->GetReflection();
+        const FieldDescriptor *field = path.back();
+        switch (field->cpp_type()) {
+            case FieldDescriptor::CPPTYPE_INT32:
+                row[i] = reflection->GetInt32(*message, field);
+                break;
+            case FieldDescriptor::CPPTYPE_INT64:
+                row[i] = static_cast<double>(reflection->GetInt64(*message, field));
+                break;
+            case FieldDescriptor::CPPTYPE_UINT32:
+                row[i] = reflection->GetUInt32(*message, field);
+                break;
+            case FieldDescriptor::CPPTYPE_UINT64:
+                row[i] = static_cast<double>(reflection->GetUInt64(*message, field));
+                break;
+            case FieldDescriptor::CPPTYPE_DOUBLE:
+                row[i] = reflection->GetDouble(*message, field);
+                break;
+            case FieldDescriptor::CPPTYPE_FLOAT:
+                row[i] = reflection->GetFloat(*message, field);
+                break;
+            case FieldDescriptor::CPPTYPE_BOOL:
+                row[i] = reflection->GetBool(*message, field);
+                break;
+            case FieldDescriptor::CPPTYPE_ENUM:
+                row[i] = reflection->GetEnumValue(*message, field);
+                break;
+            default:
+                row[i] = 0;
+                break;
+        }
+    }
+    return true;
+}
@@ -3,28 +3,90 @@
  * @author Abdulelah Mulla
  */
 
+#include <cmath>
+#include <cstdio>
+
 #include "mode/hold.h"
+#include "navigator/navigator.h"
+#include "morb.h"
+#include "log.h"
 
-Hold::Hold() {
+Hold::Hold(Morb *morb, Navigator *navigator) :
+    _morb(morb),
+    _navigator(navigator)
+{
     state_id = 2;
+    MITL_LOG::initialize().program_log("[Hold] Initialized Hold");
+}
+
+Hold::~Hold() {
+    MITL_LOG::initialize().program_log("[Hold] Destroyed Hold");
 }
 
 void Hold::on_activation() {
+    PosSet *pos = _navigator->get_position();
+    _yaw = pos->current.yaw;
+
+    /// Hold where we are, the braking profile takes over from here
+    pos->target = pos->current;
+    pos->target.yaw = _yaw;
+    pos->target.ax = 0;
+    pos->target.ay = 0;
+    pos->target.az = 0;
+    _frame = LocalFrame(pos->current.lat, pos->current.lon, pos->current.alt);
+    _v0[0] = pos->current.vx;
+    _v0[1] = pos->current.vy;
+    _v0[2] = pos->current.vz;
+    const float speed = std::sqrt(_v0[0] * _v0[0] + _v0[1] * _v0[1] + _v0[2] * _v0[2]);
+    _stop_time = speed / BRAKE_DECELERATION;
+    _start_time = Navigator::now();
+    _braking = _navigator->position_valid() && _stop_time > 0.f;
+    if (!_braking) {
+        pos->target.vx = 0;
+        pos->target.vy = 0;
+        pos->target.vz = 0;
+    }
+    _navigator->notify_position_updated();
 
+    /// On the control thread, format without allocating
+    char msg[64];
+    std::snprintf(msg, sizeof(msg), "[Hold] Activated, braking from %f m/s", speed);
+    MITL_LOG::initialize().program_log_nowait(msg);
 }
 
 void Hold::on_active() {
+    if (!_braking) {
+        /// Latched, the setpoint does not change
+        return;
+    }
 
+    /// Constant deceleration along the entry velocity
+    const float t = static_cast<float>(Navigator::now() - _start_time);
+    TrajectoryPoint point{};
+    if (t >= _stop_time) {
+        for (int axis = 0; axis < 3; axis++) {
+            point.ned[axis] = 0.5f * _v0[axis] * _stop_time;
+        }
+        _braking = false;
+    } else {
+        const float slow = 1.f - t / _stop_time;
+        for (int axis = 0; axis < 3; axis++) {
+            point.ned[axis] = _v0[axis] * (t - 0.5f * t * t / _stop_time);
+            point.vel[axis] = _v0[axis] * slow;
+            point.acc[axis] = -_v0[axis] / _stop_time;
+        }
+    }
+    _navigator->set_target(_frame, point);
+    _navigator->get_position()->target.yaw = _yaw;
 }
 
 void Hold::on_inactivation() {
-
+    _braking = false;
 }
 
 void Hold::on_inactive() {
-
 }
 
 bool Hold::is_complete() const {
     return false;
-}
\ No newline at end of file
+}
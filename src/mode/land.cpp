@@ -3,28 +3,136 @@
  * @author Abdulelah Mulla
  */
 
+#include <algorithm>
+#include <cmath>
+
 #include "mode/land.h"
+#include "navigator/navigator.h"
+#include "morb.h"
+#include "log.h"
 
-Land::Land() {
+Land::Land(Morb *morb, Navigator *navigator) :
+    _morb(morb),
+    _navigator(navigator)
+{
     state_id = 3;
+    MITL_LOG::initialize().program_log("[Land] Initialized Land");
+}
+
+Land::~Land() {
+    MITL_LOG::initialize().program_log("[Land] Destroyed Land");
+}
+
+float Land::descent_rate(float height) {
+    if (height >= SLOW_DOWN_HEIGHT) {
+        return DESCENT_RATE_FAST;
+    }
+    if (height <= TOUCHDOWN_HEIGHT) {
+        return DESCENT_RATE_SLOW;
+    }
+    const float blend = (height - TOUCHDOWN_HEIGHT) / (SLOW_DOWN_HEIGHT - TOUCHDOWN_HEIGHT);
+    return DESCENT_RATE_SLOW + blend * (DESCENT_RATE_FAST - DESCENT_RATE_SLOW);
+}
+
+void Land::update_detector() {
+    const LandDetected &detected = _navigator->land_detected();
+    if (detected.landed) {
+        _state = LandState::LANDED;
+        MITL_LOG::initialize().program_log_nowait("[Land] Landed");
+    } else if (detected.ground_contact) {
+        if (_state == LandState::DESCENDING) {
+            _state = LandState::GROUND_CONTACT;
+            MITL_LOG::initialize().program_log_nowait("[Land] Ground contact");
+        }
+    } else if (_state == LandState::GROUND_CONTACT) {
+        /// Bounced or slid, keep descending
+        _state = LandState::DESCENDING;
+        _last_time = Navigator::now();
+        MITL_LOG::initialize().program_log_nowait("[Land] Ground contact lost");
+    }
 }
 
 void Land::on_activation() {
+    PosSet *pos = _navigator->get_position();
+
+    /// Descend straight down from here
+    _lat = pos->current.lat;
+    _lon = pos->current.lon;
+    _yaw = pos->current.yaw;
+    _alt_sp = pos->current.alt;
+    _rate_sp = std::max(pos->current.vz, 0.f);
+    _last_time = Navigator::now();
 
+    pos->target.lat = _lat;
+    pos->target.lon = _lon;
+    pos->target.alt = _alt_sp;
+    pos->target.yaw = _yaw;
+    pos->target.vx = 0;
+    pos->target.vy = 0;
+    pos->target.vz = _rate_sp;
+    pos->target.ax = 0;
+    pos->target.ay = 0;
+    pos->target.az = 0;
+    _navigator->notify_position_updated();
+
+    _state = LandState::DESCENDING;
+    MITL_LOG::initialize().program_log_nowait("[Land] Activated");
 }
 
 void Land::on_active() {
+    if (_state == LandState::LANDED) {
+        return;
+    }
+    update_detector();
+
+    Position &target = _navigator->get_position()->target;
+    if (_state == LandState::LANDED) {
+        /// Settled, stop pushing down
+        target.vz = 0;
+        target.az = 0;
+        _navigator->notify_position_updated();
+        return;
+    }
+    if (_state != LandState::DESCENDING) {
+        /// On the ground, the setpoint stays where it is
+        return;
+    }
+
+    const double now = Navigator::now();
+    const float dt = std::clamp(static_cast<float>(now - _last_time), 0.f, 0.1f);
+    _last_time = now;
+
+    /// Ramp the rate towards the scheduled one
+    const VehicleState &state = _navigator->vehicle_state();
+    const float height = state.local_valid ? -state.position[2] : 0.f;
+    const float max_step = DESCENT_ACCELERATION * dt;
+    const float step = std::clamp(descent_rate(height) - _rate_sp, -max_step, max_step);
+    _rate_sp += step;
 
+    /// Never lead the vehicle by more than MAX_LEAD
+    const double current_alt = _navigator->get_position()->current.alt;
+    _alt_sp = std::max(_alt_sp - _rate_sp * dt, current_alt - MAX_LEAD);
+
+    target.lat = _lat;
+    target.lon = _lon;
+    target.alt = _alt_sp;
+    target.yaw = _yaw;
+    target.vx = 0;
+    target.vy = 0;
+    target.vz = _rate_sp;
+    target.ax = 0;
+    target.ay = 0;
+    target.az = dt > 0.f ? step / dt : 0.f;
+    _navigator->notify_position_updated();
 }
 
 void Land::on_inactivation() {
-
+    _state = LandState::INIT;
 }
 
 void Land::on_inactive() {
-
 }
 
 bool Land::is_complete() const {
-    return false;
-}
\ No newline at end of file
+    return _state == LandState::LANDED;
+}
@@ -0,0 +1,169 @@
+/**
+ * @file mission.cpp
+ * @author Abdulelah Mulla
+ */
+
+#include <cmath>
+#include <cstdio>
+
+#include "mode/mission.h"
+#include "navigator/navigator.h"
+#include "morb.h"
+#include "log.h"
+
+Mission::Mission(Morb *morb, Navigator *navigator) :
+    _morb(morb),
+    _navigator(navigator)
+{
+    state_id = 4;
+    MITL_LOG::initialize().program_log("[Mission] Initialized Mission");
+}
+
+Mission::~Mission() {
+    MITL_LOG::initialize().program_log("[Mission] Destroyed Mission");
+}
+
+void Mission::set_target() {
+    PosSet *pos = _navigator->get_position();
+    const MissionWaypoint &waypoint = (*_plan)[_index];
+    pos->target.lat = waypoint.lat;
+    pos->target.lon = waypoint.lon;
+    pos->target.alt = waypoint.alt;
+    pos->target.yaw = std::isfinite(waypoint.yaw) ? waypoint.yaw : pos->current.yaw;
+    pos->target.vx = 0;
+    pos->target.vy = 0;
+    pos->target.vz = 0;
+    pos->target.ax = 0;
+    pos->target.ay = 0;
+    pos->target.az = 0;
+    _navigator->notify_position_updated();
+
+    if (!_navigator->position_valid()) {
+        /// Nowhere to start a trajectory from
+        _tracker.reset();
+        return;
+    }
+    TrajectoryPoint start{};
+    _plan->frame().to_ned(pos->current.lat, pos->current.lon, pos->current.alt, start.ned);
+    start.vel[0] = pos->current.vx;
+    start.vel[1] = pos->current.vy;
+    start.vel[2] = pos->current.vz;
+    /// Shares the plan, the rest of the mission is not copied
+    const WaypointPath rest(_plan, _plan->path() + _index);
+    _tracker.start(_navigator->trajectories(), rest, _plan->size() - _index, start, LIMITS);
+}
+
+void Mission::report(uint16_t reached_seq) {
+    MissionProgress progress{};
+    progress.finished = _complete;
+    progress.current_seq = _complete ? (*_plan)[_plan->size() - 1].seq : (*_plan)[_index].seq;
+    progress.reached_seq = reached_seq;
+    _morb->publish<MissionProgress>("mission_progress", progress);
+}
+
+void Mission::update_plan() {
+    std::shared_ptr<const MissionPlan> plan = _navigator->mission_plan();
+    if (plan != _plan) {
+        /// New upload, or cleared
+        _plan = plan;
+        _index = 0;
+        _complete = false;
+        if (_plan && !_plan->empty()) {
+            /// On the control thread, format without allocating
+            char msg[64];
+            std::snprintf(msg, sizeof(msg), "[Mission] Flying %zu waypoints, %d m",
+                          _plan->size(), static_cast<int>(_plan->total_length()));
+            MITL_LOG::initialize().program_log_nowait(msg);
+            set_target();
+            report((*_plan)[0].seq);
+        }
+    }
+
+    const int32_t jump = _navigator->take_mission_jump();
+    if (jump >= 0 && _plan && !_plan->empty()) {
+        const size_t index = _plan->index_of(static_cast<uint16_t>(jump));
+        if (index < _plan->size()) {
+            _index = index;
+            _complete = false;
+            set_target();
+            report((*_plan)[_index].seq);
+        }
+    }
+}
+
+void Mission::on_activation() {
+    if (_complete) {
+        /// Fly a finished mission again from the start
+        _plan.reset();
+    }
+    const bool resume = _plan && _plan == _navigator->mission_plan();
+    update_plan();
+
+    if (!_plan || _plan->empty()) {
+        /// Nothing to fly, hold here
+        PosSet *pos = _navigator->get_position();
+        pos->target = pos->current;
+        pos->target.vx = 0;
+        pos->target.vy = 0;
+        pos->target.vz = 0;
+        _navigator->notify_position_updated();
+        MITL_LOG::initialize().program_log_nowait("[Mission] Activated without a mission, holding");
+        return;
+    }
+    if (resume) {
+        set_target();
+    }
+    char msg[48];
+    std::snprintf(msg, sizeof(msg), "[Mission] Activated at item %u", static_cast<unsigned>((*_plan)[_index].seq));
+    MITL_LOG::initialize().program_log_nowait(msg);
+}
+
+void Mission::on_active() {
+    update_plan();
+    if (!_plan || _plan->empty()) {
+        return;
+    }
+
+    TrajectoryPoint point;
+    if (_tracker.sample(_navigator->trajectories(), Navigator::now(), point)) {
+        _navigator->set_target(_plan->frame(), point);
+    }
+    if (_complete || !_navigator->position_valid()) {
+        return;
+    }
+
+    /// Vehicle in the plan frame
+    const PosSet *pos = _navigator->get_position();
+    float ned[3];
+    _plan->frame().to_ned(pos->current.lat, pos->current.lon, pos->current.alt, ned);
+
+    const MissionWaypoint &waypoint = (*_plan)[_index];
+    const float dn = waypoint.ned[0] - ned[0];
+    const float de = waypoint.ned[1] - ned[1];
+    const float dd = waypoint.ned[2] - ned[2];
+    const bool reached = dn * dn + de * de <= waypoint.acceptance_radius * waypoint.acceptance_radius &&
+                         std::fabs(dd) <= MissionPlan::ALTITUDE_ACCEPTANCE;
+    if (!reached) {
+        return;
+    }
+
+    _index++;
+    if (_index >= _plan->size()) {
+        _index = _plan->size() - 1;
+        _complete = true;
+        MITL_LOG::initialize().program_log_nowait("[Mission] Complete");
+    }
+    /// The trajectory already runs through the next waypoints
+    report(waypoint.seq);
+}
+
+void Mission::on_inactivation() {
+    _tracker.reset();
+}
+
+void Mission::on_inactive() {
+}
+
+bool Mission::is_complete() const {
+    return _complete;
+}
@@ -3,11 +3,13 @@
  * @author Abdulelah Mulla
  */
 
+#include <cmath>
 #include <iostream>
 
 #include "mode/takeoff.h"
 #include "navigator/navigator.h"
 #include "morb.h"
+#include "params.h"
 #include "log.h"
 
 Takeoff::Takeoff(Morb *morb, Navigator *navigator) :
@@ -31,19 +33,35 @@ void Takeoff::on_activation() {
     pos->target.lon = pos->current.lon;
     pos->target.yaw = pos->current.yaw;
 
-    /// Target altitude, Hardcoded to 10m
-    _takeoff_alt_amsl = pos->current.alt + 10.0f;
-    pos->target.alt = _takeoff_alt_amsl;
-
-    /// Initialize velocities to zero
+    /// Hold where we are until the climb is solved
+    pos->target.alt = pos->current.alt;
     pos->target.vx = 0;
     pos->target.vy = 0;
-    pos->target.vz = -0.5;
+    pos->target.vz = 0;
+    pos->target.ax = 0;
+    pos->target.ay = 0;
+    pos->target.az = 0;
+
+    /// Smooth climb straight up
+    _height = Params::initialize().get(param::MIS_TAKEOFF_ALT);
+    _frame = LocalFrame(pos->current.lat, pos->current.lon, pos->current.alt);
+    if (_top.use_count() > 1) {
+        /// The last climb is still being solved
+        _top.reset(new float[1][3]{});
+    }
+    _top[0][0] = 0.f;
+    _top[0][1] = 0.f;
+    _top[0][2] = -_height;
+    TrajectoryPoint start{};
+    start.vel[0] = pos->current.vx;
+    start.vel[1] = pos->current.vy;
+    start.vel[2] = pos->current.vz;
+    _tracker.start(_navigator->trajectories(), _top, 1, start, LIMITS);
 
     /// Update state
     _state = TakeoffState::CLIMBING;
 
-    MITL_LOG::initialize().program_log("[Takeoff] Activated");
+    MITL_LOG::initialize().program_log_nowait("[Takeoff] Activated");
 }
 
 void Takeoff::on_active() {
@@ -51,14 +69,21 @@ void Takeoff::on_active() {
     PosSet *pos = _navigator->get_position();
 
     if (_state == TakeoffState::CLIMBING) {
-        /// Notify navigator to publish the position setpoint
-        _navigator->notify_position_updated();
+        TrajectoryPoint point;
+        if (_tracker.sample(_navigator->trajectories(), Navigator::now(), point)) {
+            _navigator->set_target(_frame, point);
+        } else {
+            /// Notify navigator to publish the position setpoint
+            _navigator->notify_position_updated();
+        }
 
         /// Check if we reached our target altitude
-        float alt_error = std::abs(pos->current.alt - pos->target.alt);
+        float ned[3];
+        _frame.to_ned(pos->current.lat, pos->current.lon, pos->current.alt, ned);
+        float alt_error = std::abs(ned[2] + _height);
         if (alt_error < ALTITUDE_THRESHOLD) {
             _state = TakeoffState::COMPLETE;
-            MITL_LOG::initialize().program_log("[Takeoff] Complete");
+            MITL_LOG::initialize().program_log_nowait("[Takeoff] Complete");
         }
     } else if (_state == TakeoffState::COMPLETE) {
         /// Hold current position - set target to current
@@ -69,6 +94,7 @@ void Takeoff::on_active() {
 
 void Takeoff::on_inactivation() {
     _state = TakeoffState::INIT;
+    _tracker.reset();
 }
 
 void Takeoff::on_inactive() {
@@ -3,18 +3,22 @@
  * @author Abdulelah Mulla
  */
 
-#include <iostream>
+#include <algorithm>
+#include <cstdio>
 
 #include "mode_manager.h"
 #include "controllers/controller.h"
 #include "log.h"
+#include "alloc_audit.h"
+#include "scheduler.h"
 
 
 ModeManager::ModeManager(Vehicle& vehicle, mavsdk::ActionServer& action, Morb *morb) :
      _vehicle(vehicle), 
      _action(action),
      _morb(morb),
-     _navigator(_morb) 
+     _navigator(_morb),
+     _params(Params::initialize())
      {
         MITL_LOG::initialize().program_log("[ModeManager] Initialized ModeManager");
      }
@@ -28,19 +32,38 @@ ModeManager::~ModeManager() {
 void ModeManager::initialize_modes() {
     MITL_LOG::initialize().program_log("[ModeManager] Initializing modes...");
     /// Start in Ground mode
-    _curr_mode = mavsdk::ActionServer::FlightMode::Ready;
+    _curr_mode = ModeId::READY;
+    _reported_mode = ModeId::READY;
     _action.set_flight_mode(mavsdk::ActionServer::FlightMode::Ready);
     _navigator.set_mode(mavsdk::ActionServer::FlightMode::Ready);
     _vehicle.set_mode(mavsdk::ActionServer::FlightMode::Ready);
 
-    /// Subscribe to mode completion events
-    _morb->subscribe<std::string>("mode_complete", [this](const std::string& mode) {
-        /// Handle transitions
-        if (mode == "takeoff") {
-            change_mode(mavsdk::ActionServer::FlightMode::Hold);
+    /// Keep track of sensor health for takeoff checks
+    _morb->subscribe<SensorHealth>("sensor_health", [this](const SensorHealth& health) {
+        _sensors_healthy.store(health.healthy());
+        _sensor_health_time.store(health.timestamp);
+    });
+
+    /// Arming checks and failsafes
+    _morb->subscribe<HealthReport>("health_report", [this](const HealthReport& report) {
+        _health_failing.store(report.failing);
+        _health_arming_ok.store(report.arming_ok());
+        _health_time.store(report.timestamp);
+    });
+
+    /// A stuck thread lands the vehicle, if MITL_WD_ACTION says so
+    _morb->subscribe<WatchdogReport>("watchdog_report", [this](const WatchdogReport& report) {
+        if (report.failsafe) {
+            _watchdog_failsafe.store(true);
         }
     });
 
+    /// Ready disarms, only allow it on the ground
+    _morb->subscribe<LandDetected>("land_detected", [this](const LandDetected& detected) {
+        _landed.store(detected.landed);
+        _landed_time.store(SensorMonitor::wall_time_us());
+    });
+
     MITL_LOG::initialize().program_log("[ModeManager] All modes initialized, starting in Ground mode");
 }
 
@@ -48,8 +71,14 @@ void ModeManager::start() {
     if (_running.load()) {
         return;
     }
+    /// Requests left from a previous run are stale
+    ModeCommand command;
+    while (_commands.pop(command)) {
+        _acks[command.seq % COMMAND_QUEUE_SIZE].store((static_cast<uint64_t>(command.seq) << 2) | ACK_REFUSED,
+                                                      std::memory_order_release);
+    }
     _running.store(true);
-    _control_thread = std::thread(&ModeManager::control_loop, this);
+    _control_thread = ThreadFactory::initialize().spawn(MitlThread::CONTROL, [this] {control_loop();});
 }
 
 void ModeManager::stop() {
@@ -63,106 +92,364 @@ void ModeManager::stop() {
 }
 
 void ModeManager::control_loop() {
+    RateGroups &groups = RateGroups::initialize();
+    Watchdog &watchdog = Watchdog::initialize();
+    int watched_rate = 0;
     while (_running.load()) {
         auto loop_start =std::chrono::high_resolution_clock::now();
-        {
-            /// Lock mutex for the duration of this update cycle
-            std::lock_guard<std::mutex> lock(_mutex);
-            _navigator.run();
+        const uint64_t group_start = groups.begin(RateGroup::POSITION);
+        watchdog.stage(MitlThread::CONTROL, "params");
+        _control_rate = _params.get(param::MITL_CTRL_HZ);
+        _control_period = std::chrono::microseconds(1000000 / _control_rate);
+        if (_control_rate != watched_rate) {
+            watched_rate = _control_rate;
+            watchdog.watch(MitlThread::CONTROL, WATCHDOG_PERIODS * _control_period);
+        }
+        /// GCS requests first, the navigator runs the new mode
+        watchdog.stage(MitlThread::CONTROL, "commands");
+        run_commands();
+        watchdog.stage(MitlThread::CONTROL, "navigator");
+        _navigator.run();
+        watchdog.stage(MitlThread::CONTROL, "transitions");
+        /// Auto-transitions
+        if (_navigator.mode_complete()) {
+            dispatch(ModeEvent::MODE_COMPLETE);
+        }
+        /// Geofence failsafe
+        const GeofenceStatus &fence = _navigator.fence_status();
+        if (fence.breached) {
+            if (dispatch(ModeEvent::FENCE_BREACHED)) {
+                MITL_LOG::initialize().program_log_nowait("[ModeManager] Geofence breached, landing");
+            }
+        } else if (fence.time_to_breach < Navigator::FENCE_PREDICT_TIME) {
+            if (dispatch(ModeEvent::FENCE_PREDICTED)) {
+                MITL_LOG::initialize().program_log_nowait("[ModeManager] Geofence breach predicted, holding");
+            }
+        }
+        /// Health failsafe
+        if (_health_failing.load() & HEALTH_FAILSAFE) {
+            if (dispatch(ModeEvent::FAILSAFE)) {
+                MITL_LOG::initialize().program_log_nowait("[ModeManager] Health check failed, landing");
+            }
         }
-        /// We release the mutex
-        /// Sleep for remainder of control period to maintain fixed rate
+        /// Watchdog failsafe, possibly for this very thread
+        if (_watchdog_failsafe.exchange(false)) {
+            if (dispatch(ModeEvent::FAILSAFE)) {
+                MITL_LOG::initialize().program_log_nowait("[ModeManager] Deadline missed, landing");
+            }
+        }
+        watchdog.stage(MitlThread::CONTROL, "stats");
+        groups.end(RateGroup::POSITION, group_start);
         auto loop_end = std::chrono::high_resolution_clock::now();
         auto elapsed = loop_end - loop_start;
-        if (elapsed < _CONTROL_PERIOD) {
-            std::this_thread::sleep_for(_CONTROL_PERIOD - elapsed);
-        } else {
-            /// Log if we're running slower than desired rate
-            std::cerr << "Warning: Control loop took longer than anticipated" << std::endl;
+        /// Overruns are counted in the stats, no I/O on this thread
+        record_cycle(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed));
+        if (groups.ticking()) {
+            /// In phase with the IMU, the timeout only covers a stalled sensor
+            groups.wait(RateGroup::POSITION, 2 * _control_period);
+        } else if (elapsed < _control_period) {
+            /// No IMU, sleep for remainder of control period to maintain fixed rate
+            std::this_thread::sleep_for(_control_period - elapsed);
         }
     }
+    watchdog.unwatch(MitlThread::CONTROL);
 }
 
-bool ModeManager::isValidTransition(mavsdk::ActionServer::FlightMode new_mode_type) {
-    switch (_curr_mode) {
-        case mavsdk::ActionServer::FlightMode::Ready:
-            return new_mode_type == mavsdk::ActionServer::FlightMode::Takeoff;
+bool ModeManager::dispatch(ModeEvent event) {
+    const ModeId from = _curr_mode.load();
+    const ModeTransition *transition = find_transition(from, event);
+    if (!transition) {
+        return false;
+    }
+    if (!check_guard(transition->guard)) {
+        return false;
+    }
+    /// Perform transition
+    const ModeInfo &info = MODE_INFO[static_cast<int>(transition->to)];
+    run_action(MODE_INFO[static_cast<int>(from)].on_exit);
+    _navigator.set_mode(info.flight_mode);
+    _curr_mode = transition->to;
+    _vehicle.set_mode(info.flight_mode);
+    run_action(info.on_entry);
+    _morb->publish<ModeChange>("mode_change", {Scheduler::initialize().get_time(), from, transition->to, event});
+    return true;
+}
 
-        case mavsdk::ActionServer::FlightMode::Takeoff:
-            return new_mode_type == mavsdk::ActionServer::FlightMode::Hold;
+bool ModeManager::check_guard(ModeGuard guard) const {
+    switch (guard) {
+        case ModeGuard::HEALTHY:
+            if (!healthy()) {
+                MITL_LOG::initialize().program_log_nowait("[ModeManager] Transition refused, health checks failing");
+                return false;
+            }
+            return true;
+        case ModeGuard::LANDED:
+            if (!landed()) {
+                MITL_LOG::initialize().program_log_nowait("[ModeManager] Transition refused, not landed");
+                return false;
+            }
+            return true;
+        case ModeGuard::NONE:
+        default:
+            return true;
+    }
+}
 
-        case mavsdk::ActionServer::FlightMode::Hold:
-            return new_mode_type == mavsdk::ActionServer::FlightMode::Land ||
-                   new_mode_type == mavsdk::ActionServer::FlightMode::Mission;
+void ModeManager::run_action(ModeAction action) {
+    switch (action) {
+        case ModeAction::DISARM:
+            disarm_vehicle();
+            break;
+        case ModeAction::NONE:
+        default:
+            break;
+    }
+}
 
-        case mavsdk::ActionServer::FlightMode::Mission:
-            return new_mode_type == mavsdk::ActionServer::FlightMode::Hold;
+bool ModeManager::submit(ModeCommandType type, ModeId mode) {
+    if (!_running.load()) {
+        return false;
+    }
+    const uint32_t seq = _next_seq.fetch_add(1, std::memory_order_relaxed);
+    if (!_commands.push({type, mode, seq})) {
+        MITL_LOG::initialize().program_log("[ModeManager] Request dropped, queue full");
+        return false;
+    }
+    /// The control loop runs it within a cycle
+    const uint64_t tag = static_cast<uint64_t>(seq) << 2;
+    std::atomic<uint64_t> &ack = _acks[seq % COMMAND_QUEUE_SIZE];
+    const auto finished = [&] {
+        const uint64_t value = ack.load(std::memory_order_acquire);
+        /// Past seq, overwritten by a later request
+        return (value >> 2) > seq || value == (tag | ACK_ACCEPTED) || value == (tag | ACK_REFUSED);
+    };
+    std::unique_lock<std::mutex> lock(_ack_mutex);
+    _ack_ready.wait_for(lock, COMMAND_TIMEOUT, finished);
+    uint64_t value = ack.load(std::memory_order_acquire);
+    while ((value >> 2) < seq) {
+        /// Not picked up yet, make sure it never runs
+        if (ack.compare_exchange_weak(value, tag | ACK_CANCELLED, std::memory_order_acq_rel)) {
+            MITL_LOG::initialize().program_log("[ModeManager] Request timed out");
+            return false;
+        }
+    }
+    /// Claimed, it finishes within this cycle
+    _ack_ready.wait(lock, finished);
+    return ack.load(std::memory_order_acquire) == (tag | ACK_ACCEPTED);
+}
 
-        case mavsdk::ActionServer::FlightMode::Land:
-            return new_mode_type == mavsdk::ActionServer::FlightMode::Ready;
+void ModeManager::run_commands() {
+    ModeCommand command;
+    bool finished = false;
+    while (_commands.pop(command)) {
+        const uint64_t tag = static_cast<uint64_t>(command.seq) << 2;
+        std::atomic<uint64_t> &ack = _acks[command.seq % COMMAND_QUEUE_SIZE];
+        /// Claim it, unless the requester gave up on it
+        uint64_t value = ack.load(std::memory_order_acquire);
+        if (value == (tag | ACK_CANCELLED) ||
+            !ack.compare_exchange_strong(value, tag | ACK_RUNNING, std::memory_order_acq_rel)) {
+            continue;
+        }
+        const bool accepted = execute(command);
+        ack.store(tag | (accepted ? ACK_ACCEPTED : ACK_REFUSED), std::memory_order_release);
+        finished = true;
+    }
+    if (finished) {
+        /// A requester between its check and its wait holds the lock, so
+        /// taking it once means every requester sees the ack or the notify
+        {
+            const std::lock_guard<std::mutex> lock(_ack_mutex);
+        }
+        _ack_ready.notify_all();
+    }
+}
 
+bool ModeManager::execute(const ModeCommand &command) {
+    switch (command.type) {
+        case ModeCommandType::SET_MODE:
+            return dispatch(MODE_INFO[static_cast<int>(command.mode)].request);
+        case ModeCommandType::TAKEOFF:
+            /// Check if we need to arm first
+            if (!_vehicle.is_armed() && !arm_checked()) {
+                return false;
+            }
+            return dispatch(ModeEvent::REQUEST_TAKEOFF);
+        case ModeCommandType::LAND:
+            return dispatch(ModeEvent::REQUEST_LAND);
+        case ModeCommandType::ARM:
+            return arm_checked();
+        case ModeCommandType::DISARM:
+            if (_curr_mode.load() != ModeId::READY && !landed()) {
+                MITL_LOG::initialize().program_log_nowait("[ModeManager] Disarming refused, in flight");
+                return false;
+            }
+            disarm_vehicle();
+            return true;
         default:
             return false;
     }
 }
 
-mavsdk::ActionServer::FlightMode ModeManager::get_next_mode(mavsdk::ActionServer::FlightMode current) {
-    /// Automatic transitions when a mode completes
-    switch (current) {
-        case mavsdk::ActionServer::FlightMode::Takeoff:
-            return mavsdk::ActionServer::FlightMode::Hold;
+bool ModeManager::change_mode(mavsdk::ActionServer::FlightMode mode) {
+    ModeId id;
+    if (!mode_from_flight_mode(mode, id)) {
+        return false;
+    }
+    return submit(ModeCommandType::SET_MODE, id);
+}
 
-        case mavsdk::ActionServer::FlightMode::Mission:
-            return mavsdk::ActionServer::FlightMode::Hold;
+bool ModeManager::activate_takeoff() {
+    return submit(ModeCommandType::TAKEOFF);
+}
 
-        case mavsdk::ActionServer::FlightMode::Land:
-            return mavsdk::ActionServer::FlightMode::Ready;
+bool ModeManager::arm() {
+    return submit(ModeCommandType::ARM);
+}
 
-        default:
-            return current;
+bool ModeManager::arm_checked() {
+    if (!healthy()) {
+        MITL_LOG::initialize().program_log_nowait("[ModeManager] Arming refused, health checks failing");
+        return false;
+    }
+    const bool was_armed = _vehicle.is_armed();
+    _vehicle.arm();
+    if (!was_armed && _vehicle.is_armed()) {
+        AllocAudit::start();
+    }
+    return _vehicle.is_armed();
+}
+
+void ModeManager::disarm_vehicle() {
+    const bool was_armed = _vehicle.is_armed();
+    _vehicle.disarm();
+    if (!was_armed) {
+        return;
+    }
+    AllocAudit::stop();
+    const uint64_t count = AllocAudit::count();
+    if (count > 0) {
+        AllocRecord records[AllocAudit::RECORDS];
+        const int n = AllocAudit::records(records, AllocAudit::RECORDS);
+        char msg[96];
+        std::snprintf(msg, sizeof(msg), "[ModeManager] %llu allocations on the control path while armed",
+                      static_cast<unsigned long long>(count));
+        MITL_LOG::initialize().program_log_nowait(msg);
+        for (int i = 0; i < n; i++) {
+            std::snprintf(msg, sizeof(msg), "[ModeManager]   %zu bytes on %s", records[i].size,
+                          THREAD_TABLE[static_cast<int>(records[i].thread)].name);
+            MITL_LOG::initialize().program_log_nowait(msg);
+        }
     }
 }
 
-bool ModeManager::change_mode_internal(mavsdk::ActionServer::FlightMode new_mode_type) {
-    /// Check if mode exists
-    if (new_mode_type == mavsdk::ActionServer::FlightMode::Unknown) {
+bool ModeManager::disarm() {
+    return submit(ModeCommandType::DISARM);
+}
+
+void ModeManager::record_cycle(std::chrono::nanoseconds elapsed) {
+    const uint32_t elapsed_us = static_cast<uint32_t>(elapsed.count() / 1000);
+    _loop_stats.cycles++;
+    if (elapsed > _control_period) {
+        _loop_stats.overruns++;
+    }
+    _loop_window_max_us = std::max(_loop_window_max_us, elapsed_us);
+    if (_loop_stats.cycles % _control_rate == 0) {
+        _loop_stats.timestamp = SensorMonitor::wall_time_us();
+        _loop_stats.max_cycle_us = _loop_window_max_us;
+        _loop_window_max_us = 0;
+        _morb->publish<ControlLoopStats>("control_loop_stats", _loop_stats);
+    }
+}
+
+bool ModeManager::activate_land() {
+    return submit(ModeCommandType::LAND);
+}
+
+void ModeManager::load_mission(std::shared_ptr<const MissionPlan> plan) {
+    retire(_navigator.set_mission(std::move(plan)));
+}
+
+void ModeManager::load_geofence(std::shared_ptr<const Geofence> fence) {
+    retire(_navigator.set_geofence(std::move(fence)));
+}
+
+void ModeManager::retire(std::shared_ptr<const void> replaced) {
+    if (!replaced) {
+        return;
+    }
+    const std::lock_guard<std::mutex> lock(_retired_mutex);
+    _retired.push_back(std::move(replaced));
+}
+
+void ModeManager::release_retired() {
+    const std::lock_guard<std::mutex> lock(_retired_mutex);
+    /// Unreachable from the navigator, so nobody takes a new reference, once
+    /// ours is the last the control thread is done with it
+    _retired.erase(std::remove_if(_retired.begin(), _retired.end(),
+                                  [](const std::shared_ptr<const void> &retired) {
+                                      return retired.use_count() == 1;
+                                  }),
+                   _retired.end());
+}
+
+void ModeManager::set_mission_item(uint16_t seq) {
+    _navigator.set_mission_item(seq);
+}
+
+bool ModeManager::sensors_ready() const {
+    const uint64_t report_time = _sensor_health_time.load();
+    if (report_time == 0) {
+        /// No monitor attached, we can't tell
         return false;
     }
-    /// Validate transition
-    if (!isValidTransition(new_mode_type)) {
+    const uint64_t now = SensorMonitor::wall_time_us();
+    if (now > report_time && now - report_time > SENSOR_HEALTH_TIMEOUT_US) {
         return false;
     }
-    /// Perform transition
-    _action.set_flight_mode(new_mode_type);
-    _navigator.set_mode(new_mode_type);
-    _curr_mode = new_mode_type;
-    _vehicle.set_mode(new_mode_type);
-    return true;
+    return _sensors_healthy.load();
 }
 
-bool ModeManager::change_mode(mavsdk::ActionServer::FlightMode mode) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    return change_mode_internal(mode);
+bool ModeManager::healthy() const {
+    const uint64_t report_time = _health_time.load();
+    if (report_time == 0) {
+        /// No health monitor attached
+        return sensors_ready();
+    }
+    const uint64_t now = SensorMonitor::wall_time_us();
+    if (now > report_time && now - report_time > HEALTH_REPORT_TIMEOUT_US) {
+        return false;
+    }
+    return _health_arming_ok.load();
 }
 
-void ModeManager::activate_takeoff() {
-    std::lock_guard<std::mutex> lock(_mutex);
-    /// Check if we need to arm first
-    // if (!_vehicle.is_armed()) {
-    //     if (!_vehicle.is_arming()) {
-    //         _vehicle.arm();
-    //     }
-    //     /// We wait for the next call if arming is not done
-    //     return;
-    // }
-    change_mode_internal(mavsdk::ActionServer::FlightMode::Takeoff);
+bool ModeManager::landed() const {
+    const uint64_t report_time = _landed_time.load();
+    if (report_time == 0) {
+        /// No detector attached, we can't tell
+        return false;
+    }
+    const uint64_t now = SensorMonitor::wall_time_us();
+    if (now > report_time && now - report_time > LAND_DETECTED_TIMEOUT_US) {
+        return false;
+    }
+    return _landed.load();
 }
 
-void ModeManager::activate_land() {
-    std::lock_guard<std::mutex> lock(_mutex);
-    change_mode_internal(mavsdk::ActionServer::FlightMode::Land);
+void ModeManager::report_mode() {
+    const ModeId mode = _curr_mode.load();
+    if (mode != _reported_mode) {
+        _reported_mode = mode;
+        _action.set_flight_mode(MODE_INFO[static_cast<int>(mode)].flight_mode);
+    }
+    /// Arming on takeoff and disarming in READY happen on the control thread too
+    const bool stale = _armed_stale.exchange(false);
+    const bool armed = _vehicle.is_armed();
+    if (armed != _reported_armed || stale) {
+        _reported_armed = armed;
+        _action.set_armed_state(armed);
+    }
 }
 
 mavsdk::ActionServer::FlightMode ModeManager::get_current_mode() const {
-    return _curr_mode;
+    return MODE_INFO[static_cast<int>(_curr_mode.load())].flight_mode;
 }
\ No newline at end of file
@@ -0,0 +1,376 @@
+/**
+ * @file geofence.cpp
+ * @author Abdulelah Mulla
+ */
+
+#include <algorithm>
+
+#include "navigator/geofence.h"
+
+/// MAV_CMD of the fence items
+static constexpr uint32_t MAV_CMD_NAV_FENCE_RETURN_POINT = 5000;
+static constexpr uint32_t MAV_CMD_NAV_FENCE_POLYGON_VERTEX_INCLUSION = 5001;
+static constexpr uint32_t MAV_CMD_NAV_FENCE_POLYGON_VERTEX_EXCLUSION = 5002;
+static constexpr uint32_t MAV_CMD_NAV_FENCE_CIRCLE_INCLUSION = 5003;
+static constexpr uint32_t MAV_CMD_NAV_FENCE_CIRCLE_EXCLUSION = 5004;
+
+/// MAV_FRAME of the positions
+static constexpr uint32_t MAV_FRAME_GLOBAL = 0;
+static constexpr uint32_t MAV_FRAME_GLOBAL_RELATIVE_ALT = 3;
+static constexpr uint32_t MAV_FRAME_GLOBAL_INT = 5;
+static constexpr uint32_t MAV_FRAME_GLOBAL_RELATIVE_ALT_INT = 6;
+
+/// Most slabs a polygon is cut into
+static constexpr int MAX_SLABS = 1024;
+
+static bool is_global(uint32_t frame) {
+    return frame == MAV_FRAME_GLOBAL || frame == MAV_FRAME_GLOBAL_RELATIVE_ALT ||
+           frame == MAV_FRAME_GLOBAL_INT || frame == MAV_FRAME_GLOBAL_RELATIVE_ALT_INT;
+}
+
+static float cross(float ax, float ay, float bx, float by) {
+    return ax * by - ay * bx;
+}
+
+GeofencePolygon::GeofencePolygon(const float (*vertices)[2], size_t count, bool inclusion) :
+    _inclusion(inclusion)
+{
+    _min[0] = _max[0] = vertices[0][0];
+    _min[1] = _max[1] = vertices[0][1];
+    _edges.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        const float *u = vertices[i];
+        const float *w = vertices[(i + 1) % count];
+        Edge edge;
+        /// Lower end first
+        const bool up = u[0] <= w[0];
+        std::copy(up ? u : w, (up ? u : w) + 2, edge.a);
+        std::copy(up ? w : u, (up ? w : u) + 2, edge.b);
+        _edges.push_back(edge);
+        for (int axis = 0; axis < 2; axis++) {
+            _min[axis] = std::min(_min[axis], u[axis]);
+            _max[axis] = std::max(_max[axis], u[axis]);
+        }
+    }
+
+    _slab_count = std::max(1, std::min(MAX_SLABS, static_cast<int>(count / 2)));
+    _slab_height = std::max((_max[0] - _min[0]) / _slab_count, 1e-3f);
+
+    /// Two passes, count then fill
+    std::vector<uint32_t> spanning_count(_slab_count, 0), partial_count(_slab_count, 0);
+    auto classify = [&](auto &&spanning, auto &&partial) {
+        for (uint32_t index = 0; index < _edges.size(); index++) {
+            const Edge &edge = _edges[index];
+            const int first = slab_of(edge.a[0]);
+            const int last = slab_of(edge.b[0]);
+            for (int slab = first; slab <= last; slab++) {
+                const float bottom = _min[0] + slab * _slab_height;
+                const float top = bottom + _slab_height;
+                if (edge.a[0] <= bottom && edge.b[0] >= top) {
+                    spanning(slab, index);
+                } else {
+                    partial(slab, index);
+                }
+            }
+        }
+    };
+    classify([&](int slab, uint32_t) { spanning_count[slab]++; },
+             [&](int slab, uint32_t) { partial_count[slab]++; });
+
+    _spanning_start.assign(_slab_count + 1, 0);
+    _partial_start.assign(_slab_count + 1, 0);
+    for (int slab = 0; slab < _slab_count; slab++) {
+        _spanning_start[slab + 1] = _spanning_start[slab] + spanning_count[slab];
+        _partial_start[slab + 1] = _partial_start[slab] + partial_count[slab];
+    }
+    _spanning.resize(_spanning_start.back());
+    _partial.resize(_partial_start.back());
+
+    std::fill(spanning_count.begin(), spanning_count.end(), 0);
+    std::fill(partial_count.begin(), partial_count.end(), 0);
+    classify([&](int slab, uint32_t index) { _spanning[_spanning_start[slab] + spanning_count[slab]++] = index; },
+             [&](int slab, uint32_t index) { _partial[_partial_start[slab] + partial_count[slab]++] = index; });
+
+    /// Spanning edges do not cross inside their slab, order them W to E
+    for (int slab = 0; slab < _slab_count; slab++) {
+        const float middle = _min[0] + (slab + 0.5f) * _slab_height;
+        std::sort(_spanning.begin() + _spanning_start[slab], _spanning.begin() + _spanning_start[slab + 1],
+            [&](uint32_t lhs, uint32_t rhs) { return east_at(_edges[lhs], middle) < east_at(_edges[rhs], middle); });
+    }
+}
+
+float GeofencePolygon::east_at(const Edge &edge, float north) {
+    const float height = edge.b[0] - edge.a[0];
+    if (height <= 0.f) {
+        return edge.a[1];
+    }
+    return edge.a[1] + (edge.b[1] - edge.a[1]) * (north - edge.a[0]) / height;
+}
+
+int GeofencePolygon::slab_of(float north) const {
+    const int slab = static_cast<int>(std::floor((north - _min[0]) / _slab_height));
+    return std::max(0, std::min(_slab_count - 1, slab));
+}
+
+float GeofencePolygon::hit(const Edge &edge, const float *p, const float *d) {
+    const float s[2] = {edge.b[0] - edge.a[0], edge.b[1] - edge.a[1]};
+    const float denom = cross(d[0], d[1], s[0], s[1]);
+    if (std::fabs(denom) < 1e-9f) {
+        /// Parallel
+        return INFINITY;
+    }
+    const float q[2] = {edge.a[0] - p[0], edge.a[1] - p[1]};
+    const float t = cross(q[0], q[1], s[0], s[1]) / denom;
+    const float u = cross(q[0], q[1], d[0], d[1]) / denom;
+    return (t >= 0.f && t <= 1.f && u >= 0.f && u <= 1.f) ? t : INFINITY;
+}
+
+bool GeofencePolygon::contains(const float *p) const {
+    if (p[0] < _min[0] || p[0] >= _max[0] || p[1] < _min[1] || p[1] > _max[1]) {
+        return false;
+    }
+    const int slab = slab_of(p[0]);
+
+    /// Ray towards +E, count the crossings
+    uint32_t crossings = 0;
+    for (uint32_t i = _partial_start[slab]; i < _partial_start[slab + 1]; i++) {
+        const Edge &edge = _edges[_partial[i]];
+        if ((edge.a[0] > p[0]) != (edge.b[0] > p[0]) && east_at(edge, p[0]) > p[1]) {
+            crossings++;
+        }
+    }
+    /// Every spanning edge crosses the ray's line, those E of p cross the ray
+    const auto first = _spanning.begin() + _spanning_start[slab];
+    const auto last = _spanning.begin() + _spanning_start[slab + 1];
+    const auto east = std::partition_point(first, last,
+        [&](uint32_t index) { return east_at(_edges[index], p[0]) <= p[1]; });
+    crossings += static_cast<uint32_t>(last - east);
+
+    return crossings & 1u;
+}
+
+float GeofencePolygon::first_crossing(const float *p, const float *d) const {
+    const float end[2] = {p[0] + d[0], p[1] + d[1]};
+    if (std::max(p[0], end[0]) < _min[0] || std::min(p[0], end[0]) > _max[0] ||
+        std::max(p[1], end[1]) < _min[1] || std::min(p[1], end[1]) > _max[1]) {
+        return INFINITY;
+    }
+
+    float best = INFINITY;
+    const int first_slab = slab_of(std::min(p[0], end[0]));
+    const int last_slab = slab_of(std::max(p[0], end[0]));
+    for (int slab = first_slab; slab <= last_slab; slab++) {
+        for (uint32_t i = _partial_start[slab]; i < _partial_start[slab + 1]; i++) {
+            best = std::min(best, hit(_edges[_partial[i]], p, d));
+        }
+
+        /// E extent of the segment inside the slab
+        const float bottom = _min[0] + slab * _slab_height;
+        const float top = bottom + _slab_height;
+        float t0 = 0.f, t1 = 1.f;
+        if (std::fabs(d[0]) > 1e-9f) {
+            const float ta = (bottom - p[0]) / d[0];
+            const float tb = (top - p[0]) / d[0];
+            t0 = std::max(0.f, std::min(ta, tb));
+            t1 = std::min(1.f, std::max(ta, tb));
+        }
+        const float e0 = std::min(p[1] + d[1] * t0, p[1] + d[1] * t1);
+        const float e1 = std::max(p[1] + d[1] * t0, p[1] + d[1] * t1);
+
+        /// Spanning edges are ordered, only those overlapping [e0, e1] can be hit
+        auto it = std::partition_point(_spanning.begin() + _spanning_start[slab],
+                                       _spanning.begin() + _spanning_start[slab + 1],
+            [&](uint32_t index) {
+                const Edge &edge = _edges[index];
+                return std::max(east_at(edge, bottom), east_at(edge, top)) < e0;
+            });
+        for (; it != _spanning.begin() + _spanning_start[slab + 1]; ++it) {
+            const Edge &edge = _edges[*it];
+            if (std::min(east_at(edge, bottom), east_at(edge, top)) > e1) {
+                break;
+            }
+            best = std::min(best, hit(edge, p, d));
+        }
+    }
+    return best;
+}
+
+bool GeofenceCircle::contains(const float *p) const {
+    const float dn = p[0] - center[0];
+    const float de = p[1] - center[1];
+    return dn * dn + de * de <= radius * radius;
+}
+
+float GeofenceCircle::first_crossing(const float *p, const float *d) const {
+    const float q[2] = {p[0] - center[0], p[1] - center[1]};
+    const float a = d[0] * d[0] + d[1] * d[1];
+    if (a < 1e-9f) {
+        return INFINITY;
+    }
+    const float b = 2.f * (d[0] * q[0] + d[1] * q[1]);
+    const float c = q[0] * q[0] + q[1] * q[1] - radius * radius;
+    const float discriminant = b * b - 4.f * a * c;
+    if (discriminant < 0.f) {
+        return INFINITY;
+    }
+    const float root = std::sqrt(discriminant);
+    const float t0 = (-b - root) / (2.f * a);
+    const float t1 = (-b + root) / (2.f * a);
+    if (t0 >= 0.f && t0 <= 1.f) {
+        return t0;
+    }
+    if (t1 >= 0.f && t1 <= 1.f) {
+        return t1;
+    }
+    return INFINITY;
+}
+
+std::shared_ptr<const Geofence> Geofence::parse(
+    const std::vector<mavsdk::MissionRawServer::MissionItem> &items,
+    double ref_lat, double ref_lon, double ref_alt)
+{
+    std::shared_ptr<Geofence> fence(new Geofence());
+    fence->_frame = LocalFrame(ref_lat, ref_lon, ref_alt);
+
+    std::vector<double> lat, lon, alt;
+    std::vector<float> ned_vertices, vertices;
+    for (size_t i = 0; i < items.size();) {
+        const auto &item = items[i];
+        if (!is_global(item.frame)) {
+            return nullptr;
+        }
+        float ned[3];
+        fence->_frame.to_ned(item.x * 1e-7, item.y * 1e-7, ref_alt, ned);
+
+        switch (item.command) {
+            case MAV_CMD_NAV_FENCE_POLYGON_VERTEX_INCLUSION:
+            case MAV_CMD_NAV_FENCE_POLYGON_VERTEX_EXCLUSION: {
+                /// param1 is the vertex count, repeated on every vertex
+                const size_t count = static_cast<size_t>(item.param1);
+                if (count < 3 || i + count > items.size()) {
+                    return nullptr;
+                }
+                lat.clear();
+                lon.clear();
+                alt.assign(count, ref_alt);
+                for (size_t k = i; k < i + count; k++) {
+                    if (items[k].command != item.command || !is_global(items[k].frame)) {
+                        return nullptr;
+                    }
+                    lat.push_back(items[k].x * 1e-7);
+                    lon.push_back(items[k].y * 1e-7);
+                }
+                ned_vertices.resize(3 * count);
+                fence->_frame.to_ned(lat.data(), lon.data(), alt.data(), count,
+                                     reinterpret_cast<float (*)[3]>(ned_vertices.data()));
+                vertices.clear();
+                for (size_t k = 0; k < count; k++) {
+                    vertices.push_back(ned_vertices[3 * k]);
+                    vertices.push_back(ned_vertices[3 * k + 1]);
+                }
+                fence->_polygons.emplace_back(reinterpret_cast<const float (*)[2]>(vertices.data()), count,
+                                              item.command == MAV_CMD_NAV_FENCE_POLYGON_VERTEX_INCLUSION);
+                i += count;
+                continue;
+            }
+            case MAV_CMD_NAV_FENCE_CIRCLE_INCLUSION:
+            case MAV_CMD_NAV_FENCE_CIRCLE_EXCLUSION:
+                if (item.param1 <= 0.f) {
+                    return nullptr;
+                }
+                fence->_circles.push_back({{ned[0], ned[1]}, item.param1,
+                                           item.command == MAV_CMD_NAV_FENCE_CIRCLE_INCLUSION});
+                break;
+            case MAV_CMD_NAV_FENCE_RETURN_POINT:
+                fence->_has_return_point = true;
+                fence->_return_point[0] = ned[0];
+                fence->_return_point[1] = ned[1];
+                break;
+            default:
+                return nullptr;
+        }
+        i++;
+    }
+
+    /// Outside the box of the inclusion zones is outside the fence
+    float min[2] = {INFINITY, INFINITY}, max[2] = {-INFINITY, -INFINITY};
+    for (const GeofencePolygon &polygon : fence->_polygons) {
+        if (polygon.inclusion()) {
+            fence->_has_inclusion = true;
+            for (int axis = 0; axis < 2; axis++) {
+                min[axis] = std::min(min[axis], polygon.min()[axis]);
+                max[axis] = std::max(max[axis], polygon.max()[axis]);
+            }
+        }
+    }
+    for (const GeofenceCircle &circle : fence->_circles) {
+        if (circle.inclusion) {
+            fence->_has_inclusion = true;
+            for (int axis = 0; axis < 2; axis++) {
+                min[axis] = std::min(min[axis], circle.center[axis] - circle.radius);
+                max[axis] = std::max(max[axis], circle.center[axis] + circle.radius);
+            }
+        }
+    }
+    if (fence->_has_inclusion) {
+        std::copy(min, min + 2, fence->_min);
+        std::copy(max, max + 2, fence->_max);
+    }
+    return fence;
+}
+
+bool Geofence::contains(const float *p) const {
+    if (p[0] < _min[0] || p[0] > _max[0] || p[1] < _min[1] || p[1] > _max[1]) {
+        return false;
+    }
+    bool included = !_has_inclusion;
+    for (const GeofencePolygon &polygon : _polygons) {
+        if (polygon.inclusion()) {
+            included = included || polygon.contains(p);
+        } else if (polygon.contains(p)) {
+            return false;
+        }
+    }
+    for (const GeofenceCircle &circle : _circles) {
+        if (circle.inclusion) {
+            included = included || circle.contains(p);
+        } else if (circle.contains(p)) {
+            return false;
+        }
+    }
+    return included;
+}
+
+float Geofence::time_to_breach(const float *p, const float *v, float horizon) const {
+    if (!contains(p)) {
+        return 0.f;
+    }
+    const float d[2] = {v[0] * horizon, v[1] * horizon};
+    if (d[0] * d[0] + d[1] * d[1] < 1e-6f) {
+        return INFINITY;
+    }
+
+    /// Entering an exclusion zone, or leaving the last inclusion zone we are in
+    float exclusion = INFINITY;
+    float inclusion = _has_inclusion ? 0.f : INFINITY;
+    for (const GeofencePolygon &polygon : _polygons) {
+        if (polygon.inclusion()) {
+            if (polygon.contains(p)) {
+                inclusion = std::max(inclusion, polygon.first_crossing(p, d));
+            }
+        } else {
+            exclusion = std::min(exclusion, polygon.first_crossing(p, d));
+        }
+    }
+    for (const GeofenceCircle &circle : _circles) {
+        if (circle.inclusion) {
+            if (circle.contains(p)) {
+                inclusion = std::max(inclusion, circle.first_crossing(p, d));
+            }
+        } else {
+            exclusion = std::min(exclusion, circle.first_crossing(p, d));
+        }
+    }
+    const float t = std::min(exclusion, inclusion);
+    return std::isfinite(t) ? t * horizon : INFINITY;
+}
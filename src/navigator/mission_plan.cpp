@@ -0,0 +1,113 @@
+/**
+ * @file mission_plan.cpp
+ * @author Abdulelah Mulla
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "navigator/mission_plan.h"
+
+/// MAV_CMD of the items we fly to
+static constexpr uint32_t MAV_CMD_NAV_WAYPOINT = 16;
+static constexpr uint32_t MAV_CMD_NAV_LOITER_UNLIM = 17;
+static constexpr uint32_t MAV_CMD_NAV_LAND = 21;
+static constexpr uint32_t MAV_CMD_NAV_TAKEOFF = 22;
+
+/// MAV_FRAME of the positions
+static constexpr uint32_t MAV_FRAME_GLOBAL = 0;
+static constexpr uint32_t MAV_FRAME_GLOBAL_RELATIVE_ALT = 3;
+static constexpr uint32_t MAV_FRAME_GLOBAL_INT = 5;
+static constexpr uint32_t MAV_FRAME_GLOBAL_RELATIVE_ALT_INT = 6;
+
+static bool is_position(uint32_t command) {
+    return command == MAV_CMD_NAV_WAYPOINT || command == MAV_CMD_NAV_LOITER_UNLIM ||
+           command == MAV_CMD_NAV_LAND || command == MAV_CMD_NAV_TAKEOFF;
+}
+
+/// Arena bytes for count waypoints, with room to align each array
+static size_t arena_size(size_t count) {
+    return count * (sizeof(MissionWaypoint) + 3 * sizeof(float)) + 2 * alignof(std::max_align_t);
+}
+
+MissionPlan::MissionPlan(size_t count) :
+    _arena(arena_size(count))
+{
+}
+
+std::shared_ptr<const MissionPlan> MissionPlan::parse(
+    const std::vector<mavsdk::MissionRawServer::MissionItem> &items,
+    double ref_lat, double ref_lon, double ref_alt)
+{
+    std::shared_ptr<MissionPlan> plan(new MissionPlan(items.size()));
+    plan->_frame = LocalFrame(ref_lat, ref_lon, ref_alt);
+    plan->_item_count = static_cast<uint16_t>(items.size());
+    plan->_waypoints.reserve(items.size());
+    plan->_path.reserve(3 * items.size());
+
+    /// Global positions first, converted in one batch below. Scratch,
+    /// in its own arena so it does not stay with the plan
+    std::pmr::monotonic_buffer_resource scratch(3 * items.size() * sizeof(double) + 3 * alignof(double));
+    std::pmr::vector<double> lat(&scratch), lon(&scratch), alt(&scratch);
+    lat.reserve(items.size());
+    lon.reserve(items.size());
+    alt.reserve(items.size());
+    for (const auto &item : items) {
+        if (!is_position(item.command)) {
+            continue;
+        }
+        const bool relative = item.frame == MAV_FRAME_GLOBAL_RELATIVE_ALT ||
+                              item.frame == MAV_FRAME_GLOBAL_RELATIVE_ALT_INT;
+        if (!relative && item.frame != MAV_FRAME_GLOBAL && item.frame != MAV_FRAME_GLOBAL_INT) {
+            /// Local and body frames are not supported
+            continue;
+        }
+
+        MissionWaypoint waypoint{};
+        waypoint.seq = static_cast<uint16_t>(item.seq);
+        waypoint.command = static_cast<uint16_t>(item.command);
+        waypoint.alt = relative ? ref_alt + item.z : item.z;
+
+        if (item.x == 0 && item.y == 0) {
+            /// Takeoff and land without a position stay where we are
+            waypoint.lat = lat.empty() ? ref_lat : lat.back();
+            waypoint.lon = lon.empty() ? ref_lon : lon.back();
+        } else {
+            /// MISSION_ITEM_INT, degE7
+            waypoint.lat = item.x * 1e-7;
+            waypoint.lon = item.y * 1e-7;
+        }
+        lat.push_back(waypoint.lat);
+        lon.push_back(waypoint.lon);
+        alt.push_back(waypoint.alt);
+
+        /// param2 is the acceptance radius of NAV_WAYPOINT
+        waypoint.acceptance_radius = (item.command == MAV_CMD_NAV_WAYPOINT && item.param2 > 0.f)
+                                         ? item.param2 : DEFAULT_ACCEPTANCE_RADIUS;
+        waypoint.yaw = (item.command == MAV_CMD_NAV_WAYPOINT) ? item.param4 : NAN;
+        plan->_waypoints.push_back(waypoint);
+    }
+
+    plan->_path.resize(3 * lat.size());
+    float (*path)[3] = reinterpret_cast<float (*)[3]>(plan->_path.data());
+    plan->_frame.to_ned(lat.data(), lon.data(), alt.data(), lat.size(), path);
+
+    for (size_t i = 0; i < plan->_waypoints.size(); i++) {
+        MissionWaypoint &waypoint = plan->_waypoints[i];
+        std::copy(path[i], path[i] + 3, waypoint.ned);
+        if (i > 0) {
+            const float dn = path[i][0] - path[i - 1][0];
+            const float de = path[i][1] - path[i - 1][1];
+            const float dd = path[i][2] - path[i - 1][2];
+            waypoint.leg_length = std::sqrt(dn * dn + de * de + dd * dd);
+        }
+        plan->_total_length += waypoint.leg_length;
+    }
+    return plan;
+}
+
+size_t MissionPlan::index_of(uint16_t seq) const {
+    const auto it = std::lower_bound(_waypoints.begin(), _waypoints.end(), seq,
+        [](const MissionWaypoint &waypoint, uint16_t value) { return waypoint.seq < value; });
+    return it - _waypoints.begin();
+}
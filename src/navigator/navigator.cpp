@@ -3,6 +3,8 @@
  * @author Abdulelah Mulla
  */
 
+#include <chrono>
+#include <cmath>
 #include <iostream>
 
 #include "navigator/navigator.h"
@@ -10,19 +12,34 @@
 #include "position.h"
 #include "log.h"
 
+/// Field by field, the struct has padding
+static bool same_setpoint(const Position &a, const Position &b) {
+    return a.lat == b.lat && a.lon == b.lon && a.alt == b.alt && a.yaw == b.yaw &&
+           a.vx == b.vx && a.vy == b.vy && a.vz == b.vz &&
+           a.ax == b.ax && a.ay == b.ay && a.az == b.az;
+}
+
 Navigator::Navigator(Morb* morb):
     _morb(morb),
-    _takeoff(_morb, this)
+    _takeoff(_morb, this),
+    _hold(_morb, this),
+    _land(_morb, this),
+    _mission(_morb, this)
 {
     /// Initialize mode array
-    _modes[0] = &_takeoff;
-    _modes[1] = &_hold;
-    _modes[2] = &_land;
-
-    /// Subscribe
-    // _morb->subscribe<Position>("vehicle_position", [this](const Position &pos) {
-    //     update_position(pos);
-    // });
+    _modes[static_cast<int>(ModeId::READY)] = &_active;
+    _modes[static_cast<int>(ModeId::TAKEOFF)] = &_takeoff;
+    _modes[static_cast<int>(ModeId::HOLD)] = &_hold;
+    _modes[static_cast<int>(ModeId::MISSION)] = &_mission;
+    _modes[static_cast<int>(ModeId::LAND)] = &_land;
+
+    /// Subscribe, the control path only stores the latest state
+    _morb->subscribe<VehicleState>("vehicle_state", [this](const VehicleState &state) {
+        _state.store(state);
+    });
+    _morb->subscribe<LandDetected>("land_detected", [this](const LandDetected &detected) {
+        _land_detector.store(detected);
+    });
     MITL_LOG::initialize().program_log("[Navigator] Initialized Navigator");
 }
 
@@ -31,46 +48,109 @@ Navigator::~Navigator() {
 }
 
 void Navigator::run() {
+    update_position();
+    if (_land_detector.generation() > 0) {
+        _land_detected = _land_detector.load();
+    }
+    check_geofence();
+
     /// Iterate through mode list and set appropriately
-    for (int i = 0; i < MODE_ARRAY_SIZE; i++) {
+    for (int i = 0; i < MODE_COUNT; i++) {
         if(_modes[i]) {
             _modes[i]->run(_curr_mode == _modes[i]);
         }
     }
 
-    /// Publish position setpoint if it was updated by the mode
+    /// Publish position setpoint if the mode changed it
     if (_position_updated) {
-        _morb->publish<Position>("position_setpoint", _positions.target);
+        if (!_has_published || !same_setpoint(_positions.target, _published)) {
+            _morb->publish<Position>("position_setpoint", _positions.target);
+            _published = _positions.target;
+            _has_published = true;
+        }
         _position_updated = false;
     }
+}
 
-    /// Check if the current mode is complete
-    if (_curr_mode->is_complete()) {
-        /// Signal to ModeManager we're done here
-        if (_curr_mode->state_id == 0) {
-            _morb->publish<std::string>("mode_complete", "active");
-        } else if (_curr_mode->state_id == 1) {
-            _morb->publish<std::string>("mode_complete", "takeoff");
-        } else if (_curr_mode->state_id == 2) {
-             _morb->publish<std::string>("mode_complete", "hold");
-        } else if (_curr_mode->state_id == 3) {
-             _morb->publish<std::string>("mode_complete", "land");
-        }
+void Navigator::update_position() {
+    if (_state.generation() == 0) {
+        return;
+    }
+    _vehicle_state = _state.load();
+    const VehicleState &state = _vehicle_state;
+    if (!state.global_valid) {
+        return;
+    }
+    _positions.current.lat = state.lat;
+    _positions.current.lon = state.lon;
+    _positions.current.alt = state.alt;
+    _positions.current.yaw = std::atan2(2.f * (state.q[0] * state.q[3] + state.q[1] * state.q[2]),
+                                        1.f - 2.f * (state.q[2] * state.q[2] + state.q[3] * state.q[3])) * 180.f / M_PI;
+    _positions.current.vx = state.velocity[0];
+    _positions.current.vy = state.velocity[1];
+    _positions.current.vz = state.velocity[2];
+    _position_valid = true;
+}
+
+void Navigator::check_geofence() {
+    _fence_status = GeofenceStatus{};
+    const std::shared_ptr<const Geofence> fence = std::atomic_load(&_geofence);
+    if (!fence || fence->empty() || !_position_valid) {
+        return;
+    }
+    const Position &current = _positions.current;
+    float ned[3];
+    fence->frame().to_ned(current.lat, current.lon, current.alt, ned);
+    const float velocity[2] = {current.vx, current.vy};
+    _fence_status.time_to_breach = fence->time_to_breach(ned, velocity, FENCE_PREDICT_TIME);
+    _fence_status.breached = _fence_status.time_to_breach <= 0.f;
+}
+
+/// Replacement clock, null for the steady clock
+static std::atomic<double (*)()> clock_override{nullptr};
+
+double Navigator::now() {
+    if (double (*clock)() = clock_override.load(std::memory_order_relaxed)) {
+        return clock();
     }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Navigator::set_clock(double (*clock)()) {
+    clock_override.store(clock, std::memory_order_relaxed);
+}
+
+void Navigator::set_target(const LocalFrame &frame, const TrajectoryPoint &point) {
+    Position &target = _positions.target;
+    frame.to_global(point.ned, target.lat, target.lon, target.alt);
+    target.vx = point.vel[0];
+    target.vy = point.vel[1];
+    target.vz = point.vel[2];
+    target.ax = point.acc[0];
+    target.ay = point.acc[1];
+    target.az = point.acc[2];
+    _position_updated = true;
+}
+
+std::shared_ptr<const MissionPlan> Navigator::set_mission(std::shared_ptr<const MissionPlan> plan) {
+    return std::atomic_exchange(&_mission_plan, std::move(plan));
+}
+
+std::shared_ptr<const MissionPlan> Navigator::mission_plan() const {
+    return std::atomic_load(&_mission_plan);
+}
+
+std::shared_ptr<const Geofence> Navigator::set_geofence(std::shared_ptr<const Geofence> fence) {
+    return std::atomic_exchange(&_geofence, std::move(fence));
 }
 
-void Navigator::update_position(const Position &pos) {
-    // _pos = pos;
+std::shared_ptr<const Geofence> Navigator::geofence() const {
+    return std::atomic_load(&_geofence);
 }
 
 void Navigator::set_mode(mavsdk::ActionServer::FlightMode mode) {
-    if (mode == mavsdk::ActionServer::FlightMode::Ready) {
-        _curr_mode = &_active;
-    } else if (mode == mavsdk::ActionServer::FlightMode::Takeoff) {
-        _curr_mode = &_takeoff;
-    } else if (mode == mavsdk::ActionServer::FlightMode::Hold) {
-        _curr_mode = &_hold;
-    } else if (mode == mavsdk::ActionServer::FlightMode::Land) {
-        _curr_mode = &_land;
+    ModeId id;
+    if (mode_from_flight_mode(mode, id)) {
+        _curr_mode = _modes[static_cast<int>(id)];
     }
 }
\ No newline at end of file
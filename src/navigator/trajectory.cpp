@@ -0,0 +1,351 @@
+/**
+ * @file trajectory.cpp
+ * @author Abdulelah Mulla
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "navigator/trajectory.h"
+#include "memory_pool.h"
+
+/// Shortest leg duration, s
+static constexpr double MIN_SEGMENT_DURATION = 0.2;
+
+/// Samples per leg when checking the limits
+static constexpr int LIMIT_SAMPLES = 24;
+
+/// Attempts at stretching a leg into the limits
+static constexpr int MAX_STRETCH = 40;
+
+/// k! / (k - d)!, the factor of the d-th derivative of t^k
+static double falling(int k, int d) {
+    double value = 1.0;
+    for (int i = 0; i < d; i++) {
+        value *= (k - i);
+    }
+    return value;
+}
+
+static double norm(const double *v) {
+    return std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+}
+
+/**
+ * @brief Horner evaluation of a polynomial and its first two derivatives.
+ */
+static void horner(const double *c, int n, double tau, double &p, double &dp, double &ddp) {
+    p = c[n - 1];
+    dp = 0.0;
+    ddp = 0.0;
+    for (int k = n - 2; k >= 0; k--) {
+        ddp = ddp * tau + dp;
+        dp = dp * tau + p;
+        p = p * tau + c[k];
+    }
+    /// ddp holds half the second derivative
+    ddp *= 2.0;
+}
+
+/**
+ * @brief Coefficients of the polynomial joining two states.
+ *
+ * In normalized time, the first half of the coefficients come from
+ * the start state, the rest from solving the end conditions.
+ *
+ * @param start derivatives at the start, position first
+ * @param end derivatives at the end
+ * @param n number of coefficients, 6 or 8
+ * @param duration s
+ */
+static void solve_axis(const double *start, const double *end, int n, double duration, double *c) {
+    const int half = n / 2;
+    double scale = 1.0;
+    double factorial = 1.0;
+    for (int k = 0; k < half; k++) {
+        if (k > 0) {
+            factorial *= k;
+        }
+        c[k] = start[k] * scale / factorial;
+        scale *= duration;
+    }
+
+    /// End conditions, a half x half system in c[half..n-1]
+    double a[4][5];
+    scale = 1.0;
+    for (int d = 0; d < half; d++) {
+        double rhs = end[d] * scale;
+        for (int k = 0; k < half; k++) {
+            rhs -= falling(k, d) * c[k];
+        }
+        for (int j = 0; j < half; j++) {
+            a[d][j] = falling(half + j, d);
+        }
+        a[d][half] = rhs;
+        scale *= duration;
+    }
+
+    /// Gaussian elimination with partial pivoting
+    for (int col = 0; col < half; col++) {
+        int pivot = col;
+        for (int row = col + 1; row < half; row++) {
+            if (std::fabs(a[row][col]) > std::fabs(a[pivot][col])) {
+                pivot = row;
+            }
+        }
+        std::swap(a[col], a[pivot]);
+        for (int row = col + 1; row < half; row++) {
+            const double f = a[row][col] / a[col][col];
+            for (int j = col; j <= half; j++) {
+                a[row][j] -= f * a[col][j];
+            }
+        }
+    }
+    for (int row = half - 1; row >= 0; row--) {
+        double value = a[row][half];
+        for (int j = row + 1; j < half; j++) {
+            value -= a[row][j] * c[half + j];
+        }
+        c[half + row] = value / a[row][row];
+    }
+}
+
+/// Trapezoidal velocity profile time for a rest to rest move
+static double trapezoid_time(double distance, double max_velocity, double max_acceleration) {
+    if (distance < max_velocity * max_velocity / max_acceleration) {
+        return 2.0 * std::sqrt(distance / max_acceleration);
+    }
+    return distance / max_velocity + max_velocity / max_acceleration;
+}
+
+Trajectory::Trajectory() :
+    _segments(&MessagePools::initialize())
+{
+}
+
+std::shared_ptr<const Trajectory> Trajectory::solve(const float (*waypoints)[3], size_t count,
+                                                    const TrajectoryPoint &start,
+                                                    const TrajectoryLimits &limits,
+                                                    TrajectoryOrder order) {
+    std::shared_ptr<Trajectory> trajectory(new Trajectory());
+    trajectory->_order = order;
+    trajectory->_segments.reserve(count);
+    const int n = static_cast<int>(order);
+    const double vmax = limits.max_velocity;
+    const double amax = limits.max_acceleration;
+
+    /// State at the start of the current leg: position, velocity, acceleration, jerk
+    double from[3][4];
+    for (int axis = 0; axis < 3; axis++) {
+        from[axis][0] = start.ned[axis];
+        from[axis][1] = start.vel[axis];
+        from[axis][2] = start.acc[axis];
+        from[axis][3] = 0.0;
+    }
+
+    double time = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        /// Velocity through the waypoint, zero at the last one
+        double in[3], out[3] = {0, 0, 0}, velocity[3] = {0, 0, 0};
+        for (int axis = 0; axis < 3; axis++) {
+            in[axis] = waypoints[i][axis] - from[axis][0];
+            if (i + 1 < count) {
+                out[axis] = waypoints[i + 1][axis] - waypoints[i][axis];
+            }
+        }
+        const double in_length = norm(in);
+        const double out_length = norm(out);
+        if (i + 1 < count && in_length > 1e-3 && out_length > 1e-3) {
+            const double cos_turn = (in[0] * out[0] + in[1] * out[1] + in[2] * out[2]) / (in_length * out_length);
+            /// Slow down for turns, stop for 90° and sharper
+            double speed = vmax * std::max(0.0, cos_turn);
+            speed = std::min(speed, std::sqrt(amax * std::min(in_length, out_length)));
+            double direction[3];
+            for (int axis = 0; axis < 3; axis++) {
+                direction[axis] = in[axis] / in_length + out[axis] / out_length;
+            }
+            const double direction_length = norm(direction);
+            if (direction_length > 1e-6) {
+                for (int axis = 0; axis < 3; axis++) {
+                    velocity[axis] = speed * direction[axis] / direction_length;
+                }
+            }
+        }
+
+        double to[3][4];
+        for (int axis = 0; axis < 3; axis++) {
+            to[axis][0] = waypoints[i][axis];
+            to[axis][1] = velocity[axis];
+            to[axis][2] = 0.0;
+            to[axis][3] = 0.0;
+        }
+
+        Segment segment{};
+        segment.start = time;
+        segment.duration = std::max(MIN_SEGMENT_DURATION, trapezoid_time(in_length, vmax, amax));
+
+        /// Stretch the leg until it is within the limits
+        for (int attempt = 0; attempt < MAX_STRETCH; attempt++) {
+            for (int axis = 0; axis < 3; axis++) {
+                solve_axis(from[axis], to[axis], n, segment.duration, segment.coeffs[axis]);
+            }
+            double peak_velocity = 0.0, peak_acceleration = 0.0;
+            for (int s = 0; s <= LIMIT_SAMPLES; s++) {
+                const double tau = static_cast<double>(s) / LIMIT_SAMPLES;
+                double v[3], acc[3];
+                for (int axis = 0; axis < 3; axis++) {
+                    double p;
+                    horner(segment.coeffs[axis], n, tau, p, v[axis], acc[axis]);
+                    v[axis] /= segment.duration;
+                    acc[axis] /= segment.duration * segment.duration;
+                }
+                peak_velocity = std::max(peak_velocity, norm(v));
+                peak_acceleration = std::max(peak_acceleration, norm(acc));
+            }
+            const double excess = std::max(peak_velocity / vmax, std::sqrt(peak_acceleration / amax));
+            if (excess <= 1.0) {
+                break;
+            }
+            segment.duration *= std::max(excess, 1.05);
+        }
+
+        trajectory->_segments.push_back(segment);
+        time += segment.duration;
+        for (int axis = 0; axis < 3; axis++) {
+            std::copy(to[axis], to[axis] + 4, from[axis]);
+        }
+    }
+    trajectory->_duration = time;
+    return trajectory;
+}
+
+void Trajectory::evaluate(double t, size_t &hint, TrajectoryPoint &point) const {
+    if (_segments.empty()) {
+        point = TrajectoryPoint{};
+        return;
+    }
+    const int n = static_cast<int>(_order);
+
+    if (hint >= _segments.size() || t < _segments[hint].start) {
+        hint = 0;
+    }
+    /// Time only moves forward, so this is one step at most per tick
+    while (hint + 1 < _segments.size() && t >= _segments[hint + 1].start) {
+        hint++;
+    }
+
+    const Segment &segment = _segments[hint];
+    const bool ended = t >= segment.start + segment.duration;
+    const double tau = ended ? 1.0 : std::max(0.0, (t - segment.start) / segment.duration);
+    for (int axis = 0; axis < 3; axis++) {
+        double p, dp, ddp;
+        horner(segment.coeffs[axis], n, tau, p, dp, ddp);
+        point.ned[axis] = static_cast<float>(p);
+        point.vel[axis] = ended ? 0.f : static_cast<float>(dp / segment.duration);
+        point.acc[axis] = ended ? 0.f : static_cast<float>(ddp / (segment.duration * segment.duration));
+    }
+}
+
+TrajectoryGenerator::TrajectoryGenerator() {
+    _worker = ThreadFactory::initialize().spawn(MitlThread::TRAJECTORY, [this] {solve_loop();});
+}
+
+TrajectoryGenerator::~TrajectoryGenerator() {
+    {
+        std::lock_guard<WatchedMutex> lock(_mutex);
+        _running = false;
+    }
+    _wake.notify_all();
+    if (_worker.joinable()) {
+        _worker.join();
+    }
+}
+
+uint32_t TrajectoryGenerator::request(WaypointPath waypoints, size_t count, const TrajectoryPoint &start,
+                                      const TrajectoryLimits &limits, TrajectoryOrder order) {
+    const uint32_t id = _next_id.fetch_add(1);
+    const MitlThread caller = ThreadFactory::current();
+    if (caller != MitlThread::COUNT) {
+        /// The solver thread holds it only to swap the request, at a lower priority
+        Watchdog::initialize().stage(caller, "trajectory request", &_mutex);
+    }
+    {
+        std::lock_guard<WatchedMutex> lock(_mutex);
+        _pending.id = id;
+        /// A request that was not solved yet lets go of its waypoints here
+        _pending.waypoints = std::move(waypoints);
+        _pending.count = count;
+        _pending.start = start;
+        _pending.limits = limits;
+        _pending.order = order;
+        _has_pending = true;
+    }
+    _wake.notify_one();
+    return id;
+}
+
+std::shared_ptr<const Trajectory> TrajectoryGenerator::latest(uint32_t id) const {
+    if (_latest_id.load(std::memory_order_acquire) != id) {
+        return nullptr;
+    }
+    std::shared_ptr<const Trajectory> trajectory = std::atomic_load(&_latest);
+    /// A newer solve may have landed in between
+    return _latest_id.load(std::memory_order_acquire) == id ? trajectory : nullptr;
+}
+
+void TrajectoryGenerator::solve_loop() {
+    Request request;
+    while (true) {
+        {
+            std::unique_lock<WatchedMutex> lock(_mutex);
+            _wake.wait(lock, [this] { return !_running || _has_pending; });
+            if (!_running) {
+                return;
+            }
+            std::swap(request, _pending);
+            _has_pending = false;
+        }
+        std::shared_ptr<const Trajectory> trajectory = Trajectory::solve(
+            request.waypoints.get(), request.count, request.start, request.limits, request.order);
+        /// Solved, the owner may go
+        request.waypoints.reset();
+
+        /// Invalidate first so latest() never pairs the new id with the old solution
+        _latest_id.store(0, std::memory_order_release);
+        std::atomic_store(&_latest, std::move(trajectory));
+        _latest_id.store(request.id, std::memory_order_release);
+    }
+}
+
+void TrajectoryTracker::start(TrajectoryGenerator &generator, WaypointPath waypoints, size_t count,
+                              const TrajectoryPoint &start, const TrajectoryLimits &limits,
+                              TrajectoryOrder order) {
+    reset();
+    _request = generator.request(std::move(waypoints), count, start, limits, order);
+}
+
+void TrajectoryTracker::reset() {
+    _request = 0;
+    _trajectory.reset();
+    _hint = 0;
+}
+
+bool TrajectoryTracker::sample(const TrajectoryGenerator &generator, double now, TrajectoryPoint &point) {
+    if (!_trajectory) {
+        if (_request == 0) {
+            return false;
+        }
+        _trajectory = generator.latest(_request);
+        if (!_trajectory) {
+            return false;
+        }
+        _start_time = now;
+        _hint = 0;
+    }
+    _trajectory->evaluate(now - _start_time, _hint, point);
+    return true;
+}
+
+bool TrajectoryTracker::finished(double now) const {
+    return _trajectory && now - _start_time >= _trajectory->duration();
+}
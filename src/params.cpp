@@ -0,0 +1,182 @@
+/**
+ * @file params.cpp
+ * @author Abdulelah Mulla
+ */
+
+#include <cmath>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "params.h"
+#include "log.h"
+
+static uint32_t default_bits(const ParamInfo &info) {
+    uint32_t bits;
+    if (info.type == ParamType::FLOAT) {
+        std::memcpy(&bits, &info.default_value, sizeof(bits));
+    } else {
+        const int32_t value = static_cast<int32_t>(info.default_value);
+        std::memcpy(&bits, &value, sizeof(bits));
+    }
+    return bits;
+}
+
+Params::Params() {
+    for (int i = 0; i < PARAM_COUNT; i++) {
+        _values[i].store(default_bits(PARAM_TABLE[i]));
+    }
+}
+
+Params& Params::initialize() {
+    static Params params; // one instance
+    return params;
+}
+
+Params::~Params() {
+    close();
+}
+
+Params::FileRecord* Params::records() const {
+    return reinterpret_cast<FileRecord*>(static_cast<char*>(_map) + sizeof(FileHeader));
+}
+
+void Params::store(int index, uint32_t bits) {
+    _values[index].store(bits, std::memory_order_relaxed);
+    if (_map) {
+        /// Write through, the kernel flushes the page
+        records()[index].value = bits;
+    }
+}
+
+bool Params::set(ParamId id, float value) {
+    const int index = static_cast<int>(id);
+    const ParamInfo &info = PARAM_TABLE[index];
+    if (!(value >= info.min && value <= info.max)) {
+        MITL_LOG::initialize().program_log(std::string("[Params] ") + info.name + " out of range: " + std::to_string(value));
+        return false;
+    }
+    const uint32_t bits = info.type == ParamType::FLOAT ? to_bits(value) : to_bits(static_cast<int32_t>(std::lround(value)));
+    const std::lock_guard<std::mutex> lock(_mutex);
+    store(index, bits);
+    return true;
+}
+
+float Params::value(ParamId id) const {
+    const int index = static_cast<int>(id);
+    const uint32_t bits = _values[index].load(std::memory_order_relaxed);
+    if (PARAM_TABLE[index].type == ParamType::FLOAT) {
+        return from_bits<float>(bits);
+    }
+    return static_cast<float>(from_bits<int32_t>(bits));
+}
+
+bool Params::find(const char *name, ParamId &id) {
+    for (const ParamInfo &info : PARAM_TABLE) {
+        if (std::strncmp(info.name, name, 16) == 0) {
+            id = info.id;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Params::reset() {
+    const std::lock_guard<std::mutex> lock(_mutex);
+    for (int i = 0; i < PARAM_COUNT; i++) {
+        store(i, default_bits(PARAM_TABLE[i]));
+    }
+}
+
+bool Params::open(const std::string &path) {
+    close();
+    const std::lock_guard<std::mutex> lock(_mutex);
+
+    const int fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        MITL_LOG::initialize().program_log("[Params] Could not open " + path);
+        return false;
+    }
+
+    /// Load what a previous run saved
+    struct stat st{};
+    int loaded = 0;
+    if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(FileHeader)) {
+        void *old = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (old != MAP_FAILED) {
+            const FileHeader *header = static_cast<const FileHeader*>(old);
+            const FileRecord *saved = reinterpret_cast<const FileRecord*>(static_cast<const char*>(old) + sizeof(FileHeader));
+            const size_t room = (st.st_size - sizeof(FileHeader)) / sizeof(FileRecord);
+            if (header->magic == FILE_MAGIC && header->count <= room) {
+                for (uint32_t r = 0; r < header->count; r++) {
+                    ParamId id;
+                    char name[17] = {};
+                    std::memcpy(name, saved[r].name, 16);
+                    if (!find(name, id)) {
+                        continue;
+                    }
+                    const int index = static_cast<int>(id);
+                    const ParamInfo &info = PARAM_TABLE[index];
+                    if (saved[r].type != static_cast<uint32_t>(info.type)) {
+                        continue;
+                    }
+                    const float value = info.type == ParamType::FLOAT ? from_bits<float>(saved[r].value)
+                                                                      : static_cast<float>(from_bits<int32_t>(saved[r].value));
+                    if (value >= info.min && value <= info.max) {
+                        _values[index].store(saved[r].value, std::memory_order_relaxed);
+                        loaded++;
+                    }
+                }
+            }
+            munmap(old, st.st_size);
+        }
+    }
+
+    /// Rewrite it for the current table and keep it mapped
+    const size_t size = sizeof(FileHeader) + PARAM_COUNT * sizeof(FileRecord);
+    if (ftruncate(fd, size) != 0) {
+        ::close(fd);
+        MITL_LOG::initialize().program_log("[Params] Could not resize " + path);
+        return false;
+    }
+    void *map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        ::close(fd);
+        MITL_LOG::initialize().program_log("[Params] Could not map " + path);
+        return false;
+    }
+    _fd = fd;
+    _map = map;
+    _map_size = size;
+
+    FileHeader *header = static_cast<FileHeader*>(_map);
+    header->magic = FILE_MAGIC;
+    header->count = PARAM_COUNT;
+    FileRecord *record = records();
+    for (int i = 0; i < PARAM_COUNT; i++) {
+        std::memset(record[i].name, 0, sizeof(record[i].name));
+        std::memcpy(record[i].name, PARAM_TABLE[i].name, strnlen(PARAM_TABLE[i].name, sizeof(record[i].name)));
+        record[i].type = static_cast<uint32_t>(PARAM_TABLE[i].type);
+        record[i].value = _values[i].load(std::memory_order_relaxed);
+    }
+    msync(_map, _map_size, MS_ASYNC);
+
+    MITL_LOG::initialize().program_log("[Params] Loaded " + std::to_string(loaded) + " params from " + path);
+    return true;
+}
+
+void Params::close() {
+    const std::lock_guard<std::mutex> lock(_mutex);
+    if (_map) {
+        msync(_map, _map_size, MS_SYNC);
+        munmap(_map, _map_size);
+        _map = nullptr;
+        _map_size = 0;
+    }
+    if (_fd >= 0) {
+        ::close(_fd);
+        _fd = -1;
+    }
+}
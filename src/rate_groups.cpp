@@ -0,0 +1,170 @@
+/**
+ * @file rate_groups.cpp
+ * @author Abdulelah Mulla
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "rate_groups.h"
+#include "params.h"
+#include "thread_factory.h"
+#include "watchdog.h"
+#include "vehicle_state.h"
+#include "morb.h"
+#include "log.h"
+
+static void store_max(std::atomic<uint32_t> &max, uint32_t value) {
+    uint32_t current = max.load(std::memory_order_relaxed);
+    while (value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+/// Thread running each group, for the watchdog
+static constexpr MitlThread GROUP_THREADS[RATE_GROUP_COUNT] = {MitlThread::RATE, MitlThread::ATTITUDE, MitlThread::CONTROL};
+
+RateGroups::RateGroups() :
+    _watchdog(Watchdog::initialize())
+{
+    MITL_LOG::initialize().program_log("[RateGroups] Initialized RateGroups");
+}
+
+RateGroups& RateGroups::initialize() {
+    static RateGroups rate_groups; // one instance
+    return rate_groups;
+}
+
+uint64_t RateGroups::now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void RateGroups::attach(Morb *morb) {
+    _morb = morb;
+    _watchdog.watch(MitlThread::RATE, RATE_DEADLINE);
+    _morb->subscribe<VehicleState>("vehicle_state", [this](const VehicleState &state) {
+        tick(state.timestamp);
+    });
+}
+
+void RateGroups::detach() {
+    _morb = nullptr;
+    _watchdog.unwatch(MitlThread::RATE);
+}
+
+void RateGroups::tick(uint64_t timestamp_us) {
+    const uint64_t now = now_ns();
+    _last_tick_ns.store(now, std::memory_order_relaxed);
+
+    /// Measured IMU period
+    if (_last_tick_us != 0 && timestamp_us > _last_tick_us) {
+        const float dt = static_cast<float>(timestamp_us - _last_tick_us);
+        _imu_dt_us = _imu_dt_us == 0.f ? dt : _imu_dt_us + IMU_ALPHA * (dt - _imu_dt_us);
+    }
+    _last_tick_us = timestamp_us;
+    if (_imu_dt_us <= 0.f) {
+        return;
+    }
+
+    const float imu_hz = 1e6f / _imu_dt_us;
+    const Params &params = Params::initialize();
+    const float rates[RATE_GROUP_COUNT] = {imu_hz,
+                                           static_cast<float>(params.get(param::MITL_ATT_HZ)),
+                                           static_cast<float>(params.get(param::MITL_CTRL_HZ))};
+    for (int i = 0; i < RATE_GROUP_COUNT; i++) {
+        Group &group = _groups[i];
+        const int divider = std::max(1, static_cast<int>(std::lround(imu_hz / rates[i])));
+        group.divider.store(static_cast<uint16_t>(divider), std::memory_order_relaxed);
+        if (--group.countdown <= 0) {
+            group.countdown = divider;
+            trigger(group, now);
+        }
+    }
+
+    if (_morb && timestamp_us - _last_report_us >= REPORT_INTERVAL) {
+        _last_report_us = timestamp_us;
+        report(timestamp_us);
+    }
+}
+
+void RateGroups::trigger(Group &group, uint64_t now_ns) {
+    if (group.busy.load(std::memory_order_acquire)) {
+        group.overruns.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    {
+        std::lock_guard<WatchedMutex> lock(group.mutex);
+        if (group.triggered) {
+            /// Not even picked up yet
+            group.overruns.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        group.trigger_ns.store(now_ns, std::memory_order_relaxed);
+        group.triggered = true;
+    }
+    group.condition.notify_one();
+}
+
+bool RateGroups::ticking() const {
+    const uint64_t last = _last_tick_ns.load(std::memory_order_relaxed);
+    return last != 0 && now_ns() - last < TICK_TIMEOUT;
+}
+
+bool RateGroups::wait(RateGroup group_id, std::chrono::microseconds timeout) {
+    Group &group = _groups[static_cast<int>(group_id)];
+    /// The IMU thread holds it to trigger, at its default policy
+    _watchdog.stage(GROUP_THREADS[static_cast<int>(group_id)], "trigger wait", &group.mutex);
+    std::unique_lock<WatchedMutex> lock(group.mutex);
+    if (!group.condition.wait_for(lock, timeout, [&group] {return group.triggered;})) {
+        return false;
+    }
+    group.triggered = false;
+    /// Busy from here, so triggers until end() are overruns
+    group.busy.store(true, std::memory_order_release);
+    return true;
+}
+
+uint64_t RateGroups::begin(RateGroup group_id) {
+    Group &group = _groups[static_cast<int>(group_id)];
+    const uint64_t start = now_ns();
+    _watchdog.beat(GROUP_THREADS[static_cast<int>(group_id)]);
+    _watchdog.stage(GROUP_THREADS[static_cast<int>(group_id)], "cycle");
+    group.busy.store(true, std::memory_order_release);
+    const uint64_t triggered = group.trigger_ns.exchange(0, std::memory_order_relaxed);
+    if (triggered != 0 && start > triggered) {
+        store_max(group.max_latency_us, static_cast<uint32_t>((start - triggered) / 1000));
+    }
+    return start;
+}
+
+void RateGroups::end(RateGroup group_id, uint64_t start_ns) {
+    Group &group = _groups[static_cast<int>(group_id)];
+    store_max(group.max_run_us, static_cast<uint32_t>((now_ns() - start_ns) / 1000));
+    group.cycles.fetch_add(1, std::memory_order_relaxed);
+    group.busy.store(false, std::memory_order_release);
+    _watchdog.idle(GROUP_THREADS[static_cast<int>(group_id)]);
+}
+
+RateGroupStats RateGroups::stats(RateGroup group_id) const {
+    const Group &group = _groups[static_cast<int>(group_id)];
+    RateGroupStats stats{};
+    stats.cycles = group.cycles.load(std::memory_order_relaxed);
+    stats.overruns = group.overruns.load(std::memory_order_relaxed);
+    stats.max_run_us = group.max_run_us.load(std::memory_order_relaxed);
+    stats.max_latency_us = group.max_latency_us.load(std::memory_order_relaxed);
+    stats.divider = group.divider.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void RateGroups::report(uint64_t timestamp) {
+    RateGroupReport report{};
+    report.timestamp = timestamp;
+    report.imu_rate_hz = 1e6f / _imu_dt_us;
+    for (int i = 0; i < RATE_GROUP_COUNT; i++) {
+        report.groups[i] = stats(static_cast<RateGroup>(i));
+        /// Maxima are per report
+        _groups[i].max_run_us.store(0, std::memory_order_relaxed);
+        _groups[i].max_latency_us.store(0, std::memory_order_relaxed);
+    }
+    _morb->publish<RateGroupReport>("rate_group_stats", report);
+}
@@ -85,6 +85,8 @@ int Scheduler::cond_timedwait(pthread_cond_t *sleep_cond, pthread_mutex_t *sleep
         alarm.condition_var = sleep_cond;
         alarm.mutex = sleep_mutex;
         alarm.done = false;
+        /// Re-arm, the alarm is reused by every sleep of this thread
+        alarm.timeout = false;
         if (alarm.removed) {
             /// Add alarm object to the alarms list
             alarm.removed = false;
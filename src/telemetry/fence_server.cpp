@@ -0,0 +1,228 @@
+/**
+ * @file fence_server.cpp
+ * @author Abdulelah Mulla
+ */
+
+#include <sstream>
+
+#include "telemetry/fence_server.h"
+#include "telemetry/mavlink_json.h"
+#include "log.h"
+
+/// MAV_MISSION_RESULT values we use
+static constexpr uint32_t MAV_MISSION_ACCEPTED = 0;
+static constexpr uint32_t MAV_MISSION_ERROR = 1;
+static constexpr uint32_t MAV_MISSION_INVALID = 5;
+static constexpr uint32_t MAV_MISSION_INVALID_SEQUENCE = 13;
+
+FenceServer::FenceServer(mavsdk::MavlinkDirect &mavdirect, FenceCallback on_fence) :
+    _mavdirect(mavdirect),
+    _on_fence(std::move(on_fence))
+{
+    MITL_LOG::initialize().program_log("[FenceServer] Initialized FenceServer");
+}
+
+FenceServer::~FenceServer() {
+    stop();
+}
+
+void FenceServer::start() {
+    if (_subscribed) {
+        return;
+    }
+    _count_handle = _mavdirect.subscribe_message("MISSION_COUNT",
+        [this](mavsdk::MavlinkDirect::MavlinkMessage message) { on_count(message); });
+    _item_handle = _mavdirect.subscribe_message("MISSION_ITEM_INT",
+        [this](mavsdk::MavlinkDirect::MavlinkMessage message) { on_item(message); });
+    _request_list_handle = _mavdirect.subscribe_message("MISSION_REQUEST_LIST",
+        [this](mavsdk::MavlinkDirect::MavlinkMessage message) { on_request_list(message); });
+    _request_handle = _mavdirect.subscribe_message("MISSION_REQUEST_INT",
+        [this](mavsdk::MavlinkDirect::MavlinkMessage message) { on_request(message); });
+    _clear_handle = _mavdirect.subscribe_message("MISSION_CLEAR_ALL",
+        [this](mavsdk::MavlinkDirect::MavlinkMessage message) { on_clear_all(message); });
+    _subscribed = true;
+}
+
+void FenceServer::stop() {
+    if (!_subscribed) {
+        return;
+    }
+    _mavdirect.unsubscribe_message(_count_handle);
+    _mavdirect.unsubscribe_message(_item_handle);
+    _mavdirect.unsubscribe_message(_request_list_handle);
+    _mavdirect.unsubscribe_message(_request_handle);
+    _mavdirect.unsubscribe_message(_clear_handle);
+    _subscribed = false;
+}
+
+bool FenceServer::is_fence(const mavsdk::MavlinkDirect::MavlinkMessage &message) {
+    double type = 0;
+    return json_number(message.fields_json, "mission_type", type) && type == MISSION_TYPE_FENCE;
+}
+
+void FenceServer::on_count(const mavsdk::MavlinkDirect::MavlinkMessage &message) {
+    double count = 0;
+    if (!is_fence(message) || !json_number(message.fields_json, "count", count)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    _incoming.clear();
+    _expected = static_cast<uint32_t>(count);
+    if (_expected == 0) {
+        /// Empty upload clears the fence
+        _uploading = false;
+        const bool accepted = _on_fence(_incoming);
+        _items.clear();
+        send_ack(accepted ? MAV_MISSION_ACCEPTED : MAV_MISSION_ERROR, message);
+        return;
+    }
+    _incoming.reserve(_expected);
+    _uploading = true;
+    send_request(0, message);
+}
+
+void FenceServer::on_item(const mavsdk::MavlinkDirect::MavlinkMessage &message) {
+    if (!is_fence(message)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_uploading) {
+        return;
+    }
+
+    double seq = 0, frame = 0, command = 0, x = 0, y = 0, z = 0;
+    double param1 = 0, param2 = 0, param3 = 0, param4 = 0;
+    json_number(message.fields_json, "seq", seq);
+    if (seq < _incoming.size()) {
+        /// Our request got lost and the GCS sent it again
+        send_request(static_cast<uint32_t>(_incoming.size()), message);
+        return;
+    }
+    if (seq > _incoming.size()) {
+        _uploading = false;
+        send_ack(MAV_MISSION_INVALID_SEQUENCE, message);
+        return;
+    }
+    json_number(message.fields_json, "frame", frame);
+    json_number(message.fields_json, "command", command);
+    json_number(message.fields_json, "param1", param1);
+    json_number(message.fields_json, "param2", param2);
+    json_number(message.fields_json, "param3", param3);
+    json_number(message.fields_json, "param4", param4);
+    json_number(message.fields_json, "x", x);
+    json_number(message.fields_json, "y", y);
+    json_number(message.fields_json, "z", z);
+
+    mavsdk::MissionRawServer::MissionItem item{};
+    item.seq = static_cast<uint32_t>(seq);
+    item.frame = static_cast<uint32_t>(frame);
+    item.command = static_cast<uint32_t>(command);
+    item.param1 = static_cast<float>(param1);
+    item.param2 = static_cast<float>(param2);
+    item.param3 = static_cast<float>(param3);
+    item.param4 = static_cast<float>(param4);
+    item.x = static_cast<int32_t>(x);
+    item.y = static_cast<int32_t>(y);
+    item.z = static_cast<float>(z);
+    item.mission_type = MISSION_TYPE_FENCE;
+    _incoming.push_back(item);
+
+    if (_incoming.size() < _expected) {
+        send_request(static_cast<uint32_t>(_incoming.size()), message);
+        return;
+    }
+
+    /// All in
+    _uploading = false;
+    if (!_on_fence(_incoming)) {
+        MITL_LOG::initialize().program_log("[FenceServer] Refused fence upload");
+        send_ack(MAV_MISSION_INVALID, message);
+        return;
+    }
+    _items.swap(_incoming);
+    _incoming.clear();
+    MITL_LOG::initialize().program_log("[FenceServer] Received fence, " + std::to_string(_items.size()) + " items");
+    send_ack(MAV_MISSION_ACCEPTED, message);
+}
+
+void FenceServer::on_request_list(const mavsdk::MavlinkDirect::MavlinkMessage &message) {
+    if (!is_fence(message)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::ostringstream fields;
+    fields << "{\"target_system\":" << message.system_id << ",\"target_component\":" << message.component_id
+           << ",\"count\":" << _items.size() << ",\"mission_type\":" << MISSION_TYPE_FENCE
+           << ",\"opaque_id\":0}";
+    mavsdk::MavlinkDirect::MavlinkMessage count;
+    count.message_name = "MISSION_COUNT";
+    count.target_system_id = message.system_id;
+    count.target_component_id = message.component_id;
+    count.fields_json = fields.str();
+    _mavdirect.send_message(count);
+}
+
+void FenceServer::on_request(const mavsdk::MavlinkDirect::MavlinkMessage &message) {
+    double seq = 0;
+    if (!is_fence(message) || !json_number(message.fields_json, "seq", seq)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (seq >= _items.size()) {
+        send_ack(MAV_MISSION_INVALID_SEQUENCE, message);
+        return;
+    }
+    const auto &item = _items[static_cast<size_t>(seq)];
+    std::ostringstream fields;
+    fields << "{\"target_system\":" << message.system_id << ",\"target_component\":" << message.component_id
+           << ",\"seq\":" << item.seq << ",\"frame\":" << item.frame << ",\"command\":" << item.command
+           << ",\"current\":0,\"autocontinue\":1"
+           << ",\"param1\":" << item.param1 << ",\"param2\":" << item.param2
+           << ",\"param3\":" << item.param3 << ",\"param4\":" << item.param4
+           << ",\"x\":" << item.x << ",\"y\":" << item.y << ",\"z\":" << item.z
+           << ",\"mission_type\":" << MISSION_TYPE_FENCE << "}";
+    mavsdk::MavlinkDirect::MavlinkMessage reply;
+    reply.message_name = "MISSION_ITEM_INT";
+    reply.target_system_id = message.system_id;
+    reply.target_component_id = message.component_id;
+    reply.fields_json = fields.str();
+    _mavdirect.send_message(reply);
+}
+
+void FenceServer::on_clear_all(const mavsdk::MavlinkDirect::MavlinkMessage &message) {
+    if (!is_fence(message)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    _uploading = false;
+    _incoming.clear();
+    _items.clear();
+    _on_fence(_items);
+    MITL_LOG::initialize().program_log("[FenceServer] Fence cleared");
+    send_ack(MAV_MISSION_ACCEPTED, message);
+}
+
+void FenceServer::send_request(uint32_t seq, const mavsdk::MavlinkDirect::MavlinkMessage &to) {
+    std::ostringstream fields;
+    fields << "{\"target_system\":" << to.system_id << ",\"target_component\":" << to.component_id
+           << ",\"seq\":" << seq << ",\"mission_type\":" << MISSION_TYPE_FENCE << "}";
+    mavsdk::MavlinkDirect::MavlinkMessage request;
+    request.message_name = "MISSION_REQUEST_INT";
+    request.target_system_id = to.system_id;
+    request.target_component_id = to.component_id;
+    request.fields_json = fields.str();
+    _mavdirect.send_message(request);
+}
+
+void FenceServer::send_ack(uint32_t result, const mavsdk::MavlinkDirect::MavlinkMessage &to) {
+    std::ostringstream fields;
+    fields << "{\"target_system\":" << to.system_id << ",\"target_component\":" << to.component_id
+           << ",\"type\":" << result << ",\"mission_type\":" << MISSION_TYPE_FENCE
+           << ",\"opaque_id\":0}";
+    mavsdk::MavlinkDirect::MavlinkMessage ack;
+    ack.message_name = "MISSION_ACK";
+    ack.target_system_id = to.system_id;
+    ack.target_component_id = to.component_id;
+    ack.fields_json = fields.str();
+    _mavdirect.send_message(ack);
+}
@@ -0,0 +1,174 @@
+/**
+ * @file log_server.cpp
+ * @author Abdulelah Mulla
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
+#include "telemetry/log_server.h"
+#include "telemetry/mavlink_json.h"
+#include "log.h"
+#include "params.h"
+
+LogServer::LogServer(mavsdk::MavlinkDirect &mavdirect, std::string directory) :
+    _mavdirect(mavdirect),
+    _store(std::move(directory), {"program_log", "sensor_log"})
+{
+    _fields.reserve(512);
+    MITL_LOG::initialize().program_log("[LogServer] Initialized LogServer");
+}
+
+LogServer::~LogServer() {
+    stop();
+}
+
+void LogServer::start() {
+    if (_running.exchange(true)) {
+        return;
+    }
+    _list_handle = _mavdirect.subscribe_message("LOG_REQUEST_LIST",
+        [this](mavsdk::MavlinkDirect::MavlinkMessage message) { on_request_list(message); });
+    _data_handle = _mavdirect.subscribe_message("LOG_REQUEST_DATA",
+        [this](mavsdk::MavlinkDirect::MavlinkMessage message) { on_request_data(message); });
+    _end_handle = _mavdirect.subscribe_message("LOG_REQUEST_END",
+        [this](mavsdk::MavlinkDirect::MavlinkMessage message) { on_request_end(message); });
+    _sender = ThreadFactory::initialize().spawn(MitlThread::LOG_SERVER, [this] {send_loop();});
+}
+
+void LogServer::stop() {
+    if (!_running.exchange(false)) {
+        return;
+    }
+    _mavdirect.unsubscribe_message(_list_handle);
+    _mavdirect.unsubscribe_message(_data_handle);
+    _mavdirect.unsubscribe_message(_end_handle);
+    _wake.notify_all();
+    if (_sender.joinable()) {
+        _sender.join();
+    }
+}
+
+void LogServer::on_request_list(const mavsdk::MavlinkDirect::MavlinkMessage &message) {
+    double start = 0, end = 0;
+    json_number(message.fields_json, "start", start);
+    json_number(message.fields_json, "end", end);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    /// Listing renumbers the logs, the running transfer is void
+    _transfer.active = false;
+    const size_t count = _store.refresh();
+
+    if (count == 0) {
+        /// No logs, PX4 answers with a single empty entry
+        mavsdk::MavlinkDirect::MavlinkMessage entry;
+        entry.message_name = "LOG_ENTRY";
+        entry.target_system_id = message.system_id;
+        entry.target_component_id = message.component_id;
+        entry.fields_json = "{\"id\":0,\"num_logs\":0,\"last_log_num\":0,\"time_utc\":0,\"size\":0}";
+        _mavdirect.send_message(entry);
+        return;
+    }
+
+    const uint32_t first = std::max<uint32_t>(1, static_cast<uint32_t>(start));
+    const uint32_t last = std::min<uint32_t>(count, static_cast<uint32_t>(std::min(end, 65535.0)));
+    for (uint32_t id = first; id <= last; id++) {
+        const LogEntry &log = _store.entries()[id - 1];
+        std::ostringstream fields;
+        fields << "{\"id\":" << log.id << ",\"num_logs\":" << count << ",\"last_log_num\":" << count
+               << ",\"time_utc\":" << log.time_utc << ",\"size\":" << log.size << "}";
+        mavsdk::MavlinkDirect::MavlinkMessage entry;
+        entry.message_name = "LOG_ENTRY";
+        entry.target_system_id = message.system_id;
+        entry.target_component_id = message.component_id;
+        entry.fields_json = fields.str();
+        _mavdirect.send_message(entry);
+    }
+}
+
+void LogServer::on_request_data(const mavsdk::MavlinkDirect::MavlinkMessage &message) {
+    double id = 0, offset = 0, count = 0;
+    if (!json_number(message.fields_json, "id", id) ||
+        !json_number(message.fields_json, "ofs", offset) ||
+        !json_number(message.fields_json, "count", count)) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_store.entries().empty()) {
+            _store.refresh();
+        }
+        _transfer.active = true;
+        _transfer.id = static_cast<uint16_t>(id);
+        _transfer.offset = static_cast<uint32_t>(offset);
+        /// count is often 0xFFFFFFFF, "to the end"
+        _transfer.end = static_cast<uint32_t>(std::min(offset + count, 4294967295.0));
+        _transfer.target_system = message.system_id;
+        _transfer.target_component = message.component_id;
+    }
+    _wake.notify_one();
+}
+
+void LogServer::on_request_end(const mavsdk::MavlinkDirect::MavlinkMessage &) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _transfer.active = false;
+    _store.close();
+}
+
+uint32_t LogServer::send_data(uint16_t id, uint32_t offset, uint32_t count) {
+    const uint8_t *data = nullptr;
+    const uint32_t length = static_cast<uint32_t>(
+        _store.read(id, offset, std::min(count, LOG_DATA_LENGTH), data));
+
+    _fields.clear();
+    _fields += "{\"id\":" + std::to_string(id) + ",\"ofs\":" + std::to_string(offset) +
+               ",\"count\":" + std::to_string(length) + ",\"data\":[";
+    /// Always the full array, zero padded
+    for (uint32_t i = 0; i < LOG_DATA_LENGTH; i++) {
+        if (i > 0) {
+            _fields += ',';
+        }
+        _fields += std::to_string(i < length ? data[i] : 0);
+    }
+    _fields += "]}";
+
+    mavsdk::MavlinkDirect::MavlinkMessage packet;
+    packet.message_name = "LOG_DATA";
+    packet.target_system_id = _transfer.target_system;
+    packet.target_component_id = _transfer.target_component;
+    packet.fields_json = _fields;
+    _mavdirect.send_message(packet);
+    return length;
+}
+
+void LogServer::send_loop() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    auto next_tick = std::chrono::steady_clock::now();
+    double budget = 0;
+    while (_running) {
+        _wake.wait(lock, [this] { return !_running || _transfer.active; });
+        if (!_running) {
+            break;
+        }
+        /// Idle ticks don't add up to a burst
+        next_tick = std::max(next_tick, std::chrono::steady_clock::now());
+
+        /// Bytes allowed this tick, less than a packet carries over to the next
+        const double tick_bytes = Params::initialize().get(param::MITL_LOG_KBPS) * TICK_US / 1000.0;
+        budget = std::min(budget + tick_bytes, tick_bytes + LOG_DATA_LENGTH);
+        for (; budget >= LOG_DATA_LENGTH && _transfer.active; budget -= LOG_DATA_LENGTH) {
+            const uint32_t sent = send_data(_transfer.id, _transfer.offset, _transfer.end - _transfer.offset);
+            _transfer.offset += sent;
+            if (sent == 0 || _transfer.offset >= _transfer.end) {
+                /// Done, or past the end of the log
+                _transfer.active = false;
+            }
+        }
+
+        /// Let requests in and the link drain, a new request waits for the tick too
+        next_tick += std::chrono::microseconds(TICK_US);
+        _wake.wait_until(lock, next_tick, [this] { return !_running; });
+    }
+}
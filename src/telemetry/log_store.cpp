@@ -0,0 +1,150 @@
+/**
+ * @file log_store.cpp
+ * @author Abdulelah Mulla
+ */
+
+#include <algorithm>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "telemetry/log_store.h"
+#include "log.h"
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept :
+    _data(other._data),
+    _size(other._size)
+{
+    other._data = nullptr;
+    other._size = 0;
+}
+
+MappedFile& MappedFile::operator=(MappedFile &&other) noexcept {
+    if (this != &other) {
+        close();
+        _data = other._data;
+        _size = other._size;
+        other._data = nullptr;
+        other._size = 0;
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::string &path) {
+    close();
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+    if (st.st_size == 0) {
+        ::close(fd);
+        return true;
+    }
+    void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    /// The mapping keeps the file alive
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+    /// Downloads read front to back
+    madvise(map, st.st_size, MADV_SEQUENTIAL);
+    _data = static_cast<const uint8_t*>(map);
+    _size = st.st_size;
+    return true;
+}
+
+void MappedFile::close() {
+    if (_data) {
+        munmap(const_cast<uint8_t*>(_data), _size);
+    }
+    _data = nullptr;
+    _size = 0;
+}
+
+/// A segment of a SegmentedLog, not its index
+static bool is_segment(const std::string &name) {
+    static const std::string suffix = ".mlog";
+    return name.size() > suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+LogStore::LogStore(std::string directory, std::vector<std::string> prefixes) :
+    _directory(std::move(directory)),
+    _prefixes(std::move(prefixes))
+{
+}
+
+size_t LogStore::refresh() {
+    std::vector<LogEntry> entries;
+    DIR *dir = opendir(_directory.c_str());
+    if (!dir) {
+        MITL_LOG::initialize().program_log("[LogStore] Could not open " + _directory);
+        _entries.clear();
+        return 0;
+    }
+    while (dirent *entry = readdir(dir)) {
+        const std::string name = entry->d_name;
+        const bool offered = std::any_of(_prefixes.begin(), _prefixes.end(), [&](const std::string &prefix) {
+            return name.compare(0, prefix.size(), prefix) == 0 && (name.size() == prefix.size() || is_segment(name));
+        });
+        if (!offered) {
+            continue;
+        }
+        const std::string path = _directory + "/" + name;
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+            continue;
+        }
+        entries.push_back({0, path, static_cast<uint32_t>(st.st_size), static_cast<uint32_t>(st.st_mtime)});
+    }
+    closedir(dir);
+
+    /// Oldest first, ties by name so ids are deterministic
+    std::sort(entries.begin(), entries.end(), [](const LogEntry &a, const LogEntry &b) {
+        return a.time_utc != b.time_utc ? a.time_utc < b.time_utc : a.path < b.path;
+    });
+    for (size_t i = 0; i < entries.size(); i++) {
+        entries[i].id = static_cast<uint16_t>(i + 1);
+    }
+
+    /// The mapped log may have a new id now
+    close();
+    _entries = std::move(entries);
+    return _entries.size();
+}
+
+size_t LogStore::read(uint16_t id, uint32_t offset, uint32_t count, const uint8_t *&data) {
+    data = nullptr;
+    if (id == 0 || id > _entries.size()) {
+        return 0;
+    }
+    if (id != _mapped_id) {
+        close();
+        if (!_mapped.open(_entries[id - 1].path)) {
+            MITL_LOG::initialize().program_log("[LogStore] Could not map " + _entries[id - 1].path);
+            return 0;
+        }
+        _mapped_id = id;
+    }
+    if (offset >= _mapped.size()) {
+        return 0;
+    }
+    data = _mapped.data() + offset;
+    return std::min<size_t>(count, _mapped.size() - offset);
+}
+
+void LogStore::close() {
+    _mapped.close();
+    _mapped_id = 0;
+}
@@ -0,0 +1,20 @@
+/**
+ * @file mavlink_json.cpp
+ * @author Abdulelah Mulla
+ */
+
+#include <cstdlib>
+
+#include "telemetry/mavlink_json.h"
+
+bool json_number(const std::string &json, const char *key, double &value) {
+    const std::string pattern = std::string("\"") + key + "\":";
+    const size_t pos = json.find(pattern);
+    if (pos == std::string::npos) {
+        return false;
+    }
+    const char *start = json.c_str() + pos + pattern.size();
+    char *end = nullptr;
+    value = std::strtod(start, &end);
+    return end != start;
+}
@@ -0,0 +1,55 @@
+/**
+ * @file mavlink_loopback.cpp
+ * @author Abdulelah Mulla
+ */
+
+#include "telemetry/mavlink_loopback.h"
+
+MavlinkLoopback::MavlinkLoopback(mavsdk::Mavsdk &first, mavsdk::Mavsdk &second) :
+    _first(first),
+    _second(second)
+    {
+        _thread = std::thread([this] {deliver();});
+        _first_handle = _first.subscribe_raw_bytes_to_be_sent([this](const char *bytes, size_t length) {
+            send(true, bytes, length);
+        });
+        _second_handle = _second.subscribe_raw_bytes_to_be_sent([this](const char *bytes, size_t length) {
+            send(false, bytes, length);
+        });
+    }
+
+MavlinkLoopback::~MavlinkLoopback() {
+    _first.unsubscribe_raw_bytes_to_be_sent(_first_handle);
+    _second.unsubscribe_raw_bytes_to_be_sent(_second_handle);
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _running = false;
+    }
+    _pending.notify_one();
+    _thread.join();
+}
+
+void MavlinkLoopback::send(bool to_second, const char *bytes, size_t length) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _queue.push_back({to_second, std::string(bytes, length)});
+    }
+    _pending.notify_one();
+}
+
+void MavlinkLoopback::deliver() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        _pending.wait(lock, [this] {return !_running || !_queue.empty();});
+        if (!_running) {
+            return;
+        }
+        Chunk chunk = std::move(_queue.front());
+        _queue.pop_front();
+        /// Not under the lock, the receiver may send right back
+        lock.unlock();
+        mavsdk::Mavsdk &to = chunk.to_second ? _second : _first;
+        to.pass_received_raw_bytes(chunk.bytes.data(), chunk.bytes.size());
+        lock.lock();
+    }
+}
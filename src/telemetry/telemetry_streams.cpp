@@ -0,0 +1,108 @@
+/**
+ * @file telemetry_streams.cpp
+ * @author Abdulelah Mulla
+ */
+
+#include <algorithm>
+
+#include "telemetry/telemetry_streams.h"
+
+/// Indexed by TelemetryStream
+static const StreamInfo STREAMS[TELEMETRY_STREAM_COUNT] = {
+    {TelemetryStream::HOME,         242, ParamId::TEL_HOME_HZ}, // HOME_POSITION
+    {TelemetryStream::SYS_STATUS,   1,   ParamId::TEL_SYS_HZ},  // SYS_STATUS
+    {TelemetryStream::ATTITUDE,     30,  ParamId::TEL_ATT_HZ},  // ATTITUDE
+    {TelemetryStream::POSITION,     33,  ParamId::TEL_POS_HZ},  // GLOBAL_POSITION_INT
+    {TelemetryStream::POSITION_NED, 32,  ParamId::TEL_NED_HZ},  // LOCAL_POSITION_NED
+    {TelemetryStream::RAW_GPS,      24,  ParamId::TEL_GPS_HZ},  // GPS_RAW_INT
+};
+
+/// Interval of a stream at its param's default
+static int64_t default_interval(int index) {
+    return TelemetryStreams::rate_interval(PARAM_TABLE[static_cast<int>(STREAMS[index].param)].default_value);
+}
+
+TelemetryStreams::TelemetryStreams() {
+    for (int i = 0; i < TELEMETRY_STREAM_COUNT; i++) {
+        _interval_us[i].store(default_interval(i));
+    }
+}
+
+const StreamInfo* TelemetryStreams::table() {
+    return STREAMS;
+}
+
+bool TelemetryStreams::find(uint32_t msg_id, TelemetryStream &stream) {
+    for (const StreamInfo &info : STREAMS) {
+        if (info.msg_id == msg_id) {
+            stream = info.stream;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TelemetryStreams::find(ParamId param, TelemetryStream &stream) {
+    for (const StreamInfo &info : STREAMS) {
+        if (info.param == param) {
+            stream = info.stream;
+            return true;
+        }
+    }
+    return false;
+}
+
+void TelemetryStreams::set_interval(TelemetryStream stream, int64_t interval_us) {
+    const int index = static_cast<int>(stream);
+    if (interval_us == 0) {
+        interval_us = default_interval(index);
+    } else if (interval_us < 0) {
+        interval_us = -1;
+    } else {
+        interval_us = std::max(interval_us, MIN_INTERVAL_US);
+    }
+    _interval_us[index].store(interval_us, std::memory_order_relaxed);
+}
+
+int64_t TelemetryStreams::rate_interval(float rate_hz) {
+    if (rate_hz <= 0.f) {
+        return -1;
+    }
+    return std::max(static_cast<int64_t>(1e6f / rate_hz), MIN_INTERVAL_US);
+}
+
+void TelemetryStreams::set_rate(TelemetryStream stream, float rate_hz) {
+    set_interval(stream, rate_interval(rate_hz));
+}
+
+int64_t TelemetryStreams::interval(TelemetryStream stream) const {
+    return _interval_us[static_cast<int>(stream)].load(std::memory_order_relaxed);
+}
+
+uint32_t TelemetryStreams::due(uint64_t now_us, uint64_t &next_us) {
+    uint32_t mask = 0;
+    next_us = now_us + MAX_SLEEP_US;
+
+    for (int i = 0; i < TELEMETRY_STREAM_COUNT; i++) {
+        const int64_t interval = _interval_us[i].load(std::memory_order_relaxed);
+        if (interval <= 0) {
+            continue;
+        }
+        const uint64_t period = static_cast<uint64_t>(interval);
+
+        /// The interval got shorter, do not wait out the old one
+        if (_next_us[i] > now_us + period) {
+            _next_us[i] = now_us;
+        }
+        if (now_us >= _next_us[i]) {
+            mask |= 1u << i;
+            _next_us[i] += period;
+            if (_next_us[i] <= now_us) {
+                /// Fell behind, skip the missed sends
+                _next_us[i] = now_us + period;
+            }
+        }
+        next_us = std::min(next_us, _next_us[i]);
+    }
+    return mask;
+}
@@ -3,23 +3,256 @@
  * @author Abdulelah Mulla
  */
 
+#include <algorithm>
+#include <cstring>
+#include <system_error>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
 #include "thread_factory.h"
 #include "scheduler.h"
+#include "params.h"
+#include "log.h"
+#include "alloc_audit.h"
+
+/// What the new thread needs, freed by the thread itself
+struct ThreadStart {
+    const ThreadSpec *spec;
+    std::function<void()> body;
+};
+
+/// Table entry of the calling thread, COUNT for threads we neither spawned nor adopted
+static thread_local MitlThread current_thread = MitlThread::COUNT;
+
+static void* thread_main(void *arg) {
+    ThreadStart *start = static_cast<ThreadStart*>(arg);
+    pthread_setname_np(pthread_self(), start->spec->name);
+    current_thread = start->spec->id;
+    /// The real-time loops must not allocate once flying
+    if (start->spec->policy == SCHED_FIFO) {
+        AllocAudit::watch(start->spec->id);
+    }
+    start->body();
+    delete start;
+    return nullptr;
+}
 
+FactoryThread::~FactoryThread() {
+    if (_joinable) {
+        /// Same contract as std::thread
+        std::terminate();
+    }
+}
+
+FactoryThread::FactoryThread(FactoryThread &&other) noexcept :
+    _thread(other._thread),
+    _joinable(other._joinable),
+    _stack(other._stack),
+    _stack_size(other._stack_size)
+{
+    other._joinable = false;
+    other._stack = nullptr;
+    other._stack_size = 0;
+}
+
+FactoryThread& FactoryThread::operator=(FactoryThread &&other) noexcept {
+    if (_joinable) {
+        std::terminate();
+    }
+    if (_stack) {
+        munmap(_stack, _stack_size);
+    }
+    _thread = other._thread;
+    _joinable = other._joinable;
+    _stack = other._stack;
+    _stack_size = other._stack_size;
+    other._joinable = false;
+    other._stack = nullptr;
+    other._stack_size = 0;
+    return *this;
+}
+
+void FactoryThread::join() {
+    if (!_joinable) {
+        return;
+    }
+    pthread_join(_thread, nullptr);
+    _joinable = false;
+    if (_stack) {
+        munmap(_stack, _stack_size);
+        _stack = nullptr;
+        _stack_size = 0;
+    }
+}
 
 /**
  * Constructor
- * @brief Create instances of the classes required
- * to start a thread for a functionality.
  */
 ThreadFactory::ThreadFactory() {
+    MITL_LOG::initialize().program_log("[ThreadFactory] Initialized ThreadFactory");
+}
+
+ThreadFactory& ThreadFactory::initialize() {
+    static ThreadFactory factory; // one instance
+    return factory;
+}
+
+void ThreadFactory::log_once(bool &logged, const std::string &msg) {
+    const std::lock_guard<std::mutex> lock(_mutex);
+    if (!logged) {
+        logged = true;
+        MITL_LOG::initialize().program_log("[ThreadFactory] " + msg);
+    }
+}
+
+bool ThreadFactory::cpu_set(ThreadCpus cpus, cpu_set_t &set) {
+    const int rt_cpu = Params::initialize().get(param::MITL_RT_CPU);
+    const long count = sysconf(_SC_NPROCESSORS_CONF);
+    /// Reserving the only CPU would leave nowhere for the rest
+    if (rt_cpu < 0 || count < 2 || rt_cpu >= count || rt_cpu >= CPU_SETSIZE) {
+        return false;
+    }
+    CPU_ZERO(&set);
+    if (cpus == ThreadCpus::RT_CORE) {
+        CPU_SET(rt_cpu, &set);
+        return true;
+    }
+    /// Every CPU, even when spawned from an isolated thread
+    for (long cpu = 0; cpu < count && cpu < CPU_SETSIZE; cpu++) {
+        if (cpus == ThreadCpus::ANY || cpu != rt_cpu) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    return true;
+}
+
+FactoryThread ThreadFactory::spawn(MitlThread id, std::function<void()> body) {
+    const ThreadSpec &spec = THREAD_TABLE[static_cast<int>(id)];
+    FactoryThread thread;
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+
+    /// Locked stack, with a guard page below it
+    if (spec.stack_size > 0) {
+        const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        const size_t usable = (spec.stack_size + page - 1) / page * page;
+        void *stack = mmap(nullptr, usable + page, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+        if (stack != MAP_FAILED) {
+            char *base = static_cast<char*>(stack);
+            mprotect(base, page, PROT_NONE);
+            if (mlock(base + page, usable) != 0) {
+                log_once(_lock_logged, std::string("Stacks not locked in memory: ") + std::strerror(errno));
+            }
+            pthread_attr_setstack(&attr, base + page, usable);
+            thread._stack = stack;
+            thread._stack_size = usable + page;
+        }
+    }
+
+    cpu_set_t set;
+    if (cpu_set(spec.cpus, set)) {
+        pthread_attr_setaffinity_np(&attr, sizeof(set), &set);
+    }
 
+    if (spec.policy == SCHED_FIFO) {
+        sched_param param{};
+        param.sched_priority = spec.priority;
+        pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+        pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+        pthread_attr_setschedparam(&attr, &param);
+    }
+
+    ThreadStart *start = new ThreadStart{&spec, std::move(body)};
+    int result = pthread_create(&thread._thread, &attr, thread_main, start);
+    if (result == EPERM && spec.policy == SCHED_FIFO) {
+        log_once(_priority_logged, "No real-time priorities, threads run at normal priority");
+        pthread_attr_setinheritsched(&attr, PTHREAD_INHERIT_SCHED);
+        result = pthread_create(&thread._thread, &attr, thread_main, start);
+    }
+    pthread_attr_destroy(&attr);
+
+    if (result != 0) {
+        delete start;
+        throw std::system_error(result, std::generic_category(), std::string("Starting ") + spec.name);
+    }
+    thread._joinable = true;
+    return thread;
+}
+
+bool ThreadFactory::adopt(MitlThread id) {
+    const ThreadSpec &spec = THREAD_TABLE[static_cast<int>(id)];
+    current_thread = id;
+    cpu_set_t set;
+    if (cpu_set(spec.cpus, set)) {
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+    if (spec.policy != SCHED_FIFO) {
+        return true;
+    }
+    sched_param param{};
+    param.sched_priority = spec.priority;
+    if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0) {
+        log_once(_priority_logged, "No real-time priorities, threads run at normal priority");
+        return false;
+    }
+    return true;
+}
+
+MitlThread ThreadFactory::current() {
+    return current_thread;
+}
+
+void ThreadFactory::isolate() {
+    cpu_set_t set;
+    if (cpu_set(ThreadCpus::NON_RT, set)) {
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        MITL_LOG::initialize().program_log("[ThreadFactory] Core " +
+            std::to_string(Params::initialize().get(param::MITL_RT_CPU)) + " reserved for the control loops");
+    }
+}
+
+void ThreadFactory::add(MitlThread id, std::function<void()> start, std::function<void()> stop) {
+    const std::lock_guard<std::mutex> lock(_mutex);
+    Hooks &hooks = _hooks[static_cast<int>(id)];
+    hooks.start = std::move(start);
+    hooks.stop = std::move(stop);
 }
 
 /**
- * We only start a few for now...
- * Will integrate fully after the scheduler is tested and added.
+ * Starts the registered threads in start_order.
  */
 void ThreadFactory::start() {
+    /// The clock comes first, anything may sleep on it
     Scheduler::initialize();
-}
\ No newline at end of file
+
+    ThreadSpec order[MITL_THREAD_COUNT];
+    std::copy(THREAD_TABLE, THREAD_TABLE + MITL_THREAD_COUNT, order);
+    std::sort(order, order + MITL_THREAD_COUNT,
+              [](const ThreadSpec &a, const ThreadSpec &b) {return a.start_order < b.start_order;});
+    for (const ThreadSpec &spec : order) {
+        Hooks &hooks = _hooks[static_cast<int>(spec.id)];
+        if (hooks.start && !hooks.started) {
+            MITL_LOG::initialize().program_log(std::string("[ThreadFactory] Starting ") + spec.name);
+            hooks.start();
+            hooks.started = true;
+        }
+    }
+}
+
+void ThreadFactory::stop() {
+    ThreadSpec order[MITL_THREAD_COUNT];
+    std::copy(THREAD_TABLE, THREAD_TABLE + MITL_THREAD_COUNT, order);
+    std::sort(order, order + MITL_THREAD_COUNT,
+              [](const ThreadSpec &a, const ThreadSpec &b) {return a.start_order > b.start_order;});
+    for (const ThreadSpec &spec : order) {
+        Hooks &hooks = _hooks[static_cast<int>(spec.id)];
+        if (hooks.stop && hooks.started) {
+            MITL_LOG::initialize().program_log(std::string("[ThreadFactory] Stopping ") + spec.name);
+            hooks.stop();
+            hooks.started = false;
+        }
+    }
+}
@@ -0,0 +1,144 @@
+/**
+ * @file trace.cpp
+ * @author Abdulelah Mulla
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+
+#include "trace.h"
+#include "log.h"
+
+/// Small id of the calling thread, for the trace viewer
+static uint32_t thread_index() {
+    static std::atomic<uint32_t> next{1};
+    static thread_local uint32_t index = next.fetch_add(1);
+    return index;
+}
+
+/**
+ * Constructor
+ */
+Trace::Trace() {
+    MITL_LOG::initialize().program_log("[Trace] Initialized Trace");
+}
+
+Trace& Trace::initialize() {
+    static Trace trace; // one instance
+    return trace;
+}
+
+uint64_t Trace::now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+TraceContext Trace::begin() {
+    const uint64_t now = now_ns();
+    if (!_enabled.load(std::memory_order_relaxed)) {
+        return {0, now, now};
+    }
+    uint32_t id = _next_id.fetch_add(1, std::memory_order_relaxed);
+    if (id == 0) {
+        /// Wrapped around, 0 is reserved
+        id = _next_id.fetch_add(1, std::memory_order_relaxed);
+    }
+    return {id, now, now};
+}
+
+void Trace::stage(TraceContext &ctx, TraceStage stage) {
+    const uint64_t now = now_ns();
+    record(ctx.id, stage, ctx.last_ns, now);
+    ctx.last_ns = now;
+}
+
+void Trace::record(uint32_t id, TraceStage stage, uint64_t start_ns, uint64_t end_ns) {
+    if (id == 0) {
+        return;
+    }
+    const uint64_t index = _head.fetch_add(1, std::memory_order_relaxed);
+    Event &event = _events[index & (CAPACITY - 1)];
+
+    /// Odd while writing, readers skip the slot
+    event.seq.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    event.id.store(id, std::memory_order_relaxed);
+    event.thread.store(thread_index(), std::memory_order_relaxed);
+    event.stage.store(static_cast<uint8_t>(stage), std::memory_order_relaxed);
+    event.start_ns.store(start_ns, std::memory_order_relaxed);
+    event.end_ns.store(end_ns, std::memory_order_relaxed);
+    event.seq.store(2 * index + 2, std::memory_order_release);
+}
+
+const char* Trace::stage_name(TraceStage stage) {
+    switch (stage) {
+        case TraceStage::TRANSPORT: return "transport";
+        case TraceStage::BUS: return "bus";
+        case TraceStage::ESTIMATOR: return "estimator";
+        case TraceStage::CONTROLLER: return "controller";
+        case TraceStage::MIXER: return "mixer";
+        case TraceStage::PUBLISH: return "publish";
+        case TraceStage::END_TO_END: return "imu_to_motor";
+        default: return "unknown";
+    }
+}
+
+bool Trace::export_chrome_json(const std::string &path) const {
+    struct Copy {
+        uint32_t id;
+        uint32_t thread;
+        uint8_t stage;
+        uint64_t start_ns;
+        uint64_t end_ns;
+    };
+    std::vector<Copy> events;
+    events.reserve(CAPACITY);
+
+    for (const Event &event : _events) {
+        const uint64_t seq = event.seq.load(std::memory_order_acquire);
+        if (seq == 0 || (seq & 1)) {
+            continue;
+        }
+        Copy copy{event.id.load(std::memory_order_relaxed),
+                  event.thread.load(std::memory_order_relaxed),
+                  event.stage.load(std::memory_order_relaxed),
+                  event.start_ns.load(std::memory_order_relaxed),
+                  event.end_ns.load(std::memory_order_relaxed)};
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (event.seq.load(std::memory_order_relaxed) != seq) {
+            /// Overwritten while we were copying
+            continue;
+        }
+        events.push_back(copy);
+    }
+    std::sort(events.begin(), events.end(), [](const Copy &a, const Copy &b) {
+        return a.start_ns < b.start_ns;
+    });
+
+    std::ofstream out(path);
+    if (!out) {
+        MITL_LOG::initialize().program_log("[Trace] Could not open " + path);
+        return false;
+    }
+    const uint64_t base_ns = events.empty() ? 0 : events.front().start_ns;
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    for (const Copy &event : events) {
+        const uint64_t duration = event.end_ns > event.start_ns ? event.end_ns - event.start_ns : 0;
+        out << (first ? "" : ",") << "\n"
+            << "{\"name\":\"" << stage_name(static_cast<TraceStage>(event.stage)) << "\""
+            << ",\"cat\":\"mitl\",\"ph\":\"X\",\"pid\":1"
+            << ",\"tid\":" << event.thread
+            << ",\"ts\":" << (event.start_ns - base_ns) / 1000.0
+            << ",\"dur\":" << duration / 1000.0
+            << ",\"args\":{\"trace_id\":" << event.id << "}}";
+        first = false;
+    }
+    out << "\n]}\n";
+    MITL_LOG::initialize().program_log("[Trace] Exported " + std::to_string(events.size()) + " events to " + path);
+    return static_cast<bool>(out);
+}
@@ -3,9 +3,12 @@
  * @author Abdulelah Mulla
  */
 
+#include <cmath>
 #include <iostream>
+#include <sstream>
 
 #include "vehicle.h"
+#include "morb.h"
 #include "log.h"
 
 Vehicle::Vehicle(std::shared_ptr<mavsdk::ServerComponent> server, std::shared_ptr<mavsdk::System> system, Morb* morb):
@@ -15,6 +18,15 @@ Vehicle::Vehicle(std::shared_ptr<mavsdk::ServerComponent> server, std::shared_pt
     {
         _telem = std::make_unique<mavsdk::TelemetryServer>(server);
         _mavdirect = std::make_unique<mavsdk::MavlinkDirect>(system);
+        /// Latest value only, the control path never waits on telemetry
+        _morb->subscribe<VehicleState>("vehicle_state", [this](const VehicleState &state) {
+            _state.store(state);
+            /// Single writer, readers see _home once the flag is set
+            if (state.global_valid && !_home_set.load(std::memory_order_relaxed)) {
+                _home = {state.lat, state.lon, static_cast<float>(state.alt), 0.f};
+                _home_set.store(true, std::memory_order_release);
+            }
+        });
         MITL_LOG::initialize().program_log("[Vehicle] Initialzed Vehicle");
     }
 
@@ -24,7 +36,7 @@ Vehicle::~Vehicle() {
 
 /// TODO: Implement
 bool Vehicle::is_armed() {
-    return _armed;
+    return _armed.load();
 }
 
 /// TODO: Implement
@@ -34,7 +46,7 @@ bool Vehicle::is_arming() {
 
 /// TODO: Implement
 void Vehicle::arm() {
-    MITL_LOG::initialize().program_log("[Vehicle] Arming requested");
+    MITL_LOG::initialize().program_log_nowait("[Vehicle] Arming requested");
     _arming_in_progress = true;
     // TODO: Send actual arm command via MAVSDK
     // For testing, simulate instant arming
@@ -43,27 +55,124 @@ void Vehicle::arm() {
 }
 
 void Vehicle::disarm() {
-    MITL_LOG::initialize().program_log("[Vehicle] Disarming requested");
+    MITL_LOG::initialize().program_log_nowait("[Vehicle] Disarming requested");
     /// TODO: disarm the vehicle
     _armed = false;
 }
 
-void Vehicle::publish_telem() {
-    _telem->publish_home(_pos);
-    _telem->publish_sys_status(_battery, true, true, true, true, true);
-    _telem->publish_position(_pos, _vel, _hdg);
-    _telem->publish_position_velocity_ned(_pos_vel);
-    _telem->publish_raw_gps(_raw_gps, _gps_info);
+/// Roll, pitch and yaw of a body FRD to NED quaternion, rad
+static void quat_to_euler(const float *q, float &roll, float &pitch, float &yaw) {
+    const float w = q[0], x = q[1], y = q[2], z = q[3];
+    roll = std::atan2(2.f * (w * x + y * z), 1.f - 2.f * (x * x + y * y));
+    pitch = std::asin(std::fmax(-1.f, std::fmin(1.f, 2.f * (w * y - z * x))));
+    yaw = std::atan2(2.f * (w * z + x * y), 1.f - 2.f * (y * y + z * z));
 }
 
-/// TODO: Implement
-void Vehicle::takeoff() {
-    _pos.relative_altitude_m = 10;
+bool Vehicle::home(mavsdk::TelemetryServer::Position &home) const {
+    if (!_home_set.load(std::memory_order_acquire)) {
+        return false;
+    }
+    home = _home;
+    return true;
 }
 
-/// TODO: Implement
-void Vehicle::enter_hold() {
+void Vehicle::publish_attitude(const VehicleState &state) {
+    float roll, pitch, yaw;
+    quat_to_euler(state.q, roll, pitch, yaw);
+
+    std::ostringstream fields;
+    fields << "{\"time_boot_ms\":" << state.timestamp / 1000
+           << ",\"roll\":" << roll << ",\"pitch\":" << pitch << ",\"yaw\":" << yaw
+           << ",\"rollspeed\":" << state.rates[0]
+           << ",\"pitchspeed\":" << state.rates[1]
+           << ",\"yawspeed\":" << state.rates[2] << "}";
+
+    mavsdk::MavlinkDirect::MavlinkMessage message;
+    message.message_name = "ATTITUDE";
+    message.fields_json = fields.str();
+    _mavdirect->send_message(message);
+}
+
+void Vehicle::publish_stream(TelemetryStream stream, const VehicleState &state) {
+    switch (stream) {
+        case TelemetryStream::HOME: {
+            /// Nothing to report before the first global fix
+            mavsdk::TelemetryServer::Position position;
+            if (home(position)) {
+                _telem->publish_home(position);
+            }
+            break;
+        }
+        case TelemetryStream::SYS_STATUS:
+            _telem->publish_sys_status(_battery, true, true, true, true, true);
+            break;
+        case TelemetryStream::ATTITUDE:
+            if (state.attitude_valid) {
+                publish_attitude(state);
+            }
+            break;
+        case TelemetryStream::POSITION: {
+            float roll, pitch, yaw;
+            quat_to_euler(state.q, roll, pitch, yaw);
+            double heading = yaw * 180.0 / M_PI;
+            if (heading < 0) {
+                heading += 360.0;
+            }
+            mavsdk::TelemetryServer::Position position{state.lat, state.lon, static_cast<float>(state.alt), -state.position[2]};
+            mavsdk::TelemetryServer::VelocityNed velocity{state.velocity[0], state.velocity[1], state.velocity[2]};
+            _telem->publish_position(position, velocity, {heading});
+            break;
+        }
+        case TelemetryStream::POSITION_NED: {
+            mavsdk::TelemetryServer::PositionVelocityNed ned{
+                {state.position[0], state.position[1], state.position[2]},
+                {state.velocity[0], state.velocity[1], state.velocity[2]}};
+            _telem->publish_position_velocity_ned(ned);
+            break;
+        }
+        case TelemetryStream::RAW_GPS: {
+            mavsdk::TelemetryServer::RawGps raw_gps{};
+            raw_gps.timestamp_us = state.timestamp;
+            raw_gps.latitude_deg = state.lat;
+            raw_gps.longitude_deg = state.lon;
+            raw_gps.absolute_altitude_m = state.alt;
+            raw_gps.hdop = NAN;
+            raw_gps.vdop = NAN;
+            raw_gps.velocity_m_s = std::hypot(state.velocity[0], state.velocity[1]);
+            raw_gps.cog_deg = NAN;
+            _telem->publish_raw_gps(raw_gps, _gps_info);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void Vehicle::publish_streams(uint32_t mask) {
+    if (mask == 0) {
+        return;
+    }
+    /// One consistent state for every stream of this tick
+    const VehicleState state = _state.load();
+    for (int i = 0; i < TELEMETRY_STREAM_COUNT; i++) {
+        if (mask & (1u << i)) {
+            publish_stream(static_cast<TelemetryStream>(i), state);
+        }
+    }
+}
 
+bool Vehicle::takeoff() {
+    if (!_armed) {
+        /// Arming goes through the mode manager's health checks
+        MITL_LOG::initialize().program_log("[Vehicle] Takeoff refused, not armed");
+        return false;
+    }
+    set_mode(mavsdk::ActionServer::FlightMode::Takeoff);
+    return true;
+}
+
+void Vehicle::enter_hold() {
+    set_mode(mavsdk::ActionServer::FlightMode::Hold);
 }
 
 void Vehicle::set_mode(mavsdk::ActionServer::FlightMode mode) {
@@ -0,0 +1,192 @@
+/**
+ * @file watchdog.cpp
+ * @author Abdulelah Mulla
+ */
+
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "watchdog.h"
+#include "gazebo/sensor_monitor.h"
+#include "params.h"
+#include "morb.h"
+#include "log.h"
+#include "alloc_audit.h"
+
+void WatchedMutex::lock() {
+    _mutex.lock();
+    _owner.store(Watchdog::thread_id(), std::memory_order_relaxed);
+}
+
+bool WatchedMutex::try_lock() {
+    if (!_mutex.try_lock()) {
+        return false;
+    }
+    _owner.store(Watchdog::thread_id(), std::memory_order_relaxed);
+    return true;
+}
+
+void WatchedMutex::unlock() {
+    _owner.store(0, std::memory_order_relaxed);
+    _mutex.unlock();
+}
+
+static uint64_t monotonic_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// Name of any thread of the process, as top shows it
+static std::string thread_name(pid_t tid) {
+    std::ifstream comm("/proc/self/task/" + std::to_string(tid) + "/comm");
+    std::string name;
+    if (!std::getline(comm, name)) {
+        return "exited";
+    }
+    return name;
+}
+
+Watchdog::Watchdog() {
+    MITL_LOG::initialize().program_log("[Watchdog] Initialized Watchdog");
+}
+
+Watchdog& Watchdog::initialize() {
+    static Watchdog watchdog; // one instance
+    return watchdog;
+}
+
+pid_t Watchdog::thread_id() {
+    static thread_local const pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+    return tid;
+}
+
+void Watchdog::start() {
+    if (_running.load()) {
+        return;
+    }
+    _running.store(true);
+    _thread = ThreadFactory::initialize().spawn(MitlThread::WATCHDOG, [this] {loop();});
+}
+
+void Watchdog::stop() {
+    if (!_running.load()) {
+        return;
+    }
+    _running.store(false);
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+void Watchdog::loop() {
+    auto next = std::chrono::steady_clock::now();
+    while (_running.load()) {
+        check(monotonic_ns());
+        next += std::chrono::nanoseconds(TICK);
+        std::this_thread::sleep_until(next);
+    }
+}
+
+void Watchdog::watch(MitlThread id, std::chrono::microseconds deadline) {
+    _slots[static_cast<int>(id)].deadline_us.store(deadline.count(), std::memory_order_relaxed);
+}
+
+void Watchdog::unwatch(MitlThread id) {
+    _slots[static_cast<int>(id)].deadline_us.store(0, std::memory_order_relaxed);
+}
+
+void Watchdog::check(uint64_t now) {
+    const bool land = Params::initialize().get(param::MITL_WD_ACTION) == static_cast<int32_t>(WatchdogAction::LAND);
+    for (int i = 0; i < MITL_THREAD_COUNT; i++) {
+        Slot &slot = _slots[i];
+        const uint64_t deadline_us = slot.deadline_us.load(std::memory_order_relaxed);
+        if (deadline_us == 0) {
+            slot.seen = false;
+            slot.late = false;
+            continue;
+        }
+        const uint32_t beats = slot.beats.load(std::memory_order_relaxed);
+        if (!slot.seen || beats != slot.last_beats) {
+            /// Progress since the last check
+            const bool recovered = slot.seen && slot.late;
+            slot.seen = true;
+            slot.last_beats = beats;
+            slot.since_ns = now;
+            slot.late = false;
+            if (recovered) {
+                AllocAudit::Exempt exempt;
+                WatchdogReport report{};
+                report.timestamp = SensorMonitor::wall_time_us();
+                report.thread = static_cast<MitlThread>(i);
+                report.stage = slot.stage.load(std::memory_order_relaxed);
+                report.misses = slot.misses;
+                MITL_LOG::initialize().program_log(std::string("[Watchdog] ") + THREAD_TABLE[i].name + " recovered");
+                publish(report);
+            }
+            continue;
+        }
+        if ((beats & 1u) == 0 || slot.late || now - slot.since_ns <= deadline_us * 1000) {
+            /// Idle, already reported, or in time
+            continue;
+        }
+
+        /// Reporting reads /proc and builds strings, it is already off nominal
+        AllocAudit::Exempt exempt;
+        slot.late = true;
+        slot.misses++;
+        WatchdogReport report{};
+        report.timestamp = SensorMonitor::wall_time_us();
+        report.thread = static_cast<MitlThread>(i);
+        report.late = true;
+        report.failsafe = land;
+        report.busy_us = static_cast<uint32_t>((now - slot.since_ns) / 1000);
+        report.stage = slot.stage.load(std::memory_order_relaxed);
+        report.misses = slot.misses;
+        find_holder(report.thread, slot.waiting.load(std::memory_order_relaxed), report);
+
+        std::string msg = std::string("[Watchdog] ") + THREAD_TABLE[i].name + " missed its " +
+                          std::to_string(deadline_us / 1000) + " ms deadline in " + report.stage;
+        if (report.holder != 0) {
+            msg += ", waiting on " + thread_name(report.holder) + " (" + std::to_string(report.holder) + ")";
+            if (report.inversion) {
+                msg += ", priority inversion";
+            }
+        }
+        MITL_LOG::initialize().program_log(msg);
+        publish(report);
+    }
+}
+
+void Watchdog::find_holder(MitlThread id, const WatchedMutex *lock, WatchdogReport &report) {
+    if (!lock) {
+        return;
+    }
+    report.holder = lock->owner();
+    if (report.holder == 0) {
+        return;
+    }
+    /// The waiter as the table runs it, so this holds without real-time privileges too
+    const ThreadSpec &spec = THREAD_TABLE[static_cast<int>(id)];
+    if (spec.policy != SCHED_FIFO) {
+        return;
+    }
+    const int policy = sched_getscheduler(report.holder);
+    sched_param param{};
+    if (policy < 0 || sched_getparam(report.holder, &param) != 0) {
+        /// Exited in between
+        return;
+    }
+    report.inversion = (policy != SCHED_FIFO && policy != SCHED_RR) || param.sched_priority < spec.priority;
+}
+
+void Watchdog::publish(const WatchdogReport &report) {
+    Morb *morb = _morb.load();
+    if (morb) {
+        morb->publish<WatchdogReport>("watchdog_report", report);
+    }
+}
@@ -0,0 +1,155 @@
+/**
+ * @file alloc_audit_test.cpp
+ * @author Abdulelah Mulla
+ * @brief Unit tests for the allocation audit, and the control path it guards
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include <new>
+
+#include "alloc_audit.h"
+#include "estimator/estimator.h"
+#include "estimator/land_detector.h"
+#include "controllers/controller.h"
+#include "navigator/navigator.h"
+#include "sensors.h"
+#include "morb.h"
+#include "log.h"
+
+#include <gz/msgs.hh>
+#include <catch2/catch_test_macros.hpp>
+
+/// A call the compiler may not elide, unlike a new expression
+static void allocate(size_t size) {
+    ::operator delete(::operator new(size));
+}
+
+TEST_CASE("Only watched threads are counted", "[alloc_audit]") {
+    AllocAudit::start();
+    allocate(16);
+    REQUIRE(AllocAudit::count() == 0);
+
+    {
+        AllocAudit::Scope audit(MitlThread::RATE);
+        allocate(24);
+        {
+            /// Libraries we cannot change
+            AllocAudit::Exempt exempt;
+            allocate(32);
+        }
+        allocate(40);
+    }
+    allocate(48);
+    AllocAudit::stop();
+
+    REQUIRE(AllocAudit::count() == 2);
+    AllocRecord records[AllocAudit::RECORDS];
+    REQUIRE(AllocAudit::records(records, AllocAudit::RECORDS) == 2);
+    REQUIRE(records[0].thread == MitlThread::RATE);
+    REQUIRE(records[0].size == 24);
+    REQUIRE(records[1].size == 40);
+
+    /// Stopped, nothing is counted
+    {
+        AllocAudit::Scope audit(MitlThread::RATE);
+        allocate(56);
+    }
+    REQUIRE(AllocAudit::count() == 2);
+}
+
+TEST_CASE("The steady-state control path does not allocate", "[alloc_audit]") {
+    Morb morb;
+    Estimator estimator(&morb);
+    LandDetector land_detector(&morb);
+    Controller controller(&morb);
+    Navigator navigator(&morb);
+
+    uint64_t timestamp = 1;
+    /// One IMU sample, and the slower sensors now and then
+    auto cycle = [&](int i) {
+        timestamp += 1000;
+        {
+            AllocAudit::Scope audit(MitlThread::RATE);
+            if (i % 10 == 0) {
+                SensorOdometry odometry{};
+                odometry.timestamp = timestamp;
+                odometry.q[0] = 1.f;
+                odometry.position[2] = -10.f;
+                morb.publish<SensorOdometry>("sensor_odometry", odometry);
+                SensorBaro baro{};
+                baro.timestamp = timestamp;
+                baro.pressure_pa = 101200.f;
+                morb.publish<SensorBaro>("sensor_baro", baro);
+            }
+            if (i % 100 == 0) {
+                SensorGps gps{};
+                gps.timestamp = timestamp;
+                gps.lat = 47.3977;
+                gps.lon = 8.5456;
+                gps.alt = 498.0;
+                morb.publish<SensorGps>("sensor_gps", gps);
+            }
+            SensorImu imu{};
+            imu.timestamp = timestamp;
+            imu.accel[2] = -9.81f;
+            morb.publish<SensorImu>("sensor_imu", imu);
+            controller.rate_update();
+        }
+        if (i % 4 == 0) {
+            AllocAudit::Scope audit(MitlThread::ATTITUDE);
+            controller.attitude_update();
+        }
+        if (i % 20 == 0) {
+            AllocAudit::Scope audit(MitlThread::CONTROL);
+            navigator.run();
+        }
+    };
+
+    /// First calls may set things up
+    for (int i = 0; i < 200; i++) {
+        cycle(i);
+    }
+    {
+        AllocAudit::Scope audit(MitlThread::CONTROL);
+        navigator.set_mode(mavsdk::ActionServer::FlightMode::Hold);
+    }
+
+    AllocAudit::start();
+    for (int i = 0; i < 1000; i++) {
+        cycle(i);
+    }
+    AllocAudit::stop();
+
+    AllocRecord records[AllocAudit::RECORDS];
+    const int n = AllocAudit::records(records, AllocAudit::RECORDS);
+    for (int i = 0; i < n; i++) {
+        UNSCOPED_INFO(records[i].size << " bytes on " << THREAD_TABLE[static_cast<int>(records[i].thread)].name);
+    }
+    REQUIRE(AllocAudit::count() == 0);
+}
+
+TEST_CASE("Sensor logs are deferred without allocating", "[alloc_audit]") {
+    MITL_LOG &log = MITL_LOG::initialize();
+    log.start();
+
+    gz::msgs::IMU msg;
+    msg.mutable_header()->mutable_stamp()->set_sec(1);
+    msg.mutable_linear_acceleration()->set_z(-9.81);
+    /// The writer allocates, the first message of a type only
+    log.sensor_log(msg, "[IMU]", 0);
+
+    const uint64_t dropped = log.sensor_dropped();
+    AllocAudit::start();
+    {
+        AllocAudit::Scope audit(MitlThread::RATE);
+        for (uint64_t time = 1; time <= 100; time++) {
+            log.sensor_log(msg, "[IMU]", time);
+        }
+    }
+    AllocAudit::stop();
+    log.stop();
+
+    REQUIRE(AllocAudit::count() == 0);
+    REQUIRE(log.sensor_dropped() == dropped);
+}
@@ -0,0 +1,151 @@
+/**
+ * @file controller_test.cpp
+ * @author Abdulelah Mulla
+ * @brief Unit tests for the attitude and rate control laws
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include <vector>
+
+#include "controllers/controller.h"
+#include "mode/mode_change.h"
+#include "position.h"
+#include "vehicle_state.h"
+#include "morb.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+
+using Catch::Approx;
+
+static constexpr double HOME_LAT = 47.3977;
+static constexpr double HOME_LON = 8.5456;
+static constexpr double HOME_ALT = 498.0;
+
+/// 1 m north in degrees of latitude, near enough
+static constexpr double ONE_METER = 1.0 / 111194.9;
+
+/**
+ * @brief A controller on its own bus, level at home, and what it outputs.
+ */
+struct Rig {
+    Morb morb;
+    Controller controller{&morb};
+    VehicleState state{};
+    std::vector<ActuatorControls> outputs;
+
+    Rig() {
+        morb.subscribe<ActuatorControls>("actuator_controls", [this](const ActuatorControls &controls) {
+            outputs.push_back(controls);
+        });
+        state.timestamp = 1000000;
+        state.q[0] = 1.f;
+        state.lat = HOME_LAT;
+        state.lon = HOME_LON;
+        state.alt = HOME_ALT;
+        state.attitude_valid = true;
+        state.local_valid = true;
+        state.global_valid = true;
+    }
+
+    /// One attitude cycle, then one IMU sample through the rate loop
+    void cycle() {
+        state.timestamp += 4000;
+        morb.publish<VehicleState>("vehicle_state", state);
+        controller.attitude_update();
+        state.timestamp += 1000;
+        morb.publish<VehicleState>("vehicle_state", state);
+        controller.rate_update();
+    }
+
+    void setpoint(double north, double up) {
+        Position position{};
+        position.lat = HOME_LAT + north * ONE_METER;
+        position.lon = HOME_LON;
+        position.alt = HOME_ALT + up;
+        morb.publish<Position>("position_setpoint", position);
+    }
+};
+
+TEST_CASE("Nothing is published before a position setpoint", "[controller]") {
+    Rig rig;
+    for (int i = 0; i < 10; i++) {
+        rig.cycle();
+    }
+    REQUIRE_FALSE(rig.controller.flying());
+    REQUIRE(rig.outputs.empty());
+}
+
+TEST_CASE("At the setpoint the controller holds hover thrust", "[controller]") {
+    Rig rig;
+    rig.setpoint(0, 0);
+    rig.cycle();
+    REQUIRE(rig.controller.flying());
+    REQUIRE_FALSE(rig.outputs.empty());
+    const ActuatorControls &controls = rig.outputs.back();
+    REQUIRE(controls.thrust == Approx(Controller::HOVER_THRUST).margin(1e-3));
+    REQUIRE(controls.roll == Approx(0.f).margin(1e-4));
+    REQUIRE(controls.pitch == Approx(0.f).margin(1e-4));
+    REQUIRE(controls.yaw == Approx(0.f).margin(1e-4));
+}
+
+TEST_CASE("Position errors tilt and climb the right way", "[controller]") {
+    SECTION("A setpoint to the north pitches the nose down") {
+        Rig rig;
+        rig.setpoint(10, 0);
+        rig.cycle();
+        const ActuatorControls &controls = rig.outputs.back();
+        REQUIRE(controls.pitch < 0.f);
+        REQUIRE(controls.roll == Approx(0.f).margin(1e-4));
+        REQUIRE(controls.thrust > Controller::HOVER_THRUST);
+    }
+    SECTION("A setpoint above raises the thrust") {
+        Rig rig;
+        rig.setpoint(0, 5);
+        rig.cycle();
+        const ActuatorControls &controls = rig.outputs.back();
+        REQUIRE(controls.thrust > Controller::HOVER_THRUST);
+        REQUIRE(controls.pitch == Approx(0.f).margin(1e-4));
+    }
+    SECTION("A setpoint below lowers it") {
+        Rig rig;
+        rig.setpoint(0, -5);
+        rig.cycle();
+        const ActuatorControls &controls = rig.outputs.back();
+        REQUIRE(controls.thrust < Controller::HOVER_THRUST);
+        REQUIRE(controls.thrust >= Controller::MIN_THRUST);
+    }
+}
+
+TEST_CASE("The rate loop opposes body rates", "[controller]") {
+    Rig rig;
+    rig.setpoint(0, 0);
+    rig.state.rates[0] = -1.f;
+    rig.state.rates[2] = 0.5f;
+    rig.cycle();
+    const ActuatorControls &controls = rig.outputs.back();
+    REQUIRE(controls.roll > 0.f);
+    REQUIRE(controls.yaw < 0.f);
+    REQUIRE(controls.roll <= 1.f);
+}
+
+TEST_CASE("READY stops the motors once, then publishes nothing", "[controller]") {
+    Rig rig;
+    rig.setpoint(0, 0);
+    rig.cycle();
+    REQUIRE(rig.outputs.back().thrust > 0.f);
+
+    rig.morb.publish<ModeChange>("mode_change", {0, ModeId::LAND, ModeId::READY, ModeEvent::MODE_COMPLETE});
+    REQUIRE_FALSE(rig.controller.flying());
+    const size_t published = rig.outputs.size();
+    rig.cycle();
+    REQUIRE(rig.outputs.size() == published + 1);
+    REQUIRE(rig.outputs.back().thrust == 0.f);
+    REQUIRE(rig.outputs.back().roll == 0.f);
+
+    for (int i = 0; i < 10; i++) {
+        rig.cycle();
+    }
+    REQUIRE(rig.outputs.size() == published + 1);
+}
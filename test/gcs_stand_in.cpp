@@ -0,0 +1,122 @@
+/**
+ * @file gcs_stand_in.cpp
+ * @author Abdulelah Mulla
+ */
+
+#include "gcs_stand_in.h"
+
+using namespace mavsdk;
+
+/// Heartbeats from the start, the autopilot waits for us before it sends any
+static Mavsdk::Configuration gcs_configuration() {
+    Mavsdk::Configuration config{ComponentType::GroundStation};
+    config.set_always_send_heartbeats(true);
+    return config;
+}
+
+GcsStandIn::GcsStandIn(Mavsdk &autopilot) :
+    _mavsdk(gcs_configuration()),
+    _link(autopilot, _mavsdk)
+    {
+        _mavsdk.add_any_connection("raw://");
+    }
+
+bool GcsStandIn::connect(std::chrono::milliseconds timeout) {
+    const Mavsdk::NewSystemHandle handle = _mavsdk.subscribe_on_new_system([this] {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _systems_changed = true;
+        _changed.notify_all();
+    });
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!_system) {
+        /// Not under _mutex, MAVSDK takes its own locks
+        for (const std::shared_ptr<System> &system : _mavsdk.systems()) {
+            if (system->is_connected()) {
+                _system = system;
+                break;
+            }
+        }
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (!_system && !_changed.wait_until(lock, deadline, [this] {return _systems_changed;})) {
+            break;
+        }
+        _systems_changed = false;
+    }
+    _mavsdk.unsubscribe_on_new_system(handle);
+    if (!_system) {
+        return false;
+    }
+
+    _telemetry = std::make_unique<Telemetry>(_system);
+    _action = std::make_unique<Action>(_system);
+    _mission = std::make_unique<MissionRaw>(_system);
+    _telemetry->subscribe_flight_mode([this](Telemetry::FlightMode mode) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _mode = mode;
+        _changed.notify_all();
+    });
+    _telemetry->subscribe_armed([this](bool armed) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _armed = armed;
+        _changed.notify_all();
+    });
+    _telemetry->subscribe_position([this](Telemetry::Position) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _position_seen = true;
+        _changed.notify_all();
+    });
+    _telemetry->subscribe_raw_gps([this](Telemetry::RawGps) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _gps_seen = true;
+        _changed.notify_all();
+    });
+    _telemetry->subscribe_battery([this](Telemetry::Battery) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _battery_seen = true;
+        _changed.notify_all();
+    });
+    return true;
+}
+
+bool GcsStandIn::wait_for_mode(Telemetry::FlightMode mode, std::chrono::milliseconds timeout) {
+    /// The heartbeat that discovered the autopilot already carried it
+    if (_telemetry->flight_mode() == mode) {
+        return true;
+    }
+    return wait([this, mode] {return _mode == mode;}, timeout);
+}
+
+bool GcsStandIn::wait_for_armed(bool armed, std::chrono::milliseconds timeout) {
+    if (_telemetry->armed() == armed) {
+        return true;
+    }
+    return wait([this, armed] {return _armed == armed;}, timeout);
+}
+
+bool GcsStandIn::wait_for_telemetry(std::chrono::milliseconds timeout) {
+    return wait([this] {return _position_seen && _gps_seen && _battery_seen;}, timeout);
+}
+
+bool GcsStandIn::arm() {
+    return _action->arm() == Action::Result::Success && wait_for_armed(true);
+}
+
+bool GcsStandIn::disarm() {
+    return _action->disarm() == Action::Result::Success && wait_for_armed(false);
+}
+
+bool GcsStandIn::takeoff() {
+    return _action->takeoff() == Action::Result::Success && wait_for_mode(Telemetry::FlightMode::Takeoff);
+}
+
+bool GcsStandIn::hold() {
+    return _action->hold() == Action::Result::Success && wait_for_mode(Telemetry::FlightMode::Hold);
+}
+
+bool GcsStandIn::land() {
+    return _action->land() == Action::Result::Success && wait_for_mode(Telemetry::FlightMode::Land);
+}
+
+bool GcsStandIn::start_mission() {
+    return _mission->start_mission() == MissionRaw::Result::Success && wait_for_mode(Telemetry::FlightMode::Mission);
+}
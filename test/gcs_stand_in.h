@@ -0,0 +1,109 @@
+/**
+ * @file gcs_stand_in.h
+ * @author Abdulelah Mulla
+ * @brief Scripted ground station for the tests
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+#include "telemetry/mavlink_loopback.h"
+
+#include <mavsdk/mavsdk.h>
+#include <mavsdk/plugins/action/action.h>
+#include <mavsdk/plugins/mission_raw/mission_raw.h>
+#include <mavsdk/plugins/telemetry/telemetry.h>
+
+/**
+ * @brief A GCS on an in-process link to the autopilot under test.
+ *
+ * Connects to the autopilot's MAVSDK instance through a
+ * MavlinkLoopback, so tests need no port and can run in parallel.
+ * The autopilot instance connects with "raw://" and must outlive
+ * the stand-in.
+ *
+ * The scripted steps send a command and wait until the autopilot
+ * reports its effect, so each step starts from a known state. Waits
+ * end as soon as the report arrives, TIMEOUT is only for failures.
+ */
+class GcsStandIn {
+public:
+    /// Longest any step waits for the autopilot
+    static constexpr std::chrono::milliseconds TIMEOUT{3000};
+private:
+    mavsdk::Mavsdk _mavsdk;
+    MavlinkLoopback _link;
+
+    /// What the autopilot reported, guarded by _mutex
+    bool _systems_changed{false};
+    mavsdk::Telemetry::FlightMode _mode{mavsdk::Telemetry::FlightMode::Unknown};
+    bool _armed{false};
+    bool _position_seen{false};
+    bool _gps_seen{false};
+    bool _battery_seen{false};
+
+    std::mutex _mutex;
+    std::condition_variable _changed;
+
+    /// Last, their callbacks use the above
+    std::shared_ptr<mavsdk::System> _system;
+    std::unique_ptr<mavsdk::Telemetry> _telemetry;
+    std::unique_ptr<mavsdk::Action> _action;
+    std::unique_ptr<mavsdk::MissionRaw> _mission;
+
+    /// Wait until done() holds, under _mutex
+    template <typename Predicate>
+    bool wait(Predicate done, std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        return _changed.wait_for(lock, timeout, done);
+    }
+public:
+    /**
+     * Constructor
+     *
+     * @brief Links to the autopilot, which is not discovered yet
+     */
+    explicit GcsStandIn(mavsdk::Mavsdk &autopilot);
+
+    /// Delete copy constructor and assignment operator
+    GcsStandIn(const GcsStandIn&) = delete;
+    GcsStandIn& operator=(const GcsStandIn&) = delete;
+
+    /**
+     * @brief Wait for the autopilot's heartbeat and set up the plugins
+     * @return false if it was not heard from within the timeout
+     */
+    bool connect(std::chrono::milliseconds timeout = TIMEOUT);
+
+    /// The autopilot as seen from here, after connect()
+    std::shared_ptr<mavsdk::System> system() const {return _system;}
+    mavsdk::Action& action() {return *_action;}
+    mavsdk::MissionRaw& mission() {return *_mission;}
+    mavsdk::Telemetry& telemetry() {return *_telemetry;}
+
+    /// Wait for the autopilot to report a flight mode
+    bool wait_for_mode(mavsdk::Telemetry::FlightMode mode, std::chrono::milliseconds timeout = TIMEOUT);
+
+    /// Wait for the autopilot to report it is armed, or disarmed
+    bool wait_for_armed(bool armed, std::chrono::milliseconds timeout = TIMEOUT);
+
+    /// Wait for position, GPS and battery telemetry
+    bool wait_for_telemetry(std::chrono::milliseconds timeout = TIMEOUT);
+
+    /**
+     * @brief Scripted steps, each true once the command was accepted
+     * and the autopilot reports its effect
+     */
+    bool arm();
+    bool disarm();
+    bool takeoff();
+    bool hold();
+    bool land();
+    bool start_mission();
+};
@@ -0,0 +1,138 @@
+/**
+ * @file geodesy_test.cpp
+ * @author Abdulelah Mulla
+ * @brief Unit tests for the WGS84 conversions
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "geodesy.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+
+using Catch::Approx;
+
+static constexpr double MM = 1e-3;
+
+/// Textbook ECEF difference rotated into NED, long double, the reference
+static void reference_ned(double ref_lat, double ref_lon, double ref_alt,
+                          double lat, double lon, double alt, double *ned) {
+    double ref[3], point[3];
+    lla_to_ecef(ref_lat, ref_lon, ref_alt, ref);
+    lla_to_ecef(lat, lon, alt, point);
+    const long double phi = ref_lat * M_PI / 180.0L, lambda = ref_lon * M_PI / 180.0L;
+    const long double d[3] = {(long double)point[0] - ref[0], (long double)point[1] - ref[1],
+                              (long double)point[2] - ref[2]};
+    ned[0] = static_cast<double>(-sinl(phi) * cosl(lambda) * d[0] - sinl(phi) * sinl(lambda) * d[1] + cosl(phi) * d[2]);
+    ned[1] = static_cast<double>(-sinl(lambda) * d[0] + cosl(lambda) * d[1]);
+    ned[2] = static_cast<double>(-cosl(phi) * cosl(lambda) * d[0] - cosl(phi) * sinl(lambda) * d[1] - sinl(phi) * d[2]);
+}
+
+TEST_CASE("LLA to ECEF matches reference values", "[geodesy]") {
+    struct Case { double lat, lon, alt, x, y, z; };
+    const Case cases[] = {
+        {47.397742, 8.545594, 488.0, 4277551.1688, 642764.6762, 4672168.6856},
+        {-33.8688, 151.2093, 58.0, -4646093.4773, 2553229.5358, -3534404.7109},
+        {89.9, -120.0, 1000.0, -5585.5687, -9674.4889, 6357742.5656},
+        {0.0, 0.0, 0.0, 6378137.0, 0.0, 0.0},
+    };
+    for (const Case &c : cases) {
+        double ecef[3];
+        lla_to_ecef(c.lat, c.lon, c.alt, ecef);
+        REQUIRE(ecef[0] == Approx(c.x).margin(MM));
+        REQUIRE(ecef[1] == Approx(c.y).margin(MM));
+        REQUIRE(ecef[2] == Approx(c.z).margin(MM));
+
+        /// And back
+        double lat, lon, alt;
+        ecef_to_lla(ecef, lat, lon, alt);
+        REQUIRE(lat == Approx(c.lat).margin(1e-9));
+        REQUIRE(lon == Approx(c.lon).margin(1e-9));
+        REQUIRE(alt == Approx(c.alt).margin(MM));
+    }
+}
+
+TEST_CASE("ECEF round trip everywhere", "[geodesy]") {
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> lat(-90.0, 90.0), lon(-180.0, 180.0), alt(-500.0, 20000.0);
+    for (int i = 0; i < 10000; i++) {
+        const double la = lat(rng), lo = lon(rng), h = alt(rng);
+        double ecef[3], back[3];
+        lla_to_ecef(la, lo, h, ecef);
+        double la2, lo2, h2;
+        ecef_to_lla(ecef, la2, lo2, h2);
+        lla_to_ecef(la2, lo2, h2, back);
+        REQUIRE(std::hypot(back[0] - ecef[0], back[1] - ecef[1], back[2] - ecef[2]) < MM);
+        REQUIRE(h2 == Approx(h).margin(MM));
+    }
+}
+
+TEST_CASE("Local frame matches the reference to the millimetre", "[geodesy]") {
+    const double ref_lat = 47.397742, ref_lon = 8.545594, ref_alt = 488.0;
+    LocalFrame frame(ref_lat, ref_lon, ref_alt);
+
+    std::mt19937 rng(5);
+    /// About 10 km around the reference
+    std::uniform_real_distribution<double> offset(-0.09, 0.09), alt(-100.0, 500.0);
+    for (int i = 0; i < 10000; i++) {
+        const double lat = ref_lat + offset(rng), lon = ref_lon + offset(rng), h = ref_alt + alt(rng);
+        float ned[3];
+        double expected[3];
+        frame.to_ned(lat, lon, h, ned);
+        reference_ned(ref_lat, ref_lon, ref_alt, lat, lon, h, expected);
+        for (int axis = 0; axis < 3; axis++) {
+            REQUIRE(ned[axis] == Approx(expected[axis]).margin(MM));
+        }
+
+        double lat2, lon2, h2;
+        frame.to_global(ned, lat2, lon2, h2);
+        /// 1 mm is about 1e-8 deg
+        REQUIRE(lat2 == Approx(lat).margin(2e-8));
+        REQUIRE(lon2 == Approx(lon).margin(2e-8));
+        REQUIRE(h2 == Approx(h).margin(MM));
+    }
+}
+
+TEST_CASE("Far points leave the series and stay exact", "[geodesy]") {
+    LocalFrame frame(-33.8688, 151.2093, 58.0);
+    /// Across the antimeridian and 40 deg away
+    const double points[][3] = {{-33.0, -179.5, 100.0}, {5.0, 160.0, 0.0}};
+    for (const auto &point : points) {
+        float ned[3];
+        double expected[3];
+        frame.to_ned(point[0], point[1], point[2], ned);
+        reference_ned(-33.8688, 151.2093, 58.0, point[0], point[1], point[2], expected);
+        for (int axis = 0; axis < 3; axis++) {
+            /// Float output, a few thousand km away
+            REQUIRE(ned[axis] == Approx(expected[axis]).margin(1.0));
+        }
+    }
+}
+
+TEST_CASE("Batch conversion equals the scalar one", "[geodesy]") {
+    LocalFrame frame(47.397742, 8.545594, 488.0);
+    std::mt19937 rng(9);
+    std::uniform_real_distribution<double> offset(-0.5, 0.5);
+    for (double spread : {0.01, 20.0}) {
+        std::vector<double> lat, lon, alt;
+        for (int i = 0; i < 257; i++) {
+            lat.push_back(47.397742 + spread * offset(rng));
+            lon.push_back(8.545594 + spread * offset(rng));
+            alt.push_back(488.0 + 100 * offset(rng));
+        }
+        std::vector<float> batch(3 * lat.size());
+        frame.to_ned(lat.data(), lon.data(), alt.data(), lat.size(), reinterpret_cast<float (*)[3]>(batch.data()));
+        for (size_t i = 0; i < lat.size(); i++) {
+            float ned[3];
+            frame.to_ned(lat[i], lon[i], alt[i], ned);
+            REQUIRE(batch[3 * i] == ned[0]);
+            REQUIRE(batch[3 * i + 1] == ned[1]);
+            REQUIRE(batch[3 * i + 2] == ned[2]);
+        }
+    }
+}
@@ -0,0 +1,148 @@
+/**
+ * @file geofence_test.cpp
+ * @author Abdulelah Mulla
+ * @brief Unit tests for the geofence
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "navigator/geofence.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+
+using Catch::Approx;
+using Item = mavsdk::MissionRawServer::MissionItem;
+
+static constexpr double REF_LAT = 47.397742;
+static constexpr double REF_LON = 8.545594;
+static constexpr float REF_ALT = 488.f;
+
+/// Fence item at a local NE position
+static Item fence_item(uint32_t command, float param1, float north, float east) {
+    LocalFrame frame(REF_LAT, REF_LON, REF_ALT);
+    const float ned[3] = {north, east, 0.f};
+    double lat, lon, alt;
+    frame.to_global(ned, lat, lon, alt);
+    Item item{};
+    item.frame = 5; // MAV_FRAME_GLOBAL_INT
+    item.command = command;
+    item.param1 = param1;
+    item.x = static_cast<int32_t>(std::lround(lat * 1e7));
+    item.y = static_cast<int32_t>(std::lround(lon * 1e7));
+    item.mission_type = 1;
+    return item;
+}
+
+static void add_polygon(std::vector<Item> &items, uint32_t command, const std::vector<std::pair<float, float>> &vertices) {
+    for (const auto &vertex : vertices) {
+        items.push_back(fence_item(command, static_cast<float>(vertices.size()), vertex.first, vertex.second));
+    }
+}
+
+TEST_CASE("Concave polygon containment", "[geofence]") {
+    /// U shape, open to the north
+    const float u[][2] = {{0, 0}, {0, 30}, {30, 30}, {30, 20}, {10, 20}, {10, 10}, {30, 10}, {30, 0}};
+    GeofencePolygon polygon(u, 8, true);
+
+    const float inside[][2] = {{5, 5}, {5, 25}, {25, 5}, {25, 25}, {5, 15}};
+    const float outside[][2] = {{20, 15}, {25, 15}, {-1, 5}, {5, 31}, {31, 5}, {15, -0.5f}};
+    for (const auto &p : inside) {
+        REQUIRE(polygon.contains(p));
+    }
+    for (const auto &p : outside) {
+        REQUIRE_FALSE(polygon.contains(p));
+    }
+}
+
+TEST_CASE("Large polygon matches the circle it approximates", "[geofence]") {
+    constexpr int VERTICES = 5000;
+    constexpr float RADIUS = 500.f;
+    std::vector<float> vertices;
+    for (int i = 0; i < VERTICES; i++) {
+        const float angle = 2.f * static_cast<float>(M_PI) * i / VERTICES;
+        vertices.push_back(RADIUS * std::cos(angle));
+        vertices.push_back(RADIUS * std::sin(angle));
+    }
+    GeofencePolygon polygon(reinterpret_cast<const float (*)[2]>(vertices.data()), VERTICES, true);
+    GeofenceCircle circle{{0, 0}, RADIUS, true};
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> coordinate(-600.f, 600.f);
+    for (int i = 0; i < 10000; i++) {
+        const float p[2] = {coordinate(rng), coordinate(rng)};
+        const float r = std::hypot(p[0], p[1]);
+        if (std::fabs(r - RADIUS) < 0.1f) {
+            /// Between the chords and the arc
+            continue;
+        }
+        REQUIRE(polygon.contains(p) == circle.contains(p));
+    }
+
+    /// Heading E from the center, the boundary is RADIUS away
+    const float p[2] = {0, 0};
+    const float d[2] = {0, 1000};
+    REQUIRE(polygon.first_crossing(p, d) * 1000.f == Approx(RADIUS).margin(0.1));
+    REQUIRE(circle.first_crossing(p, d) * 1000.f == Approx(RADIUS).margin(1e-3));
+}
+
+TEST_CASE("Fence built from MAVLink items", "[geofence]") {
+    std::vector<Item> items;
+    add_polygon(items, 5001, {{-100, -100}, {-100, 100}, {100, 100}, {100, -100}});
+    items.push_back(fence_item(5004, 10.f, 50, 50));
+    items.push_back(fence_item(5000, 0.f, 0, 0));
+
+    auto fence = Geofence::parse(items, REF_LAT, REF_LON, REF_ALT);
+    REQUIRE(fence != nullptr);
+    REQUIRE(fence->polygons().size() == 1);
+    REQUIRE(fence->circles().size() == 1);
+    REQUIRE(fence->has_return_point());
+
+    const float home[2] = {0, 0};
+    const float in_exclusion[2] = {52, 48};
+    const float outside[2] = {150, 0};
+    REQUIRE(fence->contains(home));
+    REQUIRE_FALSE(fence->contains(in_exclusion));
+    REQUIRE_FALSE(fence->contains(outside));
+}
+
+TEST_CASE("Invalid fences are refused", "[geofence]") {
+    std::vector<Item> items;
+    add_polygon(items, 5001, {{0, 0}, {0, 10}});
+    REQUIRE(Geofence::parse(items, REF_LAT, REF_LON, REF_ALT) == nullptr);
+
+    items.clear();
+    items.push_back(fence_item(5003, 0.f, 0, 0));
+    REQUIRE(Geofence::parse(items, REF_LAT, REF_LON, REF_ALT) == nullptr);
+
+    items.clear();
+    items.push_back(fence_item(16, 0.f, 0, 0));
+    REQUIRE(Geofence::parse(items, REF_LAT, REF_LON, REF_ALT) == nullptr);
+}
+
+TEST_CASE("Time to breach", "[geofence]") {
+    std::vector<Item> items;
+    add_polygon(items, 5001, {{-100, -100}, {-100, 100}, {100, 100}, {100, -100}});
+    items.push_back(fence_item(5004, 10.f, 0, 50));
+    auto fence = Geofence::parse(items, REF_LAT, REF_LON, REF_ALT);
+    REQUIRE(fence != nullptr);
+
+    const float p[2] = {0, 0};
+    const float north[2] = {10, 0};
+    const float east[2] = {0, 10};
+    const float still[2] = {0, 0};
+
+    /// 100 m to the N edge at 10 m/s
+    REQUIRE(fence->time_to_breach(p, north, 20.f) == Approx(10.f).margin(0.05));
+    REQUIRE(std::isinf(fence->time_to_breach(p, north, 5.f)));
+    /// The exclusion circle is 40 m E
+    REQUIRE(fence->time_to_breach(p, east, 20.f) == Approx(4.f).margin(0.05));
+    REQUIRE(std::isinf(fence->time_to_breach(p, still, 20.f)));
+
+    const float outside[2] = {0, 200};
+    REQUIRE(fence->time_to_breach(outside, north, 20.f) == 0.f);
+}
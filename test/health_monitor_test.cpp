@@ -0,0 +1,153 @@
+/**
+ * @file health_monitor_test.cpp
+ * @author Abdulelah Mulla
+ * @brief Unit tests for the health checks
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include <vector>
+
+#include "health_monitor.h"
+#include "morb.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+/// One tick per check, µs
+static constexpr uint64_t TICK = 50000;
+
+/**
+ * @brief Steps the monitor through whole rounds of checks.
+ */
+struct Rounds {
+    Morb &morb;
+    HealthMonitor &monitor;
+    uint64_t now{1};
+    bool sensors{true};
+
+    void state(bool valid) {
+        VehicleState state{};
+        state.attitude_valid = valid;
+        state.local_valid = valid;
+        state.global_valid = valid;
+        morb.publish<VehicleState>("vehicle_state", state);
+    }
+
+    /// A fresh state and sensor report before every round
+    void run(int rounds, bool valid = true) {
+        for (int i = 0; i < rounds; i++) {
+            state(valid);
+            if (sensors) {
+                SensorHealth health{};
+                health.timestamp = now;
+                morb.publish<SensorHealth>("sensor_health", health);
+            }
+            for (int check = 0; check < HEALTH_CHECK_COUNT; check++) {
+                monitor.step(now);
+                now += TICK;
+            }
+        }
+    }
+};
+
+TEST_CASE("Arming waits for a settled estimate", "[health_monitor]") {
+    Morb morb;
+    HealthMonitor monitor(&morb);
+    Rounds rounds{morb, monitor};
+
+    /// No estimate at all
+    rounds.run(1, false);
+    REQUIRE(monitor.report().checked == HEALTH_ALL);
+    REQUIRE(monitor.report().failing == health_bit(HealthCheck::ESTIMATOR));
+    REQUIRE_FALSE(monitor.report().arming_ok());
+
+    /// Valid, but not for a second yet
+    rounds.run(4);
+    REQUIRE_FALSE(monitor.report().arming_ok());
+    rounds.run(2);
+    REQUIRE(monitor.report().arming_ok());
+
+    /// The estimator stopped publishing
+    for (int check = 0; check < HEALTH_CHECK_COUNT; check++) {
+        monitor.step(rounds.now);
+        rounds.now += TICK;
+    }
+    REQUIRE(monitor.report().failing == health_bit(HealthCheck::ESTIMATOR));
+}
+
+TEST_CASE("Sensors fail closed until the monitor reports", "[health_monitor]") {
+    Morb morb;
+    HealthMonitor monitor(&morb);
+    Rounds rounds{morb, monitor};
+    rounds.sensors = false;
+    rounds.run(6);
+    REQUIRE(monitor.report().failing == health_bit(HealthCheck::SENSORS));
+    REQUIRE_FALSE(monitor.report().arming_ok());
+
+    rounds.sensors = true;
+    rounds.run(1);
+    REQUIRE(monitor.report().arming_ok());
+}
+
+TEST_CASE("Reporting inputs are checked", "[health_monitor]") {
+    Morb morb;
+    HealthMonitor monitor(&morb);
+    Rounds rounds{morb, monitor};
+    rounds.run(6);
+    REQUIRE(monitor.report().arming_ok());
+
+    SECTION("Link loss") {
+        morb.publish<LinkStatus>("link_status", LinkStatus{rounds.now, false});
+        rounds.run(1);
+        REQUIRE(monitor.report().failing == health_bit(HealthCheck::LINK));
+        REQUIRE((monitor.report().failing & HEALTH_FAILSAFE) != 0);
+
+        morb.publish<LinkStatus>("link_status", LinkStatus{rounds.now, true});
+        rounds.run(1);
+        REQUIRE(monitor.report().failing == 0);
+    }
+    SECTION("Overrunning control loop") {
+        ControlLoopStats stats{rounds.now, 1000, 10, 3000};
+        morb.publish<ControlLoopStats>("control_loop_stats", stats);
+        rounds.run(1);
+        REQUIRE(monitor.report().failing == 0);
+
+        /// 10% of the new cycles overran
+        stats = ControlLoopStats{rounds.now, 2000, 110, 8000};
+        morb.publish<ControlLoopStats>("control_loop_stats", stats);
+        rounds.run(1);
+        REQUIRE(monitor.report().failing == health_bit(HealthCheck::CONTROL_LOOP));
+        /// Blocks arming but does not end the flight
+        REQUIRE((monitor.report().failing & HEALTH_FAILSAFE) == 0);
+
+        /// Verdict holds until new stats arrive, then goes stale
+        rounds.run(1);
+        REQUIRE(monitor.report().failing == health_bit(HealthCheck::CONTROL_LOOP));
+        stats = ControlLoopStats{rounds.now, 3000, 110, 3000};
+        morb.publish<ControlLoopStats>("control_loop_stats", stats);
+        rounds.run(1);
+        REQUIRE(monitor.report().failing == 0);
+        rounds.run(16);
+        REQUIRE(monitor.report().failing == health_bit(HealthCheck::CONTROL_LOOP));
+    }
+}
+
+TEST_CASE("Reports are published on change and heartbeat", "[health_monitor]") {
+    Morb morb;
+    std::vector<HealthReport> published;
+    morb.subscribe<HealthReport>("health_report", [&](const HealthReport &report) {
+        published.push_back(report);
+    });
+    HealthMonitor monitor(&morb);
+    Rounds rounds{morb, monitor};
+
+    /// Every first check, then the estimator passing
+    rounds.run(6);
+    const size_t settled = published.size();
+    REQUIRE(settled <= HEALTH_CHECK_COUNT + 2);
+    REQUIRE(published.back().arming_ok());
+
+    /// Two seconds of nothing new
+    rounds.run(10);
+    REQUIRE(published.size() - settled == 2);
+}
@@ -0,0 +1,150 @@
+/**
+ * @file hold_land_test.cpp
+ * @author Abdulelah Mulla
+ * @brief Unit tests for the hold and land modes
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "navigator/navigator.h"
+#include "vehicle_state.h"
+#include "morb.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+
+using Catch::Approx;
+
+static constexpr double REF_LAT = 47.3977;
+static constexpr double REF_LON = 8.5456;
+static constexpr double REF_ALT = 488.0;
+
+/// Stepped by the tests instead of sleeping
+static double sim_now = 0.0;
+
+/// Runs the navigator on sim_now while in scope
+struct SimulatedClock {
+    SimulatedClock() {
+        sim_now = 1000.0;
+        Navigator::set_clock([] {return sim_now;});
+    }
+    ~SimulatedClock() {Navigator::set_clock(nullptr);}
+    void advance(double seconds) {sim_now += seconds;}
+};
+
+/// Vehicle at a height above the origin, level
+static VehicleState state_at(float height, uint64_t timestamp) {
+    VehicleState state{};
+    state.timestamp = timestamp;
+    state.q[0] = 1.f;
+    state.accel[2] = -9.81f;
+    state.position[2] = -height;
+    state.lat = REF_LAT;
+    state.lon = REF_LON;
+    state.alt = REF_ALT + height;
+    state.attitude_valid = true;
+    state.local_valid = true;
+    state.global_valid = true;
+    return state;
+}
+
+TEST_CASE("Hold brakes to a stop and latches", "[hold]") {
+    SimulatedClock clock;
+    Morb morb;
+    int published = 0;
+    morb.subscribe<Position>("position_setpoint", [&](const Position &) {
+        published++;
+    });
+    Navigator navigator(&morb);
+
+    VehicleState state = state_at(10.f, 1);
+    state.velocity[0] = 0.3f;
+    morb.publish<VehicleState>("vehicle_state", state);
+    navigator.set_mode(mavsdk::ActionServer::FlightMode::Hold);
+    navigator.run();
+    REQUIRE(published == 1);
+    REQUIRE(navigator.get_position()->target.vx == Approx(0.3f));
+
+    /// 0.1 s to stop at 3 m/s²
+    clock.advance(0.15);
+    navigator.run();
+    const Position target = navigator.get_position()->target;
+    REQUIRE(target.vx == 0.f);
+    REQUIRE(target.ax == 0.f);
+    REQUIRE(target.lat > REF_LAT);
+    REQUIRE(target.alt == Approx(REF_ALT + 10.0));
+
+    /// Latched, nothing more to publish
+    const int count = published;
+    for (int i = 0; i < 10; i++) {
+        navigator.run();
+    }
+    REQUIRE(published == count);
+    REQUIRE_FALSE(navigator.mode_complete());
+}
+
+TEST_CASE("Land descends at the scheduled rate", "[land]") {
+    SimulatedClock clock;
+    Morb morb;
+    Navigator navigator(&morb);
+
+    morb.publish<VehicleState>("vehicle_state", state_at(20.f, 1));
+    navigator.set_mode(mavsdk::ActionServer::FlightMode::Land);
+    navigator.run();
+    REQUIRE(navigator.get_position()->target.vz == 0.f);
+
+    float last_rate = 0.f;
+    for (int i = 0; i < 20; i++) {
+        clock.advance(0.02);
+        navigator.run();
+        const Position &target = navigator.get_position()->target;
+        /// Ramps up, never past the fast rate or a lead of 1 m
+        REQUIRE(target.vz >= last_rate);
+        REQUIRE(target.vz <= 1.5f);
+        REQUIRE(target.alt >= REF_ALT + 19.0 - 1e-6);
+        REQUIRE(target.lat == REF_LAT);
+        last_rate = target.vz;
+    }
+    REQUIRE(last_rate > 0.f);
+    REQUIRE_FALSE(navigator.mode_complete());
+}
+
+TEST_CASE("Land follows the land detector", "[land]") {
+    SimulatedClock clock;
+    Morb morb;
+    int published = 0;
+    morb.subscribe<Position>("position_setpoint", [&](const Position &) {
+        published++;
+    });
+    Navigator navigator(&morb);
+    morb.publish<VehicleState>("vehicle_state", state_at(0.5f, 1));
+    navigator.set_mode(mavsdk::ActionServer::FlightMode::Land);
+    navigator.run();
+
+    /// Ground contact stops the descent
+    LandDetected detected{};
+    detected.ground_contact = true;
+    morb.publish<LandDetected>("land_detected", detected);
+    navigator.run();
+    const int count = published;
+    clock.advance(0.02);
+    navigator.run();
+    REQUIRE(published == count);
+    REQUIRE_FALSE(navigator.mode_complete());
+
+    /// Lost again, descending
+    detected.ground_contact = false;
+    morb.publish<LandDetected>("land_detected", detected);
+    navigator.run();
+    clock.advance(0.02);
+    navigator.run();
+    REQUIRE(published > count);
+
+    detected.ground_contact = true;
+    detected.maybe_landed = true;
+    detected.landed = true;
+    morb.publish<LandDetected>("land_detected", detected);
+    navigator.run();
+    REQUIRE(navigator.mode_complete());
+    REQUIRE(navigator.get_position()->target.vz == 0.f);
+}
@@ -0,0 +1,160 @@
+/**
+ * @file land_detector_test.cpp
+ * @author Abdulelah Mulla
+ * @brief Unit tests for the land detector
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include <cmath>
+#include <vector>
+
+#include "estimator/land_detector.h"
+#include "morb.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+
+using Catch::Approx;
+
+/// 250 Hz states, 50 Hz baro
+static constexpr uint64_t STATE_PERIOD = 4000;
+static constexpr int BARO_DIVIDER = 5;
+
+static float pressure_at(float altitude) {
+    return 101325.f * std::pow(1.f - altitude / 44330.77f, 1.f / 0.190263f);
+}
+
+/**
+ * @brief Feeds the detector a vehicle moving at a constant vertical speed.
+ */
+struct Feed {
+    Morb &morb;
+    uint64_t timestamp{1};
+    float height{0};
+    int ticks{0};
+
+    void step(float climb_rate, float baro_climb_rate) {
+        timestamp += STATE_PERIOD;
+        height += climb_rate * STATE_PERIOD * 1e-6f;
+        if (ticks++ % BARO_DIVIDER == 0) {
+            SensorBaro baro{};
+            baro.timestamp = timestamp;
+            baro.pressure_pa = pressure_at(100.f + baro_climb_rate * timestamp * 1e-6f);
+            morb.publish<SensorBaro>("sensor_baro", baro);
+        }
+        VehicleState state{};
+        state.timestamp = timestamp;
+        state.q[0] = 1.f;
+        state.accel[2] = -9.81f;
+        state.position[2] = -height;
+        state.velocity[2] = -climb_rate;
+        state.attitude_valid = true;
+        state.local_valid = true;
+        morb.publish<VehicleState>("vehicle_state", state);
+    }
+
+    void thrust(float value) {
+        ActuatorControls controls{};
+        controls.thrust = value;
+        morb.publish<ActuatorControls>("actuator_controls", controls);
+    }
+};
+
+TEST_CASE("Hysteresis holds each edge", "[land_detector]") {
+    Hysteresis hysteresis(100, 50);
+    REQUIRE_FALSE(hysteresis.update(true, 0));
+    REQUIRE_FALSE(hysteresis.update(true, 99));
+    /// A glitch restarts the timer
+    REQUIRE_FALSE(hysteresis.update(false, 100));
+    REQUIRE_FALSE(hysteresis.update(true, 110));
+    REQUIRE(hysteresis.update(true, 210));
+    REQUIRE(hysteresis.update(false, 220));
+    REQUIRE_FALSE(hysteresis.update(false, 270));
+}
+
+TEST_CASE("Pressure altitude", "[land_detector]") {
+    REQUIRE(LandDetector::pressure_altitude(101325.f) == Approx(0.f).margin(1e-3));
+    REQUIRE(LandDetector::pressure_altitude(pressure_at(488.f)) == Approx(488.f).margin(0.05));
+}
+
+TEST_CASE("Resting vehicle goes through the stages in order", "[land_detector]") {
+    Morb morb;
+    std::vector<LandDetected> published;
+    morb.subscribe<LandDetected>("land_detected", [&](const LandDetected &detected) {
+        published.push_back(detected);
+    });
+    LandDetector detector(&morb);
+    Feed feed{morb};
+    feed.thrust(0.f);
+
+    uint64_t contact = 0, maybe = 0, landed = 0;
+    for (int i = 0; i < 500; i++) {
+        feed.step(0.f, 0.f);
+        const LandDetected &detected = detector.detected();
+        if (detected.ground_contact && !contact) {
+            contact = detected.timestamp;
+        }
+        if (detected.maybe_landed && !maybe) {
+            maybe = detected.timestamp;
+        }
+        if (detected.landed && !landed) {
+            landed = detected.timestamp;
+        }
+    }
+    REQUIRE(contact > 0);
+    REQUIRE(maybe >= contact + 250000);
+    REQUIRE(landed >= maybe + 300000);
+    /// About a second from the first sample
+    REQUIRE(landed < 1000000);
+    REQUIRE(detector.detected().available == (LAND_VOTE_VERTICAL_SPEED | LAND_VOTE_THRUST |
+                                              LAND_VOTE_ACCEL | LAND_VOTE_BARO));
+
+    /// Published on the changes and the heartbeat only
+    REQUIRE(published.size() < 10);
+    REQUIRE(published.back().landed);
+}
+
+TEST_CASE("Descending or hovering is not landed", "[land_detector]") {
+    Morb morb;
+    LandDetector detector(&morb);
+    Feed feed{morb, 1, 20.f};
+
+    SECTION("Descending at idle thrust") {
+        feed.thrust(0.f);
+        for (int i = 0; i < 500; i++) {
+            feed.step(-1.f, -1.f);
+            REQUIRE_FALSE(detector.detected().ground_contact);
+        }
+        REQUIRE((detector.detected().votes & LAND_VOTE_BARO) == 0);
+    }
+    SECTION("Hovering") {
+        feed.thrust(0.5f);
+        for (int i = 0; i < 500; i++) {
+            feed.step(0.f, 0.f);
+            REQUIRE_FALSE(detector.detected().ground_contact);
+        }
+    }
+}
+
+TEST_CASE("One dissenting signal stops at maybe landed", "[land_detector]") {
+    Morb morb;
+    LandDetector detector(&morb);
+    Feed feed{morb};
+    feed.thrust(0.f);
+
+    /// Baro drifting as if climbing
+    for (int i = 0; i < 500; i++) {
+        feed.step(0.f, 2.f);
+    }
+    REQUIRE(detector.detected().maybe_landed);
+    REQUIRE_FALSE(detector.detected().landed);
+
+    /// Throttle up for takeoff, contact is dropped quickly
+    feed.thrust(0.6f);
+    for (int i = 0; i < 30; i++) {
+        feed.step(0.f, 2.f);
+    }
+    REQUIRE_FALSE(detector.detected().ground_contact);
+    REQUIRE_FALSE(detector.detected().maybe_landed);
+}
@@ -0,0 +1,316 @@
+/**
+ * @file log_analysis_test.cpp
+ * @author Abdulelah Mulla
+ * @brief Unit tests for reading the sensor log back and its statistics
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "analysis/log_reader.h"
+#include "analysis/column_reader.h"
+#include "analysis/flight_stats.h"
+#include "flight_recorder.h"
+#include "log_segments.h"
+#include "actuator.h"
+#include "position.h"
+#include "vehicle_state.h"
+#include "health_monitor.h"
+#include "mode_manager.h"
+#include "temp_directory.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+
+using Catch::Approx;
+
+static constexpr double HOME_LAT = 47.3977;
+static constexpr double HOME_LON = 8.5456;
+static constexpr double HOME_ALT = 488.0;
+
+/// 1 m north in degrees of latitude, near enough
+static constexpr double ONE_METER = 1.0 / 111194.9;
+
+/**
+ * A 20 s flight at 100 Hz: READY, TAKEOFF at 2 s, HOLD at 10 s.
+ * The vehicle holds 1 m north of the setpoint, 0.5 m above, and
+ * the IMU is logged at 250 Hz. Bus messages are split into their
+ * fields, as MITL_LOG does, in the COLUMNAR layout.
+ */
+static void write_flight(const std::string &dir, LogPolicy policy, LogLayout layout = LogLayout::INTERLEAVED) {
+    SegmentedLog log(dir, "sensor_log");
+    log.set_policy(policy);
+    log.set_layout(layout);
+    auto add_struct = [&](const char *label, const char *type) {
+        return log.add_topic(label, type, recorded_fields(type), false);
+    };
+    const uint8_t imu = log.add_topic("[IMU]", "gz.msgs.IMU");
+    const uint8_t state_topic = add_struct("[Vehicle state]", recorded_type::VEHICLE_STATE);
+    const uint8_t setpoint_topic = add_struct("[Position setpoint]", recorded_type::POSITION_SETPOINT);
+    const uint8_t actuator_topic = add_struct("[Actuator controls]", recorded_type::ACTUATOR_CONTROLS);
+    const uint8_t mode_topic = add_struct("[Mode]", recorded_type::MODE_CHANGE);
+
+    Position setpoint{};
+    setpoint.lat = HOME_LAT;
+    setpoint.lon = HOME_LON;
+    setpoint.alt = HOME_ALT + 10.0;
+    log.append(setpoint_topic, 0, &setpoint, sizeof(setpoint));
+
+    const uint8_t imu_bytes[64] = {};
+    for (uint64_t time = 0; time < 20000000; time += 2000) {
+        if (time % 4000 == 0) {
+            log.append(imu, time, imu_bytes, sizeof(imu_bytes));
+        }
+        if (time % 10000 != 0) {
+            continue;
+        }
+        if (time == 2000000 || time == 10000000) {
+            const bool takeoff = time == 2000000;
+            ModeChange change{time, takeoff ? ModeId::READY : ModeId::TAKEOFF,
+                              takeoff ? ModeId::TAKEOFF : ModeId::HOLD,
+                              takeoff ? ModeEvent::REQUEST_TAKEOFF : ModeEvent::MODE_COMPLETE};
+            log.append(mode_topic, time, &change, sizeof(change));
+        }
+        VehicleState state{};
+        state.timestamp = time;
+        state.lat = HOME_LAT + ONE_METER;
+        state.lon = HOME_LON;
+        state.alt = HOME_ALT + 10.5;
+        state.velocity[0] = 0.3f;
+        state.global_valid = true;
+        log.append(state_topic, time, &state, sizeof(state));
+
+        /// Every 10 ms, 300 µs after the sample
+        ActuatorControls controls{};
+        controls.trace.origin_ns = (time + 1000) * 1000;
+        controls.timestamp = controls.trace.origin_ns + 300000;
+        controls.thrust = 0.5f;
+        log.append(actuator_topic, time, &controls, sizeof(controls));
+    }
+}
+
+TEST_CASE("Columns and statistics of a flight", "[log_analysis]") {
+    const TempDirectory temp("log_analysis");
+    const std::string &dir = temp.path();
+    write_flight(dir, SegmentedLog::DEFAULT_POLICY);
+
+    const std::vector<std::string> segments = find_segments({dir});
+    REQUIRE(segments.size() == 1);
+    const LogColumns columns = read_segments(segments, 1);
+    REQUIRE(columns.bad_blocks == 0);
+    REQUIRE(columns.bad_records == 0);
+    REQUIRE(columns.state.time.size() == 2000);
+    REQUIRE(columns.actuators.time.size() == 2000);
+    REQUIRE(columns.setpoint.time.size() == 1);
+    REQUIRE(columns.modes.time.size() == 2);
+    REQUIRE(columns.state.time[1999] == 19990000);
+
+    const FlightStats stats = compute_stats(columns);
+    REQUIRE(stats.start == 0);
+    REQUIRE(stats.end == 19996000);
+
+    /// IMU at 250 Hz, the state at 100 Hz
+    REQUIRE(stats.rates.size() == 5);
+    REQUIRE(stats.rates[0].label == "[IMU]");
+    REQUIRE(stats.rates[0].rate_hz == Approx(250.0).margin(0.01));
+    REQUIRE(stats.rates[0].max_interval_us == 4000);
+    REQUIRE(stats.rates[1].rate_hz == Approx(100.0).margin(0.01));
+
+    /// Every period and latency in its bin
+    REQUIRE(stats.loop_interval.total() == 1999);
+    REQUIRE(stats.loop_interval.percentile(0.99) == 10000 + FlightStats::LOOP_BIN_US);
+    REQUIRE(stats.latency.total() == 2000);
+    REQUIRE(stats.latency.percentile(0.5) == 300 + FlightStats::LATENCY_BIN_US);
+    REQUIRE(stats.saturated == 0);
+    REQUIRE(stats.mean_thrust == Approx(0.5).margin(1e-6));
+
+    /// READY is left out
+    REQUIRE(stats.tracking[static_cast<int>(ModeId::READY)].samples == 0);
+    const TrackingStats &takeoff = stats.tracking[static_cast<int>(ModeId::TAKEOFF)];
+    const TrackingStats &hold = stats.tracking[static_cast<int>(ModeId::HOLD)];
+    REQUIRE(takeoff.samples == 800);
+    REQUIRE(hold.samples == 1000);
+    REQUIRE(hold.rms_horizontal == Approx(1.0).margin(0.01));
+    REQUIRE(hold.max_vertical == Approx(0.5).margin(0.01));
+    REQUIRE(hold.rms_velocity == Approx(0.3).margin(1e-6));
+
+    REQUIRE(stats.modes.size() == 3);
+    REQUIRE(stats.modes[0].mode == ModeId::READY);
+    REQUIRE(stats.modes[1].mode == ModeId::TAKEOFF);
+    REQUIRE(stats.modes[1].start == 2000000);
+    REQUIRE(stats.modes[1].end == 10000000);
+    REQUIRE(stats.modes[2].event == ModeEvent::MODE_COMPLETE);
+    REQUIRE(stats.modes[2].end == stats.end);
+}
+
+TEST_CASE("Reading on many threads gives the same columns", "[log_analysis]") {
+    const TempDirectory temp("log_analysis");
+    const std::string &dir = temp.path();
+    LogPolicy policy = SegmentedLog::DEFAULT_POLICY;
+    policy.segment_bytes = 1; // one block per segment
+    write_flight(dir, policy);
+
+    const std::vector<std::string> segments = find_segments({dir});
+    REQUIRE(segments.size() > 4);
+    const LogColumns serial = read_segments(segments, 1);
+    const LogColumns parallel = read_segments(segments, 8);
+    REQUIRE(parallel.blocks == serial.blocks);
+    REQUIRE(parallel.records == serial.records);
+    REQUIRE(parallel.topics.size() == 5);
+    REQUIRE(parallel.state.time == serial.state.time);
+    REQUIRE(parallel.state.lat == serial.state.lat);
+    REQUIRE(parallel.actuators.stamp_ns == serial.actuators.stamp_ns);
+    REQUIRE(parallel.modes.to == serial.modes.to);
+    for (size_t i = 0; i < parallel.topics.size(); i++) {
+        REQUIRE(parallel.topics[i].label == serial.topics[i].label);
+        REQUIRE(parallel.topics[i].time == serial.topics[i].time);
+    }
+}
+
+TEST_CASE("Truncated segments and unknown layouts are skipped", "[log_analysis]") {
+    const TempDirectory temp("log_analysis");
+    const std::string &dir = temp.path();
+    std::string path;
+    {
+        SegmentedLog log(dir, "sensor_log");
+        const uint8_t state_topic = log.add_topic("[Vehicle state]", recorded_type::VEHICLE_STATE);
+        VehicleState state{};
+        for (uint64_t time = 0; time < 3000; time++) {
+            log.append(state_topic, time, &state, sizeof(state));
+        }
+        /// From a build where VehicleState was smaller
+        log.append(state_topic, 3000, &state, sizeof(state) - 8);
+        path = log.segment_path(log.segment());
+    }
+    /// Lose the index, and the end of the last block
+    std::remove((path + ".idx").c_str());
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    const std::streamoff size = in.tellg();
+    in.close();
+    REQUIRE(truncate(path.c_str(), size - 10) == 0);
+
+    LogColumns columns;
+    REQUIRE(read_segment(path, columns));
+    REQUIRE(columns.blocks > 0);
+    REQUIRE(columns.state.time.size() > 0);
+    REQUIRE(columns.state.time.size() < 3000);
+    REQUIRE(columns.bad_blocks == 0);
+
+    /// A whole segment, with the odd record
+    {
+        SegmentedLog log(dir, "copy");
+        const uint8_t state_topic = log.add_topic("[Vehicle state]", recorded_type::VEHICLE_STATE);
+        VehicleState state{};
+        log.append(state_topic, 0, &state, sizeof(state));
+        log.append(state_topic, 1, &state, sizeof(state) - 8);
+        log.flush();
+        path = log.segment_path(log.segment());
+    }
+    LogColumns whole;
+    REQUIRE(read_segment(path, whole));
+    REQUIRE(whole.records == 2);
+    REQUIRE(whole.state.time.size() == 1);
+    REQUIRE(whole.bad_records == 1);
+    REQUIRE_FALSE(read_segment(dir + "/missing.mlog", whole));
+}
+
+TEST_CASE("Columnar logs read into the same columns", "[log_analysis]") {
+    const TempDirectory rows_temp("log_analysis");
+    const std::string &rows_dir = rows_temp.path();
+    const TempDirectory columns_temp("log_analysis");
+    const std::string &columns_dir = columns_temp.path();
+    write_flight(rows_dir, SegmentedLog::DEFAULT_POLICY);
+    write_flight(columns_dir, SegmentedLog::DEFAULT_POLICY, LogLayout::COLUMNAR);
+
+    const LogColumns rows = read_segments(find_segments({rows_dir}), 1);
+    const std::vector<std::string> segments = find_segments({columns_dir});
+    REQUIRE(segments.size() == 1);
+    const LogColumns columns = read_segments(segments, 4);
+    REQUIRE(columns.bad_records == 0);
+    REQUIRE(columns.records == rows.records);
+    REQUIRE(columns.topics.size() == rows.topics.size());
+    for (size_t i = 0; i < columns.topics.size(); i++) {
+        REQUIRE(columns.topics[i].label == rows.topics[i].label);
+        REQUIRE(columns.topics[i].time == rows.topics[i].time);
+    }
+    REQUIRE(columns.state.time == rows.state.time);
+    REQUIRE(columns.state.lat == rows.state.lat);
+    REQUIRE(columns.state.vx == rows.state.vx);
+    REQUIRE(columns.state.global_valid == rows.state.global_valid);
+    REQUIRE(columns.setpoint.alt == rows.setpoint.alt);
+    REQUIRE(columns.actuators.stamp_ns == rows.actuators.stamp_ns);
+    REQUIRE(columns.actuators.origin_ns == rows.actuators.origin_ns);
+    REQUIRE(columns.modes.to == rows.modes.to);
+
+    const FlightStats stats = compute_stats(columns);
+    REQUIRE(stats.latency.percentile(0.5) == 300 + FlightStats::LATENCY_BIN_US);
+    REQUIRE(stats.tracking[static_cast<int>(ModeId::HOLD)].samples == 1000);
+    REQUIRE(stats.modes.size() == 3);
+}
+
+TEST_CASE("One signal is read without the rest of the log", "[log_analysis]") {
+    const TempDirectory temp("log_analysis");
+    const std::string &dir = temp.path();
+    write_flight(dir, SegmentedLog::DEFAULT_POLICY, LogLayout::COLUMNAR);
+    const std::vector<std::string> segments = find_segments({dir});
+    REQUIRE(segments.size() == 1);
+
+    ColumnarSegment segment;
+    REQUIRE(segment.open(segments[0]));
+    REQUIRE(segment.bytes_read() > 0); // the schemas
+    const uint64_t opened = segment.bytes_read();
+    const int state = segment.find_topic("[Vehicle state]");
+    const int alt = segment.find_field(state, "alt");
+    REQUIRE(state >= 0);
+    REQUIRE(alt >= 0);
+    REQUIRE(segment.find_field(state, "altitude") < 0);
+
+    /// 2 s of 100 Hz
+    std::vector<double> values;
+    std::vector<uint64_t> times;
+    REQUIRE(segment.read_field(state, alt, 10000000, 11990000, values, &times));
+    REQUIRE(values.size() == 200);
+    REQUIRE(times.front() == 10000000);
+    REQUIRE(times.back() == 11990000);
+    REQUIRE(values[0] == Approx(HOME_ALT + 10.5));
+
+    uint64_t stored = 0;
+    for (const LogChunkIndex &chunk : segment.chunks()) {
+        stored += chunk.header.raw_size;
+    }
+    REQUIRE((segment.bytes_read() - opened) * 20 < stored);
+
+    /// Types must match, read_values converts any
+    std::vector<float> wrong;
+    REQUIRE_FALSE(segment.read_field(state, alt, 0, UINT64_MAX, wrong));
+    std::vector<double> valid;
+    REQUIRE(segment.read_values(state, segment.find_field(state, "global_valid"), 0, UINT64_MAX, valid));
+    REQUIRE(valid.size() == 2000);
+    REQUIRE(valid[1999] == 1.0);
+
+    /// Ranges from the chunk headers alone
+    const uint64_t before = segment.bytes_read();
+    double min = 0, max = 0;
+    REQUIRE(segment.field_range(state, segment.find_field(state, "vx"), 0, UINT64_MAX, min, max));
+    REQUIRE(min == Approx(0.3));
+    REQUIRE(max == Approx(0.3));
+    REQUIRE_FALSE(segment.field_range(state, alt, 30000000, UINT64_MAX, min, max));
+    REQUIRE(segment.bytes_read() == before);
+
+    /// Sensor messages keep their bytes, for replay
+    std::vector<uint32_t> sizes;
+    std::vector<uint8_t> payload;
+    times.clear();
+    REQUIRE(segment.read_payloads(segment.find_topic("[IMU]"), 0, 3999, times, sizes, payload));
+    REQUIRE(times.size() == 1);
+    REQUIRE(sizes[0] == 64);
+    REQUIRE(payload.size() == 64);
+    REQUIRE_FALSE(segment.read_payloads(state, 0, UINT64_MAX, times, sizes, payload));
+}
@@ -0,0 +1,331 @@
+/**
+ * @file log_segments_test.cpp
+ * @author Abdulelah Mulla
+ * @brief Unit tests for the segmented sensor log
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include "log_segments.h"
+#include "temp_directory.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+static std::vector<uint8_t> read_file(const std::string &path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+static bool exists(const std::string &path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0;
+}
+
+/// Payload of record i, compressible like a real message
+static std::vector<uint8_t> payload(uint32_t i) {
+    std::vector<uint8_t> bytes(200);
+    for (size_t j = 0; j < bytes.size(); j++) {
+        bytes[j] = static_cast<uint8_t>(j % 16 + i % 7);
+    }
+    return bytes;
+}
+
+/**
+ * @brief A decoded segment, through its index.
+ */
+struct Decoded {
+    std::vector<std::string> topics;
+    std::vector<uint64_t> times;
+    std::vector<std::vector<uint8_t>> payloads;
+    size_t blocks{0};
+};
+
+static Decoded decode(const std::string &path) {
+    Decoded decoded;
+    const std::vector<uint8_t> file = read_file(path);
+    const std::vector<uint8_t> index = read_file(path + ".idx");
+    REQUIRE(file.size() >= sizeof(LogFileHeader));
+    REQUIRE(index.size() >= sizeof(LogFileHeader));
+
+    LogFileHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    REQUIRE(std::memcmp(header.magic, "MITLLOG1", 8) == 0);
+    REQUIRE(header.codec == SegmentedLog::default_codec());
+
+    decoded.blocks = (index.size() - sizeof(LogFileHeader)) / sizeof(LogBlockIndex);
+    for (size_t b = 0; b < decoded.blocks; b++) {
+        LogBlockIndex entry;
+        std::memcpy(&entry, index.data() + sizeof(LogFileHeader) + b * sizeof(entry), sizeof(entry));
+        REQUIRE(entry.first_time <= entry.last_time);
+
+        std::vector<uint8_t> raw(entry.raw_size);
+        const uint8_t *data = file.data() + entry.offset + sizeof(LogBlockHeader);
+        REQUIRE(SegmentedLog::decompress(header.codec, data, entry.size, raw.data(), raw.size()));
+
+        /// Every block names its topics again
+        decoded.topics.clear();
+        size_t offset = 0;
+        while (offset < raw.size()) {
+            LogRecordHeader record;
+            std::memcpy(&record, raw.data() + offset, sizeof(record));
+            offset += sizeof(record);
+            const uint8_t *bytes = raw.data() + offset;
+            offset += record.size;
+            if (record.kind == LogRecordKind::TOPIC) {
+                REQUIRE(record.topic == decoded.topics.size());
+                decoded.topics.emplace_back(reinterpret_cast<const char*>(bytes), record.size);
+            } else {
+                REQUIRE(record.topic < decoded.topics.size());
+                REQUIRE(record.time >= entry.first_time);
+                REQUIRE(record.time <= entry.last_time);
+                decoded.times.push_back(record.time);
+                decoded.payloads.emplace_back(bytes, bytes + record.size);
+            }
+        }
+        REQUIRE(offset == raw.size());
+    }
+    return decoded;
+}
+
+TEST_CASE("Records read back through the index", "[log_segments]") {
+    const TempDirectory temp("log_segments");
+    const std::string &dir = temp.path();
+    std::string path;
+    {
+        SegmentedLog log(dir, "sensor_log");
+        const uint8_t imu = log.add_topic("[IMU]", "gz.msgs.IMU");
+        const uint8_t baro = log.add_topic("[Air pressure]", "gz.msgs.FluidPressure");
+        for (uint32_t i = 0; i < 1000; i++) {
+            const std::vector<uint8_t> bytes = payload(i);
+            log.append(i % 10 == 0 ? baro : imu, 1000 + i, bytes.data(), static_cast<uint32_t>(bytes.size()));
+        }
+        path = log.segment_path(log.segment());
+    }
+
+    const Decoded decoded = decode(path);
+    /// 1000 records of 216 bytes do not fit one block
+    REQUIRE(decoded.blocks > 1);
+    REQUIRE(decoded.topics.size() == 2);
+    REQUIRE(decoded.topics[0] == std::string("[IMU]") + '\0' + "gz.msgs.IMU");
+    REQUIRE(decoded.times.size() == 1000);
+    for (uint32_t i = 0; i < 1000; i++) {
+        REQUIRE(decoded.times[i] == 1000 + i);
+        REQUIRE(decoded.payloads[i] == payload(i));
+    }
+    if (SegmentedLog::default_codec() != LogCodec::NONE) {
+        REQUIRE(read_file(path).size() < 1000 * 200);
+    }
+}
+
+TEST_CASE("Segments rotate and stay within the disk budget", "[log_segments]") {
+    const TempDirectory temp("log_segments");
+    const std::string &dir = temp.path();
+    LogPolicy policy{};
+    policy.segment_bytes = 1;                       // one block per segment
+    policy.segment_duration = std::chrono::seconds(600);
+    policy.budget_bytes = 4 * SegmentedLog::BLOCK_BYTES;
+
+    /// Incompressible, so every segment holds a full block
+    std::vector<uint8_t> noise(4000);
+    uint32_t seed = 1;
+    auto refill = [&] {
+        for (uint8_t &byte : noise) {
+            seed = seed * 1664525u + 1013904223u;
+            byte = static_cast<uint8_t>(seed >> 24);
+        }
+    };
+
+    {
+        SegmentedLog log(dir, "sensor_log");
+        log.set_policy(policy);
+        const uint8_t topic = log.add_topic("[Laser Scan]", "gz.msgs.LaserScan");
+        for (uint32_t i = 0; i < 200; i++) {
+            refill();
+            log.append(topic, i, noise.data(), static_cast<uint32_t>(noise.size()));
+        }
+    }
+
+    /// The newest are kept, the oldest deleted
+    uint32_t first = 0, last = 0;
+    uint64_t total = 0;
+    for (uint32_t segment = 1; segment < 100; segment++) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "/sensor_log_%06u.mlog", segment);
+        const std::string path = dir + name;
+        if (!exists(path)) {
+            continue;
+        }
+        /// No gaps
+        REQUIRE((last == 0 || segment == last + 1));
+        REQUIRE(decode(path).payloads.size() > 0);
+        total += read_file(path).size() + read_file(path + ".idx").size();
+        first = first ? first : segment;
+        last = segment;
+    }
+    /// 200 records of 4 kB make a dozen blocks, one per segment
+    REQUIRE(last > 8);
+    REQUIRE(first > 1);
+    REQUIRE(last - first >= 1);
+    REQUIRE(total <= policy.budget_bytes);
+
+    /// A new run numbers on
+    SegmentedLog next(dir, "sensor_log");
+    const uint8_t topic = next.add_topic("[IMU]", "gz.msgs.IMU");
+    next.append(topic, 0, noise.data(), 16);
+    next.flush();
+    REQUIRE(next.segment() > last);
+}
+
+TEST_CASE("Columnar segments keep each field in its own chunks", "[log_segments]") {
+    struct Sample {
+        uint64_t stamp;
+        float value;
+        uint8_t flag;
+    };
+    const TempDirectory temp("log_segments");
+    const std::string &dir = temp.path();
+    std::string path;
+    {
+        SegmentedLog log(dir, "sensor_log");
+        log.set_layout(LogLayout::COLUMNAR);
+        const uint8_t sample = log.add_topic("[Sample]", "mitl.Sample", {
+            {"stamp", LogFieldType::U64, static_cast<uint16_t>(offsetof(Sample, stamp))},
+            {"value", LogFieldType::F32, static_cast<uint16_t>(offsetof(Sample, value))},
+            {"flag", LogFieldType::U8, static_cast<uint16_t>(offsetof(Sample, flag))}}, false);
+        const uint8_t imu = log.add_topic("[IMU]", "gz.msgs.IMU");
+        for (uint32_t i = 0; i < 20000; i++) {
+            /// A NaN is left out of the range
+            const Sample row{i * 10ull, i == 7 ? NAN : static_cast<float>(i) * 0.5f, static_cast<uint8_t>(i % 2)};
+            log.append(sample, 1000 + i, &row, sizeof(row));
+            if (i % 10 == 0) {
+                const std::vector<uint8_t> bytes = payload(i);
+                log.append(imu, 1000 + i, bytes.data(), static_cast<uint32_t>(bytes.size()));
+            }
+        }
+        /// Too short for the fields
+        const uint8_t half[4] = {};
+        log.append(sample, 30000, half, sizeof(half));
+        path = log.segment_path(log.segment());
+    }
+
+    const std::vector<uint8_t> file = read_file(path);
+    const std::vector<uint8_t> index = read_file(path + ".idx");
+    LogFileHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    REQUIRE(header.layout == LogLayout::COLUMNAR);
+
+    const size_t count = (index.size() - sizeof(LogFileHeader)) / sizeof(LogChunkIndex);
+    std::vector<uint32_t> sample_times;
+    std::vector<float> values;
+    std::vector<uint8_t> imu_payload;
+    int schemas = 0;
+    for (size_t c = 0; c < count; c++) {
+        LogChunkIndex entry;
+        std::memcpy(&entry, index.data() + sizeof(LogFileHeader) + c * sizeof(entry), sizeof(entry));
+        /// The index repeats the header in the file
+        REQUIRE(std::memcmp(file.data() + entry.offset, &entry.header, sizeof(entry.header)) == 0);
+        const LogChunkHeader &chunk = entry.header;
+        std::vector<uint8_t> raw(chunk.raw_size);
+        REQUIRE(SegmentedLog::decompress(header.codec, file.data() + entry.offset + sizeof(LogChunkHeader),
+                                         chunk.size, raw.data(), raw.size()));
+        if (chunk.kind == LogChunkKind::SCHEMA) {
+            schemas++;
+            const std::string label(reinterpret_cast<const char*>(raw.data()));
+            REQUIRE(label == (chunk.topic == 0 ? "[Sample]" : "[IMU]"));
+            continue;
+        }
+        REQUIRE(chunk.first_time <= chunk.last_time);
+        if (chunk.topic == 0 && chunk.kind == LogChunkKind::TIME) {
+            REQUIRE(chunk.raw_size == chunk.count * sizeof(uint64_t));
+            for (uint32_t r = 0; r < chunk.count; r++) {
+                uint64_t time;
+                std::memcpy(&time, raw.data() + r * sizeof(time), sizeof(time));
+                sample_times.push_back(static_cast<uint32_t>(time));
+            }
+        } else if (chunk.topic == 0 && chunk.kind == LogChunkKind::FIELD && chunk.column == 1) {
+            const size_t first = values.size();
+            values.resize(first + chunk.count);
+            std::memcpy(values.data() + first, raw.data(), chunk.count * sizeof(float));
+            const float low = first == 0 ? 0.0f : first * 0.5f;
+            REQUIRE(chunk.min == low);
+            REQUIRE(chunk.max == (first + chunk.count - 1) * 0.5f);
+        } else if (chunk.topic == 1 && chunk.kind == LogChunkKind::PAYLOAD) {
+            imu_payload.insert(imu_payload.end(), raw.begin(), raw.end());
+        }
+        /// Fields alone, the sample keeps no payload
+        REQUIRE_FALSE((chunk.topic == 0 &&
+                       (chunk.kind == LogChunkKind::SIZES || chunk.kind == LogChunkKind::PAYLOAD)));
+    }
+    REQUIRE(schemas == 2);
+    REQUIRE(sample_times.size() == 20000);
+    REQUIRE(values.size() == 20000);
+    for (uint32_t i = 0; i < 20000; i++) {
+        REQUIRE(sample_times[i] == 1000 + i);
+        if (i != 7) {
+            REQUIRE(values[i] == i * 0.5f);
+        }
+    }
+    REQUIRE(imu_payload.size() == 2000 * 200);
+    REQUIRE(std::vector<uint8_t>(imu_payload.end() - 200, imu_payload.end()) == payload(19990));
+}
+
+TEST_CASE("Columnar groups of a slow topic end after a second", "[log_segments]") {
+    const TempDirectory temp("log_segments");
+    const std::string &dir = temp.path();
+    SegmentedLog log(dir, "sensor_log");
+    log.set_layout(LogLayout::COLUMNAR);
+    const uint8_t topic = log.add_topic("[Stats]", "mitl.Stats",
+                                        {{"value", LogFieldType::U64, 0}}, false);
+
+    /// 10hz, far from filling a block
+    for (uint64_t time = 0; time < SegmentedLog::GROUP_AGE_US; time += 100000) {
+        log.append(topic, time, &time, sizeof(time));
+    }
+    REQUIRE(log.segment() == 0);
+
+    const uint64_t time = SegmentedLog::GROUP_AGE_US;
+    log.append(topic, time, &time, sizeof(time));
+    REQUIRE(log.segment() != 0);
+    const std::vector<uint8_t> index = read_file(log.segment_path(log.segment()) + ".idx");
+    bool written = false;
+    for (size_t offset = sizeof(LogFileHeader); offset + sizeof(LogChunkIndex) <= index.size();
+         offset += sizeof(LogChunkIndex)) {
+        LogChunkIndex entry;
+        std::memcpy(&entry, index.data() + offset, sizeof(entry));
+        if (entry.header.kind == LogChunkKind::TIME) {
+            REQUIRE(entry.header.count == 11);
+            REQUIRE(entry.header.last_time == SegmentedLog::GROUP_AGE_US);
+            written = true;
+        }
+    }
+    REQUIRE(written);
+}
+
+TEST_CASE("A flush ends a segment that is past its duration", "[log_segments]") {
+    const TempDirectory temp("log_segments");
+    const std::string &dir = temp.path();
+    SegmentedLog log(dir, "sensor_log");
+    log.set_policy({64ull << 20, std::chrono::seconds(0), 2048ull << 20});
+    log.set_layout(LogLayout::COLUMNAR);
+    const uint8_t topic = log.add_topic("[Stats]", "mitl.Stats",
+                                        {{"value", LogFieldType::U64, 0}}, false);
+
+    const uint64_t value = 1;
+    log.append(topic, 0, &value, sizeof(value));
+    REQUIRE(log.segment() == 0);
+    log.flush();
+    /// Written, then ended
+    REQUIRE(log.segment() == 0);
+    REQUIRE(exists(log.segment_path(1)));
+}
@@ -0,0 +1,93 @@
+/**
+ * @file log_store_test.cpp
+ * @author Abdulelah Mulla
+ * @brief Unit tests for the log download store
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#include <unistd.h>
+
+#include "telemetry/log_store.h"
+#include "temp_directory.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+static void write_file(const std::string &path, const std::string &contents) {
+    std::ofstream out(path, std::ios::binary);
+    out << contents;
+}
+
+TEST_CASE("Only logs with a known prefix are listed", "[log_store]") {
+    const TempDirectory temp("log_store");
+    const std::string &dir = temp.path();
+    write_file(dir + "/program_log", "program");
+    write_file(dir + "/sensor_log", "sensor data");
+    write_file(dir + "/sensor_log_000001.mlog", "segment");
+    write_file(dir + "/sensor_log_000001.mlog.idx", "index");
+    write_file(dir + "/trace.json", "{}");
+
+    LogStore store(dir, {"program_log", "sensor_log"});
+    REQUIRE(store.refresh() == 3);
+
+    size_t total = 0;
+    for (const LogEntry &entry : store.entries()) {
+        REQUIRE(entry.id >= 1);
+        REQUIRE(entry.id <= 3);
+        REQUIRE(entry.path.find("trace.json") == std::string::npos);
+        REQUIRE(entry.path.find(".idx") == std::string::npos);
+        total += entry.size;
+    }
+    REQUIRE(total == std::strlen("program") + std::strlen("sensor data") + std::strlen("segment"));
+}
+
+TEST_CASE("Reads point into the mapped file", "[log_store]") {
+    const TempDirectory temp("log_store");
+    const std::string &dir = temp.path();
+    std::string contents;
+    for (int i = 0; i < 1000; i++) {
+        contents += static_cast<char>(i % 251);
+    }
+    write_file(dir + "/sensor_log", contents);
+
+    LogStore store(dir, {"sensor_log"});
+    REQUIRE(store.refresh() == 1);
+
+    const uint8_t *data = nullptr;
+    REQUIRE(store.read(1, 0, 90, data) == 90);
+    REQUIRE(std::memcmp(data, contents.data(), 90) == 0);
+
+    /// Short read at the end of the file
+    REQUIRE(store.read(1, 950, 90, data) == 50);
+    REQUIRE(std::memcmp(data, contents.data() + 950, 50) == 0);
+
+    /// Nothing past the end or for an unknown id
+    REQUIRE(store.read(1, 1000, 90, data) == 0);
+    REQUIRE(store.read(2, 0, 90, data) == 0);
+    REQUIRE(data == nullptr);
+}
+
+TEST_CASE("Appends after mapping are not read", "[log_store]") {
+    const TempDirectory temp("log_store");
+    const std::string &dir = temp.path();
+    write_file(dir + "/program_log", "0123456789");
+
+    LogStore store(dir, {"program_log"});
+    REQUIRE(store.refresh() == 1);
+    const uint8_t *data = nullptr;
+    REQUIRE(store.read(1, 0, 90, data) == 10);
+
+    std::ofstream(dir + "/program_log", std::ios::app) << "more";
+    REQUIRE(store.read(1, 10, 90, data) == 0);
+
+    /// A new listing picks the growth up
+    REQUIRE(store.refresh() == 1);
+    REQUIRE(store.entries()[0].size == 14);
+    REQUIRE(store.read(1, 10, 90, data) == 4);
+}
@@ -2,154 +2,118 @@
  * @file mavlink_interface_test.cpp
  * @author Abdulelah Mulla
  * @brief Unit tests for the mavlink interface
- * @version 0.2
+ * @version 0.3
  * @date 2025-12-15
  */
 
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <thread>
-#include <iostream>
 
 #include "mavlink_interface.h"
+#include "mode/mission.h"
+#include "vehicle_state.h"
+#include "gcs_stand_in.h"
 
 #include <mavsdk/mavsdk.h>
 #include <mavsdk/plugins/action/action.h>
 #include <mavsdk/plugins/telemetry/telemetry.h>
-#include <mavsdk/plugins/action_server/action_server.h>
 #include <mavsdk/plugins/param/param.h>
 #include <mavsdk/plugins/mission_raw/mission_raw.h>
 #include <catch2/catch_test_macros.hpp>
 
 using namespace mavsdk;
 
-TEST_CASE("MavlinkInterface start initializes connections properly", "[MavlinkInterface]") {
-    /// Initialize GCS for connection with the mavlink interface
-    Mavsdk mavsdk_gcs{Mavsdk::Configuration{ComponentType::GroundStation}};
-    auto result = mavsdk_gcs.add_any_connection("udpin://127.0.0.1:14551");
-    REQUIRE(result == ConnectionResult::Success);
-
-    /// Track when a system is discovered
-    std::atomic<bool> system_discovered{false};
-    std::shared_ptr<System> discovered_system = nullptr;
-
-    /// Subscribe to new systems
-    mavsdk_gcs.subscribe_on_new_system([&]() {
-        auto systems = mavsdk_gcs.systems();
-        if (!systems.empty()) {
-            discovered_system = systems[0];
-            system_discovered = true;
+/// Every test links the interface to a GCS stand-in in process, no ports
+
+static constexpr double HOME_LAT = 47.3977;
+static constexpr double HOME_LON = 8.5456;
+static constexpr double HOME_ALT = 488.0;
+
+/**
+ * @brief Stands in for the health monitor, the mode manager refuses
+ * to arm without its reports. Reports passing checks at 10hz.
+ *
+ * Publishes from its own thread, so construct it once start() has
+ * returned and every subscription is made.
+ */
+class HealthyReports {
+private:
+    std::atomic<bool> _running{true};
+    std::thread _thread;
+public:
+    explicit HealthyReports(Morb &morb) : _thread([this, &morb] {
+        while (_running.load()) {
+            morb.publish<HealthReport>("health_report", {SensorMonitor::wall_time_us(), 0, HEALTH_ALL});
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
         }
-    });
+    }) {}
 
+    ~HealthyReports() {
+        _running.store(false);
+        _thread.join();
+    }
+};
+
+TEST_CASE("MavlinkInterface start initializes connections properly", "[MavlinkInterface]") {
     Morb morb;
-    MavlinkInterface mav_interface{&morb, "udpout://127.0.0.1:14551"};
+    MavlinkInterface mav_interface{&morb, "raw://"};
+    GcsStandIn gcs{mav_interface.mavsdk()};
 
-    /// Start the mavlink interface
+    /// Start the mavlink interface, returns once it heard the GCS
     bool start_result = mav_interface.start();
     REQUIRE(start_result);
 
-    /// Wait for the GCS to discover the system (with timeout)
-    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
-    while (!system_discovered && std::chrono::steady_clock::now() < deadline) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    }
-
-    /// Verify that the system was discovered
-    REQUIRE(system_discovered);
-    REQUIRE(discovered_system != nullptr);
-    REQUIRE(discovered_system->is_connected());
+    /// Verify that the GCS discovered the system
+    REQUIRE(gcs.connect());
+    REQUIRE(gcs.system() != nullptr);
+    REQUIRE(gcs.system()->is_connected());
 
     /// Clean up
     mav_interface.stop();
 }
 
 TEST_CASE("Takeoff functionality", "[takeoff]") {
-    /// Setup MavlinkInterface and GCS connection
-    Mavsdk mavsdk_gcs{Mavsdk::Configuration{ComponentType::GroundStation}};
-    auto result = mavsdk_gcs.add_any_connection("udpin://127.0.0.1:14552");
     Morb morb;
-    MavlinkInterface mav_interface{&morb, "udpout://127.0.0.1:14552"};
+    MavlinkInterface mav_interface{&morb, "raw://"};
+    GcsStandIn gcs{mav_interface.mavsdk()};
     bool start_result = mav_interface.start();
     REQUIRE(start_result);
+    HealthyReports health{morb};
     mav_interface.run();
-    std::shared_ptr<System> discovered_system = nullptr;
-    std::atomic<bool> system_discovered{false};
-    mavsdk_gcs.subscribe_on_new_system([&]() {
-        auto systems = mavsdk_gcs.systems();
-        if (!systems.empty()) {
-            discovered_system = systems[0];
-            system_discovered = true;
-        }
-    });
-    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
-    while (!system_discovered && std::chrono::steady_clock::now() < deadline) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    }
+    REQUIRE(gcs.connect());
 
     /// Verify default mode before mode change
-    auto telemetry = Telemetry(discovered_system);
-    Telemetry::FlightMode mode = telemetry.flight_mode();
-    REQUIRE(mode == Telemetry::FlightMode::Ready);
-    /// Send a takeoff command via MAVSDK Action plugin from GCS side
-    mavsdk::Action action{discovered_system};
-    mavsdk::Action::Result takeoff_result = action.takeoff();
-    REQUIRE(takeoff_result == mavsdk::Action::Result::Success);
-
-    /// Wait for the mode change to complete (asynchronous operation)
-    const auto mode_deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
-    while (telemetry.flight_mode() != Telemetry::FlightMode::Takeoff &&
-           std::chrono::steady_clock::now() < mode_deadline) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    }
+    REQUIRE(gcs.wait_for_mode(Telemetry::FlightMode::Ready));
+
+    /// Send a takeoff command from the GCS side, and wait for mitl to report it
+    REQUIRE(gcs.takeoff());
+    REQUIRE(gcs.telemetry().flight_mode() == Telemetry::FlightMode::Takeoff);
 
-    /// Verify that mitl responded appropriately
-    mode = telemetry.flight_mode();
-    REQUIRE(mode == Telemetry::FlightMode::Takeoff);
+    /// Takeoff armed on the control thread, which the GCS hears about too
+    REQUIRE(gcs.wait_for_armed(true));
 
     /// Clean up threads before object destruction
     mav_interface.stop();
 }
 
 TEST_CASE("Parameters are set correctly", "[parameters]") {
-    /// Setup MavlinkInterface and GCS connection
-    Mavsdk mavsdk_gcs{Mavsdk::Configuration{ComponentType::GroundStation}};
-    auto result = mavsdk_gcs.add_any_connection("udpin://127.0.0.1:14553");
-    REQUIRE(result == ConnectionResult::Success);
-
     Morb morb;
-    MavlinkInterface mav_interface{&morb, "udpout://127.0.0.1:14553"};
+    MavlinkInterface mav_interface{&morb, "raw://"};
+    GcsStandIn gcs{mav_interface.mavsdk()};
     bool start_result = mav_interface.start();
     REQUIRE(start_result);
+    REQUIRE(gcs.connect());
 
-    /// Wait for system discovery
-    std::shared_ptr<System> discovered_system = nullptr;
-    std::atomic<bool> system_discovered{false};
-    mavsdk_gcs.subscribe_on_new_system([&]() {
-        auto systems = mavsdk_gcs.systems();
-        if (!systems.empty()) {
-            discovered_system = systems[0];
-            system_discovered = true;
-        }
-    });
-
-    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
-    while (!system_discovered && std::chrono::steady_clock::now() < deadline) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    }
-    REQUIRE(system_discovered);
-    REQUIRE(discovered_system != nullptr);
-
-    /// Retrieve parameters using Param plugin
-    mavsdk::Param param{discovered_system};
-
-    /// Allow some time for parameters to be set up
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    /// Parameters are provided by start(), retrieve them using Param plugin
+    mavsdk::Param param{gcs.system()};
 
     /// Test MIS_TAKEOFF_ALT parameter
-    auto takeoff_alt_result = param.get_param_int("MIS_TAKEOFF_ALT");
+    auto takeoff_alt_result = param.get_param_float("MIS_TAKEOFF_ALT");
     REQUIRE(takeoff_alt_result.first == mavsdk::Param::Result::Success);
-    REQUIRE(takeoff_alt_result.second == 0);
+    REQUIRE(takeoff_alt_result.second == 10.f);
 
     /// Test custom parameter
     auto my_param_result = param.get_param_int("MY_PARAM");
@@ -161,133 +125,50 @@ TEST_CASE("Parameters are set correctly", "[parameters]") {
 }
 
 TEST_CASE("Arm and disarm functionality", "[arm_disarm]") {
-    /// Setup MavlinkInterface and GCS connection
-    Mavsdk mavsdk_gcs{Mavsdk::Configuration{ComponentType::GroundStation}};
-    auto result = mavsdk_gcs.add_any_connection("udpin://127.0.0.1:14554");
-    REQUIRE(result == ConnectionResult::Success);
-
     Morb morb;
-    MavlinkInterface mav_interface{&morb, "udpout://127.0.0.1:14554"};
+    MavlinkInterface mav_interface{&morb, "raw://"};
+    GcsStandIn gcs{mav_interface.mavsdk()};
     bool start_result = mav_interface.start();
     REQUIRE(start_result);
-
-    /// Wait for system discovery
-    std::shared_ptr<System> discovered_system = nullptr;
-    std::atomic<bool> system_discovered{false};
-    mavsdk_gcs.subscribe_on_new_system([&]() {
-        auto systems = mavsdk_gcs.systems();
-        if (!systems.empty()) {
-            discovered_system = systems[0];
-            system_discovered = true;
-        }
-    });
-
-    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
-    while (!system_discovered && std::chrono::steady_clock::now() < deadline) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    }
-    REQUIRE(system_discovered);
-    REQUIRE(discovered_system != nullptr);
-
-    /// Create Action plugin to send arm command
-    mavsdk::Action action{discovered_system};
+    HealthyReports health{morb};
+    /// The control loop decides on arming
+    mav_interface.run();
+    REQUIRE(gcs.connect());
 
     /// Verify system starts disarmed
-    auto telemetry = mavsdk::Telemetry{discovered_system};
-    REQUIRE(!telemetry.armed());
+    REQUIRE(!gcs.telemetry().armed());
 
-    /// Send arm command
-    auto arm_result = action.arm();
-    REQUIRE(arm_result == mavsdk::Action::Result::Success);
-
-    /// Wait for arm to complete
-    const auto arm_deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
-    while (!telemetry.armed() && std::chrono::steady_clock::now() < arm_deadline) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    }
-
-    /// Verify system is armed
-    REQUIRE(telemetry.armed());
+    /// Send arm command, and wait for it to be reported
+    REQUIRE(gcs.arm());
+    REQUIRE(gcs.telemetry().armed());
 
     /// Send disarm command
-    auto disarm_result = action.disarm();
-    REQUIRE(disarm_result == mavsdk::Action::Result::Success);
-
-    /// Wait for disarm to complete
-    const auto disarm_deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
-    while (telemetry.armed() && std::chrono::steady_clock::now() < disarm_deadline) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    }
-
-    /// Verify system is disarmed
-    REQUIRE(!telemetry.armed());
+    REQUIRE(gcs.disarm());
+    REQUIRE(!gcs.telemetry().armed());
 
     /// Clean up
     mav_interface.stop();
 }
 
 TEST_CASE("Land callback is triggered", "[land]") {
-    /// Setup MavlinkInterface and GCS connection
-    Mavsdk mavsdk_gcs{Mavsdk::Configuration{ComponentType::GroundStation}};
-    auto result = mavsdk_gcs.add_any_connection("udpin://127.0.0.1:14555");
-    REQUIRE(result == ConnectionResult::Success);
-
     Morb morb;
-    MavlinkInterface mav_interface{&morb, "udpout://127.0.0.1:14555"};
+    MavlinkInterface mav_interface{&morb, "raw://"};
+    GcsStandIn gcs{mav_interface.mavsdk()};
     bool start_result = mav_interface.start();
     REQUIRE(start_result);
+    HealthyReports health{morb};
     mav_interface.run();
-
-    /// Wait for system discovery
-    std::shared_ptr<System> discovered_system = nullptr;
-    std::atomic<bool> system_discovered{false};
-    mavsdk_gcs.subscribe_on_new_system([&]() {
-        auto systems = mavsdk_gcs.systems();
-        if (!systems.empty()) {
-            discovered_system = systems[0];
-            system_discovered = true;
-        }
-    });
-
-    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
-    while (!system_discovered && std::chrono::steady_clock::now() < deadline) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    }
-    REQUIRE(system_discovered);
-    REQUIRE(discovered_system != nullptr);
-
-    auto telemetry = Telemetry{discovered_system};
-    mavsdk::Action action{discovered_system};
+    REQUIRE(gcs.connect());
 
     /// First, takeoff to get vehicle in air
-    auto takeoff_result = action.takeoff();
-    REQUIRE(takeoff_result == mavsdk::Action::Result::Success);
-
-    /// Wait for takeoff mode
-    const auto takeoff_deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
-    while (telemetry.flight_mode() != Telemetry::FlightMode::Takeoff &&
-           std::chrono::steady_clock::now() < takeoff_deadline) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    }
-    REQUIRE(telemetry.flight_mode() == Telemetry::FlightMode::Takeoff);
+    REQUIRE(gcs.takeoff());
 
     /// Manually transition to Hold by sending hold command
-    auto hold_result = action.hold();
-
-    /// Allow time for the command to be processed
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
-
-    /// Now attempt to send a land command
-    auto land_result = action.land();
+    gcs.hold();
 
-    /// If land succeeds, verify mode changes to Land
-    if (land_result == mavsdk::Action::Result::Success) {
-        const auto mode_deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
-        while (telemetry.flight_mode() != Telemetry::FlightMode::Land &&
-               std::chrono::steady_clock::now() < mode_deadline) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        }
-        REQUIRE(telemetry.flight_mode() == Telemetry::FlightMode::Land);
+    /// Now attempt to send a land command, if it succeeds verify mode changes to Land
+    if (gcs.action().land() == Action::Result::Success) {
+        REQUIRE(gcs.wait_for_mode(Telemetry::FlightMode::Land));
     }
 
     /// Clean up
@@ -295,105 +176,59 @@ TEST_CASE("Land callback is triggered", "[land]") {
 }
 
 TEST_CASE("Vehicle loop publishes telemetry", "[vehicle_loop]") {
-    /// Setup MavlinkInterface and GCS connection
-    Mavsdk mavsdk_gcs{Mavsdk::Configuration{ComponentType::GroundStation}};
-    auto result = mavsdk_gcs.add_any_connection("udpin://127.0.0.1:14557");
-    REQUIRE(result == ConnectionResult::Success);
-
     Morb morb;
-    MavlinkInterface mav_interface{&morb, "udpout://127.0.0.1:14557"};
+    MavlinkInterface mav_interface{&morb, "raw://"};
+    GcsStandIn gcs{mav_interface.mavsdk()};
     bool start_result = mav_interface.start();
     REQUIRE(start_result);
-
-    /// Wait for system discovery
-    std::shared_ptr<System> discovered_system = nullptr;
-    std::atomic<bool> system_discovered{false};
-    mavsdk_gcs.subscribe_on_new_system([&]() {
-        auto systems = mavsdk_gcs.systems();
-        if (!systems.empty()) {
-            discovered_system = systems[0];
-            system_discovered = true;
-        }
-    });
-
-    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
-    while (!system_discovered && std::chrono::steady_clock::now() < deadline) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    }
-    REQUIRE(system_discovered);
-    REQUIRE(discovered_system != nullptr);
+    REQUIRE(gcs.connect());
 
     /// Start the vehicle loop
     mav_interface.run();
 
-    /// Subscribe to telemetry to verify it's being published
-    auto telemetry = mavsdk::Telemetry{discovered_system};
-    std::atomic<bool> position_received{false};
-    std::atomic<bool> gps_received{false};
-    std::atomic<bool> battery_received{false};
-
-    telemetry.subscribe_position([&](mavsdk::Telemetry::Position pos) {
-        position_received = true;
-    });
-
-    telemetry.subscribe_raw_gps([&](mavsdk::Telemetry::RawGps gps) {
-        gps_received = true;
-    });
-
-    telemetry.subscribe_battery([&](mavsdk::Telemetry::Battery battery) {
-        battery_received = true;
-    });
-
-    /// Wait for telemetry to be published (vehicle loop runs at 1Hz)
-    const auto telem_deadline = std::chrono::steady_clock::now() + std::chrono::seconds(3);
-    while ((!position_received || !gps_received || !battery_received) &&
-           std::chrono::steady_clock::now() < telem_deadline) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    }
-
-    /// Verify telemetry was received
-    REQUIRE(position_received);
-    REQUIRE(gps_received);
-    REQUIRE(battery_received);
+    /// Verify position, GPS and battery telemetry are received
+    REQUIRE(gcs.wait_for_telemetry());
 
     /// Clean up
     mav_interface.stop();
 }
 
 TEST_CASE("Mission upload functionality", "[mission]") {
-    /// Setup MavlinkInterface and GCS connection
-    Mavsdk mavsdk_gcs{Mavsdk::Configuration{ComponentType::GroundStation}};
-    auto result = mavsdk_gcs.add_any_connection("udpin://127.0.0.1:14558");
-    REQUIRE(result == ConnectionResult::Success);
-
     Morb morb;
-    MavlinkInterface mav_interface{&morb, "udpout://127.0.0.1:14558"};
-    bool start_result = mav_interface.start();
-    REQUIRE(start_result);
 
-    /// Wait for system discovery
-    std::shared_ptr<System> discovered_system = nullptr;
-    std::atomic<bool> system_discovered{false};
-    mavsdk_gcs.subscribe_on_new_system([&]() {
-        auto systems = mavsdk_gcs.systems();
-        if (!systems.empty()) {
-            discovered_system = systems[0];
-            system_discovered = true;
-        }
+    /// Flying the mission reports its progress, from the control thread
+    std::mutex mutex;
+    std::condition_variable reported;
+    bool progress = false;
+    morb.subscribe<MissionProgress>("mission_progress", [&](const MissionProgress &) {
+        std::lock_guard<std::mutex> lock(mutex);
+        progress = true;
+        reported.notify_all();
     });
 
-    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
-    while (!system_discovered && std::chrono::steady_clock::now() < deadline) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    }
-    REQUIRE(system_discovered);
-    REQUIRE(discovered_system != nullptr);
-
-    /// Create a simple mission with one waypoint
-    mavsdk::MissionRaw mission_raw{discovered_system};
+    MavlinkInterface mav_interface{&morb, "raw://"};
+    GcsStandIn gcs{mav_interface.mavsdk()};
+    bool start_result = mav_interface.start();
+    REQUIRE(start_result);
+    HealthyReports health{morb};
+    mav_interface.run();
+    REQUIRE(gcs.connect());
+
+    /// Missions are relative to home, which the first global fix sets
+    VehicleState state{};
+    state.q[0] = 1.f;
+    state.lat = HOME_LAT;
+    state.lon = HOME_LON;
+    state.alt = HOME_ALT;
+    state.attitude_valid = true;
+    state.local_valid = true;
+    state.global_valid = true;
+    morb.publish<VehicleState>("vehicle_state", state);
+
+    /// Create a simple mission with one waypoint, north of home
     mavsdk::MissionRaw::MissionItem item{};
     item.seq = 0;
-    item.frame = 0;
+    item.frame = 6; // MAV_FRAME_GLOBAL_RELATIVE_ALT_INT
     item.command = 16; // MAV_CMD_NAV_WAYPOINT
     item.current = 1;
     item.autocontinue = 1;
@@ -401,20 +236,26 @@ TEST_CASE("Mission upload functionality", "[mission]") {
     item.param2 = 0;
     item.param3 = 0;
     item.param4 = 0;
-    item.x = 47;
-    item.y = 8;
+    item.x = static_cast<int32_t>((HOME_LAT + 0.001) * 1e7);
+    item.y = static_cast<int32_t>(HOME_LON * 1e7);
     item.z = 10;
     item.mission_type = 0;
 
     std::vector<mavsdk::MissionRaw::MissionItem> mission_items{item};
 
     /// Upload the mission
-    auto upload_result = mission_raw.upload_mission(mission_items);
+    auto upload_result = gcs.mission().upload_mission(mission_items);
     REQUIRE(upload_result == mavsdk::MissionRaw::Result::Success);
 
-    /// Allow time for mission to be processed
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    /// The upload is acked before the plan is parsed, flying it shows it was loaded
+    REQUIRE(gcs.takeoff());
+    REQUIRE(gcs.hold());
+    REQUIRE(gcs.start_mission());
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        REQUIRE(reported.wait_for(lock, GcsStandIn::TIMEOUT, [&] {return progress;}));
+    }
 
     /// Clean up
     mav_interface.stop();
-}
\ No newline at end of file
+}
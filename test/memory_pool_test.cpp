@@ -0,0 +1,121 @@
+/**
+ * @file memory_pool_test.cpp
+ * @author Abdulelah Mulla
+ * @brief Unit tests for the message pools and the mission arena
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "memory_pool.h"
+#include "alloc_audit.h"
+#include "navigator/mission_plan.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("Blocks are reused, and the upstream serves what does not fit", "[memory_pool]") {
+    BlockPool pool(40, 4);
+    REQUIRE(pool.block_size() == 48);
+
+    std::set<void*> blocks;
+    for (int i = 0; i < 4; i++) {
+        blocks.insert(pool.allocate(40));
+    }
+    REQUIRE(blocks.size() == 4);
+    REQUIRE(pool.stats().in_use == 4);
+
+    /// Exhausted, and too large
+    void *extra = pool.allocate(40);
+    void *large = pool.allocate(100);
+    REQUIRE(blocks.count(extra) == 0);
+    REQUIRE(pool.stats().fallbacks == 2);
+    pool.deallocate(extra, 40);
+    pool.deallocate(large, 100);
+
+    for (void *block : blocks) {
+        pool.deallocate(block, 40);
+    }
+    REQUIRE(pool.stats().in_use == 0);
+    void *again = pool.allocate(8);
+    REQUIRE(blocks.count(again) == 1);
+    pool.deallocate(again, 8);
+}
+
+TEST_CASE("try_allocate never goes upstream", "[memory_pool]") {
+    BlockPool pool(64, 2);
+    void *first = pool.try_allocate(64);
+    void *second = pool.try_allocate(10);
+    REQUIRE(first != nullptr);
+    REQUIRE(second != nullptr);
+    REQUIRE(pool.try_allocate(10) == nullptr);
+    pool.deallocate(second, 10);
+    REQUIRE(pool.try_allocate(100) == nullptr);
+    REQUIRE(pool.stats().fallbacks == 0);
+    REQUIRE(pool.stats().in_use == 1);
+    pool.deallocate(first, 64);
+}
+
+TEST_CASE("pmr containers allocate from the pools", "[memory_pool]") {
+    MessagePools &pools = MessagePools::initialize();
+    const uint32_t in_use = pools.stats(1).in_use;
+    {
+        /// 200 bytes, the 256 byte class
+        std::pmr::vector<double> values(25, 1.0, &pools);
+        REQUIRE(pools.stats(1).in_use == in_use + 1);
+    }
+    REQUIRE(pools.stats(1).in_use == in_use);
+}
+
+TEST_CASE("A block is never handed out twice", "[memory_pool]") {
+    BlockPool pool(sizeof(int), 16);
+    std::atomic<bool> overlap{false};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&pool, &overlap, t] {
+            for (int i = 0; i < 20000; i++) {
+                int *value = static_cast<int*>(pool.allocate(sizeof(int)));
+                *value = t;
+                std::this_thread::yield();
+                if (*value != t) {
+                    overlap = true;
+                }
+                pool.deallocate(value, sizeof(int));
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    REQUIRE_FALSE(overlap);
+    REQUIRE(pool.stats().in_use == 0);
+}
+
+/// Allocations made parsing a mission of count waypoints
+static uint64_t parse_allocations(size_t count) {
+    std::vector<mavsdk::MissionRawServer::MissionItem> items(count);
+    for (size_t i = 0; i < count; i++) {
+        items[i].seq = static_cast<uint32_t>(i);
+        items[i].frame = 6; // MAV_FRAME_GLOBAL_RELATIVE_ALT_INT
+        items[i].command = 16; // MAV_CMD_NAV_WAYPOINT
+        items[i].x = 473977000 + static_cast<int32_t>(i) * 90;
+        items[i].y = 85456000;
+        items[i].z = 10.f;
+    }
+    AllocAudit::Scope audit(MitlThread::CONTROL);
+    AllocAudit::start();
+    std::shared_ptr<const MissionPlan> plan = MissionPlan::parse(items, 47.3977, 8.5456, 488.0);
+    AllocAudit::stop();
+    REQUIRE(plan->size() == count);
+    return AllocAudit::count();
+}
+
+TEST_CASE("A mission plan takes the same few allocations at any size", "[memory_pool]") {
+    const uint64_t small = parse_allocations(2);
+    REQUIRE(small > 0);
+    REQUIRE(parse_allocations(50) == small);
+    REQUIRE(parse_allocations(500) == small);
+}
@@ -0,0 +1,178 @@
+/**
+ * @file mission_test.cpp
+ * @author Abdulelah Mulla
+ * @brief Unit tests for mission parsing and the mission mode
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include <cmath>
+#include <vector>
+
+#include "navigator/navigator.h"
+#include "navigator/mission_plan.h"
+#include "vehicle_state.h"
+#include "morb.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+
+using Catch::Approx;
+using MissionItem = mavsdk::MissionRawServer::MissionItem;
+
+static constexpr double REF_LAT = 47.3977;
+static constexpr double REF_LON = 8.5456;
+static constexpr float REF_ALT = 488.f;
+
+/// Roughly one meter in latitude, degE7
+static constexpr int32_t METER = 90;
+
+static MissionItem waypoint(uint32_t seq, int32_t north, int32_t east, float rel_alt, float radius = 0.f) {
+    MissionItem item{};
+    item.seq = seq;
+    item.frame = 6; // MAV_FRAME_GLOBAL_RELATIVE_ALT_INT
+    item.command = 16; // MAV_CMD_NAV_WAYPOINT
+    item.autocontinue = 1;
+    item.param2 = radius;
+    item.x = static_cast<int32_t>(REF_LAT * 1e7) + north;
+    item.y = static_cast<int32_t>(REF_LON * 1e7) + east;
+    item.z = rel_alt;
+    return item;
+}
+
+static MissionItem do_item(uint32_t seq) {
+    MissionItem item{};
+    item.seq = seq;
+    item.frame = 2; // MAV_FRAME_MISSION
+    item.command = 178; // MAV_CMD_DO_CHANGE_SPEED
+    return item;
+}
+
+/// Put the vehicle at a waypoint
+static void fly_to(Morb &morb, const MissionWaypoint &target) {
+    VehicleState state{};
+    state.q[0] = 1.f;
+    state.lat = target.lat;
+    state.lon = target.lon;
+    state.alt = target.alt;
+    state.global_valid = true;
+    morb.publish<VehicleState>("vehicle_state", state);
+}
+
+TEST_CASE("Mission is parsed into local waypoints", "[mission]") {
+    std::vector<MissionItem> items{
+        waypoint(0, 0, 0, 10.f),
+        do_item(1),
+        waypoint(2, 100 * METER, 0, 10.f, 5.f),
+        waypoint(3, 100 * METER, 100 * METER, 20.f),
+    };
+    auto plan = MissionPlan::parse(items, REF_LAT, REF_LON, REF_ALT);
+
+    REQUIRE(plan->size() == 3);
+    REQUIRE(plan->item_count() == 4);
+
+    const MissionWaypoint &first = (*plan)[0];
+    REQUIRE(first.seq == 0);
+    REQUIRE(first.ned[2] == Approx(-10.f));
+    REQUIRE(first.alt == Approx(REF_ALT + 10.f));
+    REQUIRE(first.leg_length == 0.f);
+    REQUIRE(first.acceptance_radius == MissionPlan::DEFAULT_ACCEPTANCE_RADIUS);
+
+    const MissionWaypoint &second = (*plan)[1];
+    REQUIRE(second.seq == 2);
+    REQUIRE(second.acceptance_radius == 5.f);
+    /// Meridian radius of curvature at the reference
+    const double sin_lat = std::sin(REF_LAT * M_PI / 180.0);
+    const double meridian = Wgs84::A * (1.0 - Wgs84::E2) / std::pow(1.0 - Wgs84::E2 * sin_lat * sin_lat, 1.5);
+    REQUIRE(second.ned[0] == Approx(100 * METER * 1e-7 * M_PI / 180.0 * meridian).epsilon(1e-4));
+    REQUIRE(second.leg_length == Approx(second.ned[0]).epsilon(1e-3));
+
+    const MissionWaypoint &third = (*plan)[2];
+    /// The tangent plane rises above the curved earth, 1 mm at 141 m
+    REQUIRE(third.ned[2] == Approx(-20.f).margin(0.01));
+    REQUIRE(plan->total_length() == Approx(second.leg_length + third.leg_length));
+
+    /// The DO item maps to the waypoint after it
+    REQUIRE(plan->index_of(1) == 1);
+    REQUIRE(plan->index_of(3) == 2);
+    REQUIRE(plan->index_of(4) == plan->size());
+}
+
+TEST_CASE("Mission mode steps through the waypoints", "[mission]") {
+    Morb morb;
+    std::vector<MissionProgress> progress;
+    morb.subscribe<MissionProgress>("mission_progress", [&](const MissionProgress &p) {
+        progress.push_back(p);
+    });
+    Navigator navigator(&morb);
+
+    std::vector<MissionItem> items{
+        waypoint(0, 0, 0, 10.f),
+        waypoint(1, 50 * METER, 0, 10.f),
+        waypoint(2, 50 * METER, 50 * METER, 10.f),
+    };
+    auto plan = MissionPlan::parse(items, REF_LAT, REF_LON, REF_ALT);
+    navigator.set_mission(plan);
+
+    /// Start on the ground under the first waypoint
+    VehicleState ground{};
+    ground.q[0] = 1.f;
+    ground.lat = REF_LAT;
+    ground.lon = REF_LON;
+    ground.alt = REF_ALT;
+    ground.global_valid = true;
+    morb.publish<VehicleState>("vehicle_state", ground);
+
+    navigator.set_mode(mavsdk::ActionServer::FlightMode::Mission);
+    navigator.run();
+    REQUIRE(progress.size() == 1);
+    REQUIRE(progress.back().current_seq == 0);
+    REQUIRE(navigator.get_position()->target.alt == Approx(REF_ALT + 10.f));
+
+    /// Not there yet
+    navigator.run();
+    REQUIRE(progress.size() == 1);
+
+    for (size_t i = 0; i < plan->size(); i++) {
+        fly_to(morb, (*plan)[i]);
+        navigator.run();
+        REQUIRE(progress.back().reached_seq == (*plan)[i].seq);
+    }
+    REQUIRE(progress.back().finished);
+}
+
+TEST_CASE("The GCS can set the current mission item", "[mission]") {
+    Morb morb;
+    std::vector<MissionProgress> progress;
+    morb.subscribe<MissionProgress>("mission_progress", [&](const MissionProgress &p) {
+        progress.push_back(p);
+    });
+    Navigator navigator(&morb);
+
+    std::vector<MissionItem> items{
+        waypoint(0, 0, 0, 10.f),
+        do_item(1),
+        waypoint(2, 50 * METER, 0, 10.f),
+    };
+    auto plan = MissionPlan::parse(items, REF_LAT, REF_LON, REF_ALT);
+    navigator.set_mission(plan);
+    navigator.set_mode(mavsdk::ActionServer::FlightMode::Mission);
+    navigator.run();
+
+    /// Jumping to the DO item flies to the waypoint after it
+    navigator.set_mission_item(1);
+    navigator.run();
+    REQUIRE(progress.back().current_seq == 2);
+    REQUIRE(navigator.get_position()->target.lat == Approx((*plan)[1].lat));
+}
+
+TEST_CASE("Mission mode holds without a mission", "[mission]") {
+    Morb morb;
+    Navigator navigator(&morb);
+    navigator.set_mode(mavsdk::ActionServer::FlightMode::Mission);
+    for (int i = 0; i < 5; i++) {
+        navigator.run();
+        /// Not complete, so the mode manager does not leave Mission
+        REQUIRE_FALSE(navigator.mode_complete());
+    }
+}
@@ -0,0 +1,100 @@
+/**
+ * @file mixer_test.cpp
+ * @author Abdulelah Mulla
+ * @brief Unit tests for the x500 mixer
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include <algorithm>
+
+#include "controllers/mixer.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+
+using Catch::Approx;
+
+TEST_CASE("Hover thrust is equal on all motors", "[mixer]") {
+    Mixer mixer = Mixer::x500();
+    float out[4];
+    mixer.mix({0, 0.f, 0.f, 0.f, 0.6f}, out);
+    for (float o : out) {
+        REQUIRE(o == Approx(0.6f).margin(1e-4));
+    }
+}
+
+TEST_CASE("Torques drive the right motors", "[mixer]") {
+    Mixer mixer = Mixer::x500();
+    float out[4];
+
+    /// Positive roll, the left motors (1 and 2) speed up
+    mixer.mix({0, 0.2f, 0.f, 0.f, 0.5f}, out);
+    REQUIRE(out[1] > out[0]);
+    REQUIRE(out[2] > out[3]);
+
+    /// Positive pitch, nose up, the front motors (0 and 2) speed up
+    mixer.mix({0, 0.f, 0.2f, 0.f, 0.5f}, out);
+    REQUIRE(out[0] > out[1]);
+    REQUIRE(out[2] > out[3]);
+
+    /// Positive yaw, the CCW motors (0 and 1) speed up
+    mixer.mix({0, 0.f, 0.f, 0.2f, 0.5f}, out);
+    REQUIRE(out[0] > out[2]);
+    REQUIRE(out[1] > out[3]);
+}
+
+TEST_CASE("Airmode keeps roll authority at zero thrust", "[mixer]") {
+    float out[4];
+
+    Mixer airmode = Mixer::x500(Airmode::ROLL_PITCH);
+    airmode.mix({0, 0.4f, 0.f, 0.f, 0.f}, out);
+    const float airmode_diff = out[1] - out[0];
+    REQUIRE(*std::min_element(out, out + 4) >= 0.f);
+    /// Full roll spans half the range, so 0.4 roll is not clipped
+    REQUIRE(airmode_diff > 0.f);
+
+    Mixer no_airmode = Mixer::x500(Airmode::DISABLED);
+    no_airmode.mix({0, 0.4f, 0.f, 0.f, 0.f}, out);
+    /// Thrust is not raised, so half of the roll is clipped away
+    REQUIRE(out[1] - out[0] < airmode_diff);
+}
+
+TEST_CASE("Saturation at full thrust preserves roll and pitch", "[mixer]") {
+    Mixer mixer = Mixer::x500(Airmode::ROLL_PITCH);
+    float out[4];
+    float reference[4];
+
+    mixer.mix({0, 0.3f, -0.2f, 0.f, 0.5f}, reference);
+    mixer.mix({0, 0.3f, -0.2f, 0.f, 1.f}, out);
+
+    for (int i = 0; i < 4; i++) {
+        REQUIRE(out[i] <= 1.f);
+        REQUIRE(out[i] >= 0.f);
+    }
+    /// Thrust was reduced, the differential stays the same
+    REQUIRE(out[1] - out[0] == Approx(reference[1] - reference[0]).margin(1e-4));
+    REQUIRE(out[2] - out[3] == Approx(reference[2] - reference[3]).margin(1e-4));
+}
+
+TEST_CASE("Yaw is dropped before roll and pitch", "[mixer]") {
+    Mixer mixer = Mixer::x500(Airmode::ROLL_PITCH);
+    float out[4];
+    float reference[4];
+
+    mixer.mix({0, 0.4f, 0.f, 0.f, 0.5f}, reference);
+    mixer.mix({0, 0.4f, 0.f, 1.f, 0.5f}, out);
+
+    for (int i = 0; i < 4; i++) {
+        REQUIRE(out[i] <= 1.f);
+        REQUIRE(out[i] >= 0.f);
+    }
+    /// Roll torque is left untouched by the yaw desaturation
+    const float arm_y[4] = {0.22f, -0.20f, -0.22f, 0.20f};
+    float roll_ref = 0.f, roll_out = 0.f;
+    for (int i = 0; i < 4; i++) {
+        roll_ref -= arm_y[i] * reference[i];
+        roll_out -= arm_y[i] * out[i];
+    }
+    REQUIRE(roll_out == Approx(roll_ref).margin(1e-4));
+}
@@ -9,48 +9,46 @@
 #include "mode_manager.h"
 #include "vehicle.h"
 #include "morb.h"
+#include "gcs_stand_in.h"
 
 #include <mavsdk/mavsdk.h>
 #include <mavsdk/server_component.h>
 #include <mavsdk/plugins/action_server/action_server.h>
 #include <catch2/catch_test_macros.hpp>
 
-#include <atomic>
-#include <chrono>
-#include <thread>
 #include <memory>
 
+/// What the sensor monitor would say, reported now
+static void publish_sensors(Morb &morb, bool healthy) {
+    SensorHealth health{};
+    health.timestamp = SensorMonitor::wall_time_us();
+    health.required_mask = 1;
+    health.stale_mask = healthy ? 0 : 1;
+    morb.publish<SensorHealth>("sensor_health", health);
+}
+
+/// What the land detector would say, received now
+static void publish_landed(Morb &morb, bool landed) {
+    LandDetected detected{};
+    detected.ground_contact = landed;
+    detected.maybe_landed = landed;
+    detected.landed = landed;
+    morb.publish<LandDetected>("land_detected", detected);
+}
+
 TEST_CASE("ModeManager valid state transitions", "[mode_manager]") {
-    /// Setup MAVSDK autopilot side
+    /// Setup MAVSDK autopilot side, linked in process to the GCS
     mavsdk::Mavsdk mavsdk_autopilot{mavsdk::Mavsdk::Configuration{mavsdk::ComponentType::Autopilot}};
-    auto connection_result = mavsdk_autopilot.add_any_connection("udpout://127.0.0.1:14560");
+    auto connection_result = mavsdk_autopilot.add_any_connection("raw://");
     REQUIRE(connection_result == mavsdk::ConnectionResult::Success);
 
     auto server = mavsdk_autopilot.server_component();
     REQUIRE(server != nullptr);
 
     /// Setup GCS side to verify mode changes
-    mavsdk::Mavsdk mavsdk_gcs{mavsdk::Mavsdk::Configuration{mavsdk::ComponentType::GroundStation}};
-    auto gcs_result = mavsdk_gcs.add_any_connection("udpin://127.0.0.1:14560");
-    REQUIRE(gcs_result == mavsdk::ConnectionResult::Success);
-
-    /// Wait for GCS to discover the system
-    std::atomic<bool> system_discovered{false};
-    std::shared_ptr<mavsdk::System> discovered_system = nullptr;
-    mavsdk_gcs.subscribe_on_new_system([&]() {
-        auto systems = mavsdk_gcs.systems();
-        if (!systems.empty()) {
-            discovered_system = systems[0];
-            system_discovered = true;
-        }
-    });
-
-    /// Wait for system discovery
-    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
-    while (!system_discovered && std::chrono::steady_clock::now() < deadline) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    }
-    REQUIRE(system_discovered);
+    GcsStandIn gcs{mavsdk_autopilot};
+    REQUIRE(gcs.connect());
+    std::shared_ptr<mavsdk::System> discovered_system = gcs.system();
     REQUIRE(discovered_system != nullptr);
 
     /// Initialize components
@@ -68,44 +66,42 @@ TEST_CASE("ModeManager valid state transitions", "[mode_manager]") {
     REQUIRE(mode == mavsdk::ActionServer::FlightMode::Ready);
 
     /// Ready to Takeoff
+    publish_sensors(morb, true);
     bool result = mode_manager.change_mode(mavsdk::ActionServer::FlightMode::Takeoff);
     REQUIRE(result);
-    std::this_thread::sleep_for(std::chrono::milliseconds(200));
     mode = mode_manager.get_current_mode();
     REQUIRE(mode == mavsdk::ActionServer::FlightMode::Takeoff);
 
     /// Takeoff to Hold
     result = mode_manager.change_mode(mavsdk::ActionServer::FlightMode::Hold);
     REQUIRE(result);
-    std::this_thread::sleep_for(std::chrono::milliseconds(200));
     mode = mode_manager.get_current_mode();
     REQUIRE(mode == mavsdk::ActionServer::FlightMode::Hold);
 
     /// Hold to Mission
     result = mode_manager.change_mode(mavsdk::ActionServer::FlightMode::Mission);
     REQUIRE(result);
-    std::this_thread::sleep_for(std::chrono::milliseconds(200));
     mode = mode_manager.get_current_mode();
     REQUIRE(mode == mavsdk::ActionServer::FlightMode::Mission);
 
     /// Mission to Hold
     result = mode_manager.change_mode(mavsdk::ActionServer::FlightMode::Hold);
     REQUIRE(result);
-    std::this_thread::sleep_for(std::chrono::milliseconds(200));
     mode = mode_manager.get_current_mode();
     REQUIRE(mode == mavsdk::ActionServer::FlightMode::Hold);
 
     /// Hold to Land
     result = mode_manager.change_mode(mavsdk::ActionServer::FlightMode::Land);
     REQUIRE(result);
-    std::this_thread::sleep_for(std::chrono::milliseconds(200));
     mode = mode_manager.get_current_mode();
     REQUIRE(mode == mavsdk::ActionServer::FlightMode::Land);
 
-    /// Land to Ready
+    /// Land to Ready, once the land detector agrees
+    result = mode_manager.change_mode(mavsdk::ActionServer::FlightMode::Ready);
+    REQUIRE(!result);
+    publish_landed(morb, true);
     result = mode_manager.change_mode(mavsdk::ActionServer::FlightMode::Ready);
     REQUIRE(result);
-    std::this_thread::sleep_for(std::chrono::milliseconds(200));
     mode = mode_manager.get_current_mode();
     REQUIRE(mode == mavsdk::ActionServer::FlightMode::Ready);
 
@@ -114,36 +110,18 @@ TEST_CASE("ModeManager valid state transitions", "[mode_manager]") {
 }
 
 TEST_CASE("ModeManager invalid state transitions", "[mode_manager]") {
-    /// Setup MAVSDK autopilot side
+    /// Setup MAVSDK autopilot side, linked in process to the GCS
     mavsdk::Mavsdk mavsdk_autopilot{mavsdk::Mavsdk::Configuration{mavsdk::ComponentType::Autopilot}};
-    auto connection_result = mavsdk_autopilot.add_any_connection("udpout://127.0.0.1:14561");
+    auto connection_result = mavsdk_autopilot.add_any_connection("raw://");
     REQUIRE(connection_result == mavsdk::ConnectionResult::Success);
 
     auto server = mavsdk_autopilot.server_component();
     REQUIRE(server != nullptr);
 
     /// Setup GCS side to verify mode changes
-    mavsdk::Mavsdk mavsdk_gcs{mavsdk::Mavsdk::Configuration{mavsdk::ComponentType::GroundStation}};
-    auto gcs_result = mavsdk_gcs.add_any_connection("udpin://127.0.0.1:14561");
-    REQUIRE(gcs_result == mavsdk::ConnectionResult::Success);
-
-    /// Wait for GCS to discover the system
-    std::atomic<bool> system_discovered{false};
-    std::shared_ptr<mavsdk::System> discovered_system = nullptr;
-    mavsdk_gcs.subscribe_on_new_system([&]() {
-        auto systems = mavsdk_gcs.systems();
-        if (!systems.empty()) {
-            discovered_system = systems[0];
-            system_discovered = true;
-        }
-    });
-
-    /// Wait for system discovery
-    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
-    while (!system_discovered && std::chrono::steady_clock::now() < deadline) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    }
-    REQUIRE(system_discovered);
+    GcsStandIn gcs{mavsdk_autopilot};
+    REQUIRE(gcs.connect());
+    std::shared_ptr<mavsdk::System> discovered_system = gcs.system();
     REQUIRE(discovered_system != nullptr);
 
     /// Initialize components
@@ -161,27 +139,24 @@ TEST_CASE("ModeManager invalid state transitions", "[mode_manager]") {
     REQUIRE(mode == mavsdk::ActionServer::FlightMode::Ready);
     bool result = mode_manager.change_mode(mavsdk::ActionServer::FlightMode::Land);
     REQUIRE(!result);
-    std::this_thread::sleep_for(std::chrono::milliseconds(200));
     mode = mode_manager.get_current_mode();
     REQUIRE(mode == mavsdk::ActionServer::FlightMode::Ready); /// Mode should not change
 
     /// Ready to Hold
     result = mode_manager.change_mode(mavsdk::ActionServer::FlightMode::Hold);
     REQUIRE(!result);
-    std::this_thread::sleep_for(std::chrono::milliseconds(200));
     mode = mode_manager.get_current_mode();
     REQUIRE(mode == mavsdk::ActionServer::FlightMode::Ready);
 
     /// Ready to Mission
     result = mode_manager.change_mode(mavsdk::ActionServer::FlightMode::Mission);
     REQUIRE(!result);
-    std::this_thread::sleep_for(std::chrono::milliseconds(200));
     mode = mode_manager.get_current_mode();
     REQUIRE(mode == mavsdk::ActionServer::FlightMode::Ready);
 
+    publish_sensors(morb, true);
     result = mode_manager.change_mode(mavsdk::ActionServer::FlightMode::Takeoff);
     REQUIRE(result);
-    std::this_thread::sleep_for(std::chrono::milliseconds(200));
 
     /// Takeoff to Ready
     result = mode_manager.change_mode(mavsdk::ActionServer::FlightMode::Ready);
@@ -206,36 +181,18 @@ TEST_CASE("ModeManager invalid state transitions", "[mode_manager]") {
 }
 
 TEST_CASE("ModeManager activate_takeoff method", "[mode_manager]") {
-    /// Setup MAVSDK autopilot side
+    /// Setup MAVSDK autopilot side, linked in process to the GCS
     mavsdk::Mavsdk mavsdk_autopilot{mavsdk::Mavsdk::Configuration{mavsdk::ComponentType::Autopilot}};
-    auto connection_result = mavsdk_autopilot.add_any_connection("udpout://127.0.0.1:14562");
+    auto connection_result = mavsdk_autopilot.add_any_connection("raw://");
     REQUIRE(connection_result == mavsdk::ConnectionResult::Success);
 
     auto server = mavsdk_autopilot.server_component();
     REQUIRE(server != nullptr);
 
     /// Setup GCS side to verify mode changes
-    mavsdk::Mavsdk mavsdk_gcs{mavsdk::Mavsdk::Configuration{mavsdk::ComponentType::GroundStation}};
-    auto gcs_result = mavsdk_gcs.add_any_connection("udpin://127.0.0.1:14562");
-    REQUIRE(gcs_result == mavsdk::ConnectionResult::Success);
-
-    /// Wait for GCS to discover the system
-    std::atomic<bool> system_discovered{false};
-    std::shared_ptr<mavsdk::System> discovered_system = nullptr;
-    mavsdk_gcs.subscribe_on_new_system([&]() {
-        auto systems = mavsdk_gcs.systems();
-        if (!systems.empty()) {
-            discovered_system = systems[0];
-            system_discovered = true;
-        }
-    });
-
-    /// Wait for system discovery
-    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
-    while (!system_discovered && std::chrono::steady_clock::now() < deadline) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    }
-    REQUIRE(system_discovered);
+    GcsStandIn gcs{mavsdk_autopilot};
+    REQUIRE(gcs.connect());
+    std::shared_ptr<mavsdk::System> discovered_system = gcs.system();
     REQUIRE(discovered_system != nullptr);
 
     /// Initialize components
@@ -253,8 +210,8 @@ TEST_CASE("ModeManager activate_takeoff method", "[mode_manager]") {
     REQUIRE(mode == mavsdk::ActionServer::FlightMode::Ready);
 
     /// Test activate_takeoff
+    publish_sensors(morb, true);
     mode_manager.activate_takeoff();
-    std::this_thread::sleep_for(std::chrono::milliseconds(200));
     mode = mode_manager.get_current_mode();
     REQUIRE(mode == mavsdk::ActionServer::FlightMode::Takeoff);
 
@@ -263,36 +220,18 @@ TEST_CASE("ModeManager activate_takeoff method", "[mode_manager]") {
 }
 
 TEST_CASE("ModeManager activate_land method", "[mode_manager]") {
-    /// Setup MAVSDK autopilot side
+    /// Setup MAVSDK autopilot side, linked in process to the GCS
     mavsdk::Mavsdk mavsdk_autopilot{mavsdk::Mavsdk::Configuration{mavsdk::ComponentType::Autopilot}};
-    auto connection_result = mavsdk_autopilot.add_any_connection("udpout://127.0.0.1:14563");
+    auto connection_result = mavsdk_autopilot.add_any_connection("raw://");
     REQUIRE(connection_result == mavsdk::ConnectionResult::Success);
 
     auto server = mavsdk_autopilot.server_component();
     REQUIRE(server != nullptr);
 
     /// Setup GCS side to verify mode changes
-    mavsdk::Mavsdk mavsdk_gcs{mavsdk::Mavsdk::Configuration{mavsdk::ComponentType::GroundStation}};
-    auto gcs_result = mavsdk_gcs.add_any_connection("udpin://127.0.0.1:14563");
-    REQUIRE(gcs_result == mavsdk::ConnectionResult::Success);
-
-    /// Wait for GCS to discover the system
-    std::atomic<bool> system_discovered{false};
-    std::shared_ptr<mavsdk::System> discovered_system = nullptr;
-    mavsdk_gcs.subscribe_on_new_system([&]() {
-        auto systems = mavsdk_gcs.systems();
-        if (!systems.empty()) {
-            discovered_system = systems[0];
-            system_discovered = true;
-        }
-    });
-
-    /// Wait for system discovery
-    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
-    while (!system_discovered && std::chrono::steady_clock::now() < deadline) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    }
-    REQUIRE(system_discovered);
+    GcsStandIn gcs{mavsdk_autopilot};
+    REQUIRE(gcs.connect());
+    std::shared_ptr<mavsdk::System> discovered_system = gcs.system();
     REQUIRE(discovered_system != nullptr);
 
     /// Initialize components
@@ -306,10 +245,9 @@ TEST_CASE("ModeManager activate_land method", "[mode_manager]") {
     mode_manager.start();
 
     /// Get to Hold mode first (via Takeoff)
+    publish_sensors(morb, true);
     mode_manager.activate_takeoff();
-    std::this_thread::sleep_for(std::chrono::milliseconds(200));
     mode_manager.change_mode(mavsdk::ActionServer::FlightMode::Hold);
-    std::this_thread::sleep_for(std::chrono::milliseconds(200));
 
     /// Verify we're in Hold mode
     auto mode = mode_manager.get_current_mode();
@@ -317,10 +255,128 @@ TEST_CASE("ModeManager activate_land method", "[mode_manager]") {
 
     /// Test activate_land
     mode_manager.activate_land();
-    std::this_thread::sleep_for(std::chrono::milliseconds(200));
     mode = mode_manager.get_current_mode();
     REQUIRE(mode == mavsdk::ActionServer::FlightMode::Land);
 
     /// Clean up
     mode_manager.stop();
-}
\ No newline at end of file
+}
+
+TEST_CASE("ModeManager disarms in flight only once landed", "[mode_manager]") {
+    /// Setup MAVSDK autopilot side, linked in process to the GCS
+    mavsdk::Mavsdk mavsdk_autopilot{mavsdk::Mavsdk::Configuration{mavsdk::ComponentType::Autopilot}};
+    auto connection_result = mavsdk_autopilot.add_any_connection("raw://");
+    REQUIRE(connection_result == mavsdk::ConnectionResult::Success);
+
+    auto server = mavsdk_autopilot.server_component();
+    REQUIRE(server != nullptr);
+
+    GcsStandIn gcs{mavsdk_autopilot};
+    REQUIRE(gcs.connect());
+    std::shared_ptr<mavsdk::System> discovered_system = gcs.system();
+    REQUIRE(discovered_system != nullptr);
+
+    Morb morb;
+    mavsdk::ActionServer action{server};
+    Vehicle vehicle(server, discovered_system, &morb);
+    ModeManager mode_manager(vehicle, action, &morb);
+    mode_manager.initialize_modes();
+    mode_manager.start();
+
+    /// Ready always disarms
+    REQUIRE(mode_manager.disarm());
+
+    /// No land detector report, assume we are flying
+    publish_sensors(morb, true);
+    REQUIRE(mode_manager.activate_takeoff());
+    REQUIRE(!mode_manager.disarm());
+
+    /// Airborne
+    publish_landed(morb, false);
+    REQUIRE(!mode_manager.disarm());
+
+    publish_landed(morb, true);
+    REQUIRE(mode_manager.disarm());
+
+    /// Clean up
+    mode_manager.stop();
+}
+
+TEST_CASE("ModeManager takes off only with fresh healthy sensors", "[mode_manager]") {
+    /// Setup MAVSDK autopilot side, linked in process to the GCS
+    mavsdk::Mavsdk mavsdk_autopilot{mavsdk::Mavsdk::Configuration{mavsdk::ComponentType::Autopilot}};
+    auto connection_result = mavsdk_autopilot.add_any_connection("raw://");
+    REQUIRE(connection_result == mavsdk::ConnectionResult::Success);
+
+    auto server = mavsdk_autopilot.server_component();
+    REQUIRE(server != nullptr);
+
+    GcsStandIn gcs{mavsdk_autopilot};
+    REQUIRE(gcs.connect());
+    std::shared_ptr<mavsdk::System> discovered_system = gcs.system();
+    REQUIRE(discovered_system != nullptr);
+
+    Morb morb;
+    mavsdk::ActionServer action{server};
+    Vehicle vehicle(server, discovered_system, &morb);
+    ModeManager mode_manager(vehicle, action, &morb);
+    mode_manager.initialize_modes();
+    mode_manager.start();
+
+    /// No sensor report, we can't tell
+    REQUIRE(!mode_manager.change_mode(mavsdk::ActionServer::FlightMode::Takeoff));
+
+    publish_sensors(morb, false);
+    REQUIRE(!mode_manager.change_mode(mavsdk::ActionServer::FlightMode::Takeoff));
+
+    /// Healthy, but from a second ago
+    SensorHealth health{};
+    health.timestamp = SensorMonitor::wall_time_us() - 1000000;
+    morb.publish<SensorHealth>("sensor_health", health);
+    REQUIRE(!mode_manager.change_mode(mavsdk::ActionServer::FlightMode::Takeoff));
+    REQUIRE(mode_manager.get_current_mode() == mavsdk::ActionServer::FlightMode::Ready);
+
+    publish_sensors(morb, true);
+    REQUIRE(mode_manager.change_mode(mavsdk::ActionServer::FlightMode::Takeoff));
+    REQUIRE(mode_manager.get_current_mode() == mavsdk::ActionServer::FlightMode::Takeoff);
+
+    /// Clean up
+    mode_manager.stop();
+}
+
+TEST_CASE("ModeManager frees replaced missions off the control thread", "[mode_manager]") {
+    /// Setup MAVSDK autopilot side, linked in process to the GCS
+    mavsdk::Mavsdk mavsdk_autopilot{mavsdk::Mavsdk::Configuration{mavsdk::ComponentType::Autopilot}};
+    auto connection_result = mavsdk_autopilot.add_any_connection("raw://");
+    REQUIRE(connection_result == mavsdk::ConnectionResult::Success);
+
+    auto server = mavsdk_autopilot.server_component();
+    REQUIRE(server != nullptr);
+
+    GcsStandIn gcs{mavsdk_autopilot};
+    REQUIRE(gcs.connect());
+    std::shared_ptr<mavsdk::System> discovered_system = gcs.system();
+    REQUIRE(discovered_system != nullptr);
+
+    Morb morb;
+    mavsdk::ActionServer action{server};
+    Vehicle vehicle(server, discovered_system, &morb);
+    ModeManager mode_manager(vehicle, action, &morb);
+    mode_manager.initialize_modes();
+
+    mavsdk::MissionRawServer::MissionItem item{};
+    item.frame = 6; // MAV_FRAME_GLOBAL_RELATIVE_ALT_INT
+    item.command = 16; // MAV_CMD_NAV_WAYPOINT
+    item.x = 473977000;
+    item.y = 85456000;
+    item.z = 10.f;
+    std::shared_ptr<const MissionPlan> plan = MissionPlan::parse({item}, 47.3977, 8.5456, 488.0);
+    const std::weak_ptr<const MissionPlan> first = plan;
+    mode_manager.load_mission(std::move(plan));
+
+    /// Replaced, but kept until the vehicle thread lets it go
+    mode_manager.load_mission(nullptr);
+    REQUIRE(!first.expired());
+    mode_manager.release_retired();
+    REQUIRE(first.expired());
+}
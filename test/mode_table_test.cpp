@@ -0,0 +1,82 @@
+/**
+ * @file mode_table_test.cpp
+ * @author Abdulelah Mulla
+ * @brief Unit tests for the flight mode transition table
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "mode/mode_table.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+using FlightMode = mavsdk::ActionServer::FlightMode;
+
+/// Checked at compile time, a broken table does not build
+static_assert(find_transition(ModeId::READY, ModeEvent::REQUEST_TAKEOFF)->to == ModeId::TAKEOFF, "");
+static_assert(find_transition(ModeId::READY, ModeEvent::REQUEST_LAND) == nullptr, "");
+
+static ModeId request(ModeId from, FlightMode mode) {
+    ModeId to;
+    REQUIRE(mode_from_flight_mode(mode, to));
+    const ModeTransition *transition = find_transition(from, MODE_INFO[static_cast<int>(to)].request);
+    return transition ? transition->to : from;
+}
+
+TEST_CASE("Requests follow the state machine", "[mode_table]") {
+    REQUIRE(request(ModeId::READY, FlightMode::Takeoff) == ModeId::TAKEOFF);
+    REQUIRE(request(ModeId::TAKEOFF, FlightMode::Hold) == ModeId::HOLD);
+    REQUIRE(request(ModeId::HOLD, FlightMode::Mission) == ModeId::MISSION);
+    REQUIRE(request(ModeId::MISSION, FlightMode::Hold) == ModeId::HOLD);
+    REQUIRE(request(ModeId::HOLD, FlightMode::Land) == ModeId::LAND);
+    REQUIRE(request(ModeId::LAND, FlightMode::Ready) == ModeId::READY);
+
+    /// Refused, the mode stays
+    REQUIRE(request(ModeId::READY, FlightMode::Land) == ModeId::READY);
+    REQUIRE(request(ModeId::READY, FlightMode::Mission) == ModeId::READY);
+    REQUIRE(request(ModeId::TAKEOFF, FlightMode::Land) == ModeId::TAKEOFF);
+    REQUIRE(request(ModeId::TAKEOFF, FlightMode::Ready) == ModeId::TAKEOFF);
+}
+
+TEST_CASE("Completed modes move on", "[mode_table]") {
+    REQUIRE(find_transition(ModeId::TAKEOFF, ModeEvent::MODE_COMPLETE)->to == ModeId::HOLD);
+    REQUIRE(find_transition(ModeId::MISSION, ModeEvent::MODE_COMPLETE)->to == ModeId::HOLD);
+    REQUIRE(find_transition(ModeId::LAND, ModeEvent::MODE_COMPLETE)->to == ModeId::READY);
+    REQUIRE(find_transition(ModeId::HOLD, ModeEvent::MODE_COMPLETE) == nullptr);
+}
+
+TEST_CASE("Takeoff is guarded by the health checks", "[mode_table]") {
+    REQUIRE(find_transition(ModeId::READY, ModeEvent::REQUEST_TAKEOFF)->guard == ModeGuard::HEALTHY);
+    REQUIRE(MODE_INFO[static_cast<int>(ModeId::READY)].on_entry == ModeAction::DISARM);
+}
+
+TEST_CASE("Disarming from Land waits for the land detector", "[mode_table]") {
+    REQUIRE(find_transition(ModeId::LAND, ModeEvent::REQUEST_READY)->guard == ModeGuard::LANDED);
+    /// Landing completes only once landed
+    REQUIRE(find_transition(ModeId::LAND, ModeEvent::MODE_COMPLETE)->guard == ModeGuard::NONE);
+}
+
+TEST_CASE("Geofence failsafe stops, then lands", "[mode_table]") {
+    REQUIRE(find_transition(ModeId::MISSION, ModeEvent::FENCE_PREDICTED)->to == ModeId::HOLD);
+    REQUIRE(find_transition(ModeId::MISSION, ModeEvent::FENCE_BREACHED)->to == ModeId::LAND);
+    REQUIRE(find_transition(ModeId::HOLD, ModeEvent::FENCE_BREACHED)->to == ModeId::LAND);
+    /// Holding already, nothing more to do until outside
+    REQUIRE(find_transition(ModeId::HOLD, ModeEvent::FENCE_PREDICTED) == nullptr);
+    /// On the ground or landing, the fence does not matter
+    REQUIRE(find_transition(ModeId::READY, ModeEvent::FENCE_BREACHED) == nullptr);
+    REQUIRE(find_transition(ModeId::LAND, ModeEvent::FENCE_BREACHED) == nullptr);
+}
+
+TEST_CASE("Unknown flight modes are not mapped", "[mode_table]") {
+    ModeId mode = ModeId::HOLD;
+    REQUIRE_FALSE(mode_from_flight_mode(FlightMode::Unknown, mode));
+    REQUIRE(mode == ModeId::HOLD);
+}
+
+TEST_CASE("Health failsafe lands from every flying mode", "[mode_table]") {
+    for (ModeId mode : {ModeId::TAKEOFF, ModeId::HOLD, ModeId::MISSION}) {
+        REQUIRE(find_transition(mode, ModeEvent::FAILSAFE)->to == ModeId::LAND);
+    }
+    REQUIRE(find_transition(ModeId::READY, ModeEvent::FAILSAFE) == nullptr);
+    REQUIRE(find_transition(ModeId::LAND, ModeEvent::FAILSAFE) == nullptr);
+}
@@ -0,0 +1,83 @@
+/**
+ * @file mpsc_queue_test.cpp
+ * @author Abdulelah Mulla
+ * @brief Unit tests for the lock-free command queue
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "mpsc_queue.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("The queue is first in first out and bounded", "[mpsc_queue]") {
+    MpscQueue<int, 4> queue;
+    int value = 0;
+    REQUIRE_FALSE(queue.pop(value));
+
+    for (int i = 0; i < 4; i++) {
+        REQUIRE(queue.push(i));
+    }
+    REQUIRE_FALSE(queue.push(4));
+
+    /// Wraps around
+    for (int round = 0; round < 10; round++) {
+        REQUIRE(queue.pop(value));
+        REQUIRE(value == round);
+        REQUIRE(queue.push(round + 4));
+    }
+    for (int i = 10; i < 14; i++) {
+        REQUIRE(queue.pop(value));
+        REQUIRE(value == i);
+    }
+    REQUIRE_FALSE(queue.pop(value));
+}
+
+TEST_CASE("Every value from every producer arrives once, in order per producer", "[mpsc_queue]") {
+    struct Item {
+        int producer;
+        int index;
+    };
+    constexpr int PRODUCERS = 4;
+    constexpr int ITEMS = 20000;
+    MpscQueue<Item, 64> queue;
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; p++) {
+        producers.emplace_back([&queue, p] {
+            for (int i = 0; i < ITEMS; i++) {
+                while (!queue.push({p, i})) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<int> next(PRODUCERS, 0);
+    int received = 0;
+    bool ordered = true;
+    while (received < PRODUCERS * ITEMS) {
+        Item item;
+        if (!queue.pop(item)) {
+            std::this_thread::yield();
+            continue;
+        }
+        ordered = ordered && item.index == next[item.producer];
+        next[item.producer] = item.index + 1;
+        received++;
+    }
+    for (std::thread &producer : producers) {
+        producer.join();
+    }
+
+    REQUIRE(ordered);
+    for (int p = 0; p < PRODUCERS; p++) {
+        REQUIRE(next[p] == ITEMS);
+    }
+    Item item;
+    REQUIRE_FALSE(queue.pop(item));
+}
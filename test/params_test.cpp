@@ -0,0 +1,91 @@
+/**
+ * @file params_test.cpp
+ * @author Abdulelah Mulla
+ * @brief Unit tests for the parameter store
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include <fstream>
+#include <string>
+
+#include "params.h"
+#include "temp_directory.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("Params start at their defaults", "[params]") {
+    Params &params = Params::initialize();
+    params.reset();
+    REQUIRE(params.get(param::MIS_TAKEOFF_ALT) == 10.f);
+    REQUIRE(params.get(param::MITL_CTRL_HZ) == 50);
+    REQUIRE(params.get(param::MY_PARAM) == 1);
+
+    ParamId id;
+    REQUIRE(Params::find("MITL_CTRL_HZ", id));
+    REQUIRE(id == ParamId::MITL_CTRL_HZ);
+    REQUIRE_FALSE(Params::find("MITL_CTRL", id));
+}
+
+TEST_CASE("Params are range checked", "[params]") {
+    Params &params = Params::initialize();
+    params.reset();
+
+    REQUIRE(params.set(param::MIS_TAKEOFF_ALT, 25.5f));
+    REQUIRE(params.get(param::MIS_TAKEOFF_ALT) == 25.5f);
+    REQUIRE_FALSE(params.set(param::MIS_TAKEOFF_ALT, 500.f));
+    REQUIRE(params.get(param::MIS_TAKEOFF_ALT) == 25.5f);
+
+    /// Int params set from the GCS as floats are rounded
+    REQUIRE(params.set(ParamId::MITL_CTRL_HZ, 99.6f));
+    REQUIRE(params.get(param::MITL_CTRL_HZ) == 100);
+    REQUIRE(params.value(ParamId::MITL_CTRL_HZ) == 100.f);
+    REQUIRE_FALSE(params.set(param::MITL_CTRL_HZ, 0));
+    params.reset();
+}
+
+TEST_CASE("Params persist across opens", "[params]") {
+    const TempDirectory temp("params");
+    const std::string param_file = temp.path() + "/params";
+    Params &params = Params::initialize();
+    params.reset();
+
+    REQUIRE(params.open(param_file));
+    REQUIRE(params.set(param::MIS_TAKEOFF_ALT, 5.f));
+    REQUIRE(params.set(param::MITL_CTRL_HZ, 200));
+    params.close();
+
+    /// Writes after close are not saved
+    params.set(param::MY_PARAM, 7);
+    params.reset();
+    REQUIRE(params.get(param::MIS_TAKEOFF_ALT) == 10.f);
+
+    REQUIRE(params.open(param_file));
+    REQUIRE(params.get(param::MIS_TAKEOFF_ALT) == 5.f);
+    REQUIRE(params.get(param::MITL_CTRL_HZ) == 200);
+    REQUIRE(params.get(param::MY_PARAM) == 1);
+    params.close();
+    params.reset();
+}
+
+TEST_CASE("A foreign param file is ignored", "[params]") {
+    const TempDirectory temp("params");
+    const std::string param_file = temp.path() + "/params";
+    {
+        std::ofstream file(param_file, std::ios::binary);
+        file << "not a param file at all, just some text";
+    }
+    Params &params = Params::initialize();
+    params.reset();
+    REQUIRE(params.open(param_file));
+    REQUIRE(params.get(param::MIS_TAKEOFF_ALT) == 10.f);
+
+    /// And rewritten as ours
+    REQUIRE(params.set(param::MIS_TAKEOFF_ALT, 20.f));
+    params.close();
+    params.reset();
+    REQUIRE(params.open(param_file));
+    REQUIRE(params.get(param::MIS_TAKEOFF_ALT) == 20.f);
+    params.close();
+    params.reset();
+}
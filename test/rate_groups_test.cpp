@@ -0,0 +1,148 @@
+/**
+ * @file rate_groups_test.cpp
+ * @author Abdulelah Mulla
+ * @brief Unit tests for the rate group scheduling
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include <thread>
+#include <vector>
+
+#include "rate_groups.h"
+#include "params.h"
+#include "vehicle_state.h"
+#include "morb.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+/// 1 kHz IMU, the groups are a singleton so time keeps going across tests
+static constexpr uint64_t IMU_PERIOD = 1000;
+static uint64_t imu_time = 1;
+
+static void tick() {
+    imu_time += IMU_PERIOD;
+    RateGroups::initialize().tick(imu_time);
+}
+
+/// Take a trigger without blocking and run an empty cycle
+static bool run_if_triggered(RateGroup group) {
+    RateGroups &groups = RateGroups::initialize();
+    if (!groups.wait(group, std::chrono::microseconds(0))) {
+        return false;
+    }
+    groups.end(group, groups.begin(group));
+    return true;
+}
+
+TEST_CASE("Slower groups run on integer sub-multiples of the IMU", "[rate_groups]") {
+    RateGroups &groups = RateGroups::initialize();
+    Params::initialize().reset();
+    tick();
+
+    int attitude = 0, position = 0;
+    for (int i = 0; i < 200; i++) {
+        tick();
+        attitude += run_if_triggered(RateGroup::ATTITUDE);
+        position += run_if_triggered(RateGroup::POSITION);
+    }
+    REQUIRE(groups.ticking());
+    REQUIRE(groups.stats(RateGroup::ATTITUDE).divider == 4);
+    REQUIRE(groups.stats(RateGroup::POSITION).divider == 20);
+    REQUIRE(attitude == 50);
+    REQUIRE(position == 10);
+
+    /// Rates follow the params
+    REQUIRE(Params::initialize().set(param::MITL_ATT_HZ, 500));
+    attitude = 0;
+    for (int i = 0; i < 200; i++) {
+        tick();
+        attitude += run_if_triggered(RateGroup::ATTITUDE);
+        run_if_triggered(RateGroup::POSITION);
+    }
+    REQUIRE(groups.stats(RateGroup::ATTITUDE).divider == 2);
+    REQUIRE((attitude == 100 || attitude == 99));
+    Params::initialize().reset();
+}
+
+TEST_CASE("A busy group drops its triggers", "[rate_groups]") {
+    RateGroups &groups = RateGroups::initialize();
+    Params::initialize().reset();
+    for (int i = 0; i < 8; i++) {
+        tick();
+        run_if_triggered(RateGroup::ATTITUDE);
+        run_if_triggered(RateGroup::POSITION);
+    }
+
+    const uint64_t overruns = groups.stats(RateGroup::ATTITUDE).overruns;
+    const uint64_t start = groups.begin(RateGroup::ATTITUDE);
+    for (int i = 0; i < 8; i++) {
+        tick();
+        run_if_triggered(RateGroup::POSITION);
+    }
+    REQUIRE(groups.stats(RateGroup::ATTITUDE).overruns == overruns + 2);
+    groups.end(RateGroup::ATTITUDE, start);
+
+    /// Nothing queued up while busy
+    REQUIRE_FALSE(run_if_triggered(RateGroup::ATTITUDE));
+    int attitude = 0;
+    for (int i = 0; i < 8; i++) {
+        tick();
+        attitude += run_if_triggered(RateGroup::ATTITUDE);
+        run_if_triggered(RateGroup::POSITION);
+    }
+    REQUIRE(attitude == 2);
+    REQUIRE(groups.stats(RateGroup::ATTITUDE).overruns == overruns + 2);
+}
+
+TEST_CASE("A group thread wakes on its trigger", "[rate_groups]") {
+    RateGroups &groups = RateGroups::initialize();
+    Params::initialize().reset();
+
+    const uint64_t cycles = groups.stats(RateGroup::POSITION).cycles;
+    std::atomic<int> woken{0};
+    std::thread position([&] {
+        for (int i = 0; i < 3; i++) {
+            if (groups.wait(RateGroup::POSITION, std::chrono::seconds(1))) {
+                groups.end(RateGroup::POSITION, groups.begin(RateGroup::POSITION));
+                woken++;
+            }
+        }
+    });
+    /// Tick until each wake is seen rather than pacing on the wall clock
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (woken.load() < 3 && std::chrono::steady_clock::now() < deadline) {
+        tick();
+        run_if_triggered(RateGroup::ATTITUDE);
+        std::this_thread::yield();
+    }
+    position.join();
+    REQUIRE(woken == 3);
+    REQUIRE(groups.stats(RateGroup::POSITION).cycles == cycles + 3);
+}
+
+TEST_CASE("Stats are published once a second", "[rate_groups]") {
+    Morb morb;
+    std::vector<RateGroupReport> reports;
+    morb.subscribe<RateGroupReport>("rate_group_stats", [&](const RateGroupReport &report) {
+        reports.push_back(report);
+    });
+    RateGroups::initialize().attach(&morb);
+    Params::initialize().reset();
+
+    for (int i = 0; i < 2000; i++) {
+        VehicleState state{};
+        imu_time += IMU_PERIOD;
+        state.timestamp = imu_time;
+        morb.publish<VehicleState>("vehicle_state", state);
+        run_if_triggered(RateGroup::ATTITUDE);
+        run_if_triggered(RateGroup::POSITION);
+    }
+    RateGroups::initialize().detach();
+
+    REQUIRE(reports.size() >= 1);
+    REQUIRE(reports.size() <= 3);
+    REQUIRE(reports.back().imu_rate_hz > 990.f);
+    REQUIRE(reports.back().imu_rate_hz < 1010.f);
+    REQUIRE(reports.back().groups[static_cast<int>(RateGroup::POSITION)].divider == 20);
+}
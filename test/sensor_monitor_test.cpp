@@ -0,0 +1,92 @@
+/**
+ * @file sensor_monitor_test.cpp
+ * @author Abdulelah Mulla
+ * @brief Unit tests for the sensor monitor
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "gazebo/sensor_monitor.h"
+#include "morb.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+/// Records every topic once
+static void record_all(SensorMonitor &monitor, uint64_t sim_us, uint64_t wall_us) {
+    for (int i = 0; i < SENSOR_TOPIC_COUNT; i++) {
+        monitor.record(static_cast<SensorTopic>(i), sim_us, wall_us);
+    }
+}
+
+TEST_CASE("Topics that never arrived are stale", "[sensor_monitor]") {
+    Morb morb;
+    SensorMonitor monitor(&morb);
+
+    SensorHealth health;
+    monitor.evaluate(SensorMonitor::wall_time_us(), health);
+
+    REQUIRE(health.required_mask != 0);
+    REQUIRE(health.stale_mask == (1u << SENSOR_TOPIC_COUNT) - 1);
+    REQUIRE(!health.healthy());
+}
+
+TEST_CASE("Fresh topics are healthy and go stale", "[sensor_monitor]") {
+    Morb morb;
+    SensorMonitor monitor(&morb);
+
+    const uint64_t start = SensorMonitor::wall_time_us();
+    record_all(monitor, 0, start);
+    record_all(monitor, 2000, start + 2000);
+
+    SensorHealth health;
+    monitor.evaluate(start + 2000, health);
+    REQUIRE(health.stale_mask == 0);
+    REQUIRE(health.healthy());
+
+    const int imu = static_cast<int>(SensorTopic::IMU);
+    REQUIRE(health.topics[imu].count == 2);
+    REQUIRE(health.topics[imu].rate_hz > 0.f);
+
+    /// The imu runs at 250hz, a second without it is stale
+    monitor.evaluate(start + 1002000, health);
+    REQUIRE((health.stale_mask & (1u << imu)) != 0);
+    REQUIRE(!health.healthy());
+}
+
+TEST_CASE("Gaps are counted", "[sensor_monitor]") {
+    Morb morb;
+    SensorMonitor monitor(&morb);
+
+    /// 3 nominal periods of the imu is 12ms, 20ms go by
+    const uint64_t start = SensorMonitor::wall_time_us();
+    monitor.record(SensorTopic::IMU, 0, start);
+    monitor.record(SensorTopic::IMU, 4000, start + 20000);
+
+    SensorHealth health;
+    monitor.evaluate(start + 20000, health);
+    const TopicHealth &imu = health.topics[static_cast<int>(SensorTopic::IMU)];
+    REQUIRE(imu.gaps == 1);
+    REQUIRE(imu.max_gap_us >= 20000);
+    /// More wall time than sim time went by
+    REQUIRE(imu.skew_us > 0.f);
+}
+
+TEST_CASE("Reports are published from the clock", "[sensor_monitor]") {
+    Morb morb;
+    SensorMonitor monitor(&morb);
+
+    int reports = 0;
+    SensorHealth last{};
+    morb.subscribe<SensorHealth>("sensor_health", [&](const SensorHealth &health) {
+        reports++;
+        last = health;
+    });
+
+    monitor.record(SensorTopic::CLOCK, 1000);
+    REQUIRE(reports == 1);
+    REQUIRE(last.timestamp != 0);
+
+    /// Rate limited
+    monitor.record(SensorTopic::CLOCK, 2000);
+    REQUIRE(reports == 1);
+}
@@ -0,0 +1,92 @@
+/**
+ * @file telemetry_streams_test.cpp
+ * @author Abdulelah Mulla
+ * @brief Unit tests for the telemetry stream scheduler
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "telemetry/telemetry_streams.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+static uint32_t bit(TelemetryStream stream) {
+    return 1u << static_cast<int>(stream);
+}
+
+TEST_CASE("Every stream is due on the first call", "[telemetry]") {
+    TelemetryStreams streams;
+    uint64_t next_us = 0;
+    const uint32_t mask = streams.due(0, next_us);
+    REQUIRE(mask == (1u << TELEMETRY_STREAM_COUNT) - 1);
+    /// Attitude runs at 50 Hz by default
+    REQUIRE(next_us == 20000);
+}
+
+TEST_CASE("Streams run at their own rates", "[telemetry]") {
+    TelemetryStreams streams;
+    uint64_t next_us = 0;
+    int attitude = 0, sys_status = 0, gps = 0;
+
+    /// One second, stepping to each deadline
+    uint64_t now = 0;
+    while (now < 1000000) {
+        const uint32_t mask = streams.due(now, next_us);
+        attitude += (mask & bit(TelemetryStream::ATTITUDE)) != 0;
+        sys_status += (mask & bit(TelemetryStream::SYS_STATUS)) != 0;
+        gps += (mask & bit(TelemetryStream::RAW_GPS)) != 0;
+        REQUIRE(next_us > now);
+        now = next_us;
+    }
+    REQUIRE(attitude == 50);
+    REQUIRE(gps == 5);
+    REQUIRE(sys_status == 1);
+}
+
+TEST_CASE("SET_MESSAGE_INTERVAL semantics", "[telemetry]") {
+    TelemetryStreams streams;
+    TelemetryStream stream;
+
+    REQUIRE(TelemetryStreams::find(33u, stream));
+    REQUIRE(stream == TelemetryStream::POSITION);
+    REQUIRE_FALSE(TelemetryStreams::find(9999u, stream));
+
+    streams.set_interval(TelemetryStream::POSITION, 100000);
+    REQUIRE(streams.interval(TelemetryStream::POSITION) == 100000);
+
+    /// Clamped to the fastest rate we support
+    streams.set_interval(TelemetryStream::POSITION, 10);
+    REQUIRE(streams.interval(TelemetryStream::POSITION) == TelemetryStreams::MIN_INTERVAL_US);
+
+    /// -1 disables, 0 is the default
+    streams.set_interval(TelemetryStream::POSITION, -1);
+    uint64_t next_us = 0;
+    REQUIRE((streams.due(0, next_us) & bit(TelemetryStream::POSITION)) == 0);
+    streams.set_interval(TelemetryStream::POSITION, 0);
+    REQUIRE(streams.interval(TelemetryStream::POSITION) == 20000);
+}
+
+TEST_CASE("A faster rate applies without waiting out the old interval", "[telemetry]") {
+    TelemetryStreams streams;
+    uint64_t next_us = 0;
+    streams.due(0, next_us);
+
+    /// Home is at 1 Hz, speed it up to 10 Hz
+    TelemetryStream stream;
+    REQUIRE(TelemetryStreams::find(ParamId::TEL_HOME_HZ, stream));
+    streams.set_rate(stream, 10.f);
+    REQUIRE((streams.due(1000, next_us) & bit(TelemetryStream::HOME)) != 0);
+    REQUIRE((streams.due(50000, next_us) & bit(TelemetryStream::HOME)) == 0);
+    REQUIRE((streams.due(101000, next_us) & bit(TelemetryStream::HOME)) != 0);
+}
+
+TEST_CASE("Missed sends are dropped, not bunched", "[telemetry]") {
+    TelemetryStreams streams;
+    uint64_t next_us = 0;
+    streams.due(0, next_us);
+
+    /// The thread stalled for half a second
+    REQUIRE((streams.due(500000, next_us) & bit(TelemetryStream::ATTITUDE)) != 0);
+    REQUIRE((streams.due(500001, next_us) & bit(TelemetryStream::ATTITUDE)) == 0);
+    REQUIRE(next_us == 520000);
+}
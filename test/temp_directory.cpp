@@ -0,0 +1,30 @@
+/**
+ * @file temp_directory.cpp
+ * @author Abdulelah Mulla
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+
+#include <ftw.h>
+
+#include "temp_directory.h"
+
+TempDirectory::TempDirectory(const std::string &name) {
+    std::string pattern = "/tmp/mitl_" + name + "_XXXXXX";
+    std::vector<char> path(pattern.begin(), pattern.end());
+    path.push_back('\0');
+    if (!mkdtemp(path.data())) {
+        throw std::runtime_error("Cannot create " + pattern);
+    }
+    _path = path.data();
+}
+
+TempDirectory::~TempDirectory() {
+    /// Children first, links are removed, not followed
+    nftw(_path.c_str(), [](const char *path, const struct stat*, int, struct FTW*) {
+        return std::remove(path);
+    }, 16, FTW_DEPTH | FTW_PHYS);
+}
@@ -0,0 +1,34 @@
+/**
+ * @file temp_directory.h
+ * @author Abdulelah Mulla
+ * @brief Scratch directory for the tests that write files
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <string>
+
+/**
+ * @brief A fresh directory under /tmp, removed with everything in it
+ * when it goes out of scope.
+ */
+class TempDirectory {
+private:
+    std::string _path;
+public:
+    /**
+     * Constructor
+     *
+     * @param name part of the directory name, to tell the tests apart
+     */
+    explicit TempDirectory(const std::string &name);
+    ~TempDirectory();
+
+    /// Delete copy constructor and assignment operator
+    TempDirectory(const TempDirectory&) = delete;
+    TempDirectory& operator=(const TempDirectory&) = delete;
+
+    const std::string& path() const {return _path;}
+};
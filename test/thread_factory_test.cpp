@@ -0,0 +1,109 @@
+/**
+ * @file thread_factory_test.cpp
+ * @author Abdulelah Mulla
+ * @brief Unit tests for the thread factory
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include <cstring>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "thread_factory.h"
+#include "params.h"
+
+#include <unistd.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("The thread table is consistent", "[thread_factory]") {
+    std::set<int> orders;
+    for (int i = 0; i < MITL_THREAD_COUNT; i++) {
+        const ThreadSpec &spec = THREAD_TABLE[i];
+        REQUIRE(static_cast<int>(spec.id) == i);
+        REQUIRE(std::strlen(spec.name) <= 15);
+        REQUIRE(orders.insert(spec.start_order).second);
+        if (spec.policy == SCHED_FIFO) {
+            REQUIRE(spec.priority >= sched_get_priority_min(SCHED_FIFO));
+            REQUIRE(spec.priority <= sched_get_priority_max(SCHED_FIFO));
+        }
+    }
+    /// Inner loops above outer ones
+    REQUIRE(THREAD_TABLE[static_cast<int>(MitlThread::RATE)].priority >
+            THREAD_TABLE[static_cast<int>(MitlThread::ATTITUDE)].priority);
+    REQUIRE(THREAD_TABLE[static_cast<int>(MitlThread::ATTITUDE)].priority >
+            THREAD_TABLE[static_cast<int>(MitlThread::CONTROL)].priority);
+}
+
+TEST_CASE("Spawned threads are named and joinable", "[thread_factory]") {
+    Params::initialize().reset();
+    std::string name;
+    bool ran = false;
+    MitlThread current = MitlThread::COUNT;
+    FactoryThread thread = ThreadFactory::initialize().spawn(MitlThread::HEALTH, [&] {
+        char buffer[16] = {};
+        pthread_getname_np(pthread_self(), buffer, sizeof(buffer));
+        name = buffer;
+        current = ThreadFactory::current();
+        /// Use some of the stack
+        volatile char scratch[32 * 1024];
+        scratch[0] = 1;
+        ran = scratch[0] == 1;
+    });
+    REQUIRE(thread.joinable());
+    FactoryThread moved = std::move(thread);
+    REQUIRE_FALSE(thread.joinable());
+    moved.join();
+    REQUIRE_FALSE(moved.joinable());
+    REQUIRE(ran);
+    REQUIRE(name == "mitl_health");
+    REQUIRE(current == MitlThread::HEALTH);
+    REQUIRE(ThreadFactory::current() == MitlThread::COUNT);
+}
+
+TEST_CASE("The real-time core is reserved", "[thread_factory]") {
+    if (sysconf(_SC_NPROCESSORS_CONF) < 2) {
+        WARN("Needs two CPUs, skipped");
+        return;
+    }
+    REQUIRE(Params::initialize().set(param::MITL_RT_CPU, 0));
+    cpu_set_t rt_set, other_set;
+    CPU_ZERO(&rt_set);
+    CPU_ZERO(&other_set);
+    FactoryThread rt = ThreadFactory::initialize().spawn(MitlThread::ATTITUDE, [&] {
+        pthread_getaffinity_np(pthread_self(), sizeof(rt_set), &rt_set);
+    });
+    FactoryThread other = ThreadFactory::initialize().spawn(MitlThread::HEALTH, [&] {
+        pthread_getaffinity_np(pthread_self(), sizeof(other_set), &other_set);
+    });
+    rt.join();
+    other.join();
+    Params::initialize().reset();
+
+    REQUIRE(CPU_COUNT(&rt_set) == 1);
+    REQUIRE(CPU_ISSET(0, &rt_set));
+    REQUIRE_FALSE(CPU_ISSET(0, &other_set));
+}
+
+TEST_CASE("Modules start in order and stop in reverse", "[thread_factory]") {
+    ThreadFactory &threads = ThreadFactory::initialize();
+    std::vector<std::string> events;
+    threads.add(MitlThread::HEALTH, [&] {events.push_back("start health");}, [&] {events.push_back("stop health");});
+    threads.add(MitlThread::ATTITUDE, [&] {events.push_back("start attitude");}, [&] {events.push_back("stop attitude");});
+    threads.add(MitlThread::CONTROL, [&] {events.push_back("start control");}, [&] {events.push_back("stop control");});
+
+    threads.start();
+    threads.start();
+    threads.stop();
+    threads.stop();
+    const std::vector<std::string> expected = {"start attitude", "start control", "start health",
+                                               "stop health", "stop control", "stop attitude"};
+    REQUIRE(events == expected);
+
+    /// Leave nothing behind that points at this test
+    for (MitlThread id : {MitlThread::HEALTH, MitlThread::ATTITUDE, MitlThread::CONTROL}) {
+        threads.add(id, nullptr, nullptr);
+    }
+}
@@ -0,0 +1,72 @@
+/**
+ * @file trace_test.cpp
+ * @author Abdulelah Mulla
+ * @brief Unit tests for latency tracing along the control path
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "morb.h"
+#include "trace.h"
+#include "sensors.h"
+#include "vehicle_state.h"
+#include "estimator/estimator.h"
+#include "temp_directory.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+static std::string read_file(const std::string &path) {
+    std::ifstream in(path);
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    return buffer.str();
+}
+
+TEST_CASE("Stages advance the trace context", "[trace]") {
+    Trace &trace = Trace::initialize();
+    TraceContext ctx = trace.begin();
+    REQUIRE(ctx.id != 0);
+    REQUIRE(ctx.last_ns == ctx.origin_ns);
+
+    trace.stage(ctx, TraceStage::TRANSPORT);
+    REQUIRE(ctx.last_ns >= ctx.origin_ns);
+
+    trace.enable(false);
+    REQUIRE(trace.begin().id == 0);
+    trace.enable(true);
+}
+
+TEST_CASE("An IMU sample is traced through to the estimator output", "[trace]") {
+    Morb morb;
+    Estimator estimator(&morb);
+
+    VehicleState received{};
+    bool got_state = false;
+    morb.subscribe<VehicleState>("vehicle_state", [&](const VehicleState &state) {
+        received = state;
+        got_state = true;
+    });
+
+    SensorImu imu{};
+    imu.trace = Trace::initialize().begin();
+    Trace::initialize().stage(imu.trace, TraceStage::TRANSPORT);
+    morb.publish<SensorImu>("sensor_imu", imu);
+
+    /// Synchronous bus, the estimator has already run
+    REQUIRE(got_state);
+    REQUIRE(received.trace.id == imu.trace.id);
+    REQUIRE(received.trace.origin_ns == imu.trace.origin_ns);
+    REQUIRE(received.trace.last_ns >= imu.trace.last_ns);
+
+    const TempDirectory temp("trace");
+    const std::string path = temp.path() + "/trace_test.json";
+    REQUIRE(Trace::initialize().export_chrome_json(path));
+    const std::string json = read_file(path);
+    REQUIRE(json.find("\"traceEvents\"") != std::string::npos);
+    REQUIRE(json.find("\"name\":\"estimator\"") != std::string::npos);
+    REQUIRE(json.find("\"trace_id\":" + std::to_string(imu.trace.id)) != std::string::npos);
+}
@@ -0,0 +1,132 @@
+/**
+ * @file trajectory_test.cpp
+ * @author Abdulelah Mulla
+ * @brief Unit tests for the trajectory generator
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#include "navigator/trajectory.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+
+using Catch::Approx;
+
+static float norm(const float *v) {
+    return std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+}
+
+TEST_CASE("A single leg goes from rest to rest", "[trajectory]") {
+    const float waypoints[1][3] = {{10.f, -5.f, -3.f}};
+    const TrajectoryPoint start{};
+    for (TrajectoryOrder order : {TrajectoryOrder::MIN_JERK, TrajectoryOrder::MIN_SNAP}) {
+        auto trajectory = Trajectory::solve(waypoints, 1, start, {2.f, 1.f}, order);
+        REQUIRE(trajectory->segment_count() == 1);
+
+        size_t hint = 0;
+        TrajectoryPoint point;
+        trajectory->evaluate(0.0, hint, point);
+        REQUIRE(norm(point.ned) == Approx(0.f).margin(1e-4));
+        REQUIRE(norm(point.vel) == Approx(0.f).margin(1e-4));
+
+        trajectory->evaluate(trajectory->duration() - 1e-6, hint, point);
+        for (int axis = 0; axis < 3; axis++) {
+            REQUIRE(point.ned[axis] == Approx(waypoints[0][axis]).margin(1e-3));
+        }
+        REQUIRE(norm(point.vel) == Approx(0.f).margin(1e-3));
+        REQUIRE(norm(point.acc) == Approx(0.f).margin(1e-3));
+
+        /// Held after the end
+        trajectory->evaluate(trajectory->duration() + 5.0, hint, point);
+        REQUIRE(point.ned[0] == Approx(10.f).margin(1e-3));
+        REQUIRE(norm(point.vel) == 0.f);
+    }
+}
+
+TEST_CASE("Velocity and acceleration limits are respected", "[trajectory]") {
+    const float waypoints[3][3] = {{20.f, 0.f, -5.f}, {20.f, 20.f, -5.f}, {40.f, 25.f, -10.f}};
+    const TrajectoryLimits limits{3.f, 1.5f};
+    auto trajectory = Trajectory::solve(waypoints, 3, TrajectoryPoint{}, limits, TrajectoryOrder::MIN_SNAP);
+
+    size_t hint = 0;
+    TrajectoryPoint point;
+    for (double t = 0.0; t <= trajectory->duration(); t += 0.01) {
+        trajectory->evaluate(t, hint, point);
+        REQUIRE(norm(point.vel) <= limits.max_velocity * 1.02f);
+        REQUIRE(norm(point.acc) <= limits.max_acceleration * 1.05f);
+    }
+}
+
+TEST_CASE("Legs join at the waypoints", "[trajectory]") {
+    const float waypoints[3][3] = {{10.f, 0.f, 0.f}, {20.f, 1.f, 0.f}, {30.f, 0.f, 0.f}};
+    auto trajectory = Trajectory::solve(waypoints, 3, TrajectoryPoint{}, {5.f, 3.f}, TrajectoryOrder::MIN_SNAP);
+    REQUIRE(trajectory->segment_count() == 3);
+
+    for (size_t i = 1; i < trajectory->segment_count(); i++) {
+        const double t = trajectory->segment(i).start;
+        size_t before = i - 1, after = i;
+        TrajectoryPoint end, begin;
+        trajectory->evaluate(t - 1e-9, before, end);
+        trajectory->evaluate(t, after, begin);
+        for (int axis = 0; axis < 3; axis++) {
+            REQUIRE(begin.ned[axis] == Approx(waypoints[i - 1][axis]).margin(1e-3));
+            REQUIRE(end.ned[axis] == Approx(begin.ned[axis]).margin(1e-3));
+            REQUIRE(end.vel[axis] == Approx(begin.vel[axis]).margin(1e-3));
+            REQUIRE(end.acc[axis] == Approx(begin.acc[axis]).margin(1e-3));
+        }
+        /// Nearly straight, so it flies through without stopping
+        REQUIRE(begin.vel[0] > 1.f);
+    }
+}
+
+TEST_CASE("Velocity and acceleration are the derivatives of position", "[trajectory]") {
+    const float waypoints[2][3] = {{5.f, 5.f, -2.f}, {0.f, 10.f, -4.f}};
+    TrajectoryPoint start{};
+    start.vel[0] = 1.f;
+    auto trajectory = Trajectory::solve(waypoints, 2, start, {4.f, 2.f}, TrajectoryOrder::MIN_SNAP);
+
+    const double dt = 1e-3;
+    size_t hint = 0;
+    for (double t = 0.5; t < trajectory->duration() - 0.5; t += 0.37) {
+        TrajectoryPoint before, now, after;
+        size_t h0 = 0, h1 = 0;
+        trajectory->evaluate(t - dt, h0, before);
+        trajectory->evaluate(t, hint, now);
+        trajectory->evaluate(t + dt, h1, after);
+        for (int axis = 0; axis < 3; axis++) {
+            REQUIRE(now.vel[axis] == Approx((after.ned[axis] - before.ned[axis]) / (2 * dt)).margin(1e-2));
+            REQUIRE(now.acc[axis] == Approx((after.vel[axis] - before.vel[axis]) / (2 * dt)).margin(1e-2));
+        }
+    }
+}
+
+TEST_CASE("The generator solves off the calling thread", "[trajectory]") {
+    TrajectoryGenerator generator;
+    static const float first_points[1][3] = {{1.f, 0.f, 0.f}};
+    static const float second_points[1][3] = {{0.f, 8.f, 0.f}};
+    /// Static, nothing to own
+    const WaypointPath first(WaypointPath(), first_points);
+    const WaypointPath second(WaypointPath(), second_points);
+    const uint32_t old_id = generator.request(first, 1, TrajectoryPoint{}, {2.f, 1.f});
+    const uint32_t id = generator.request(second, 1, TrajectoryPoint{}, {2.f, 1.f});
+    REQUIRE(id != old_id);
+
+    TrajectoryTracker tracker;
+    tracker.start(generator, second, 1, TrajectoryPoint{}, {2.f, 1.f});
+
+    TrajectoryPoint point;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (!tracker.sample(generator, 0.0, point) && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    /// The tracker only follows its own request
+    REQUIRE(tracker.sample(generator, 100.0, point));
+    REQUIRE(point.ned[1] == Approx(8.f).margin(1e-3));
+    REQUIRE(tracker.finished(100.0));
+    REQUIRE(generator.latest(old_id) == nullptr);
+}
@@ -0,0 +1,148 @@
+/**
+ * @file watchdog_test.cpp
+ * @author Abdulelah Mulla
+ * @brief Unit tests for the deadline watchdog
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "watchdog.h"
+#include "params.h"
+#include "morb.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+static constexpr uint64_t MS = 1000000;
+
+/**
+ * @brief Watches one thread and collects the reports.
+ */
+struct Watched {
+    Morb morb;
+    Watchdog &watchdog{Watchdog::initialize()};
+    std::vector<WatchdogReport> reports;
+    MitlThread id;
+
+    explicit Watched(MitlThread thread) : id(thread) {
+        Params::initialize().reset();
+        morb.subscribe<WatchdogReport>("watchdog_report", [this](const WatchdogReport &report) {
+            reports.push_back(report);
+        });
+        watchdog.attach(&morb);
+        watchdog.idle(id);
+        watchdog.watch(id, std::chrono::milliseconds(20));
+    }
+
+    ~Watched() {
+        watchdog.unwatch(id);
+        watchdog.stage(id, "none");
+        watchdog.check(0);
+        watchdog.detach();
+    }
+};
+
+TEST_CASE("A thread that keeps beating is never late", "[watchdog]") {
+    Watched watched(MitlThread::ATTITUDE);
+    uint64_t now = 1000 * MS;
+    for (int i = 0; i < 100; i++) {
+        watched.watchdog.beat(watched.id);
+        watched.watchdog.check(now);
+        now += 15 * MS;
+        watched.watchdog.idle(watched.id);
+        watched.watchdog.check(now);
+        now += 10 * MS;
+    }
+    REQUIRE(watched.reports.empty());
+}
+
+TEST_CASE("An idle thread is never late", "[watchdog]") {
+    Watched watched(MitlThread::ATTITUDE);
+    watched.watchdog.check(1000 * MS);
+    watched.watchdog.check(5000 * MS);
+    REQUIRE(watched.reports.empty());
+}
+
+TEST_CASE("A stuck cycle is reported once, with its stage", "[watchdog]") {
+    Watched watched(MitlThread::ATTITUDE);
+    REQUIRE(Params::initialize().set(param::MITL_WD_ACTION, static_cast<int32_t>(WatchdogAction::LAND)));
+    uint64_t now = 1000 * MS;
+    watched.watchdog.check(now);
+    watched.watchdog.beat(watched.id);
+    watched.watchdog.stage(watched.id, "attitude law");
+    watched.watchdog.check(now);
+    watched.watchdog.check(now + 20 * MS);
+    REQUIRE(watched.reports.empty());
+
+    watched.watchdog.check(now + 30 * MS);
+    watched.watchdog.check(now + 40 * MS);
+    REQUIRE(watched.reports.size() == 1);
+    const WatchdogReport &miss = watched.reports[0];
+    REQUIRE(miss.thread == MitlThread::ATTITUDE);
+    REQUIRE(miss.late);
+    REQUIRE(miss.failsafe);
+    REQUIRE(miss.busy_us == 30000);
+    REQUIRE(std::strcmp(miss.stage, "attitude law") == 0);
+    REQUIRE(miss.holder == 0);
+    REQUIRE_FALSE(miss.inversion);
+
+    /// Back to waiting for work
+    watched.watchdog.idle(watched.id);
+    watched.watchdog.check(now + 50 * MS);
+    REQUIRE(watched.reports.size() == 2);
+    REQUIRE_FALSE(watched.reports[1].late);
+    REQUIRE_FALSE(watched.reports[1].failsafe);
+    REQUIRE(watched.reports[1].misses == 1);
+    Params::initialize().reset();
+}
+
+TEST_CASE("A miss only reports by default", "[watchdog]") {
+    Watched watched(MitlThread::ATTITUDE);
+    REQUIRE(Params::initialize().get(param::MITL_WD_ACTION) == static_cast<int32_t>(WatchdogAction::REPORT));
+    watched.watchdog.check(1000 * MS);
+    watched.watchdog.beat(watched.id);
+    watched.watchdog.check(1000 * MS);
+    watched.watchdog.check(1100 * MS);
+
+    REQUIRE(watched.reports.size() == 1);
+    REQUIRE(watched.reports[0].late);
+    REQUIRE_FALSE(watched.reports[0].failsafe);
+}
+
+TEST_CASE("A lower priority lock holder is a priority inversion", "[watchdog]") {
+    Watched watched(MitlThread::CONTROL);
+    WatchedMutex mutex;
+    std::atomic<pid_t> holder{0};
+    std::atomic<bool> release{false};
+
+    /// A normal priority thread, as a MAVSDK callback would be
+    std::thread callback([&] {
+        std::lock_guard<WatchedMutex> lock(mutex);
+        holder.store(Watchdog::thread_id());
+        while (!release.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    while (holder.load() == 0) {
+        std::this_thread::yield();
+    }
+    REQUIRE(mutex.owner() == holder.load());
+
+    watched.watchdog.check(1000 * MS);
+    watched.watchdog.beat(watched.id);
+    watched.watchdog.stage(watched.id, "mode lock", &mutex);
+    watched.watchdog.check(1000 * MS);
+    watched.watchdog.check(1100 * MS);
+    release.store(true);
+    callback.join();
+    REQUIRE(mutex.owner() == 0);
+
+    REQUIRE(watched.reports.size() == 1);
+    REQUIRE(std::strcmp(watched.reports[0].stage, "mode lock") == 0);
+    REQUIRE(watched.reports[0].holder == holder.load());
+    REQUIRE(watched.reports[0].inversion);
+}
@@ -0,0 +1,313 @@
+/**
+ * @file mitl_analyze.cpp
+ * @author Abdulelah Mulla
+ * @brief Flight statistics from the binary sensor log
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include "analysis/log_reader.h"
+#include "analysis/column_reader.h"
+#include "analysis/flight_stats.h"
+
+#ifdef MITL_HAVE_ARROW
+#include <arrow/api.h>
+#include <arrow/io/file.h>
+#include <arrow/ipc/writer.h>
+
+/// Wrap a column without copying, the table lives shorter than the columns
+template<typename T>
+static std::shared_ptr<arrow::Array> arrow_column(const void *data, size_t rows) {
+    using ArrowType = typename arrow::CTypeTraits<T>::ArrowType;
+    auto buffer = std::make_shared<arrow::Buffer>(static_cast<const uint8_t*>(data), rows * sizeof(T));
+    return std::make_shared<arrow::NumericArray<ArrowType>>(rows, buffer);
+}
+
+static arrow::Status write_table_arrow(const TableRef &table, const std::string &path) {
+    arrow::FieldVector fields;
+    arrow::ArrayVector arrays;
+    for (const ColumnRef &column : table.columns) {
+        switch (column.type) {
+            case ColumnType::U8:
+                arrays.push_back(arrow_column<uint8_t>(column.data, table.rows));
+                break;
+            case ColumnType::U32:
+                arrays.push_back(arrow_column<uint32_t>(column.data, table.rows));
+                break;
+            case ColumnType::U64:
+                arrays.push_back(arrow_column<uint64_t>(column.data, table.rows));
+                break;
+            case ColumnType::F32:
+                arrays.push_back(arrow_column<float>(column.data, table.rows));
+                break;
+            case ColumnType::F64:
+                arrays.push_back(arrow_column<double>(column.data, table.rows));
+                break;
+        }
+        fields.push_back(arrow::field(column.name, arrays.back()->type()));
+    }
+    const auto schema = arrow::schema(fields);
+    ARROW_ASSIGN_OR_RAISE(auto file, arrow::io::FileOutputStream::Open(path));
+    ARROW_ASSIGN_OR_RAISE(auto writer, arrow::ipc::MakeFileWriter(file, schema));
+    ARROW_RETURN_NOT_OK(writer->WriteTable(*arrow::Table::Make(schema, arrays)));
+    ARROW_RETURN_NOT_OK(writer->Close());
+    return file->Close();
+}
+#endif
+
+/**
+ * @brief Write each table as an Arrow IPC file, name.arrow.
+ * @return false if Arrow is not compiled in, or a file failed
+ */
+static bool write_tables_arrow(const std::vector<TableRef> &tables, const std::string &directory) {
+#ifdef MITL_HAVE_ARROW
+    bool ok = true;
+    for (const TableRef &table : tables) {
+        const arrow::Status status = write_table_arrow(table, directory + "/" + table.name + ".arrow");
+        if (!status.ok()) {
+            std::cerr << table.name << ": " << status.ToString() << std::endl;
+            ok = false;
+        }
+    }
+    return ok;
+#else
+    (void)tables;
+    (void)directory;
+    std::cerr << "Built without Apache Arrow, use --format=csv" << std::endl;
+    return false;
+#endif
+}
+
+static void print_summary(const LogColumns &columns, const FlightStats &stats) {
+    std::printf("%llu records in %llu blocks, %.1f s of flight\n",
+                static_cast<unsigned long long>(columns.records), static_cast<unsigned long long>(columns.blocks),
+                (stats.end - stats.start) * 1e-6);
+    if (columns.bad_blocks || columns.bad_records) {
+        std::printf("skipped %llu bad blocks, %llu records of an unknown layout\n",
+                    static_cast<unsigned long long>(columns.bad_blocks),
+                    static_cast<unsigned long long>(columns.bad_records));
+    }
+
+    std::printf("\n%-22s %10s %10s %12s %12s\n", "topic", "count", "rate Hz", "p99 gap us", "max gap us");
+    for (const TopicRate &rate : stats.rates) {
+        std::printf("%-22s %10llu %10.1f %12llu %12llu\n", rate.label.c_str(),
+                    static_cast<unsigned long long>(rate.count), rate.rate_hz,
+                    static_cast<unsigned long long>(rate.p99_interval_us),
+                    static_cast<unsigned long long>(rate.max_interval_us));
+    }
+
+    if (stats.loop_interval.total() > 0) {
+        std::printf("\ncontrol loop: period p50 %llu us, p99 %llu us; latency p50 %llu us, p99 %llu us\n",
+                    static_cast<unsigned long long>(stats.loop_interval.percentile(0.5)),
+                    static_cast<unsigned long long>(stats.loop_interval.percentile(0.99)),
+                    static_cast<unsigned long long>(stats.latency.percentile(0.5)),
+                    static_cast<unsigned long long>(stats.latency.percentile(0.99)));
+    }
+    if (stats.loop_cycles > 0) {
+        std::printf("control loop: %llu cycles, %llu overruns, longest %u us\n",
+                    static_cast<unsigned long long>(stats.loop_cycles),
+                    static_cast<unsigned long long>(stats.loop_overruns), stats.max_cycle_us);
+    }
+    if (stats.actuator_samples > 0) {
+        std::printf("actuators: mean thrust %.3f, saturated %.2f%%\n", stats.mean_thrust,
+                    100.0 * stats.saturated / stats.actuator_samples);
+    }
+
+    std::printf("\n%-8s %10s %10s %10s %10s %10s\n", "mode", "samples", "rms xy m", "max xy m", "rms z m",
+                "rms v m/s");
+    for (int i = 0; i < MODE_COUNT; i++) {
+        const TrackingStats &t = stats.tracking[i];
+        if (t.samples > 0) {
+            std::printf("%-8s %10llu %10.3f %10.3f %10.3f %10.3f\n", mode_name(static_cast<ModeId>(i)),
+                        static_cast<unsigned long long>(t.samples), t.rms_horizontal, t.max_horizontal,
+                        t.rms_vertical, t.rms_velocity);
+        }
+    }
+
+    if (!stats.modes.empty()) {
+        std::printf("\n");
+        for (const ModeSpan &span : stats.modes) {
+            std::printf("%10.3f s  %-8s %8.3f s\n", (span.start - stats.start) * 1e-6, mode_name(span.mode),
+                        (span.end - span.start) * 1e-6);
+        }
+    }
+}
+
+/**
+ * @brief Write one field of a topic as time_us,value rows in signal.csv.
+ *
+ * Only COLUMNAR segments hold fields, and only the chunks of the field
+ * in [from, to] are decompressed.
+ *
+ * @param signal label:field, like "[IMU]:linear_acceleration.z"
+ * @return process exit code
+ */
+static int export_signal(const std::vector<std::string> &segments, const std::string &signal, uint64_t from,
+                         uint64_t to, const std::string &directory) {
+    const size_t split = signal.rfind(':');
+    if (split == std::string::npos) {
+        std::cerr << "Expected --signal=<label>:<field>" << std::endl;
+        return 1;
+    }
+    const std::string label = signal.substr(0, split);
+    const std::string name = signal.substr(split + 1);
+
+    std::vector<uint64_t> times;
+    std::vector<double> values;
+    uint64_t read = 0;
+    uint64_t stored = 0;
+    for (const std::string &path : segments) {
+        ColumnarSegment segment;
+        if (!segment.open(path)) {
+            std::cerr << "Not a columnar segment: " << path << std::endl;
+            continue;
+        }
+        const int topic = segment.find_topic(label);
+        const int field = segment.find_field(topic, name);
+        if (field < 0) {
+            continue;
+        }
+        if (!segment.read_values(topic, field, from, to, values, &times)) {
+            std::cerr << "Bad chunk in " << path << std::endl;
+        }
+        read += segment.bytes_read();
+        for (const LogChunkIndex &chunk : segment.chunks()) {
+            stored += chunk.header.raw_size;
+        }
+    }
+    if (times.empty()) {
+        std::cerr << "No values of " << signal << std::endl;
+        return 1;
+    }
+
+    mkdir(directory.c_str(), 0755);
+    const std::string path = directory + "/signal.csv";
+    FILE *file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        return 1;
+    }
+    std::fprintf(file, "time_us,%s\n", name.c_str());
+    for (size_t i = 0; i < times.size(); i++) {
+        std::fprintf(file, "%llu,%.9g\n", static_cast<unsigned long long>(times[i]), values[i]);
+    }
+    const bool ok = std::fclose(file) == 0;
+    std::printf("%zu values of %s written to %s, %.1f%% of the log decompressed\n", times.size(), signal.c_str(),
+                path.c_str(), stored ? 100.0 * read / stored : 0.0);
+    return ok ? 0 : 1;
+}
+
+/**
+ * @brief Parse a time in seconds, like "12.5", into µs.
+ * @return false unless it is a finite, non-negative number and nothing else
+ */
+static bool parse_seconds(const char *text, uint64_t &us) {
+    char *end = nullptr;
+    const double seconds = std::strtod(text, &end);
+    if (end == text || *end != '\0' || !std::isfinite(seconds) || seconds < 0.0 || seconds * 1e6 >= 1.8e19) {
+        return false;
+    }
+    us = static_cast<uint64_t>(seconds * 1e6);
+    return true;
+}
+
+/**
+ * Reads the segments of a sensor log, on all cores, prints a summary
+ * and exports the statistics and the bus message columns for notebooks.
+ * Arguments:
+ * --out=<dir>: where the files go (default: analysis)
+ * --format=csv|arrow: format of the columns (default: csv), the
+ *   statistics are always CSV
+ * --threads=<n>: reader threads (default: one per core)
+ * --signal=<label>:<field>: only export one field of a COLUMNAR log,
+ *   with --from=<s> and --to=<s> in sim time to bound it
+ * Then any number of segments, or directories of segments.
+ */
+int main(int argc, char *argv[]) {
+    std::string out = "analysis";
+    std::string format = "csv";
+    unsigned threads = 0;
+    std::string signal;
+    uint64_t from = 0;
+    uint64_t to = UINT64_MAX;
+    std::vector<std::string> paths;
+    bool valid = true;
+
+    for (int i = 1; i < argc && valid; i++) {
+        std::string arg(argv[i]);
+
+        if (arg.find("--out=") == 0) {
+            out = arg.substr(6);
+        } else if (arg.find("--format=") == 0) {
+            format = arg.substr(9);
+        } else if (arg.find("--threads=") == 0) {
+            threads = static_cast<unsigned>(std::strtoul(arg.c_str() + 10, nullptr, 10));
+        } else if (arg.find("--signal=") == 0) {
+            signal = arg.substr(9);
+        } else if (arg.find("--from=") == 0) {
+            if (!parse_seconds(arg.c_str() + 7, from)) {
+                std::cout << "Expected seconds, not negative: " << arg << std::endl;
+                valid = false;
+            }
+        } else if (arg.find("--to=") == 0) {
+            if (!parse_seconds(arg.c_str() + 5, to)) {
+                std::cout << "Expected seconds, not negative: " << arg << std::endl;
+                valid = false;
+            }
+        } else if (arg.find("--") == 0) {
+            std::cout << "Unknown argument: " << arg << std::endl;
+            valid = false;
+        } else {
+            paths.push_back(arg);
+        }
+    }
+    if (valid && from > to) {
+        std::cout << "--from is after --to" << std::endl;
+        valid = false;
+    }
+    if (!valid || paths.empty() || out.empty() || (format != "csv" && format != "arrow")) {
+        std::cout << "Usage: " << argv[0]
+                  << " [--out=<dir>] [--format=csv|arrow] [--threads=<n>]"
+                  << " [--signal=<label>:<field> [--from=<s>] [--to=<s>]] <segment or directory>..." << std::endl;
+        return 1;
+    }
+    if (!signal.empty()) {
+        return export_signal(find_segments(paths), signal, from, to, out);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const std::vector<std::string> segments = find_segments(paths);
+    std::vector<std::string> failed;
+    const LogColumns columns = read_segments(segments, threads, &failed);
+    for (const std::string &segment : failed) {
+        std::cerr << "Not a log segment: " << segment << std::endl;
+    }
+    if (failed.size() == segments.size()) {
+        return 1;
+    }
+    const FlightStats stats = compute_stats(columns);
+    const auto read = std::chrono::steady_clock::now();
+
+    print_summary(columns, stats);
+
+    mkdir(out.c_str(), 0755);
+    const std::vector<TableRef> tables = column_tables(columns);
+    bool ok = write_stats_csv(stats, out);
+    ok = (format == "arrow" ? write_tables_arrow(tables, out) : write_tables_csv(tables, out)) && ok;
+    const auto written = std::chrono::steady_clock::now();
+
+    std::printf("\n%zu segments read in %.2f s, written to %s/ in %.2f s\n", segments.size() - failed.size(),
+                std::chrono::duration<double>(read - start).count(), out.c_str(),
+                std::chrono::duration<double>(written - read).count());
+    return ok ? 0 : 1;
+}